@@ -5,6 +5,7 @@
 #include "browser/gui/app.h"
 
 #include "os/os.h"
+#include "type/font_finder.h"
 
 #include <spdlog/cfg/env.h>
 #include <spdlog/sinks/dup_filter_sink.h>
@@ -31,6 +32,7 @@ int main(int argc, char **argv) {
     spdlog::set_default_logger(std::make_shared<spdlog::logger>(kBrowserTitle, std::move(dup_filter)));
     spdlog::cfg::load_env_levels();
     spdlog::set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%L%$] %v");
+    type::start_indexing_system_fonts();
 
     std::optional<std::string> page_provided{std::nullopt};
     std::optional<unsigned> scale{std::nullopt};
@@ -6,9 +6,12 @@
 
 #include "css/rule.h"
 #include "dom/dom.h"
+#include "geom/geom.h"
 #include "gfx/color.h"
 #include "gfx/opengl_canvas.h"
 #include "gfx/painter.h"
+#include "os/os.h"
+#include "render/display_list.h"
 #include "render/render.h"
 #include "uri/uri.h"
 
@@ -22,6 +25,7 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
+#include <filesystem>
 #include <functional>
 #include <optional>
 #include <sstream>
@@ -156,6 +160,15 @@ App::~App() {
     ImGui::SFML::Shutdown();
 }
 
+std::optional<std::filesystem::path> App::http_cache_directory() {
+    auto const cache_path = os::cache_path();
+    if (!cache_path) {
+        return std::nullopt;
+    }
+
+    return std::filesystem::path{*cache_path} / "http";
+}
+
 void App::set_scale(unsigned scale) {
     scale_ = scale;
     ImGui::GetIO().FontGlobalScale = static_cast<float>(scale_);
@@ -392,20 +405,24 @@ void App::on_layout_updated() {
     nav_widget_extra_info_.clear();
     auto const *layout = engine_.layout();
     layout_str_ = layout != nullptr ? layout::to_string(*layout) : "";
+
+    auto const *flat_layout = engine_.flat_layout();
+    display_list_ = flat_layout != nullptr ? render::build_display_list(*flat_layout) : render::DisplayList{};
 }
 
 std::vector<dom::Node const *> App::get_hovered_nodes(geom::Position document_position) const {
-    auto const *layout = engine_.layout();
-    if (!page_loaded_ || layout == nullptr) {
+    auto const *layout = engine_.flat_layout();
+    auto const *index = engine_.spatial_index();
+    if (!page_loaded_ || layout == nullptr || index == nullptr) {
         return {};
     }
 
-    auto const *moused_over = layout::box_at_position(*layout, document_position);
-    if (moused_over == nullptr || moused_over->node == nullptr) {
+    auto const moused_over = index->box_at_position(*layout, document_position);
+    if (!moused_over || layout->node(*moused_over) == nullptr) {
         return {};
     }
 
-    return gather_node_and_parents(*moused_over->node);
+    return gather_node_and_parents(*layout->node(*moused_over));
 }
 
 geom::Position App::to_document_position(geom::Position window_position) const {
@@ -534,17 +551,22 @@ void App::clear_render_surface() {
 }
 
 void App::render_layout() {
-    auto const *layout = engine_.layout();
+    auto const *layout = engine_.flat_layout();
     if (layout == nullptr) {
         return;
     }
 
-    gfx::Painter painter(*canvas_);
     if (render_debug_) {
+        gfx::Painter painter(*canvas_);
         render::debug::render_layout_depth(painter, *layout);
-    } else {
-        render::render_layout(painter, *layout);
+        return;
     }
+
+    auto const &size = window_.getSize();
+    auto const scale = static_cast<int>(scale_);
+    geom::Rect const viewport{
+            0, -scroll_offset_y_, static_cast<int>(size.x) / scale, static_cast<int>(size.y) / scale};
+    display_list_.replay(*canvas_, viewport);
 }
 
 void App::render_overlay() {
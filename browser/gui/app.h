@@ -11,6 +11,8 @@
 #include "gfx/sfml_canvas.h"
 #include "layout/layout.h"
 #include "protocol/handler_factory.h"
+#include "render/display_list.h"
+#include "type/freetype.h"
 #include "uri/uri.h"
 #include "util/history.h"
 
@@ -18,7 +20,9 @@
 #include <SFML/System/Clock.hpp>
 #include <SFML/Window/Cursor.hpp>
 
+#include <filesystem>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -33,9 +37,17 @@ public:
     int run();
 
 private:
+    // Where responses are cached so that revisiting pages doesn't require
+    // downloading them again.
+    [[nodiscard]] static std::optional<std::filesystem::path> http_cache_directory();
+
     // Latest Firefox ESR user agent (on Windows). This matches what the Tor browser does.
-    engine::Engine engine_{protocol::HandlerFactory::create(
-            "Mozilla/5.0 (Windows NT 10.0; Win64; x64; rv:102.0) Gecko/20100101 Firefox/102.0")};
+    engine::Engine engine_{
+            protocol::HandlerFactory::create(
+                    "Mozilla/5.0 (Windows NT 10.0; Win64; x64; rv:102.0) Gecko/20100101 Firefox/102.0",
+                    http_cache_directory()),
+            std::make_unique<type::FreeTypeType>(),
+    };
     bool page_loaded_{};
 
     std::string browser_title_{};
@@ -62,6 +74,9 @@ private:
     // When we scroll "down", the web page is translated "up".
     int scroll_offset_y_{};
 
+    // Rebuilt whenever the layout changes, and then replayed every frame.
+    render::DisplayList display_list_{};
+
     bool render_debug_{};
 
     unsigned scale_{1};
@@ -39,7 +39,7 @@ int main(int argc, char **argv) {
     std::cout << dom::to_string(engine.dom());
     spdlog::info("Building TUI");
 
-    auto const *layout = engine.layout();
+    auto const *layout = engine.flat_layout();
     if (layout == nullptr) {
         spdlog::error("Unable to create a layout of {}", uri.uri);
         return 1;
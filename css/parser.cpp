@@ -237,7 +237,7 @@ std::vector<css::Rule> Parser::parse_rules() {
             advance(std::strlen("@media"));
             skip_whitespace_and_comments();
 
-            std::string_view tmp_query = consume_while([](char c) { return c != '{'; });
+            std::string_view tmp_query = consume_until_any_of("{");
             if (auto last_char = tmp_query.find_last_not_of(' '); last_char != std::string_view::npos) {
                 tmp_query.remove_suffix(tmp_query.size() - (last_char + 1));
             }
@@ -253,11 +253,11 @@ std::vector<css::Rule> Parser::parse_rules() {
         // Make sure we don't crash if we hit a currently unsupported at-rule.
         // @font-face works fine with the normal parsing-logic.
         if (starts_with("@") && !starts_with("@font-face")) {
-            auto kind = consume_while([](char c) { return c != ' ' && c != '{' && c != '('; });
+            auto kind = consume_until_any_of(" {(");
             spdlog::warn("Encountered unhandled {} at-rule", kind);
 
             skip_whitespace_and_comments();
-            std::ignore = consume_while([](char c) { return c != '{'; });
+            std::ignore = consume_until_any_of("{");
             consume_char(); // {
             skip_whitespace_and_comments();
 
@@ -310,7 +310,7 @@ constexpr void Parser::skip_if_neq(char c) {
 css::Rule Parser::parse_rule() {
     Rule rule{};
     while (peek() != '{') {
-        auto selector = consume_while([](char c) { return c != ',' && c != '{'; });
+        auto selector = consume_until_any_of(",{");
         rule.selectors.push_back(std::string{util::trim(selector)});
         skip_if_neq('{'); // ' ' or ','
         skip_whitespace_and_comments();
@@ -331,10 +331,10 @@ css::Rule Parser::parse_rule() {
 }
 
 std::pair<std::string_view, std::string_view> Parser::parse_declaration() {
-    auto name = consume_while([](char c) { return c != ':'; });
+    auto name = consume_until_any_of(":");
     consume_char(); // :
     skip_whitespace_and_comments();
-    auto value = consume_while([](char c) { return c != ';' && c != '}'; });
+    auto value = consume_until_any_of(";}");
     skip_if_neq('}'); // ;
     return {name, value};
 }
@@ -8,73 +8,122 @@
 #include "css/parser.h"
 #include "html/parser.h"
 #include "style/style.h"
+#include "style/stylesheet_index.h"
 
 #include <spdlog/spdlog.h>
-#include <zlib.h>
 
+#include <algorithm>
+#include <cstddef>
 #include <future>
 #include <iterator>
 #include <optional>
+#include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 using namespace std::literals;
 
 namespace engine {
+
+struct StylesheetDownload {
+    uri::Uri uri;
+    std::future<protocol::Response> response;
+};
+
+// Stylesheets linked more than once are only downloaded once.
+struct StylesheetDownloads {
+    std::vector<StylesheetDownload> downloads;
+    // The download used by each link, in document order.
+    std::vector<std::size_t> links;
+};
+
 namespace {
 
-std::optional<std::string> zlib_decode(std::string_view data) {
-    z_stream s{
-            .next_in = reinterpret_cast<Bytef const *>(data.data()),
-            .avail_in = static_cast<uInt>(data.size()),
-    };
+bool is_redirect(int status_code) {
+    return status_code == 301 || status_code == 302 || status_code == 307 || status_code == 308;
+}
 
-    // https://github.com/madler/zlib/blob/v1.2.13/zlib.h#L832
-    // The windowBits parameter is the base two logarithm of the
-    // maximum window size (the size of the history buffer). It
-    // should be in the range 8..15 for this version of the library.
-    // <...>
-    // windowBits can also be greater than 15 for optional gzip
-    // decoding. Add 32 to windowBits to enable zlib and gzip
-    // decoding with automatic header detection, or add 16 to decode
-    // only the gzip format <...>.
-    constexpr int kWindowBits = 15;
-    constexpr int kEnableGzip = 32;
-    if (inflateInit2(&s, kWindowBits + kEnableGzip) != Z_OK) {
-        return std::nullopt;
-    }
+StylesheetDownloads start_stylesheet_downloads(
+        protocol::IProtocolHandler &protocol_handler, uri::Uri const &base_uri, dom::Document const &document) {
+    auto head_links = dom::nodes_by_xpath(document.html(), "/html/head/link");
+    std::erase_if(head_links, [](auto const *link) {
+        return !link->attributes.contains("rel")
+                || (link->attributes.contains("rel") && link->attributes.at("rel") != "stylesheet")
+                || !link->attributes.contains("href");
+    });
 
-    std::string out{};
-    std::string buf{};
-    constexpr auto kZlibInflateChunkSize = std::size_t{64} * 1024; // Chosen by a fair dice roll.
-    buf.resize(kZlibInflateChunkSize);
-    do {
-        s.next_out = reinterpret_cast<Bytef *>(buf.data());
-        s.avail_out = static_cast<uInt>(buf.size());
-        int ret = inflate(&s, Z_NO_FLUSH);
-        if (ret != Z_OK && ret != Z_STREAM_END) {
-            spdlog::error("Error '{}: {}' during zlib inflation", ret, s.msg);
-            inflateEnd(&s);
-            return std::nullopt;
+    // Start downloading all stylesheets. They're all in flight at the same
+    // time without needing a thread each.
+    spdlog::info("Loading {} stylesheets", head_links.size());
+    StylesheetDownloads stylesheets;
+    stylesheets.links.reserve(head_links.size());
+    for (auto const *link : head_links) {
+        // The document may still be under construction, so nothing in it can
+        // be referenced from the download.
+        auto stylesheet_url = uri::Uri::parse(link->attributes.at("href"), base_uri);
+        auto &downloads = stylesheets.downloads;
+        auto existing = std::ranges::find(downloads, stylesheet_url.uri, [](auto const &d) { return d.uri.uri; });
+        if (existing != end(downloads)) {
+            stylesheets.links.push_back(static_cast<std::size_t>(std::distance(begin(downloads), existing)));
+            continue;
         }
 
-        uInt inflated_bytes = static_cast<uInt>(buf.size()) - s.avail_out;
-        out += buf.substr(0, inflated_bytes);
-    } while (s.avail_out == 0);
+        spdlog::info("Downloading stylesheet from {}", stylesheet_url.uri);
+        auto response = protocol::fetch(protocol_handler, stylesheet_url);
+        stylesheets.links.push_back(downloads.size());
+        downloads.push_back({std::move(stylesheet_url), std::move(response)});
+    }
+
+    return stylesheets;
+}
+
+std::vector<css::Rule> parse_stylesheet(uri::Uri const &stylesheet_url, protocol::Response style_data) {
+    if (style_data.err != protocol::Error::Ok) {
+        spdlog::warn("Error {} downloading {}", static_cast<int>(style_data.err), stylesheet_url.uri);
+        return {};
+    }
+
+    if ((stylesheet_url.scheme == "http" || stylesheet_url.scheme == "https")
+            && style_data.status_line.status_code != 200) {
+        spdlog::warn("Error {}: {} downloading {}",
+                style_data.status_line.status_code,
+                style_data.status_line.reason,
+                stylesheet_url.uri);
+        return {};
+    }
+
+    // Supported encodings are decoded by the protocol handlers as the data is
+    // received, so anything left is something we can't handle.
+    if (auto encoding = style_data.headers.get("Content-Encoding"); encoding && encoding != "identity") {
+        spdlog::warn("Got unsupported encoding '{}', skipping stylesheet '{}'", *encoding, stylesheet_url.uri);
+        return {};
+    }
 
-    inflateEnd(&s);
-    return out;
+    return css::parse(style_data.body);
 }
 
 } // namespace
 
 protocol::Error Engine::navigate(uri::Uri uri) {
-    auto is_redirect = [](int status_code) {
-        return status_code == 301 || status_code == 302 || status_code == 307 || status_code == 308;
+    // The document is parsed while it's being downloaded so that the
+    // stylesheets can be downloaded at the same time as the rest of it.
+    std::optional<html::Parser> parser;
+    StylesheetDownloads stylesheet_downloads;
+    auto load = [&] {
+        parser.emplace(html::ParserOptions{});
+        parser->set_on_head_parsed([&](dom::Document const &document) {
+            stylesheet_downloads = start_stylesheet_downloads(*protocol_handler_, uri_, document);
+        });
+        response_ = protocol_handler_->stream(uri_, [&](protocol::Response const &head, std::string_view data) {
+            if (!is_redirect(head.status_line.status_code)) {
+                parser->feed(data);
+            }
+        });
     };
 
     uri_ = std::move(uri);
-    response_ = protocol_handler_->handle(uri_);
+    load();
     while (response_.err == protocol::Error::Ok && is_redirect(response_.status_line.status_code)) {
         auto location = response_.headers.get("Location");
         if (!location) {
@@ -85,12 +134,13 @@ protocol::Error Engine::navigate(uri::Uri uri) {
 
         spdlog::info("Following {} redirect from {} to {}", response_.status_line.status_code, uri_.uri, *location);
         uri_ = uri::Uri::parse(std::string(*location), uri_);
-        response_ = protocol_handler_->handle(uri_);
+        load();
     }
 
     switch (response_.err) {
         case protocol::Error::Ok:
-            on_navigation_success();
+            dom_ = parser->finish();
+            on_navigation_success(std::move(stylesheet_downloads));
             break;
         default:
             on_navigation_failure_(response_.err);
@@ -101,18 +151,43 @@ protocol::Error Engine::navigate(uri::Uri uri) {
 }
 
 void Engine::set_layout_width(int width) {
-    layout_width_ = width;
+    auto const previous_width = std::exchange(layout_width_, width);
     if (!styled_) {
         return;
     }
 
-    styled_ = style::style_tree(dom_.html_node, stylesheet_, {.window_width = layout_width_});
-    layout_ = layout::create_layout(*styled_, layout_width_);
+    // Media queries are the only part of styling that depends on the width, so
+    // unless one of them changes its mind, the old styles and boxes are reused.
+    auto const &breakpoints = stylesheet_index_->width_breakpoints();
+    auto const breakpoint = std::ranges::upper_bound(breakpoints, std::min(previous_width, width));
+    if (breakpoint != end(breakpoints) && *breakpoint <= std::max(previous_width, width)) {
+        update_styles();
+        layout_ = layout::create_layout(*styled_, layout_width_, *type_, *pool_);
+    } else if (layout_) {
+        layout::relayout(*layout_, layout_width_, *type_);
+    }
+
+    update_flat_layout();
     on_layout_update_();
 }
 
-void Engine::on_navigation_success() {
-    dom_ = html::parse(response_.body);
+void Engine::update_styles() {
+    styled_ = style::style_tree(dom_.html_node, *stylesheet_index_, {.window_width = layout_width_}, *pool_);
+}
+
+void Engine::update_flat_layout() {
+    if (!layout_) {
+        flat_layout_.reset();
+        spatial_index_.reset();
+        return;
+    }
+
+    flat_layout_ = layout::FlatLayout::from(*layout_);
+    spatial_index_.emplace(*flat_layout_);
+}
+
+void Engine::on_navigation_success(StylesheetDownloads stylesheet_downloads) {
+    stylesheet_index_.reset();
     stylesheet_ = css::default_style();
 
     if (auto style = dom::nodes_by_xpath(dom_.html(), "/html/head/style"sv);
@@ -125,68 +200,35 @@ void Engine::on_navigation_success() {
                 end(stylesheet_), std::make_move_iterator(begin(new_rules)), std::make_move_iterator(end(new_rules)));
     }
 
-    auto head_links = dom::nodes_by_xpath(dom_.html(), "/html/head/link");
-    std::erase_if(head_links, [](auto const *link) {
-        return !link->attributes.contains("rel")
-                || (link->attributes.contains("rel") && link->attributes.at("rel") != "stylesheet")
-                || !link->attributes.contains("href");
-    });
-
-    // Start downloading all stylesheets.
-    spdlog::info("Loading {} stylesheets", head_links.size());
-    std::vector<std::future<std::vector<css::Rule>>> future_new_rules;
-    future_new_rules.reserve(head_links.size());
-    for (auto const *link : head_links) {
-        future_new_rules.push_back(std::async(std::launch::async, [=, this]() -> std::vector<css::Rule> {
-            auto const &href = link->attributes.at("href");
-            auto stylesheet_url = uri::Uri::parse(href, uri_);
-
-            spdlog::info("Downloading stylesheet from {}", stylesheet_url.uri);
-            auto style_data = protocol_handler_->handle(stylesheet_url);
-            if (style_data.err != protocol::Error::Ok) {
-                spdlog::warn("Error {} downloading {}", static_cast<int>(style_data.err), stylesheet_url.uri);
-                return {};
-            }
-
-            if ((stylesheet_url.scheme == "http" || stylesheet_url.scheme == "https")
-                    && style_data.status_line.status_code != 200) {
-                spdlog::warn("Error {}: {} downloading {}",
-                        style_data.status_line.status_code,
-                        style_data.status_line.reason,
-                        stylesheet_url.uri);
-                return {};
-            }
-
-            // https://developer.mozilla.org/en-US/docs/Web/HTTP/Headers/Content-Encoding#directives
-            auto encoding = style_data.headers.get("Content-Encoding");
-            if (encoding == "gzip" || encoding == "x-gzip") {
-                auto decoded = zlib_decode(style_data.body);
-                if (!decoded) {
-                    spdlog::error("Failed {}-decoding of '{}'", *encoding, stylesheet_url.uri);
-                    return {};
-                }
-
-                style_data.body = *std::move(decoded);
-            } else if (encoding) {
-                spdlog::warn("Got unsupported encoding '{}', skipping stylesheet '{}'", *encoding, stylesheet_url.uri);
-                return {};
-            }
-
-            return css::parse(style_data.body);
-        }));
+    // Wait for every download to finish, and then parse the ones that
+    // haven't been parsed before in parallel.
+    auto &downloads = stylesheet_downloads.downloads;
+    std::vector<protocol::Response> responses;
+    responses.reserve(downloads.size());
+    for (auto &download : downloads) {
+        responses.push_back(download.response.get());
     }
 
-    // In order, wait for the download to finish and merge with the big stylesheet.
-    for (auto &future_rules : future_new_rules) {
-        auto rules = future_rules.get();
+    std::vector<StylesheetCache::Rules> downloaded_rules(downloads.size());
+    pool_->parallel_for(downloads.size(), [&](std::size_t i) {
+        downloaded_rules[i] = stylesheet_cache_->get_or_parse(downloads[i].uri.uri, responses[i], [&] {
+            return parse_stylesheet(downloads[i].uri, std::move(responses[i]));
+        });
+    });
+
+    // In order, merge with the big stylesheet. The cached rules are shared, so
+    // they're copied rather than moved.
+    for (auto i : stylesheet_downloads.links) {
+        auto const &rules = *downloaded_rules[i];
         stylesheet_.reserve(stylesheet_.size() + rules.size());
-        stylesheet_.insert(
-                end(stylesheet_), std::make_move_iterator(begin(rules)), std::make_move_iterator(end(rules)));
+        stylesheet_.insert(end(stylesheet_), begin(rules), end(rules));
     }
 
     spdlog::info("Styling dom w/ {} rules", stylesheet_.size());
-    styled_ = style::style_tree(dom_.html_node, stylesheet_, {.window_width = layout_width_});
-    layout_ = layout::create_layout(*styled_, layout_width_);
+    stylesheet_index_.emplace(stylesheet_);
+    update_styles();
+    layout_ = layout::create_layout(*styled_, layout_width_, *type_, *pool_);
+    update_flat_layout();
     on_page_loaded_();
 }
 
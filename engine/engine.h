@@ -6,12 +6,20 @@
 #ifndef ENGINE_ENGINE_H_
 #define ENGINE_ENGINE_H_
 
+#include "engine/stylesheet_cache.h"
+
 #include "css/rule.h"
 #include "dom/dom.h"
+#include "layout/flat_layout.h"
 #include "layout/layout.h"
+#include "layout/spatial_index.h"
 #include "protocol/iprotocol_handler.h"
 #include "style/styled_node.h"
+#include "style/stylesheet_index.h"
+#include "type/naive.h"
+#include "type/type.h"
 #include "uri/uri.h"
+#include "util/work_stealing_pool.h"
 
 #include <functional>
 #include <memory>
@@ -21,10 +29,13 @@
 
 namespace engine {
 
+struct StylesheetDownloads;
+
 class Engine {
 public:
-    explicit Engine(std::unique_ptr<protocol::IProtocolHandler> protocol_handler)
-        : protocol_handler_{std::move(protocol_handler)} {}
+    explicit Engine(std::unique_ptr<protocol::IProtocolHandler> protocol_handler,
+            std::unique_ptr<type::IType> type = std::make_unique<type::NaiveType>())
+        : protocol_handler_{std::move(protocol_handler)}, type_{std::move(type)} {}
 
     protocol::Error navigate(uri::Uri uri);
 
@@ -38,7 +49,13 @@ public:
     protocol::Response const &response() const { return response_; }
     dom::Document const &dom() const { return dom_; }
     std::vector<css::Rule> const &stylesheet() const { return stylesheet_; }
+    StylesheetCacheStats stylesheet_cache_stats() const { return stylesheet_cache_->stats(); }
     layout::LayoutBox const *layout() const { return layout_.has_value() ? &*layout_ : nullptr; }
+    layout::FlatLayout const *flat_layout() const { return flat_layout_.has_value() ? &*flat_layout_ : nullptr; }
+    // Indexes the boxes in flat_layout().
+    layout::SpatialIndex const *spatial_index() const {
+        return spatial_index_.has_value() ? &*spatial_index_ : nullptr;
+    }
 
 private:
     std::function<void(protocol::Error)> on_navigation_failure_{[](protocol::Error) {
@@ -51,15 +68,26 @@ private:
     int layout_width_{};
 
     std::unique_ptr<protocol::IProtocolHandler> protocol_handler_{};
+    std::unique_ptr<type::IType> type_{};
 
     uri::Uri uri_{};
     protocol::Response response_{};
     dom::Document dom_{};
     std::vector<css::Rule> stylesheet_{};
+    // Built whenever stylesheet_ changes and reused for every restyle until then.
+    std::optional<style::StylesheetIndex> stylesheet_index_{};
     std::unique_ptr<style::StyledNode> styled_{};
     std::optional<layout::LayoutBox> layout_{};
-
-    void on_navigation_success();
+    // The same boxes as in layout_, stored for fast traversal.
+    std::optional<layout::FlatLayout> flat_layout_{};
+    std::optional<layout::SpatialIndex> spatial_index_{};
+    std::unique_ptr<util::WorkStealingPool> pool_{std::make_unique<util::WorkStealingPool>()};
+    // Kept between navigations, as pages on the same site tend to share stylesheets.
+    std::unique_ptr<StylesheetCache> stylesheet_cache_{std::make_unique<StylesheetCache>()};
+
+    void update_styles();
+    void update_flat_layout();
+    void on_navigation_success(StylesheetDownloads stylesheet_downloads);
 };
 
 } // namespace engine
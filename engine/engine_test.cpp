@@ -4,13 +4,17 @@
 
 #include "engine/engine.h"
 
+#include "dom/dom.h"
 #include "etest/etest.h"
 #include "protocol/iprotocol_handler.h"
 #include "protocol/response.h"
 #include "uri/uri.h"
 
+#include <chrono>
+#include <future>
 #include <map>
 #include <string>
+#include <string_view>
 #include <utility>
 
 using namespace std::literals;
@@ -31,6 +35,57 @@ private:
     std::map<std::string, Response> responses_;
 };
 
+// Counts how many times each URL is requested.
+class CountingProtocolHandler final : public protocol::IProtocolHandler {
+public:
+    CountingProtocolHandler(std::map<std::string, Response> responses, std::map<std::string, int> &requests)
+        : responses_{std::move(responses)}, requests_{requests} {}
+    [[nodiscard]] Response handle(uri::Uri const &uri) override {
+        ++requests_[uri.uri];
+        return responses_.at(uri.uri);
+    }
+
+private:
+    std::map<std::string, Response> responses_;
+    std::map<std::string, int> &requests_;
+};
+
+// Hands over the page in two pieces, only sending the second one once the
+// stylesheet linked in the first one has been requested.
+class StreamingProtocolHandler final : public protocol::IProtocolHandler {
+public:
+    [[nodiscard]] Response handle(uri::Uri const &uri) override {
+        if (uri.uri == "hax://example.com/style.css") {
+            stylesheet_requested_.set_value();
+            return Response{.err = Error::Ok, .status_line{.status_code = 200}, .body{"p { color: green; }"}};
+        }
+
+        return {.err = Error::Unresolved};
+    }
+
+    [[nodiscard]] Response stream(uri::Uri const &, protocol::BodyDataCallback const &on_body_data) override {
+        Response response{.err = Error::Ok, .status_line{.status_code = 200}};
+        auto send = [&](std::string_view data) {
+            response.body += data;
+            on_body_data(response, data);
+        };
+
+        send("<html><head><link rel=stylesheet href=style.css></head><body>"sv);
+        // The tokenizer waits for a bit more data before it knows the head is done.
+        send(std::string(64, ' '));
+        stylesheet_requested_before_body_ =
+                stylesheet_requested_.get_future().wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+        send("<p>hello</p></body></html>"sv);
+        return response;
+    }
+
+    bool stylesheet_requested_before_body() const { return stylesheet_requested_before_body_; }
+
+private:
+    std::promise<void> stylesheet_requested_;
+    bool stylesheet_requested_before_body_{false};
+};
+
 bool contains(std::vector<css::Rule> const &stylesheet, css::Rule const &rule) {
     return std::ranges::find(stylesheet, rule) != end(stylesheet);
 }
@@ -120,6 +175,47 @@ int main() {
         expect(success);
     });
 
+    etest::test("layout update, media query breakpoints", [] {
+        std::map<std::string, Response> responses{{
+                "hax://example.com"s,
+                Response{
+                        .err = Error::Ok,
+                        .status_line = {.status_code = 200},
+                        .body{"<html><head><style>"
+                              "p { height: 10px; } "
+                              "@media (min-width: 500px) { p { height: 20px; } }"
+                              "</style></head><body><p></p></body></html>"},
+                },
+        }};
+        engine::Engine e{std::make_unique<FakeProtocolHandler>(std::move(responses))};
+        e.set_layout_width(100);
+        e.navigate(uri::Uri::parse("hax://example.com"));
+
+        auto p_height = [&] {
+            auto const *p = dom::nodes_by_xpath(*e.layout(), "/html/body/p").at(0);
+            return p->dimensions.content.height;
+        };
+        expect_eq(p_height(), 10);
+
+        int layout_updates{};
+        e.set_on_layout_updated([&] { ++layout_updates; });
+
+        e.set_layout_width(499);
+        expect_eq(p_height(), 10);
+        expect_eq(e.layout()->dimensions.content.width, 499);
+
+        e.set_layout_width(500);
+        expect_eq(p_height(), 20);
+        expect_eq(e.layout()->dimensions.content.width, 500);
+
+        e.set_layout_width(1000);
+        expect_eq(p_height(), 20);
+
+        e.set_layout_width(200);
+        expect_eq(p_height(), 10);
+        expect_eq(layout_updates, 4);
+    });
+
     etest::test("css in <head><style> takes priority over browser built-in css", [] {
         std::map<std::string, Response> responses{{
                 "hax://example.com"s,
@@ -179,115 +275,75 @@ int main() {
         expect(contains(e.stylesheet(), {.selectors{"p"}, .declarations{{css::PropertyId::Color, "green"}}}));
     });
 
-    etest::test("stylesheet link, unsupported Content-Encoding", [] {
+    etest::test("stylesheet link, same stylesheet linked twice", [] {
         std::map<std::string, Response> responses;
         responses["hax://example.com"s] = Response{
                 .err = Error::Ok,
                 .status_line = {.status_code = 200},
-                .body{"<html><head><link rel=stylesheet href=lol.css /></head></html>"},
-        };
-        responses["hax://example.com/lol.css"s] = Response{
-                .err = Error::Ok,
-                .status_line = {.status_code = 200},
-                .headers{{"Content-Encoding", "really-borked-content-type"}},
-                .body{"p { font-size: 123em; }"},
+                .body{"<html><head>"
+                      "<link rel=stylesheet href=one.css />"
+                      "<link rel=stylesheet href=two.css />"
+                      "<link rel=stylesheet href=one.css />"
+                      "</head></html>"},
         };
-        engine::Engine e{std::make_unique<FakeProtocolHandler>(std::move(responses))};
-        e.navigate(uri::Uri::parse("hax://example.com"));
-        expect(!contains(e.stylesheet(), {.selectors{"p"}, .declarations{{css::PropertyId::FontSize, "123em"}}}));
-    });
-
-    // p { font-size: 123em; }, gzipped.
-    std::string gzipped_css =
-            "\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\x03\x2b\x50\xa8\x56\x48\xcb\xcf\x2b\xd1\x2d\xce\xac\x4a\xb5\x52\x30\x34\x32\x4e\xcd\xb5\x56\xa8\xe5\x02\x00\x0c\x97\x72\x35\x18\x00\x00\x00"s;
-
-    etest::test("stylesheet link, gzip Content-Encoding", [gzipped_css] {
-        std::map<std::string, Response> responses;
-        responses["hax://example.com"s] = Response{
+        responses["hax://example.com/one.css"s] = Response{
                 .err = Error::Ok,
                 .status_line = {.status_code = 200},
-                .body{"<html><head><link rel=stylesheet href=lol.css /></head></html>"},
+                .body{"p { color: green; }"},
         };
-        responses["hax://example.com/lol.css"s] = Response{
+        responses["hax://example.com/two.css"s] = Response{
                 .err = Error::Ok,
                 .status_line = {.status_code = 200},
-                .headers{{"Content-Encoding", "gzip"}},
-                .body{gzipped_css},
+                .body{"p { color: red; }"},
         };
-        engine::Engine e{std::make_unique<FakeProtocolHandler>(responses)};
+        std::map<std::string, int> requests;
+        engine::Engine e{std::make_unique<CountingProtocolHandler>(std::move(responses), requests)};
         e.navigate(uri::Uri::parse("hax://example.com"));
-        expect(std::ranges::find(e.stylesheet(),
-                       css::Rule{
-                               .selectors{"p"},
-                               .declarations{{css::PropertyId::FontSize, "123em"}},
-                       })
-                != end(e.stylesheet()));
-
-        // And again, but with x-gzip instead.
-        responses["hax://example.com/lol.css"s] = Response{
-                .err = Error::Ok,
-                .status_line = {.status_code = 200},
-                .headers{{"Content-Encoding", "x-gzip"}},
-                .body{std::move(gzipped_css)},
-        };
-        e = engine::Engine{std::make_unique<FakeProtocolHandler>(responses)};
+        expect_eq(requests["hax://example.com/one.css"], 1);
+        expect_eq(e.stylesheet_cache_stats(), engine::StylesheetCacheStats{.misses = 2});
+
+        // The rules still appear once per link, so the last link wins.
+        require(!e.stylesheet().empty());
+        expect_eq(e.stylesheet().back(),
+                css::Rule{.selectors{"p"}, .declarations{{css::PropertyId::Color, "green"}}});
+        expect(contains(e.stylesheet(), {.selectors{"p"}, .declarations{{css::PropertyId::Color, "red"}}}));
+
+        // The second navigation reuses the rules parsed in the first one.
         e.navigate(uri::Uri::parse("hax://example.com"));
-        expect(std::ranges::find(e.stylesheet(),
-                       css::Rule{
-                               .selectors{"p"},
-                               .declarations{{css::PropertyId::FontSize, "123em"}},
-                       })
-                != end(e.stylesheet()));
+        expect_eq(requests["hax://example.com/one.css"], 2);
+        expect_eq(e.stylesheet_cache_stats(), engine::StylesheetCacheStats{.hits = 2, .misses = 2});
+        expect_eq(e.stylesheet().back(),
+                css::Rule{.selectors{"p"}, .declarations{{css::PropertyId::Color, "green"}}});
     });
 
-    etest::test("stylesheet link, gzip Content-Encoding, bad header", [gzipped_css]() mutable {
-        std::map<std::string, Response> responses;
-        responses["hax://example.com"s] = Response{
-                .err = Error::Ok,
-                .status_line = {.status_code = 200},
-                .body{"<html><head><link rel=stylesheet href=lol.css /></head></html>"},
-        };
-        // Ruin the gzip header.
-        gzipped_css[1] += 1;
-        responses["hax://example.com/lol.css"s] = Response{
-                .err = Error::Ok,
-                .status_line = {.status_code = 200},
-                .headers{{"Content-Encoding", "gzip"}},
-                .body{std::move(gzipped_css)},
-        };
-        engine::Engine e{std::make_unique<FakeProtocolHandler>(std::move(responses))};
+    etest::test("stylesheet link, downloaded while the page is loading", [] {
+        auto handler = std::make_unique<StreamingProtocolHandler>();
+        auto const &streaming_handler = *handler;
+        engine::Engine e{std::move(handler)};
         e.navigate(uri::Uri::parse("hax://example.com"));
-        expect(std::ranges::find(e.stylesheet(),
-                       css::Rule{
-                               .selectors{"p"},
-                               .declarations{{css::PropertyId::FontSize, "123em"}},
-                       })
-                == end(e.stylesheet()));
+        expect(streaming_handler.stylesheet_requested_before_body());
+        expect(contains(e.stylesheet(), {.selectors{"p"}, .declarations{{css::PropertyId::Color, "green"}}}));
+
+        auto const &body = std::get<dom::Element>(e.dom().html().children.at(1));
+        expect_eq(std::get<dom::Element>(body.children.at(0)).name, "p");
     });
 
-    etest::test("stylesheet link, gzip Content-Encoding, crc32 mismatch", [gzipped_css]() mutable {
+    etest::test("stylesheet link, unsupported Content-Encoding", [] {
         std::map<std::string, Response> responses;
         responses["hax://example.com"s] = Response{
                 .err = Error::Ok,
                 .status_line = {.status_code = 200},
                 .body{"<html><head><link rel=stylesheet href=lol.css /></head></html>"},
         };
-        // Ruin the content.
-        gzipped_css[20] += 1;
         responses["hax://example.com/lol.css"s] = Response{
                 .err = Error::Ok,
                 .status_line = {.status_code = 200},
-                .headers{{"Content-Encoding", "gzip"}},
-                .body{std::move(gzipped_css)},
+                .headers{{"Content-Encoding", "really-borked-content-type"}},
+                .body{"p { font-size: 123em; }"},
         };
         engine::Engine e{std::make_unique<FakeProtocolHandler>(std::move(responses))};
         e.navigate(uri::Uri::parse("hax://example.com"));
-        expect(std::ranges::find(e.stylesheet(),
-                       css::Rule{
-                               .selectors{"p"},
-                               .declarations{{css::PropertyId::FontSize, "123em"}},
-                       })
-                == end(e.stylesheet()));
+        expect(!contains(e.stylesheet(), {.selectors{"p"}, .declarations{{css::PropertyId::FontSize, "123em"}}}));
     });
 
     etest::test("redirect", [] {
@@ -296,6 +352,8 @@ int main() {
                 .err = Error::Ok,
                 .status_line = {.status_code = 301},
                 .headers = {{"Location", "hax://example.com/redirected"}},
+                // Nothing in the body of the redirect should be loaded.
+                .body{"<html><head><link rel=stylesheet href=moved.css></head></html>"},
         };
         responses["hax://example.com/redirected"s] = Response{
                 .err = Error::Ok,
@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "engine/stylesheet_cache.h"
+
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+
+namespace engine {
+
+StylesheetCache::Rules StylesheetCache::get_or_parse(std::string_view url,
+        protocol::Response const &response,
+        std::function<std::vector<css::Rule>()> const &parse) {
+    auto k = key(url, response);
+    std::promise<Rules> promise;
+    {
+        std::unique_lock lock{mtx_};
+        if (auto *entry = entries_.get(k)) {
+            auto rules = *entry;
+            if (rules.wait_for(std::chrono::seconds{0}) == std::future_status::ready) {
+                ++stats_.hits;
+            } else {
+                ++stats_.coalesced;
+            }
+
+            lock.unlock();
+            return rules.get();
+        }
+
+        ++stats_.misses;
+        entries_.put(k, promise.get_future().share());
+    }
+
+    Rules rules;
+    try {
+        rules = std::make_shared<std::vector<css::Rule> const>(parse());
+    } catch (...) {
+        // Nothing's cached, so the next lookup tries parsing it again.
+        {
+            std::lock_guard lock{mtx_};
+            entries_.erase(k);
+        }
+
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+
+    promise.set_value(rules);
+    return rules;
+}
+
+StylesheetCacheStats StylesheetCache::stats() const {
+    std::lock_guard lock{mtx_};
+    return stats_;
+}
+
+void StylesheetCache::clear() {
+    std::lock_guard lock{mtx_};
+    entries_.clear();
+}
+
+std::string StylesheetCache::key(std::string_view url, protocol::Response const &response) {
+    // Responses with the same validator have the same body, and hashing the
+    // body is a lot cheaper than parsing it again when there's no validator.
+    auto validator = response.headers.get("etag"sv);
+    if (!validator) {
+        validator = response.headers.get("last-modified"sv);
+    }
+
+    auto const body_id = validator
+            ? std::string{*validator}
+            : std::to_string(response.body.size()) + ':' + std::to_string(std::hash<std::string_view>{}(response.body));
+    return std::to_string(static_cast<int>(response.err)) + ' ' + std::to_string(response.status_line.status_code)
+            + ' ' + body_id + ' ' + std::string{url};
+}
+
+} // namespace engine
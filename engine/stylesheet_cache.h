@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef ENGINE_STYLESHEET_CACHE_H_
+#define ENGINE_STYLESHEET_CACHE_H_
+
+#include "css/rule.h"
+#include "protocol/response.h"
+#include "util/lru_cache.h"
+
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace engine {
+
+struct StylesheetCacheStats {
+    std::size_t hits{};
+    std::size_t misses{};
+    // Lookups that waited on a parse another thread had already started.
+    std::size_t coalesced{};
+
+    [[nodiscard]] bool operator==(StylesheetCacheStats const &) const = default;
+};
+
+// Parsed stylesheets, shared between navigations so that pages using the
+// same stylesheets don't have to parse them again. Safe to use from multiple
+// threads.
+class StylesheetCache {
+public:
+    using Rules = std::shared_ptr<std::vector<css::Rule> const>;
+
+    explicit StylesheetCache(std::size_t max_entries = 64) : entries_{max_entries} {}
+
+    // Returns the rules parsed out of the response, only calling parse if
+    // nothing has been parsed out of a response for the same URL with the same
+    // validator, or the same body if it doesn't have one. Only one thread at a
+    // time parses any given stylesheet, with the others waiting for its rules.
+    // If parse throws, nothing is cached and the exception is passed on to
+    // everyone waiting for the rules.
+    [[nodiscard]] Rules get_or_parse(std::string_view url,
+            protocol::Response const &,
+            std::function<std::vector<css::Rule>()> const &parse);
+
+    [[nodiscard]] StylesheetCacheStats stats() const;
+    void clear();
+
+private:
+    [[nodiscard]] static std::string key(std::string_view url, protocol::Response const &);
+
+    mutable std::mutex mtx_;
+    // Either parsed or being parsed.
+    util::LruCache<std::string, std::shared_future<Rules>> entries_;
+    StylesheetCacheStats stats_{};
+};
+
+} // namespace engine
+
+#endif
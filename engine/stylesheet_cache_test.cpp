@@ -0,0 +1,164 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "engine/stylesheet_cache.h"
+
+#include "css/rule.h"
+#include "etest/etest.h"
+#include "protocol/response.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using etest::expect;
+using etest::expect_eq;
+using engine::StylesheetCache;
+using engine::StylesheetCacheStats;
+using protocol::Response;
+
+namespace {
+
+Response response(protocol::Headers headers, std::string body = "p { color: green; }") {
+    return Response{
+            .status_line{"HTTP/1.1", 200, "OK"},
+            .headers = std::move(headers),
+            .body = std::move(body),
+    };
+}
+
+std::vector<css::Rule> const kRules{{.selectors{"p"}, .declarations{{css::PropertyId::Color, "green"}}}};
+
+} // namespace
+
+int main() {
+    etest::test("parsed stylesheets are reused", [] {
+        StylesheetCache cache;
+        int parses{};
+        auto parse = [&] {
+            ++parses;
+            return kRules;
+        };
+
+        auto first = cache.get_or_parse("https://example.com/a.css", response({{"ETag", "\"1\""}}), parse);
+        auto second = cache.get_or_parse("https://example.com/a.css", response({{"ETag", "\"1\""}}), parse);
+        expect_eq(*first, kRules);
+        expect_eq(first, second);
+        expect_eq(parses, 1);
+        expect_eq(cache.stats(), StylesheetCacheStats{.hits = 1, .misses = 1});
+    });
+
+    etest::test("changed stylesheets are parsed again", [] {
+        StylesheetCache cache;
+        int parses{};
+        auto parse = [&] {
+            ++parses;
+            return kRules;
+        };
+
+        std::ignore = cache.get_or_parse("https://example.com/a.css", response({{"ETag", "\"1\""}}), parse);
+        std::ignore = cache.get_or_parse("https://example.com/a.css", response({{"ETag", "\"2\""}}), parse);
+        std::ignore = cache.get_or_parse("https://example.com/b.css", response({{"ETag", "\"2\""}}), parse);
+        expect_eq(parses, 3);
+    });
+
+    etest::test("stylesheets without validators are compared by body", [] {
+        StylesheetCache cache;
+        int parses{};
+        auto parse = [&] {
+            ++parses;
+            return kRules;
+        };
+
+        std::ignore = cache.get_or_parse("https://example.com/a.css", response({}), parse);
+        std::ignore = cache.get_or_parse("https://example.com/a.css", response({}), parse);
+        expect_eq(parses, 1);
+
+        std::ignore = cache.get_or_parse("https://example.com/a.css", response({}, "p { color: red; }"), parse);
+        expect_eq(parses, 2);
+    });
+
+    etest::test("least recently used stylesheets are evicted", [] {
+        StylesheetCache cache{1};
+        int parses{};
+        auto parse = [&] {
+            ++parses;
+            return kRules;
+        };
+
+        std::ignore = cache.get_or_parse("https://example.com/a.css", response({}), parse);
+        std::ignore = cache.get_or_parse("https://example.com/b.css", response({}), parse);
+        std::ignore = cache.get_or_parse("https://example.com/a.css", response({}), parse);
+        expect_eq(parses, 3);
+    });
+
+    etest::test("failed parses aren't cached", [] {
+        StylesheetCache cache;
+        int parses{};
+        auto parse = [&] {
+            if (parses++ == 0) {
+                throw std::runtime_error{"oh no"};
+            }
+            return kRules;
+        };
+
+        bool threw{};
+        try {
+            std::ignore = cache.get_or_parse("https://example.com/a.css", response({}), parse);
+        } catch (std::runtime_error const &) {
+            threw = true;
+        }
+
+        expect(threw);
+        expect_eq(*cache.get_or_parse("https://example.com/a.css", response({}), parse), kRules);
+        expect_eq(parses, 2);
+    });
+
+    etest::test("concurrent parses of the same stylesheet are coalesced", [] {
+        StylesheetCache cache;
+        std::promise<void> parse_started;
+        std::promise<void> finish_parse;
+        std::atomic<int> parses{};
+        auto parse = [&] {
+            ++parses;
+            parse_started.set_value();
+            finish_parse.get_future().wait();
+            return kRules;
+        };
+
+        auto first = std::async(std::launch::async, [&] {
+            return cache.get_or_parse("https://example.com/a.css", response({}), parse);
+        });
+        parse_started.get_future().wait();
+
+        std::vector<std::future<StylesheetCache::Rules>> waiters;
+        for (int i = 0; i < 4; ++i) {
+            waiters.push_back(std::async(std::launch::async, [&] {
+                return cache.get_or_parse("https://example.com/a.css", response({}), parse);
+            }));
+        }
+
+        // Wait for every waiter to find the parse in progress.
+        while (cache.stats().coalesced < 4) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+
+        finish_parse.set_value();
+        auto rules = first.get();
+        for (auto &waiter : waiters) {
+            expect_eq(waiter.get(), rules);
+        }
+
+        expect_eq(parses.load(), 1);
+        expect_eq(cache.stats(), StylesheetCacheStats{.misses = 1, .coalesced = 4});
+    });
+
+    return etest::run_all_tests();
+}
@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef ETEST_TMP_DIR_H_
+#define ETEST_TMP_DIR_H_
+
+#include <filesystem>
+#include <random>
+#include <string>
+#include <system_error>
+
+namespace etest {
+
+// A new, empty directory that's removed along with everything in it when this
+// goes away.
+class TmpDir {
+public:
+    TmpDir() {
+        std::random_device rng;
+        path_ = std::filesystem::temp_directory_path() / ("hastur-test." + std::to_string(rng()));
+        std::filesystem::create_directories(path_);
+    }
+
+    ~TmpDir() {
+        std::error_code errc;
+        std::filesystem::remove_all(path_, errc);
+    }
+
+    TmpDir(TmpDir const &) = delete;
+    TmpDir &operator=(TmpDir const &) = delete;
+
+    std::filesystem::path const &path() const { return path_; }
+
+private:
+    std::filesystem::path path_;
+};
+
+} // namespace etest
+
+#endif
@@ -0,0 +1,161 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef GFX_BLEND_H_
+#define GFX_BLEND_H_
+
+#include "gfx/color.h"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define HASTUR_GFX_BLEND_SSE2
+#endif
+
+// Source-over blending of colors onto RGBA8 pixels. The vectorized and scalar
+// versions produce exactly the same results.
+namespace gfx {
+namespace detail {
+
+// Rounds x / 255 to the nearest integer for x in [0, 255 * 255].
+constexpr std::uint8_t div255(unsigned x) {
+    x += 128;
+    return static_cast<std::uint8_t>((x + (x >> 8)) >> 8);
+}
+
+constexpr void blend_pixel(std::uint8_t *dst, Color color, std::uint8_t alpha) {
+    unsigned const inverse = 255U - alpha;
+    dst[0] = div255(color.r * alpha + dst[0] * inverse);
+    dst[1] = div255(color.g * alpha + dst[1] * inverse);
+    dst[2] = div255(color.b * alpha + dst[2] * inverse);
+    dst[3] = div255(255U * alpha + dst[3] * inverse);
+}
+
+constexpr void blend_span_scalar(std::span<std::uint8_t> rgba, Color color) {
+    for (std::size_t i = 0; i + 4 <= rgba.size(); i += 4) {
+        blend_pixel(rgba.data() + i, color, color.a);
+    }
+}
+
+constexpr void blend_mask_span_scalar(
+        std::span<std::uint8_t> rgba, std::span<std::uint8_t const> coverage, Color color) {
+    for (std::size_t i = 0; i < coverage.size(); ++i) {
+        if (coverage[i] != 0) {
+            blend_pixel(rgba.data() + i * 4, color, div255(unsigned{color.a} * coverage[i]));
+        }
+    }
+}
+
+#if defined(HASTUR_GFX_BLEND_SSE2)
+// div255 on 16-bit lanes holding values in [0, 255 * 255].
+inline __m128i div255_epu16(__m128i x) {
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// Blends 2 pixels widened to 16-bit lanes, with alpha holding the alpha
+// for each lane.
+inline __m128i blend_epu16(__m128i dst, __m128i src, __m128i alpha) {
+    auto const inverse = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+    return div255_epu16(_mm_add_epi16(_mm_mullo_epi16(src, alpha), _mm_mullo_epi16(dst, inverse)));
+}
+
+inline __m128i widened_color(Color color) {
+    return _mm_setr_epi16(color.r, color.g, color.b, 255, color.r, color.g, color.b, 255);
+}
+
+inline void blend_span_sse2(std::span<std::uint8_t> rgba, Color color) {
+    auto const src = widened_color(color);
+    auto const alpha = _mm_set1_epi16(color.a);
+    auto const zero = _mm_setzero_si128();
+
+    std::size_t i = 0;
+    for (; i + 16 <= rgba.size(); i += 16) {
+        auto *p = reinterpret_cast<__m128i *>(rgba.data() + i);
+        auto const pixels = _mm_loadu_si128(p);
+        auto const lo = blend_epu16(_mm_unpacklo_epi8(pixels, zero), src, alpha);
+        auto const hi = blend_epu16(_mm_unpackhi_epi8(pixels, zero), src, alpha);
+        _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+    }
+
+    blend_span_scalar(rgba.subspan(i), color);
+}
+
+inline void blend_mask_span_sse2(std::span<std::uint8_t> rgba, std::span<std::uint8_t const> coverage, Color color) {
+    auto const src = widened_color(color);
+    auto const color_alpha = _mm_set1_epi16(color.a);
+    auto const zero = _mm_setzero_si128();
+
+    std::size_t i = 0;
+    for (; i + 4 <= coverage.size(); i += 4) {
+        std::uint32_t covered{};
+        std::memcpy(&covered, coverage.data() + i, sizeof(covered));
+        if (covered == 0) {
+            continue;
+        }
+
+        // a0 a1 a2 a3 -> a0 a0 a0 a0 a1 a1 a1 a1, a2 a2 a2 a2 a3 a3 a3 a3
+        auto const cov = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(covered)), zero);
+        auto const alpha = div255_epu16(_mm_mullo_epi16(cov, color_alpha));
+        auto const pairs = _mm_unpacklo_epi16(alpha, alpha);
+
+        auto *p = reinterpret_cast<__m128i *>(rgba.data() + i * 4);
+        auto const pixels = _mm_loadu_si128(p);
+        auto const lo = blend_epu16(_mm_unpacklo_epi8(pixels, zero), src, _mm_unpacklo_epi32(pairs, pairs));
+        auto const hi = blend_epu16(_mm_unpackhi_epi8(pixels, zero), src, _mm_unpackhi_epi32(pairs, pairs));
+        _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+    }
+
+    blend_mask_span_scalar(rgba.subspan(i * 4), coverage.subspan(i), color);
+}
+#endif
+
+} // namespace detail
+
+// Blends color over every pixel in rgba, which holds 4 bytes per pixel.
+inline void blend_span(std::span<std::uint8_t> rgba, Color color) {
+    assert(rgba.size() % 4 == 0);
+    if (color.a == 0) {
+        return;
+    }
+
+    if (color.a == 0xFF) {
+        std::array<std::uint8_t, 4> const pixel{color.r, color.g, color.b, color.a};
+        for (std::size_t i = 0; i < rgba.size(); i += 4) {
+            std::memcpy(rgba.data() + i, pixel.data(), pixel.size());
+        }
+        return;
+    }
+
+#if defined(HASTUR_GFX_BLEND_SSE2)
+    detail::blend_span_sse2(rgba, color);
+#else
+    detail::blend_span_scalar(rgba, color);
+#endif
+}
+
+// Blends color over the pixels in rgba, scaling its alpha by the coverage of
+// each pixel.
+inline void blend_mask_span(std::span<std::uint8_t> rgba, std::span<std::uint8_t const> coverage, Color color) {
+    assert(rgba.size() == coverage.size() * 4);
+    if (color.a == 0) {
+        return;
+    }
+
+#if defined(HASTUR_GFX_BLEND_SSE2)
+    detail::blend_mask_span_sse2(rgba, coverage, color);
+#else
+    detail::blend_mask_span_scalar(rgba, coverage, color);
+#endif
+}
+
+} // namespace gfx
+
+#endif
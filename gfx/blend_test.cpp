@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "gfx/blend.h"
+
+#include "etest/etest.h"
+#include "gfx/color.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using etest::expect_eq;
+
+namespace {
+
+std::vector<std::uint8_t> random_bytes(std::mt19937 &rng, std::size_t count) {
+    std::uniform_int_distribution<int> byte{0, 255};
+    std::vector<std::uint8_t> bytes(count);
+    for (auto &b : bytes) {
+        b = static_cast<std::uint8_t>(byte(rng));
+    }
+    return bytes;
+}
+
+gfx::Color random_color(std::mt19937 &rng) {
+    auto bytes = random_bytes(rng, 4);
+    return {bytes[0], bytes[1], bytes[2], bytes[3]};
+}
+
+} // namespace
+
+int main() {
+    etest::test("div255", [] {
+        for (unsigned x = 0; x <= 255 * 255; ++x) {
+            expect_eq(gfx::detail::div255(x), static_cast<std::uint8_t>((x * 2 + 255) / 510));
+        }
+    });
+
+    etest::test("blend span", [] {
+        std::vector<std::uint8_t> pixels{0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0, 0};
+        gfx::blend_span(pixels, {0xFF, 0, 0, 0x80});
+        expect_eq(pixels, std::vector<std::uint8_t>{0xFF, 0x7F, 0x7F, 0xFF, 0x80, 0, 0, 0x80});
+
+        gfx::blend_span(pixels, {1, 2, 3, 0xFF});
+        expect_eq(pixels, std::vector<std::uint8_t>{1, 2, 3, 0xFF, 1, 2, 3, 0xFF});
+
+        gfx::blend_span(pixels, {0xFF, 0xFF, 0xFF, 0});
+        expect_eq(pixels, std::vector<std::uint8_t>{1, 2, 3, 0xFF, 1, 2, 3, 0xFF});
+    });
+
+    etest::test("blend mask span", [] {
+        std::vector<std::uint8_t> pixels(5 * 4, 0xFF);
+        std::vector<std::uint8_t> const coverage{0, 0xFF, 0x80, 0, 0xFF};
+        gfx::blend_mask_span(pixels, coverage, {0, 0, 0, 0xFF});
+        expect_eq(pixels,
+                std::vector<std::uint8_t>{
+                        0xFF, 0xFF, 0xFF, 0xFF, // Not covered.
+                        0, 0, 0, 0xFF, // Fully covered.
+                        0x7F, 0x7F, 0x7F, 0xFF,
+                        0xFF, 0xFF, 0xFF, 0xFF,
+                        0, 0, 0, 0xFF,
+                });
+    });
+
+    etest::test("vectorized blending matches scalar blending", [] {
+        std::mt19937 rng{1234};
+        for (std::size_t pixel_count = 0; pixel_count < 40; ++pixel_count) {
+            auto const pixels = random_bytes(rng, pixel_count * 4);
+            auto const coverage = random_bytes(rng, pixel_count);
+            auto const color = random_color(rng);
+
+            auto expected = pixels;
+            gfx::detail::blend_span_scalar(expected, color);
+            auto actual = pixels;
+            gfx::blend_span(actual, color);
+            expect_eq(actual, expected);
+
+            expected = pixels;
+            gfx::detail::blend_mask_span_scalar(expected, coverage, color);
+            actual = pixels;
+            gfx::blend_mask_span(actual, coverage, color);
+            expect_eq(actual, expected);
+        }
+    });
+
+    return etest::run_all_tests();
+}
@@ -0,0 +1,50 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef GFX_FAKE_TYPE_H_
+#define GFX_FAKE_TYPE_H_
+
+#include "gfx/font.h"
+#include "type/type.h"
+
+#include <memory>
+#include <optional>
+#include <string_view>
+
+namespace gfx {
+
+// Draws every character as a 1x2 px block, with the top half fully covered
+// and the bottom half half-covered.
+class FakeFont : public type::IFont {
+public:
+    type::Size measure(std::string_view text, type::Px, FontStyle) const override {
+        return {static_cast<int>(text.size()), 2};
+    }
+
+    type::RasterizedText rasterize(std::string_view text, type::Px, FontStyle) const override {
+        type::RasterizedText rasterized{
+                .bounds{0, 0, static_cast<int>(text.size()), 2},
+                .baseline = 2,
+                .advance = static_cast<int>(text.size()),
+        };
+        rasterized.coverage.resize(text.size(), 0xFF);
+        rasterized.coverage.resize(text.size() * 2, 0x80);
+        return rasterized;
+    }
+};
+
+// Only has one font, FakeFont, named "fake".
+class FakeType : public type::IType {
+public:
+    std::optional<std::shared_ptr<type::IFont const>> font(std::string_view name) const override {
+        if (name != "fake") {
+            return std::nullopt;
+        }
+        return std::make_shared<FakeFont>();
+    }
+};
+
+} // namespace gfx
+
+#endif
@@ -5,6 +5,9 @@
 #ifndef GFX_FONT_H_
 #define GFX_FONT_H_
 
+#include "geom/geom.h"
+
+#include <algorithm>
 #include <string_view>
 #include <utility>
 
@@ -57,6 +60,13 @@ constexpr FontStyle operator~(FontStyle v) {
     return static_cast<FontStyle>(~std::to_underlying(v));
 }
 
+// Glyphs and underlines may reach a bit outside of the rectangle text was
+// measured to fill, so this errs on the side of being too large.
+constexpr geom::Rect padded_text_bounds(geom::Rect const &measured, FontSize size) {
+    auto const margin = std::max(measured.height, size.px) / 2 + 1;
+    return measured.expanded({margin, margin, margin, margin});
+}
+
 } // namespace gfx
 
 #endif
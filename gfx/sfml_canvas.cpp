@@ -5,8 +5,7 @@
 
 #include "gfx/sfml_canvas.h"
 
-#include "os/os.h"
-#include "util/string.h"
+#include "type/font_finder.h"
 
 #include <SFML/Graphics/RectangleShape.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
@@ -15,11 +14,9 @@
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
-#include <filesystem>
 #include <optional>
 #include <string>
 #include <string_view>
-#include <system_error>
 
 using namespace std::literals;
 
@@ -29,46 +26,6 @@ namespace {
 #include "gfx/basic_vertex_shader.h"
 #include "gfx/rect_fragment_shader.h"
 
-std::filesystem::recursive_directory_iterator get_font_dir_iterator(std::filesystem::path const &path) {
-    std::error_code errc;
-    if (auto it = std::filesystem::recursive_directory_iterator(path, errc); !errc) {
-        return it;
-    }
-
-    return {};
-}
-
-std::optional<std::string> find_path_to_fallback_font() {
-    for (auto const &path : os::font_paths()) {
-        for (auto const &entry : get_font_dir_iterator(path)) {
-            if (std::filesystem::is_regular_file(entry) && entry.path().filename().string().ends_with(".ttf")) {
-                spdlog::info("Using fallback {}", entry.path().string());
-                return std::make_optional(entry.path().string());
-            }
-        }
-    }
-
-    return std::nullopt;
-}
-
-// TODO(robinlinden): We should be looking at font names rather than filenames.
-std::optional<std::string> find_path_to_font(std::string_view font_filename) {
-    for (auto const &path : os::font_paths()) {
-        for (auto const &entry : get_font_dir_iterator(path)) {
-            auto name = entry.path().filename().string();
-            // TODO(robinlinden): std::ranges once Clang supports it. Last tested w/ 15.
-            if (std::search(begin(name), end(name), begin(font_filename), end(font_filename), [](char a, char b) {
-                    return util::lowercased(a) == util::lowercased(b);
-                }) != end(name)) {
-                spdlog::info("Found font {} for {}", entry.path().string(), font_filename);
-                return std::make_optional(entry.path().string());
-            }
-        }
-    }
-
-    return std::nullopt;
-}
-
 sf::Glsl::Vec2 to_vec2(int x, int y) {
     return {static_cast<float>(x), static_cast<float>(y)};
 }
@@ -163,7 +120,7 @@ void SfmlCanvas::draw_text(geom::Position p,
         Color color) {
     // Try to find a cached font.
     for (auto const &font : font_options) {
-        if (auto it = font_cache_.find(font.font); it != font_cache_.end()) {
+        if (font_cache_.get(font.font) != nullptr) {
             draw_text(p, text, font, size, style, color);
             return;
         }
@@ -171,13 +128,13 @@ void SfmlCanvas::draw_text(geom::Position p,
 
     // Try to load one of the options provided.
     for (auto const &font : font_options) {
-        auto font_path = find_path_to_font(font.font);
+        auto font_path = type::find_path_to_font(font.font);
         auto entry = std::make_shared<sf::Font>();
         if (!font_path || !entry->loadFromFile(*font_path)) {
             continue;
         }
 
-        font_cache_[std::string{font.font}] = std::move(entry);
+        font_cache_.put(std::string{font.font}, std::move(entry));
         draw_text(p, text, font, size, style, color);
         return;
     }
@@ -188,20 +145,19 @@ void SfmlCanvas::draw_text(geom::Position p,
     }
 }
 
-// TODO(robinlinden): Fonts are never evicted from the cache.
 void SfmlCanvas::draw_text(
         geom::Position p, std::string_view text, Font font, FontSize size, FontStyle style, Color color) {
     p = p.translated(tx_, ty_).scaled(scale_);
 
     auto const *sf_font = [&]() -> sf::Font const * {
-        if (auto it = font_cache_.find(font.font); it != font_cache_.end()) {
-            return &*it->second;
+        if (auto const *cached = font_cache_.get(font.font)) {
+            return &**cached;
         }
 
-        auto font_path = find_path_to_font(font.font);
+        auto font_path = type::find_path_to_font(font.font);
         if (!font_path) {
             spdlog::warn("Unable to find font {}, looking for literally any font", font.font);
-            font_path = find_path_to_fallback_font();
+            font_path = type::find_path_to_fallback_font();
         }
 
         auto entry = std::make_shared<sf::Font>();
@@ -209,8 +165,7 @@ void SfmlCanvas::draw_text(
             return nullptr;
         }
 
-        font_cache_[std::string{font.font}] = std::move(entry);
-        return &*font_cache_.find(font.font)->second;
+        return &*font_cache_.put(std::string{font.font}, std::move(entry));
     }();
 
     if (!sf_font) {
@@ -7,10 +7,13 @@
 
 #include "gfx/icanvas.h"
 
+#include "util/lru_cache.h"
+
 #include <SFML/Graphics/Shader.hpp>
 
-#include <map>
+#include <cstddef>
 #include <memory>
+#include <string>
 
 namespace sf {
 class Font;
@@ -37,9 +40,11 @@ public:
     void draw_text(geom::Position, std::string_view, Font, FontSize, FontStyle, Color) override;
 
 private:
+    static constexpr std::size_t kMaxCachedFonts = 32;
+
     sf::RenderTarget &target_;
     sf::Shader border_shader_{};
-    std::map<std::string, std::shared_ptr<sf::Font>, std::less<>> font_cache_;
+    util::LruCache<std::string, std::shared_ptr<sf::Font>> font_cache_{kMaxCachedFonts};
 
     int scale_{1};
     int tx_{0};
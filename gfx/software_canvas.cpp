@@ -0,0 +1,398 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "gfx/software_canvas.h"
+
+#include "gfx/blend.h"
+
+#include "geom/geom.h"
+#include "img/png.h"
+#include "type/freetype.h"
+#include "type/type.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <utility>
+
+namespace gfx {
+namespace {
+
+struct Vec2 {
+    float x{};
+    float y{};
+};
+
+constexpr Vec2 operator-(Vec2 a, Vec2 b) {
+    return {a.x - b.x, a.y - b.y};
+}
+
+constexpr Vec2 to_vec2(int x, int y) {
+    return {static_cast<float>(x), static_cast<float>(y)};
+}
+
+// The z component of the cross product of the vectors extended to 3d.
+constexpr float cross(Vec2 a, Vec2 b) {
+    return a.x * b.y - a.y * b.x;
+}
+
+// A port of rect_shader.frag, see that for what everything does.
+class RectShader {
+public:
+    RectShader(geom::Rect const &inner, geom::Rect const &outer, Color color, Borders const &borders, Corners const &c)
+        : inner_top_left_{to_vec2(inner.left(), inner.top())}, inner_top_right_{to_vec2(inner.right(), inner.top())},
+          inner_bottom_left_{to_vec2(inner.left(), inner.bottom())},
+          inner_bottom_right_{to_vec2(inner.right(), inner.bottom())},
+          outer_top_left_{to_vec2(outer.left(), outer.top())}, outer_top_right_{to_vec2(outer.right(), outer.top())},
+          outer_bottom_left_{to_vec2(outer.left(), outer.bottom())},
+          outer_bottom_right_{to_vec2(outer.right(), outer.bottom())},
+          top_left_radii_{to_vec2(c.top_left.horizontal, c.top_left.vertical)},
+          top_right_radii_{to_vec2(c.top_right.horizontal, c.top_right.vertical)},
+          bottom_left_radii_{to_vec2(c.bottom_left.horizontal, c.bottom_left.vertical)},
+          bottom_right_radii_{to_vec2(c.bottom_right.horizontal, c.bottom_right.vertical)},
+          left_border_color_{borders.left.color}, right_border_color_{borders.right.color},
+          top_border_color_{borders.top.color}, bottom_border_color_{borders.bottom.color}, inner_rect_color_{color} {
+        inner_top_left_radii_ = {std::max(top_left_radii_.x - (inner_top_left_.x - outer_top_left_.x), 0.f),
+                std::max(top_left_radii_.y - (inner_top_left_.y - outer_top_left_.y), 0.f)};
+        inner_top_right_radii_ = {std::max(top_right_radii_.x - (outer_top_right_.x - inner_top_right_.x), 0.f),
+                std::max(top_right_radii_.y - (inner_top_right_.y - outer_top_right_.y), 0.f)};
+        inner_bottom_left_radii_ = {
+                std::max(bottom_left_radii_.x - (inner_bottom_left_.x - outer_bottom_left_.x), 0.f),
+                std::max(bottom_left_radii_.y - (outer_bottom_left_.y - inner_bottom_left_.y), 0.f)};
+        inner_bottom_right_radii_ = {
+                std::max(bottom_right_radii_.x - (outer_bottom_right_.x - inner_bottom_right_.x), 0.f),
+                std::max(bottom_right_radii_.y - (outer_bottom_right_.y - inner_bottom_right_.y), 0.f)};
+
+        // The shader uses the bottom left radii for the top left corner here
+        // as well, so this does too to draw the same thing.
+        inner_top_left_inward_ = top_left_inward_pos(inner_top_left_, max_radius(inner_bottom_left_radii_));
+        inner_top_right_inward_ = top_right_inward_pos(inner_top_right_, max_radius(inner_top_right_radii_));
+        inner_bottom_left_inward_ = bottom_left_inward_pos(inner_bottom_left_, max_radius(inner_bottom_left_radii_));
+        inner_bottom_right_inward_ =
+                bottom_right_inward_pos(inner_bottom_right_, max_radius(inner_bottom_right_radii_));
+    }
+
+    [[nodiscard]] Color shade(Vec2 p) const {
+        if (is_inside_rounded_rect(p,
+                    inner_top_left_,
+                    inner_top_right_,
+                    inner_bottom_left_,
+                    inner_bottom_right_,
+                    inner_top_left_radii_,
+                    inner_top_right_radii_,
+                    inner_bottom_left_radii_,
+                    inner_bottom_right_radii_)) {
+            return inner_rect_color_;
+        }
+
+        if (!is_inside_rounded_rect(p,
+                    outer_top_left_,
+                    outer_top_right_,
+                    outer_bottom_left_,
+                    outer_bottom_right_,
+                    top_left_radii_,
+                    top_right_radii_,
+                    bottom_left_radii_,
+                    bottom_right_radii_)) {
+            return kNoColor;
+        }
+
+        if (is_point_inside_quadrilateral(
+                    p, outer_top_left_, outer_top_right_, inner_top_right_inward_, inner_top_left_inward_)) {
+            return top_border_color_;
+        }
+
+        if (is_point_inside_quadrilateral(
+                    p, outer_top_right_, outer_bottom_right_, inner_bottom_right_inward_, inner_top_right_inward_)) {
+            return right_border_color_;
+        }
+
+        if (is_point_inside_quadrilateral(p,
+                    outer_bottom_right_,
+                    outer_bottom_left_,
+                    inner_bottom_left_inward_,
+                    inner_bottom_right_inward_)) {
+            return bottom_border_color_;
+        }
+
+        if (is_point_inside_quadrilateral(
+                    p, outer_bottom_left_, outer_top_left_, inner_top_left_inward_, inner_bottom_left_inward_)) {
+            return left_border_color_;
+        }
+
+        return kNoColor;
+    }
+
+private:
+    static constexpr Color kNoColor{0xFF, 0xFF, 0xFF, 0};
+
+    static constexpr Vec2 top_left_inward_pos(Vec2 origin, Vec2 offset) {
+        return {origin.x + offset.x, origin.y + offset.y};
+    }
+
+    static constexpr Vec2 top_right_inward_pos(Vec2 origin, Vec2 offset) {
+        return {origin.x - offset.x, origin.y + offset.y};
+    }
+
+    static constexpr Vec2 bottom_left_inward_pos(Vec2 origin, Vec2 offset) {
+        return {origin.x + offset.x, origin.y - offset.y};
+    }
+
+    static constexpr Vec2 bottom_right_inward_pos(Vec2 origin, Vec2 offset) {
+        return {origin.x - offset.x, origin.y - offset.y};
+    }
+
+    static constexpr Vec2 max_radius(Vec2 r) {
+        auto const lr = std::max(r.x, r.y);
+        return {lr, lr};
+    }
+
+    static constexpr bool is_point_inside_quadrilateral(Vec2 p, Vec2 a, Vec2 b, Vec2 c, Vec2 d) {
+        return cross(p - a, b - a) * cross(p - d, c - d) <= 0.f && cross(p - a, d - a) * cross(p - b, c - b) <= 0.f;
+    }
+
+    static constexpr bool is_point_inside_ellipse(Vec2 p, Vec2 origin, Vec2 radii) {
+        auto const dx = p.x - origin.x;
+        auto const dy = p.y - origin.y;
+        return (dx * dx) / (radii.x * radii.x) + (dy * dy) / (radii.y * radii.y) <= 1.f;
+    }
+
+    static constexpr bool is_inside_rounded_rect(Vec2 p,
+            Vec2 top_left_pos,
+            Vec2 top_right_pos,
+            Vec2 bottom_left_pos,
+            Vec2 bottom_right_pos,
+            Vec2 top_left_radii,
+            Vec2 top_right_radii,
+            Vec2 bottom_left_radii,
+            Vec2 bottom_right_radii) {
+        if (!is_point_inside_quadrilateral(p, top_left_pos, top_right_pos, bottom_right_pos, bottom_left_pos)) {
+            return false;
+        }
+
+        if (top_left_radii.x > 0.f || top_left_radii.y > 0.f) {
+            auto c = top_left_inward_pos(top_left_pos, top_left_radii);
+            if (p.x <= c.x && p.y <= c.y && !is_point_inside_ellipse(p, c, top_left_radii)) {
+                return false;
+            }
+        }
+
+        if (top_right_radii.x > 0.f || top_right_radii.y > 0.f) {
+            auto c = top_right_inward_pos(top_right_pos, top_right_radii);
+            if (p.x >= c.x && p.y <= c.y && !is_point_inside_ellipse(p, c, top_right_radii)) {
+                return false;
+            }
+        }
+
+        if (bottom_left_radii.x > 0.f || bottom_left_radii.y > 0.f) {
+            auto c = bottom_left_inward_pos(bottom_left_pos, bottom_left_radii);
+            if (p.x <= c.x && p.y >= c.y && !is_point_inside_ellipse(p, c, bottom_left_radii)) {
+                return false;
+            }
+        }
+
+        if (bottom_right_radii.x > 0.f || bottom_right_radii.y > 0.f) {
+            auto c = bottom_right_inward_pos(bottom_right_pos, bottom_right_radii);
+            if (p.x >= c.x && p.y >= c.y && !is_point_inside_ellipse(p, c, bottom_right_radii)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    Vec2 inner_top_left_;
+    Vec2 inner_top_right_;
+    Vec2 inner_bottom_left_;
+    Vec2 inner_bottom_right_;
+    Vec2 outer_top_left_;
+    Vec2 outer_top_right_;
+    Vec2 outer_bottom_left_;
+    Vec2 outer_bottom_right_;
+    Vec2 top_left_radii_;
+    Vec2 top_right_radii_;
+    Vec2 bottom_left_radii_;
+    Vec2 bottom_right_radii_;
+    Color left_border_color_;
+    Color right_border_color_;
+    Color top_border_color_;
+    Color bottom_border_color_;
+    Color inner_rect_color_;
+
+    Vec2 inner_top_left_radii_{};
+    Vec2 inner_top_right_radii_{};
+    Vec2 inner_bottom_left_radii_{};
+    Vec2 inner_bottom_right_radii_{};
+    Vec2 inner_top_left_inward_{};
+    Vec2 inner_top_right_inward_{};
+    Vec2 inner_bottom_left_inward_{};
+    Vec2 inner_bottom_right_inward_{};
+};
+
+} // namespace
+
+SoftwareCanvas::SoftwareCanvas() {
+    auto type = std::make_shared<type::FreeTypeType>();
+    fallback_font_ = type->fallback_font().value_or(nullptr);
+    type_ = std::move(type);
+}
+
+SoftwareCanvas::SoftwareCanvas(
+        std::shared_ptr<type::IType const> type, std::shared_ptr<type::IFont const> fallback_font)
+    : type_{std::move(type)}, fallback_font_{std::move(fallback_font)} {}
+
+void SoftwareCanvas::set_viewport_size(int width, int height) {
+    width_ = std::max(width, 0);
+    height_ = std::max(height, 0);
+    pixels_.assign(static_cast<std::size_t>(width_) * static_cast<std::size_t>(height_) * 4, 0);
+}
+
+void SoftwareCanvas::fill_rect(geom::Rect const &rect, Color color) {
+    fill(to_framebuffer(rect), color);
+}
+
+void SoftwareCanvas::draw_rect(
+        geom::Rect const &rect, Color const &color, Borders const &borders, Corners const &corners) {
+    auto const inner = to_framebuffer(rect);
+    auto const outer = inner.expanded({borders.left.size, borders.right.size, borders.top.size, borders.bottom.size});
+    RectShader const shader{inner, outer, color, borders, corners};
+
+    // Rows where the corners may be rounded have to be shaded pixel by pixel.
+    auto const top_corners =
+            static_cast<float>(outer.top() + std::max(corners.top_left.vertical, corners.top_right.vertical));
+    auto const bottom_corners =
+            static_cast<float>(outer.bottom() - std::max(corners.bottom_left.vertical, corners.bottom_right.vertical));
+
+    auto shade_pixels = [&](int y, int from, int to) {
+        for (int x = std::max(from, 0); x < std::min(to, width_); ++x) {
+            blend(x, y, shader.shade({static_cast<float>(x) + .5f, static_cast<float>(y) + .5f}));
+        }
+    };
+
+    for (int y = std::max(outer.top(), 0); y < std::min(outer.bottom(), height_); ++y) {
+        auto const center_y = static_cast<float>(y) + .5f;
+        if (y >= inner.top() && y < inner.bottom() && center_y > top_corners && center_y < bottom_corners) {
+            // Every pixel between the side borders is inside of the inner rect.
+            shade_pixels(y, outer.left(), inner.left());
+            fill({inner.left(), y, inner.width, 1}, color);
+            shade_pixels(y, inner.right(), outer.right());
+        } else {
+            shade_pixels(y, outer.left(), outer.right());
+        }
+    }
+}
+
+void SoftwareCanvas::draw_text(geom::Position p,
+        std::string_view text,
+        std::span<Font const> font_options,
+        FontSize size,
+        FontStyle style,
+        Color color) {
+    for (auto const &font : font_options) {
+        if (auto f = type_->font(font.font)) {
+            draw_text(p, text, **f, size, style, color);
+            return;
+        }
+    }
+
+    if (!fallback_font_) {
+        spdlog::error("Unable to find font, not drawing text");
+        return;
+    }
+
+    draw_text(p, text, *fallback_font_, size, style, color);
+}
+
+void SoftwareCanvas::draw_text(
+        geom::Position p, std::string_view text, Font font, FontSize size, FontStyle style, Color color) {
+    draw_text(p, text, std::span<Font const>{&font, 1}, size, style, color);
+}
+
+void SoftwareCanvas::clear(Color color) {
+    for (std::size_t i = 0; i < pixels_.size(); i += 4) {
+        pixels_[i] = color.r;
+        pixels_[i + 1] = color.g;
+        pixels_[i + 2] = color.b;
+        pixels_[i + 3] = color.a;
+    }
+}
+
+Color SoftwareCanvas::pixel(int x, int y) const {
+    assert(x >= 0 && x < width_ && y >= 0 && y < height_);
+    auto const *p = pixels_.data() + (static_cast<std::size_t>(y) * static_cast<std::size_t>(width_) + x) * 4;
+    return {p[0], p[1], p[2], p[3]};
+}
+
+img::Png SoftwareCanvas::to_png() const {
+    return img::Png{
+            .width = static_cast<std::uint32_t>(width_),
+            .height = static_cast<std::uint32_t>(height_),
+            .bytes{pixels_.begin(), pixels_.end()},
+    };
+}
+
+geom::Rect SoftwareCanvas::to_framebuffer(geom::Rect const &rect) const {
+    return rect.translated(tx_, ty_).scaled(scale_).translated(-origin_.x, -origin_.y);
+}
+
+void SoftwareCanvas::fill(geom::Rect const &rect, Color color) {
+    auto const left = std::max(rect.left(), 0);
+    auto const right = std::min(rect.right(), width_);
+    if (left >= right) {
+        return;
+    }
+
+    for (int y = std::max(rect.top(), 0); y < std::min(rect.bottom(), height_); ++y) {
+        blend_span(row(y, left, right - left), color);
+    }
+}
+
+void SoftwareCanvas::blend(int x, int y, Color color) {
+    if (color.a != 0) {
+        detail::blend_pixel(row(y, x, 1).data(), color, color.a);
+    }
+}
+
+std::span<std::uint8_t> SoftwareCanvas::row(int y, int x, int count) {
+    assert(y >= 0 && y < height_ && x >= 0 && count >= 0 && x + count <= width_);
+    auto const start = (static_cast<std::size_t>(y) * static_cast<std::size_t>(width_) + x) * 4;
+    return std::span{pixels_}.subspan(start, static_cast<std::size_t>(count) * 4);
+}
+
+void SoftwareCanvas::draw_text(
+        geom::Position p, std::string_view text, type::IFont const &font, FontSize size, FontStyle style, Color color) {
+    p = p.translated(tx_, ty_).scaled(scale_).translated(-origin_.x, -origin_.y);
+    auto const px = size.px * scale_;
+    auto const rasterized = font.rasterize(text, type::Px{px}, style);
+
+    auto const bounds = rasterized.bounds.translated(p.x, p.y);
+    auto const left = std::max(bounds.left(), 0);
+    auto const right = std::min(bounds.right(), width_);
+    for (int y = std::max(bounds.top(), 0); left < right && y < std::min(bounds.bottom(), height_); ++y) {
+        auto const coverage = std::span{rasterized.coverage}.subspan(
+                static_cast<std::size_t>((y - bounds.top()) * bounds.width + left - bounds.left()),
+                static_cast<std::size_t>(right - left));
+        blend_mask_span(row(y, left, right - left), coverage, color);
+    }
+
+    // FreeType only draws the glyphs, so lines are added here. Their
+    // placement is an approximation of what fonts usually ask for.
+    auto const thickness = std::max(px / 14, 1);
+    auto const baseline = p.y + rasterized.baseline;
+    if ((style & FontStyle::Underlined) == FontStyle::Underlined) {
+        fill({p.x, baseline + std::max(px / 10, 1), rasterized.advance, thickness}, color);
+    }
+
+    if ((style & FontStyle::Strikethrough) == FontStyle::Strikethrough) {
+        fill({p.x, baseline - px * 3 / 10, rasterized.advance, thickness}, color);
+    }
+}
+
+} // namespace gfx
@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef GFX_SOFTWARE_CANVAS_H_
+#define GFX_SOFTWARE_CANVAS_H_
+
+#include "gfx/icanvas.h"
+
+#include "geom/geom.h"
+#include "img/png.h"
+#include "type/type.h"
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace gfx {
+
+// Draws into an RGBA8 framebuffer in memory, so it works without a window or
+// a GPU. Rects are drawn the same way rect_shader.frag draws them.
+class SoftwareCanvas : public ICanvas {
+public:
+    // Uses the fonts installed on the system, see type::FreeTypeType.
+    SoftwareCanvas();
+
+    // Text is drawn using the first of the fonts asked for that type has, or
+    // using fallback_font if there isn't one.
+    explicit SoftwareCanvas(
+            std::shared_ptr<type::IType const> type, std::shared_ptr<type::IFont const> fallback_font = nullptr);
+
+    // Resizes the framebuffer, which also clears it.
+    void set_viewport_size(int width, int height) override;
+    constexpr void set_scale(int scale) override { scale_ = scale; }
+
+    constexpr void add_translation(int dx, int dy) override {
+        tx_ += dx;
+        ty_ += dy;
+    }
+
+    void fill_rect(geom::Rect const &, Color) override;
+    void draw_rect(geom::Rect const &, Color const &, Borders const &, Corners const &) override;
+    void draw_text(geom::Position, std::string_view, std::span<Font const>, FontSize, FontStyle, Color) override;
+    void draw_text(geom::Position, std::string_view, Font, FontSize, FontStyle, Color) override;
+
+    // Makes pixel (0, 0) of the framebuffer be the one at origin after
+    // translating and scaling, so that the canvas can draw one part of a
+    // larger picture.
+    constexpr void set_origin(geom::Position origin) { origin_ = origin; }
+
+    // Sets every pixel to the color, without blending.
+    void clear(Color);
+
+    [[nodiscard]] int width() const { return width_; }
+    [[nodiscard]] int height() const { return height_; }
+
+    // 4 bytes per pixel, row by row.
+    [[nodiscard]] std::span<std::uint8_t const> pixels() const { return pixels_; }
+    [[nodiscard]] Color pixel(int x, int y) const;
+
+    [[nodiscard]] img::Png to_png() const;
+
+private:
+    [[nodiscard]] geom::Rect to_framebuffer(geom::Rect const &) const;
+
+    // Blends color over the part of rect that's inside the framebuffer.
+    // Doesn't care about the translation or scale.
+    void fill(geom::Rect const &, Color);
+    void blend(int x, int y, Color);
+    [[nodiscard]] std::span<std::uint8_t> row(int y, int x, int count);
+    void draw_text(geom::Position, std::string_view, type::IFont const &, FontSize, FontStyle, Color);
+
+    std::shared_ptr<type::IType const> type_;
+    std::shared_ptr<type::IFont const> fallback_font_;
+
+    int width_{};
+    int height_{};
+    std::vector<std::uint8_t> pixels_;
+
+    int scale_{1};
+    int tx_{0};
+    int ty_{0};
+    geom::Position origin_{};
+};
+
+} // namespace gfx
+
+#endif
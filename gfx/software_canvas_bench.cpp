@@ -0,0 +1,139 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "gfx/software_canvas.h"
+#include "gfx/tiled_canvas.h"
+
+#include "geom/geom.h"
+#include "gfx/blend.h"
+#include "gfx/color.h"
+#include "gfx/font.h"
+#include "gfx/icanvas.h"
+#include "util/work_stealing_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int kWidth = 1280;
+constexpr int kHeight = 720;
+constexpr int kDocumentPages = 4;
+constexpr int kDocumentScale = 2;
+
+// Something like a page of text with a few boxes on it.
+void draw_page(gfx::ICanvas &canvas) {
+    for (int i = 0; i < 20; ++i) {
+        canvas.fill_rect({i * 30, i * 20, 600, 300}, {0x20, 0x40, static_cast<std::uint8_t>(i * 10), 0x30});
+    }
+
+    gfx::Borders const borders{
+            .left{{0xFF, 0, 0}, 3},
+            .right{{0, 0xFF, 0}, 3},
+            .top{{0, 0, 0xFF}, 3},
+            .bottom{{0, 0, 0}, 3},
+    };
+    gfx::Corners const corners{.top_left{10, 10}, .top_right{10, 10}, .bottom_left{10, 10}, .bottom_right{10, 10}};
+    for (int i = 0; i < 10; ++i) {
+        canvas.draw_rect({700, 20 + i * 65, 500, 50}, {0xEE, 0xEE, 0xEE}, borders, corners);
+    }
+
+    for (int line = 0; line < 35; ++line) {
+        canvas.draw_text({10, line * 20},
+                "The quick brown fox jumps over the lazy dog, again and again.",
+                gfx::Font{"sans"},
+                {16},
+                gfx::FontStyle::Normal,
+                {0, 0, 0});
+    }
+}
+
+void draw_frame(gfx::SoftwareCanvas &canvas) {
+    canvas.clear({0xFF, 0xFF, 0xFF});
+    draw_page(canvas);
+}
+
+// A long document, rendered in full at a high scale.
+void draw_document(gfx::TiledCanvas &canvas, gfx::Color background) {
+    canvas.clear(background);
+    for (int page = 0; page < kDocumentPages; ++page) {
+        draw_page(canvas);
+        canvas.add_translation(0, kHeight);
+    }
+    canvas.add_translation(0, -kHeight * kDocumentPages);
+}
+
+} // namespace
+
+// Usage: software_canvas_bench [png to write the frame to]
+int main(int argc, char **argv) {
+    auto time = [](auto const &fn, int iterations = 50) {
+        auto const start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            fn();
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+                / iterations;
+    };
+
+    std::vector<std::uint8_t> span(kWidth * 4, 0x80);
+    gfx::Color const color{0x10, 0x20, 0x30, 0x40};
+    auto const scalar = time([&] {
+        for (int row = 0; row < kHeight; ++row) {
+            gfx::detail::blend_span_scalar(span, color);
+        }
+    });
+    auto const vectorized = time([&] {
+        for (int row = 0; row < kHeight; ++row) {
+            gfx::blend_span(span, color);
+        }
+    });
+    std::cout << "blending a " << kWidth << "x" << kHeight << " area, scalar: " << scalar
+              << " ms, vectorized: " << vectorized << " ms, " << scalar / vectorized << "x\n";
+
+    gfx::SoftwareCanvas canvas;
+    canvas.set_viewport_size(kWidth, kHeight);
+    draw_frame(canvas);
+    auto const frame = time([&] { draw_frame(canvas); });
+    std::cout << "drawing a frame: " << frame << " ms, " << 1000 / frame << " fps\n";
+
+    gfx::TiledCanvas tiled;
+    tiled.set_viewport_size(kWidth * kDocumentScale, kHeight * kDocumentPages * kDocumentScale);
+    tiled.set_scale(kDocumentScale);
+    auto const max_threads = std::max(std::thread::hardware_concurrency(), 1U);
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+        util::WorkStealingPool pool{threads};
+        std::uint8_t background{0xFF};
+        auto const full = time(
+                [&] {
+                    // A new background color makes every tile be drawn again.
+                    background ^= 1;
+                    draw_document(tiled, {background, background, background});
+                    tiled.rasterize(pool);
+                },
+                5);
+        auto const tiles = tiled.rasterized_tile_count();
+        auto const unchanged = time([&] {
+            draw_document(tiled, {background, background, background});
+            tiled.rasterize(pool);
+        });
+        std::cout << "drawing a " << kDocumentPages << " page document at scale " << kDocumentScale << " with "
+                  << threads << " threads, " << tiles << " tiles: " << full << " ms, unchanged: " << unchanged
+                  << " ms\n";
+    }
+
+    if (argc > 1) {
+        if (!canvas.to_png().to(std::ofstream{argv[1], std::ios::binary})) {
+            std::cerr << "Unable to write " << argv[1] << '\n';
+            return 1;
+        }
+    }
+}
@@ -0,0 +1,169 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "gfx/software_canvas.h"
+
+#include "etest/etest.h"
+#include "geom/geom.h"
+#include "gfx/color.h"
+#include "gfx/fake_type.h"
+#include "gfx/font.h"
+#include "gfx/icanvas.h"
+#include "img/png.h"
+#include "type/type.h"
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <sstream>
+#include <utility>
+
+using etest::expect;
+using etest::expect_eq;
+using gfx::FakeFont;
+using gfx::FakeType;
+
+namespace {
+
+constexpr auto kWhite = gfx::Color{0xFF, 0xFF, 0xFF};
+constexpr auto kRed = gfx::Color{0xFF, 0, 0};
+constexpr auto kGreen = gfx::Color{0, 0xFF, 0};
+constexpr auto kBlue = gfx::Color{0, 0, 0xFF};
+constexpr auto kBlack = gfx::Color{0, 0, 0};
+
+gfx::SoftwareCanvas create_canvas(int width, int height, std::shared_ptr<type::IFont const> fallback = nullptr) {
+    gfx::SoftwareCanvas canvas{std::make_shared<FakeType>(), std::move(fallback)};
+    canvas.set_viewport_size(width, height);
+    canvas.clear(kWhite);
+    return canvas;
+}
+
+} // namespace
+
+int main() {
+    etest::test("fill_rect", [] {
+        auto canvas = create_canvas(4, 4);
+        canvas.fill_rect({1, 1, 2, 2}, kRed);
+        expect_eq(canvas.pixel(0, 0), kWhite);
+        expect_eq(canvas.pixel(1, 1), kRed);
+        expect_eq(canvas.pixel(2, 2), kRed);
+        expect_eq(canvas.pixel(3, 3), kWhite);
+
+        // Partially transparent colors are blended with what's already there.
+        canvas.fill_rect({0, 0, 1, 1}, gfx::Color{0, 0, 0, 0x80});
+        expect_eq(canvas.pixel(0, 0), (gfx::Color{0x7F, 0x7F, 0x7F}));
+
+        // Anything outside of the canvas is clipped.
+        canvas.fill_rect({-10, -10, 100, 100}, kBlue);
+        expect_eq(canvas.pixel(0, 0), kBlue);
+        expect_eq(canvas.pixel(3, 3), kBlue);
+        canvas.fill_rect({10, 10, 100, 100}, kRed);
+        canvas.fill_rect({-10, 0, 5, 100}, kRed);
+        expect_eq(canvas.pixel(0, 0), kBlue);
+    });
+
+    etest::test("translation and scale", [] {
+        auto canvas = create_canvas(4, 4);
+        canvas.set_scale(2);
+        canvas.add_translation(1, 0);
+        canvas.fill_rect({0, 0, 1, 1}, kRed);
+        expect_eq(canvas.pixel(1, 0), kWhite);
+        expect_eq(canvas.pixel(2, 0), kRed);
+        expect_eq(canvas.pixel(3, 1), kRed);
+        expect_eq(canvas.pixel(3, 2), kWhite);
+    });
+
+    etest::test("draw_rect, borders", [] {
+        auto canvas = create_canvas(10, 10);
+        gfx::Borders borders{
+                .left{kRed, 2},
+                .right{kGreen, 2},
+                .top{kBlue, 2},
+                .bottom{kBlack, 2},
+        };
+        canvas.draw_rect({2, 2, 6, 6}, gfx::Color{0x12, 0x34, 0x56}, borders, {});
+
+        expect_eq(canvas.pixel(5, 5), (gfx::Color{0x12, 0x34, 0x56}));
+        expect_eq(canvas.pixel(2, 2), (gfx::Color{0x12, 0x34, 0x56}));
+        expect_eq(canvas.pixel(7, 7), (gfx::Color{0x12, 0x34, 0x56}));
+        expect_eq(canvas.pixel(0, 5), kRed);
+        expect_eq(canvas.pixel(9, 5), kGreen);
+        expect_eq(canvas.pixel(5, 0), kBlue);
+        expect_eq(canvas.pixel(5, 9), kBlack);
+    });
+
+    etest::test("draw_rect, rounded corners", [] {
+        auto canvas = create_canvas(10, 10);
+        gfx::Corners const corners{
+                .top_left{5, 5},
+                .top_right{5, 5},
+                .bottom_left{5, 5},
+                .bottom_right{5, 5},
+        };
+        canvas.draw_rect({0, 0, 10, 10}, kRed, {}, corners);
+        expect_eq(canvas.pixel(0, 0), kWhite);
+        expect_eq(canvas.pixel(9, 0), kWhite);
+        expect_eq(canvas.pixel(0, 9), kWhite);
+        expect_eq(canvas.pixel(9, 9), kWhite);
+        expect_eq(canvas.pixel(5, 0), kRed);
+        expect_eq(canvas.pixel(0, 5), kRed);
+        expect_eq(canvas.pixel(5, 5), kRed);
+
+        // Without the corners, it's a plain rect.
+        canvas.draw_rect({0, 0, 10, 10}, kBlue, {}, {});
+        expect_eq(canvas.pixel(0, 0), kBlue);
+        expect_eq(canvas.pixel(9, 9), kBlue);
+    });
+
+    etest::test("draw_text", [] {
+        auto canvas = create_canvas(4, 4);
+        std::array<gfx::Font, 2> const fonts{gfx::Font{"missing"}, gfx::Font{"fake"}};
+        canvas.draw_text({1, 1}, "ab", fonts, {10}, gfx::FontStyle::Normal, kBlack);
+        expect_eq(canvas.pixel(0, 1), kWhite);
+        expect_eq(canvas.pixel(1, 1), kBlack);
+        expect_eq(canvas.pixel(2, 1), kBlack);
+        expect_eq(canvas.pixel(3, 1), kWhite);
+        expect_eq(canvas.pixel(1, 2), (gfx::Color{0x7F, 0x7F, 0x7F}));
+
+        // Text that doesn't fit is clipped.
+        canvas.draw_text({3, 3}, "abc", gfx::Font{"fake"}, {10}, gfx::FontStyle::Normal, kRed);
+        expect_eq(canvas.pixel(3, 3), kRed);
+    });
+
+    etest::test("draw_text, missing fonts", [] {
+        auto canvas = create_canvas(4, 4);
+        canvas.draw_text({0, 0}, "abcd", gfx::Font{"missing"}, {10}, gfx::FontStyle::Normal, kBlack);
+        expect_eq(canvas.pixel(0, 0), kWhite);
+
+        canvas = create_canvas(4, 4, std::make_shared<FakeFont>());
+        canvas.draw_text({0, 0}, "abcd", gfx::Font{"missing"}, {10}, gfx::FontStyle::Normal, kBlack);
+        expect_eq(canvas.pixel(0, 0), kBlack);
+    });
+
+    etest::test("draw_text, underline", [] {
+        auto canvas = create_canvas(4, 4);
+        canvas.draw_text({0, 0}, "ab", gfx::Font{"fake"}, {10}, gfx::FontStyle::Underlined, kBlack);
+        // Baseline at 2, and the line 1px below that.
+        expect_eq(canvas.pixel(0, 2), kWhite);
+        expect_eq(canvas.pixel(0, 3), kBlack);
+        expect_eq(canvas.pixel(1, 3), kBlack);
+        expect_eq(canvas.pixel(2, 3), kWhite);
+    });
+
+    etest::test("png", [] {
+        auto canvas = create_canvas(3, 2);
+        canvas.fill_rect({1, 0, 1, 1}, kRed);
+
+        auto const png = canvas.to_png();
+        expect_eq(png.width, 3U);
+        expect_eq(png.height, 2U);
+        expect_eq(png.bytes.size(), std::size_t{3 * 2 * 4});
+
+        std::stringstream ss;
+        expect(png.to(ss));
+        expect_eq(img::Png::from(ss), png);
+    });
+
+    return etest::run_all_tests();
+}
@@ -0,0 +1,204 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "gfx/tiled_canvas.h"
+
+#include "gfx/canvas_command_saver.h"
+#include "gfx/software_canvas.h"
+
+#include "geom/geom.h"
+#include "img/png.h"
+#include "type/freetype.h"
+#include "type/type.h"
+#include "util/work_stealing_pool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace gfx {
+
+TiledCanvas::TiledCanvas(int tile_size) : tile_size_{std::max(tile_size, 1)} {
+    auto type = std::make_shared<type::FreeTypeType>();
+    fallback_font_ = type->fallback_font().value_or(nullptr);
+    type_ = std::move(type);
+}
+
+TiledCanvas::TiledCanvas(
+        std::shared_ptr<type::IType const> type, std::shared_ptr<type::IFont const> fallback_font, int tile_size)
+    : type_{std::move(type)}, fallback_font_{std::move(fallback_font)}, tile_size_{std::max(tile_size, 1)} {}
+
+void TiledCanvas::set_viewport_size(int width, int height) {
+    width_ = std::max(width, 0);
+    height_ = std::max(height, 0);
+    pixels_.assign(static_cast<std::size_t>(width_) * static_cast<std::size_t>(height_) * 4, 0);
+
+    tiles_.clear();
+    for (int y = 0; y < height_; y += tile_size_) {
+        for (int x = 0; x < width_; x += tile_size_) {
+            tiles_.push_back(Tile{.rect{x, y, std::min(tile_size_, width_ - x), std::min(tile_size_, height_ - y)}});
+        }
+    }
+}
+
+void TiledCanvas::fill_rect(geom::Rect const &rect, Color color) {
+    record(rect.translated(tx_, ty_).scaled(scale_), FillRectCmd{rect, color});
+}
+
+void TiledCanvas::draw_rect(
+        geom::Rect const &rect, Color const &color, Borders const &borders, Corners const &corners) {
+    auto const bounds = rect.translated(tx_, ty_).scaled(scale_).expanded(
+            {borders.left.size, borders.right.size, borders.top.size, borders.bottom.size});
+    record(bounds, DrawRectCmd{rect, color, borders, corners});
+}
+
+void TiledCanvas::draw_text(geom::Position p,
+        std::string_view text,
+        std::span<Font const> font_options,
+        FontSize size,
+        FontStyle style,
+        Color color) {
+    std::vector<std::string> fonts;
+    std::ranges::transform(
+            font_options, std::back_inserter(fonts), [](auto const &font) { return std::string{font.font}; });
+    record(text_bounds(p, text, font_options, size, style),
+            DrawTextWithFontOptionsCmd{p, std::string{text}, std::move(fonts), size.px, style, color});
+}
+
+void TiledCanvas::draw_text(
+        geom::Position p, std::string_view text, Font font, FontSize size, FontStyle style, Color color) {
+    record(text_bounds(p, text, std::span<Font const>{&font, 1}, size, style),
+            DrawTextCmd{p, std::string{text}, std::string{font.font}, size.px, style, color});
+}
+
+void TiledCanvas::clear(Color color) {
+    items_.clear();
+    if (color != background_) {
+        background_ = color;
+        for (auto &tile : tiles_) {
+            tile.valid = false;
+        }
+    }
+}
+
+void TiledCanvas::rasterize(util::WorkStealingPool &pool) {
+    std::vector<std::vector<std::size_t>> bins(tiles_.size());
+    auto const columns = (width_ + tile_size_ - 1) / tile_size_;
+    for (std::size_t i = 0; i < items_.size(); ++i) {
+        auto const bounds = items_[i].bounds.intersected({0, 0, width_, height_});
+        if (bounds.width <= 0 || bounds.height <= 0) {
+            continue;
+        }
+
+        for (int row = bounds.top() / tile_size_; row <= (bounds.bottom() - 1) / tile_size_; ++row) {
+            for (int column = bounds.left() / tile_size_; column <= (bounds.right() - 1) / tile_size_; ++column) {
+                bins[static_cast<std::size_t>(row * columns + column)].push_back(i);
+            }
+        }
+    }
+
+    std::vector<std::size_t> changed;
+    for (std::size_t i = 0; i < tiles_.size(); ++i) {
+        if (!is_unchanged(bins[i], tiles_[i])) {
+            changed.push_back(i);
+        }
+        tiles_[i].bin = std::move(bins[i]);
+        tiles_[i].valid = true;
+    }
+
+    rasterized_items_ = std::move(items_);
+    items_.clear();
+    rasterized_tile_count_ = changed.size();
+    pool.parallel_for(changed.size(), [&](std::size_t i) { rasterize_tile(tiles_[changed[i]]); });
+}
+
+Color TiledCanvas::pixel(int x, int y) const {
+    assert(x >= 0 && x < width_ && y >= 0 && y < height_);
+    auto const *p = pixels_.data() + (static_cast<std::size_t>(y) * static_cast<std::size_t>(width_) + x) * 4;
+    return {p[0], p[1], p[2], p[3]};
+}
+
+img::Png TiledCanvas::to_png() const {
+    return img::Png{
+            .width = static_cast<std::uint32_t>(width_),
+            .height = static_cast<std::uint32_t>(height_),
+            .bytes{pixels_.begin(), pixels_.end()},
+    };
+}
+
+void TiledCanvas::record(geom::Rect const &bounds, CanvasCommand command) {
+    items_.push_back(Item{bounds, scale_, tx_, ty_, std::move(command)});
+}
+
+std::shared_ptr<type::IFont const> TiledCanvas::find_font(std::span<Font const> font_options) const {
+    for (auto const &font : font_options) {
+        if (auto f = type_->font(font.font)) {
+            return *std::move(f);
+        }
+    }
+
+    return fallback_font_;
+}
+
+geom::Rect TiledCanvas::text_bounds(geom::Position p,
+        std::string_view text,
+        std::span<Font const> font_options,
+        FontSize size,
+        FontStyle style) const {
+    auto const font = find_font(font_options);
+    if (!font) {
+        return {};
+    }
+
+    p = p.translated(tx_, ty_).scaled(scale_);
+    auto const px = size.px * scale_;
+    auto const measured = font->measure(text, type::Px{px}, style);
+    return padded_text_bounds({p.x, p.y, measured.width, measured.height}, FontSize{px});
+}
+
+bool TiledCanvas::is_unchanged(std::vector<std::size_t> const &bin, Tile const &tile) const {
+    return tile.valid && std::ranges::equal(bin, tile.bin, [this](std::size_t a, std::size_t b) {
+        return items_[a] == rasterized_items_[b];
+    });
+}
+
+void TiledCanvas::rasterize_tile(Tile const &tile) {
+    SoftwareCanvas canvas{type_, fallback_font_};
+    canvas.set_viewport_size(tile.rect.width, tile.rect.height);
+    canvas.set_origin(tile.rect.position());
+    canvas.clear(background_);
+
+    int tx{0};
+    int ty{0};
+    CanvasCommandVisitor visitor{canvas};
+    for (auto const i : tile.bin) {
+        auto const &item = rasterized_items_[i];
+        canvas.set_scale(item.scale);
+        canvas.add_translation(item.tx - tx, item.ty - ty);
+        tx = item.tx;
+        ty = item.ty;
+        std::visit(visitor, item.command);
+    }
+
+    // Tiles don't overlap, so they can all be copied in at the same time.
+    auto const row_bytes = static_cast<std::size_t>(tile.rect.width) * 4;
+    for (int y = 0; y < tile.rect.height; ++y) {
+        auto const *src = canvas.pixels().data() + static_cast<std::size_t>(y) * row_bytes;
+        auto *dst = pixels_.data()
+                + (static_cast<std::size_t>(tile.rect.y + y) * static_cast<std::size_t>(width_) + tile.rect.x) * 4;
+        std::memcpy(dst, src, row_bytes);
+    }
+}
+
+} // namespace gfx
@@ -0,0 +1,125 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef GFX_TILED_CANVAS_H_
+#define GFX_TILED_CANVAS_H_
+
+#include "gfx/canvas_command_saver.h"
+#include "gfx/icanvas.h"
+
+#include "geom/geom.h"
+#include "img/png.h"
+#include "type/type.h"
+#include "util/work_stealing_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace gfx {
+
+// Records what's drawn and rasterizes it in square tiles on a thread pool,
+// drawing each tile the same way a SoftwareCanvas would. Every command is
+// binned into the tiles it touches, and tiles whose bins are the same as the
+// last time they were rasterized are left alone.
+class TiledCanvas : public ICanvas {
+public:
+    static constexpr int kDefaultTileSize = 256;
+
+    // Uses the fonts installed on the system, see type::FreeTypeType.
+    explicit TiledCanvas(int tile_size = kDefaultTileSize);
+
+    // Text is drawn using the first of the fonts asked for that type has, or
+    // using fallback_font if there isn't one.
+    TiledCanvas(std::shared_ptr<type::IType const> type,
+            std::shared_ptr<type::IFont const> fallback_font,
+            int tile_size = kDefaultTileSize);
+
+    // Resizes the framebuffer, which means that every tile will have to be
+    // rasterized again.
+    void set_viewport_size(int width, int height) override;
+    constexpr void set_scale(int scale) override { scale_ = scale; }
+
+    constexpr void add_translation(int dx, int dy) override {
+        tx_ += dx;
+        ty_ += dy;
+    }
+
+    void fill_rect(geom::Rect const &, Color) override;
+    void draw_rect(geom::Rect const &, Color const &, Borders const &, Corners const &) override;
+    void draw_text(geom::Position, std::string_view, std::span<Font const>, FontSize, FontStyle, Color) override;
+    void draw_text(geom::Position, std::string_view, Font, FontSize, FontStyle, Color) override;
+
+    // Drops everything drawn since the last call to rasterize, and makes the
+    // tiles start out as this color.
+    void clear(Color);
+
+    // Draws everything recorded since the last call into the framebuffer.
+    void rasterize(util::WorkStealingPool &);
+
+    // How many tiles the last call to rasterize had to draw.
+    [[nodiscard]] std::size_t rasterized_tile_count() const { return rasterized_tile_count_; }
+
+    [[nodiscard]] int width() const { return width_; }
+    [[nodiscard]] int height() const { return height_; }
+
+    // 4 bytes per pixel, row by row.
+    [[nodiscard]] std::span<std::uint8_t const> pixels() const { return pixels_; }
+    [[nodiscard]] Color pixel(int x, int y) const;
+
+    [[nodiscard]] img::Png to_png() const;
+
+private:
+    // A command along with the scale and translation it was drawn with, and
+    // the part of the framebuffer it may touch.
+    struct Item {
+        geom::Rect bounds{};
+        int scale{};
+        int tx{};
+        int ty{};
+        CanvasCommand command{};
+
+        [[nodiscard]] bool operator==(Item const &) const = default;
+    };
+
+    struct Tile {
+        geom::Rect rect{};
+        // Indices of the items drawn into the tile, in drawing order.
+        std::vector<std::size_t> bin{};
+        bool valid{false};
+    };
+
+    void record(geom::Rect const &bounds, CanvasCommand);
+    [[nodiscard]] std::shared_ptr<type::IFont const> find_font(std::span<Font const>) const;
+    [[nodiscard]] geom::Rect text_bounds(
+            geom::Position, std::string_view, std::span<Font const>, FontSize, FontStyle) const;
+    [[nodiscard]] bool is_unchanged(std::vector<std::size_t> const &bin, Tile const &) const;
+    void rasterize_tile(Tile const &);
+
+    std::shared_ptr<type::IType const> type_;
+    std::shared_ptr<type::IFont const> fallback_font_;
+    int tile_size_{};
+
+    int width_{};
+    int height_{};
+    std::vector<std::uint8_t> pixels_;
+    std::vector<Tile> tiles_;
+    Color background_{0, 0, 0, 0};
+
+    int scale_{1};
+    int tx_{0};
+    int ty_{0};
+
+    std::vector<Item> items_;
+    // The items the tiles' bins point into.
+    std::vector<Item> rasterized_items_;
+    std::size_t rasterized_tile_count_{};
+};
+
+} // namespace gfx
+
+#endif
@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "gfx/tiled_canvas.h"
+
+#include "etest/etest.h"
+#include "geom/geom.h"
+#include "gfx/color.h"
+#include "gfx/fake_type.h"
+#include "gfx/font.h"
+#include "gfx/icanvas.h"
+#include "gfx/software_canvas.h"
+#include "util/work_stealing_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+
+using etest::expect;
+using etest::expect_eq;
+using gfx::FakeFont;
+using gfx::FakeType;
+
+namespace {
+
+constexpr auto kWhite = gfx::Color{0xFF, 0xFF, 0xFF};
+constexpr auto kRed = gfx::Color{0xFF, 0, 0};
+constexpr auto kBlue = gfx::Color{0, 0, 0xFF};
+
+void draw(gfx::ICanvas &canvas) {
+    canvas.set_scale(2);
+    canvas.add_translation(3, -2);
+    canvas.fill_rect({0, 0, 20, 10}, {0x12, 0x34, 0x56, 0x80});
+
+    gfx::Borders const borders{
+            .left{kRed, 2},
+            .right{{0, 0xFF, 0}, 3},
+            .top{kBlue, 1},
+            .bottom{{0, 0, 0}, 4},
+    };
+    gfx::Corners const corners{.top_left{6, 4}, .top_right{3, 3}, .bottom_left{5, 5}, .bottom_right{2, 8}};
+    canvas.draw_rect({4, 6, 12, 9}, {0xEE, 0xDD, 0xCC, 0xBB}, borders, corners);
+
+    canvas.add_translation(-3, 2);
+    std::array<gfx::Font, 2> const fonts{gfx::Font{"missing"}, gfx::Font{"fake"}};
+    canvas.draw_text({1, 20}, "hello", fonts, {10}, gfx::FontStyle::Underlined, {0x10, 0x20, 0x30});
+    canvas.draw_text({9, 1}, "world", gfx::Font{"missing"}, {10}, gfx::FontStyle::Normal, kRed);
+}
+
+gfx::TiledCanvas create_canvas(int width, int height, int tile_size) {
+    gfx::TiledCanvas canvas{std::make_shared<FakeType>(), std::make_shared<FakeFont>(), tile_size};
+    canvas.set_viewport_size(width, height);
+    canvas.clear(kWhite);
+    return canvas;
+}
+
+} // namespace
+
+int main() {
+    etest::test("draws the same thing as the software canvas", [] {
+        gfx::SoftwareCanvas expected{std::make_shared<FakeType>(), std::make_shared<FakeFont>()};
+        expected.set_viewport_size(45, 50);
+        expected.clear(kWhite);
+        draw(expected);
+
+        util::WorkStealingPool pool{3};
+        for (int tile_size : {1, 7, 16, 64}) {
+            auto canvas = create_canvas(45, 50, tile_size);
+            draw(canvas);
+            canvas.rasterize(pool);
+            expect(canvas.pixels().size() == expected.pixels().size());
+            expect(std::ranges::equal(canvas.pixels(), expected.pixels()));
+        }
+    });
+
+    etest::test("only changed tiles are rasterized", [] {
+        util::WorkStealingPool pool{2};
+        auto canvas = create_canvas(40, 40, 10);
+        canvas.fill_rect({0, 0, 40, 5}, kRed);
+        canvas.fill_rect({12, 12, 5, 5}, kBlue);
+        canvas.rasterize(pool);
+        expect_eq(canvas.rasterized_tile_count(), std::size_t{16});
+        expect_eq(canvas.pixel(0, 0), kRed);
+        expect_eq(canvas.pixel(14, 14), kBlue);
+
+        // Nothing changed.
+        canvas.fill_rect({0, 0, 40, 5}, kRed);
+        canvas.fill_rect({12, 12, 5, 5}, kBlue);
+        canvas.rasterize(pool);
+        expect_eq(canvas.rasterized_tile_count(), std::size_t{0});
+        expect_eq(canvas.pixel(14, 14), kBlue);
+
+        // The blue square moved into the next tile.
+        canvas.fill_rect({0, 0, 40, 5}, kRed);
+        canvas.fill_rect({22, 12, 5, 5}, kBlue);
+        canvas.rasterize(pool);
+        expect_eq(canvas.rasterized_tile_count(), std::size_t{2});
+        expect_eq(canvas.pixel(14, 14), kWhite);
+        expect_eq(canvas.pixel(24, 14), kBlue);
+
+        // Things that are in different tiles can be drawn in any order.
+        canvas.fill_rect({22, 12, 5, 5}, kBlue);
+        canvas.fill_rect({0, 0, 40, 5}, kRed);
+        canvas.rasterize(pool);
+        expect_eq(canvas.rasterized_tile_count(), std::size_t{0});
+        canvas.fill_rect({0, 0, 40, 20}, kRed);
+        canvas.fill_rect({22, 12, 5, 5}, kBlue);
+        canvas.rasterize(pool);
+        expect_eq(canvas.rasterized_tile_count(), std::size_t{8});
+        expect_eq(canvas.pixel(24, 14), kBlue);
+    });
+
+    etest::test("clearing to a new color redraws everything", [] {
+        util::WorkStealingPool pool{1};
+        auto canvas = create_canvas(20, 20, 10);
+        canvas.rasterize(pool);
+        expect_eq(canvas.rasterized_tile_count(), std::size_t{4});
+
+        canvas.clear(kWhite);
+        canvas.rasterize(pool);
+        expect_eq(canvas.rasterized_tile_count(), std::size_t{0});
+
+        canvas.clear(kBlue);
+        canvas.rasterize(pool);
+        expect_eq(canvas.rasterized_tile_count(), std::size_t{4});
+        expect_eq(canvas.pixel(19, 19), kBlue);
+
+        canvas.set_viewport_size(25, 20);
+        canvas.rasterize(pool);
+        expect_eq(canvas.rasterized_tile_count(), std::size_t{6});
+        expect_eq(canvas.pixel(24, 19), kBlue);
+    });
+
+    return etest::run_all_tests();
+}
@@ -95,11 +95,25 @@ constexpr std::array kDisallowsParagraphEndTagOmissionWhenClosed{
 
 } // namespace
 
-void Parser::on_token(html2::Tokenizer &, html2::Token &&token) {
+void Parser::on_token(html2::Tokenizer &tokenizer, html2::Token &&token) {
+    // Apart from when collecting text, the insertion modes look at one character at a time.
+    if (auto const *span = std::get_if<html2::CharacterSpanToken>(&token);
+            span != nullptr && !std::holds_alternative<AfterHead>(insertion_mode_)
+            && !std::holds_alternative<Text>(insertion_mode_)) {
+        for (char c : span->data) {
+            on_token(tokenizer, html2::CharacterToken{c});
+        }
+        return;
+    }
+
     // Everything in <head> and earlier is handled by the new parser.
     if (!std::holds_alternative<AfterHead>(insertion_mode_)) {
         insertion_mode_ = std::visit([&](auto &mode) { return mode.process(actions_, token); }, insertion_mode_)
                                   .value_or(insertion_mode_);
+        if (std::holds_alternative<AfterHead>(insertion_mode_)) {
+            notify_head_parsed_if_needed();
+        }
+
         if (auto const *end = std::get_if<html2::EndTagToken>(&token); end != nullptr && end->tag_name == "head") {
             return;
         }
@@ -206,7 +220,11 @@ void Parser::operator()(html2::CommentToken const &) {
 }
 
 void Parser::operator()(html2::CharacterToken const &character) {
-    current_text_ << character.data;
+    current_text_ += character.data;
+}
+
+void Parser::operator()(html2::CharacterSpanToken const &span) {
+    current_text_ += span.data;
 }
 
 void Parser::operator()(html2::EndOfFileToken const &) {
@@ -233,9 +251,20 @@ void Parser::operator()(html2::EndOfFileToken const &) {
     }
 }
 
+void Parser::notify_head_parsed_if_needed() {
+    if (head_parsed_) {
+        return;
+    }
+
+    head_parsed_ = true;
+    if (on_head_parsed_) {
+        on_head_parsed_(doc_);
+    }
+}
+
 void Parser::generate_text_node_if_needed() {
     assert(!open_elements_.empty());
-    auto text = std::exchange(current_text_, {}).str();
+    auto text = std::exchange(current_text_, {});
     bool is_uninteresting = std::ranges::all_of(text, [](char c) { return util::is_whitespace(c); });
     if (is_uninteresting) {
         return;
@@ -11,8 +11,8 @@
 #include "html2/tokenizer.h"
 
 #include <functional>
-#include <sstream>
 #include <stack>
+#include <string>
 #include <string_view>
 #include <utility>
 
@@ -29,12 +29,33 @@ public:
         return parser.run();
     }
 
+    // Creates a parser for a document that's provided piece by piece using
+    // feed(). finish() returns the document once all of it has been fed.
+    explicit Parser(ParserOptions const &opts)
+        : tokenizer_{std::bind_front(&Parser::on_token, this)}, scripting_{opts.scripting} {}
+
+    Parser(Parser const &) = delete;
+    Parser &operator=(Parser const &) = delete;
+
+    // Called once everything up until the end of <head> has been parsed, e.g.
+    // to start downloading stylesheets before the rest of the document is here.
+    void set_on_head_parsed(std::function<void(dom::Document const &)> cb) { on_head_parsed_ = std::move(cb); }
+
+    void feed(std::string_view input) { tokenizer_.feed(input); }
+
+    [[nodiscard]] dom::Document finish() {
+        tokenizer_.finish();
+        notify_head_parsed_if_needed();
+        return std::move(doc_);
+    }
+
     // These must be public for std::visit to be happy with Parser as a visitor.
     void operator()(html2::DoctypeToken const &);
     void operator()(html2::StartTagToken const &);
     void operator()(html2::EndTagToken const &);
     void operator()(html2::CommentToken const &);
     void operator()(html2::CharacterToken const &);
+    void operator()(html2::CharacterSpanToken const &);
     void operator()(html2::EndOfFileToken const &);
 
 private:
@@ -49,14 +70,17 @@ private:
     void on_token(html2::Tokenizer &, html2::Token &&token);
 
     void generate_text_node_if_needed();
+    void notify_head_parsed_if_needed();
 
     html2::Tokenizer tokenizer_;
     dom::Document doc_{};
     std::stack<dom::Element *> open_elements_{};
-    std::stringstream current_text_{};
+    std::string current_text_{};
     bool scripting_{false};
     InsertionMode insertion_mode_{};
     Actions actions_{doc_, tokenizer_, scripting_, open_elements_};
+    std::function<void(dom::Document const &)> on_head_parsed_{};
+    bool head_parsed_{false};
 };
 
 inline dom::Document parse(std::string_view input, ParserOptions const &opts = {}) {
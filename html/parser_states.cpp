@@ -10,6 +10,7 @@
 #include <array>
 #include <cassert>
 #include <optional>
+#include <string>
 #include <string_view>
 #include <variant>
 #include <vector>
@@ -252,15 +253,23 @@ std::optional<InsertionMode> InBody::process(Actions &a, html2::Token const &tok
 }
 
 std::optional<InsertionMode> Text::process(Actions &a, html2::Token const &token) {
-    if (auto const *character = std::get_if<html2::CharacterToken>(&token)) {
-        assert(character->data != '\0');
-
+    auto current_text = [&]() -> std::string & {
         auto &current_element = a.open_elements().top();
         if (current_element->children.empty() || !std::holds_alternative<dom::Text>(current_element->children.back())) {
             current_element->children.emplace_back(dom::Text{});
         }
 
-        std::get<dom::Text>(current_element->children.back()).text += character->data;
+        return std::get<dom::Text>(current_element->children.back()).text;
+    };
+
+    if (auto const *character = std::get_if<html2::CharacterToken>(&token)) {
+        assert(character->data != '\0');
+        current_text() += character->data;
+        return {};
+    }
+
+    if (auto const *span = std::get_if<html2::CharacterSpanToken>(&token)) {
+        current_text() += span->data;
         return {};
     }
 
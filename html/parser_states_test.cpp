@@ -31,10 +31,23 @@ ParseResult parse(std::string_view html, ParseOptions opts) {
     std::stack<dom::Element *> open_elements{};
     html::Actions actions{res.document, tokenizer, opts.scripting, open_elements};
 
-    auto on_token = [&](html2::Tokenizer &, html2::Token const &token) {
+    auto process = [&](html2::Token const &token) {
         mode = std::visit([&](auto &v) { return v.process(actions, token); }, mode).value_or(mode);
     };
 
+    // Like in html::Parser, spans of characters are only handled as-is when collecting text.
+    auto on_token = [&](html2::Tokenizer &, html2::Token const &token) {
+        if (auto const *span = std::get_if<html2::CharacterSpanToken>(&token);
+                span != nullptr && !std::holds_alternative<html::Text>(mode)) {
+            for (char c : span->data) {
+                process(html2::CharacterToken{c});
+            }
+            return;
+        }
+
+        process(token);
+    };
+
     tokenizer = html2::Tokenizer{html, std::move(on_token)};
     tokenizer.run();
     return res;
@@ -7,6 +7,8 @@
 #include "etest/etest.h"
 
 #include <cstddef>
+#include <string>
+#include <tuple>
 
 using namespace std::literals;
 using etest::expect;
@@ -327,5 +329,50 @@ int main() {
         expect_eq(span.name, "span");
     });
 
+    etest::test("fed document is the same as one parsed all at once", [] {
+        auto html = "<!doctype html><html><head><title>hi</title><style>p { color: green; }</style></head>"
+                    "<body><p>hello &amp; <b>goodbye</b></p><script>if (a < b) {}</script></body></html>"sv;
+
+        for (std::size_t chunk_size : {1, 2, 3, 7, 64}) {
+            html::Parser parser{{}};
+            for (std::size_t i = 0; i < html.size(); i += chunk_size) {
+                parser.feed(html.substr(i, chunk_size));
+            }
+
+            expect(parser.finish() == html::parse(html));
+        }
+    });
+
+    etest::test("head parsed callback", [] {
+        html::Parser parser{{}};
+        std::size_t calls{};
+        parser.set_on_head_parsed([&](dom::Document const &doc) {
+            calls += 1;
+            auto const &head = std::get<dom::Element>(doc.html().children.at(0));
+            expect_eq(head.name, "head");
+            expect_eq(head.children.size(), std::size_t{1});
+        });
+
+        parser.feed("<html><head><link rel=stylesheet href=a.css></head><bo"sv);
+        expect_eq(calls, std::size_t{0});
+        // The tokenizer holds on to the tail of the input until it knows what comes after it.
+        parser.feed("dy>"s + std::string(64, ' '));
+        expect_eq(calls, std::size_t{1});
+
+        parser.feed("<p>hello</p></body></html>"sv);
+        std::ignore = parser.finish();
+        expect_eq(calls, std::size_t{1});
+    });
+
+    etest::test("head parsed callback, document ends in head", [] {
+        html::Parser parser{{}};
+        std::size_t calls{};
+        parser.set_on_head_parsed([&](dom::Document const &) { calls += 1; });
+
+        parser.feed("<html><head><link rel=stylesheet href=a.css>"sv);
+        std::ignore = parser.finish();
+        expect_eq(calls, std::size_t{1});
+    });
+
     return etest::run_all_tests();
 }
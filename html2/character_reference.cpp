@@ -4,7 +4,13 @@
 
 #include "html2/character_reference.h"
 
+#include <algorithm>
 #include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
 #include <string_view>
 
 using namespace std::literals;
@@ -2261,19 +2267,104 @@ static constexpr std::array references = std::to_array<CharacterReference>({{"&A
         {"&zwj;"sv, 8205},
         {"&zwnj;"sv, 8204}});
 
+// The references sorted by name and with every prefix of every name as a
+// node, the children of each node stored next to each other. This lets us
+// find the longest reference matching some input by only looking at each
+// character in it once.
+constexpr std::uint16_t kNoReference = std::numeric_limits<std::uint16_t>::max();
+
+struct TrieNode {
+    char character{};
+    std::uint16_t first_child{};
+    std::uint16_t child_count{};
+    std::uint16_t reference{kNoReference};
+};
+
+constexpr std::size_t count_trie_nodes() {
+    std::size_t nodes = 1; // The root.
+    std::string_view previous{};
+    for (auto const &reference : references) {
+        auto shared_prefix = std::ranges::mismatch(reference.name, previous).in1 - reference.name.begin();
+        nodes += reference.name.size() - static_cast<std::size_t>(shared_prefix);
+        previous = reference.name;
+    }
+
+    return nodes;
+}
+
+constexpr auto build_trie() {
+    static_assert(std::ranges::is_sorted(references, {}, &CharacterReference::name));
+
+    std::array<TrieNode, count_trie_nodes()> trie{};
+    static_assert(trie.size() < kNoReference);
+
+    // The references sharing the prefix the node represents.
+    struct Range {
+        std::size_t first{};
+        std::size_t last{};
+    };
+    std::array<Range, trie.size()> ranges{};
+    ranges[0] = {0, references.size()};
+    std::array<std::size_t, trie.size()> depths{};
+
+    // Nodes are added breadth-first, so every node is processed after its parent.
+    std::size_t next_free = 1;
+    for (std::size_t node = 0; node < next_free; ++node) {
+        auto [first, last] = ranges[node];
+        auto depth = depths[node];
+
+        // A name ending at this node sorts before all names continuing past it.
+        if (references[first].name.size() == depth) {
+            trie[node].reference = static_cast<std::uint16_t>(first);
+            ++first;
+        }
+
+        trie[node].first_child = static_cast<std::uint16_t>(next_free);
+        while (first < last) {
+            char c = references[first].name[depth];
+            auto group_end = first;
+            while (group_end < last && references[group_end].name[depth] == c) {
+                ++group_end;
+            }
+
+            trie[next_free].character = c;
+            ranges[next_free] = {first, group_end};
+            depths[next_free] = depth + 1;
+            ++next_free;
+            ++trie[node].child_count;
+            first = group_end;
+        }
+    }
+
+    return trie;
+}
+
+constexpr auto kTrie = build_trie();
+
 } // namespace
 
 std::optional<CharacterReference> find_named_character_reference_for(std::string_view buffer) {
     std::optional<CharacterReference> maybe_reference{std::nullopt};
 
-    for (auto const &reference : references) {
-        if (buffer.starts_with(reference.name)
-                && (!maybe_reference || reference.name.size() > maybe_reference->name.size())) {
-            maybe_reference = reference;
+    TrieNode const *node = &kTrie[0];
+    for (char c : buffer) {
+        auto children = std::span{kTrie}.subspan(node->first_child, node->child_count);
+        auto child = std::ranges::lower_bound(children, c, {}, &TrieNode::character);
+        if (child == children.end() || child->character != c) {
+            break;
+        }
+
+        node = &*child;
+        if (node->reference != kNoReference) {
+            maybe_reference = references[node->reference];
         }
     }
 
     return maybe_reference;
 }
 
+std::span<CharacterReference const> named_character_references() {
+    return references;
+}
+
 } // namespace html2
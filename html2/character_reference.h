@@ -7,6 +7,7 @@
 
 #include <cstdint>
 #include <optional>
+#include <span>
 #include <string_view>
 
 namespace html2 {
@@ -17,8 +18,11 @@ struct CharacterReference {
     std::optional<std::uint32_t> second_codepoint{};
 };
 
+// Returns the longest named character reference that the input starts with.
 std::optional<CharacterReference> find_named_character_reference_for(std::string_view);
 
+std::span<CharacterReference const> named_character_references();
+
 } // namespace html2
 
 #endif
@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "html2/character_reference.h"
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// How the lookup used to be done, kept around for comparison.
+std::optional<html2::CharacterReference> linear_search(std::string_view buffer) {
+    std::optional<html2::CharacterReference> maybe_reference{std::nullopt};
+
+    for (auto const &reference : html2::named_character_references()) {
+        if (buffer.starts_with(reference.name)
+                && (!maybe_reference || reference.name.size() > maybe_reference->name.size())) {
+            maybe_reference = reference;
+        }
+    }
+
+    return maybe_reference;
+}
+
+template<typename LookupT>
+void run(std::string_view name, std::vector<std::string> const &inputs, LookupT const &lookup) {
+    constexpr int kIterations = 100;
+    std::size_t found{};
+    auto const start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        for (auto const &input : inputs) {
+            found += lookup(input).has_value() ? 1 : 0;
+        }
+    }
+    auto const elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+
+    auto const lookups = static_cast<double>(inputs.size()) * kIterations;
+    std::cout << name << ": " << elapsed.count() / lookups << " ns/lookup, " << found / kIterations << '/'
+              << inputs.size() << " found\n";
+}
+
+} // namespace
+
+// Looks up every named character reference, followed by some text as it
+// would be in a document, plus some things that aren't references.
+int main() {
+    std::vector<std::string> inputs;
+    for (auto const &reference : html2::named_character_references()) {
+        inputs.push_back(std::string{reference.name} + " and some more text");
+    }
+
+    for (auto const *not_a_reference : {"&hello;", "&ampere", "& ", "&#123;", "&Zz;"}) {
+        inputs.emplace_back(not_a_reference);
+    }
+
+    run("linear search", inputs, linear_search);
+    run("trie", inputs, html2::find_named_character_reference_for);
+}
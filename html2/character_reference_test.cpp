@@ -47,5 +47,22 @@ int main() {
         expect(ref->name == "&lt;"sv);
     });
 
+    etest::test("partial match of a longer reference", [] {
+        // &notin; exists, but we only have enough for &not.
+        auto ref = find_named_character_reference_for("&notit;"sv);
+        require(ref.has_value());
+        expect(ref->name == "&not"sv);
+    });
+
+    etest::test("all references are found", [] {
+        for (auto const &reference : named_character_references()) {
+            auto ref = find_named_character_reference_for(reference.name);
+            require(ref.has_value());
+            expect(ref->name == reference.name);
+            expect(ref->first_codepoint == reference.first_codepoint);
+            expect(ref->second_codepoint == reference.second_codepoint);
+        }
+    });
+
     return etest::run_all_tests();
 }
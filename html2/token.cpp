@@ -36,6 +36,7 @@ std::string to_string(Token const &token) {
                        [&ss](EndTagToken const &t) { ss << "EndTag " << t.tag_name << ' ' << t.self_closing; },
                        [&ss](CommentToken const &t) { ss << "Comment " << t.data; },
                        [&ss](CharacterToken const &t) { ss << "Character " << t.data; },
+                       [&ss](CharacterSpanToken const &t) { ss << "CharacterSpan " << t.data; },
                        [&ss](EndOfFileToken const &) { ss << "EndOfFile"; },
                },
             token);
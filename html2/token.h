@@ -7,6 +7,7 @@
 
 #include <optional>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -50,11 +51,25 @@ struct CharacterToken {
     [[nodiscard]] bool operator==(CharacterToken const &) const = default;
 };
 
+// A run of characters that needed no special handling, emitted as one token
+// instead of one CharacterToken per character. The data points into the
+// tokenizer's input and is only valid until the token handler returns.
+struct CharacterSpanToken {
+    std::string_view data{};
+    [[nodiscard]] bool operator==(CharacterSpanToken const &) const = default;
+};
+
 struct EndOfFileToken {
     [[nodiscard]] bool operator==(EndOfFileToken const &) const = default;
 };
 
-using Token = std::variant<DoctypeToken, StartTagToken, EndTagToken, CommentToken, CharacterToken, EndOfFileToken>;
+using Token = std::variant<DoctypeToken,
+        StartTagToken,
+        EndTagToken,
+        CommentToken,
+        CharacterToken,
+        CharacterSpanToken,
+        EndOfFileToken>;
 
 std::string to_string(Token const &);
 
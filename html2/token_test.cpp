@@ -39,6 +39,7 @@ int main() {
     etest::test("to_string(Character)", [] {
         expect_eq(to_string(CharacterToken{'a'}), "Character a");
         expect_eq(to_string(CharacterToken{'?'}), "Character ?");
+        expect_eq(to_string(CharacterSpanToken{"hello"}), "CharacterSpan hello");
     });
 
     etest::test("to_string(EndOfFile)", [] { expect_eq(to_string(EndOfFileToken{}), "EndOfFile"); });
@@ -5,6 +5,7 @@
 #include "html2/tokenizer.h"
 
 #include "html2/character_reference.h"
+#include "util/find_first_of.h"
 #include "util/string.h"
 #include "util/unicode.h"
 
@@ -96,6 +97,14 @@ constexpr bool is_unicode_noncharacter(int code_point) {
 
 std::string const kReplacementCharacter = util::unicode_to_utf8(0xFFFD);
 
+// The most input any state looks at in one go is a named character reference,
+// the longest being "&CounterClockwiseContourIntegral;", followed by the
+// character after it.
+constexpr std::size_t kMaxLookahead = 34;
+
+// Consumed input is dropped once it's taking up this much of the buffer.
+constexpr std::size_t kMinCompactionSize = std::size_t{16} * 1024;
+
 } // namespace
 
 void Tokenizer::set_state(State state) {
@@ -112,6 +121,12 @@ void Tokenizer::set_state(State state) {
 // NOLINTNEXTLINE(google-readability-function-size)
 void Tokenizer::run() {
     while (true) {
+        // If there may be more input coming, wait for it instead of treating
+        // the end of what we have as the end of the file.
+        if (!input_complete_ && input_.size() - pos_ < kMaxLookahead) {
+            return;
+        }
+
         switch (state_) {
             // https://html.spec.whatwg.org/multipage/parsing.html#data-state
             case State::Data: {
@@ -134,7 +149,7 @@ void Tokenizer::run() {
                         emit(CharacterToken{*c});
                         continue;
                     default:
-                        emit(CharacterToken{*c});
+                        emit_character_span_until("&<\0"sv);
                         continue;
                 }
                 break;
@@ -161,7 +176,7 @@ void Tokenizer::run() {
                         emit_replacement_character();
                         continue;
                     default:
-                        emit(CharacterToken{*c});
+                        emit_character_span_until("&<\0"sv);
                         continue;
                 }
             }
@@ -183,7 +198,7 @@ void Tokenizer::run() {
                         emit_replacement_character();
                         continue;
                     default:
-                        emit(CharacterToken{*c});
+                        emit_character_span_until("<\0"sv);
                         continue;
                 }
             }
@@ -204,7 +219,7 @@ void Tokenizer::run() {
                         emit_replacement_character();
                         continue;
                     default:
-                        emit(CharacterToken{*c});
+                        emit_character_span_until("<\0"sv);
                         continue;
                 }
             }
@@ -1129,7 +1144,7 @@ void Tokenizer::run() {
                         current_attribute().value += kReplacementCharacter;
                         continue;
                     default:
-                        current_attribute().value += *c;
+                        current_attribute().value += consume_run_until("\"&\0"sv);
                         continue;
                 }
             }
@@ -1155,7 +1170,7 @@ void Tokenizer::run() {
                         current_attribute().value += kReplacementCharacter;
                         continue;
                     default:
-                        current_attribute().value += *c;
+                        current_attribute().value += consume_run_until("'&\0"sv);
                         continue;
                 }
             }
@@ -2417,10 +2432,49 @@ void Tokenizer::run() {
     }
 }
 
+void Tokenizer::feed(std::string_view input) {
+    if (input_complete_) {
+        return;
+    }
+
+    // Everything but the character before the current one, which a few states
+    // look back at, has been tokenized and can be dropped.
+    if (pos_ > kMinCompactionSize && pos_ > buffer_.size() / 2) {
+        auto consumed = std::string_view{buffer_}.substr(0, pos_ - 1);
+        if (auto newlines = std::ranges::count(consumed, '\n'); newlines > 0) {
+            buffer_start_line_ += static_cast<int>(newlines);
+            buffer_start_column_ = static_cast<int>(consumed.size() - consumed.rfind('\n') - 1);
+        } else {
+            buffer_start_column_ += static_cast<int>(consumed.size());
+        }
+
+        buffer_.erase(0, consumed.size());
+        pos_ -= consumed.size();
+    }
+
+    buffer_.append(input);
+    input_ = buffer_;
+    run();
+}
+
+void Tokenizer::finish() {
+    if (input_complete_) {
+        return;
+    }
+
+    input_complete_ = true;
+    run();
+}
+
 SourceLocation Tokenizer::current_source_location() const {
-    int line = static_cast<int>(std::ranges::count(input_.substr(0, pos_), '\n')) + 1;
+    auto newlines = static_cast<int>(std::ranges::count(input_.substr(0, pos_), '\n'));
+    int line = buffer_start_line_ + newlines + 1;
+    if (newlines == 0) {
+        return {.line = line, .column = buffer_start_column_ + static_cast<int>(pos_)};
+    }
+
     auto col = input_.rfind('\n', pos_);
-    return {.line = line, .column = static_cast<int>(line == 1 ? pos_ : pos_ - col - 1)};
+    return {.line = line, .column = static_cast<int>(pos_ - col - 1)};
 }
 
 void Tokenizer::emit(ParseError error) {
@@ -2509,4 +2563,16 @@ void Tokenizer::emit_replacement_character() {
     }
 }
 
+// Consumes everything up until the next delimiter, returning it together with
+// the character that was just consumed.
+std::string_view Tokenizer::consume_run_until(std::string_view delimiters) {
+    auto start = pos_ - 1;
+    pos_ = std::min(util::find_first_of(input_, delimiters, pos_), input_.size());
+    return input_.substr(start, pos_ - start);
+}
+
+void Tokenizer::emit_character_span_until(std::string_view delimiters) {
+    emit(CharacterSpanToken{consume_run_until(delimiters)});
+}
+
 } // namespace html2
@@ -150,9 +150,23 @@ public:
             std::function<void(Tokenizer &, ParseError)> on_error = [](auto &, auto) {})
         : input_{input}, on_emit_{std::move(on_emit)}, on_error_{std::move(on_error)} {}
 
+    // Creates a tokenizer without any input. The input is then provided piece
+    // by piece using feed(), and finish() is called once all of it has been
+    // provided.
+    explicit Tokenizer(
+            std::function<void(Tokenizer &, Token &&)> on_emit,
+            std::function<void(Tokenizer &, ParseError)> on_error = [](auto &, auto) {})
+        : on_emit_{std::move(on_emit)}, on_error_{std::move(on_error)}, input_complete_{false} {}
+
     void set_state(State);
     void run();
 
+    // Tokenizes as much of the input as possible without knowing what comes
+    // next, keeping the state machine's state until more input arrives.
+    void feed(std::string_view);
+    // Tokenizes whatever input is left and emits the end-of-file token.
+    void finish();
+
     [[nodiscard]] SourceLocation current_source_location() const;
 
     // This will definitely change once we implement the tree construction, but this works for now.
@@ -177,6 +191,13 @@ private:
     std::function<void(Tokenizer &, Token &&)> on_emit_{};
     std::function<void(Tokenizer &, ParseError)> on_error_{};
 
+    // Only used when the input is fed to us piece by piece.
+    bool input_complete_{true};
+    std::string buffer_{};
+    // Where in the document the start of the buffer is, for source locations.
+    int buffer_start_line_{0};
+    int buffer_start_column_{0};
+
     void emit(ParseError);
     void emit(Token &&);
     std::optional<char> consume_next_input_character();
@@ -192,6 +213,8 @@ private:
     void emit_temporary_buffer_as_character_tokens();
     bool is_appropriate_end_tag_token(Token const &) const;
     void emit_replacement_character();
+    std::string_view consume_run_until(std::string_view delimiters);
+    void emit_character_span_until(std::string_view delimiters);
 };
 
 } // namespace html2
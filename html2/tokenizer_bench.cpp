@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "html2/token.h"
+#include "html2/tokenizer.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <variant>
+
+using namespace std::literals;
+
+namespace {
+
+// Roughly what a text-heavy page looks like.
+std::string generate_document() {
+    std::string document{"<!DOCTYPE html><html><head><title>Benchmark</title></head><body>\n"};
+    for (int i = 0; i < 20000; ++i) {
+        document += "<p class=\"paragraph\">Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+                    "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim veniam, quis nostrud "
+                    "exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat &amp; "
+                    "<a href=\"https://example.com\">duis aute irure dolor</a>.</p>\n";
+    }
+    document += "<script>for (let i = 0; i < 10; ++i) { console.log(i); }</script></body></html>\n";
+    return document;
+}
+
+} // namespace
+
+// Usage: tokenizer_bench [file]
+// Tokenizes the file, or a generated document if none is given, a few times
+// and prints how long it took.
+int main(int argc, char **argv) {
+    std::string input = generate_document();
+    if (argc > 1) {
+        std::ifstream file{argv[1], std::ios::binary};
+        if (!file) {
+            std::cerr << "Unable to open " << argv[1] << '\n';
+            return EXIT_FAILURE;
+        }
+
+        input.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+    }
+
+    constexpr int kIterations = 10;
+    std::size_t tokens{};
+    auto const start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        html2::Tokenizer{input, [&](html2::Tokenizer &tokenizer, html2::Token &&token) {
+                             if (auto const *start_tag = std::get_if<html2::StartTagToken>(&token);
+                                     start_tag != nullptr && start_tag->tag_name == "script"sv) {
+                                 tokenizer.set_state(html2::State::ScriptData);
+                             }
+                             ++tokens;
+                         }}.run();
+    }
+    auto const elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    auto const mib = static_cast<double>(input.size()) * kIterations / (1024 * 1024);
+    std::cout << "Tokenized " << mib << " MiB in " << elapsed.count() * 1000 << " ms (" << mib / elapsed.count()
+              << " MiB/s), " << tokens / kIterations << " tokens per iteration\n";
+}
@@ -56,29 +56,54 @@ TokenizerOutput run_tokenizer(std::string_view input,
         etest::source_location loc = etest::source_location::current()) {
     std::vector<Token> tokens;
     std::vector<ParseErrorWithLocation> errors;
-    Tokenizer tokenizer{input,
-            [&](Tokenizer &the, Token &&t) {
-                if (auto const *start_tag = std::get_if<StartTagToken>(&t)) {
-                    if (start_tag->tag_name == "script") {
-                        the.set_state(State::ScriptData);
-                    } else if (start_tag->tag_name == "style") {
-                        the.set_state(State::Rawtext);
-                    } else if (start_tag->tag_name == "title") {
-                        the.set_state(State::Rcdata);
-                    }
-                }
-                tokens.push_back(std::move(t));
-            },
-            [&](Tokenizer &the, ParseError e) {
-                errors.push_back({e, the.current_source_location()});
-            }};
-    if (opts.state_override) {
-        tokenizer.set_state(*opts.state_override);
-    }
-    tokenizer.set_adjusted_current_node_not_in_html_namespace(!opts.in_html_namespace);
+    auto on_emit = [&](Tokenizer &the, Token &&t) {
+        if (auto const *start_tag = std::get_if<StartTagToken>(&t)) {
+            if (start_tag->tag_name == "script") {
+                the.set_state(State::ScriptData);
+            } else if (start_tag->tag_name == "style") {
+                the.set_state(State::Rawtext);
+            } else if (start_tag->tag_name == "title") {
+                the.set_state(State::Rcdata);
+            }
+        }
+
+        // Spans depend on how the input was split up, so we look at the characters in them instead.
+        if (auto const *span = std::get_if<CharacterSpanToken>(&t)) {
+            for (char c : span->data) {
+                tokens.emplace_back(CharacterToken{c});
+            }
+            return;
+        }
+
+        tokens.push_back(std::move(t));
+    };
+    auto on_error = [&](Tokenizer &the, ParseError e) {
+        errors.push_back({e, the.current_source_location()});
+    };
+    auto set_up = [&](Tokenizer &tokenizer) {
+        if (opts.state_override) {
+            tokenizer.set_state(*opts.state_override);
+        }
+        tokenizer.set_adjusted_current_node_not_in_html_namespace(!opts.in_html_namespace);
+    };
+
+    Tokenizer tokenizer{input, on_emit, on_error};
+    set_up(tokenizer);
     tokenizer.run();
+    auto all_at_once_tokens = std::exchange(tokens, {});
+    auto all_at_once_errors = std::exchange(errors, {});
+
+    // Getting the input one byte at a time should make no difference.
+    Tokenizer push_tokenizer{on_emit, on_error};
+    set_up(push_tokenizer);
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        push_tokenizer.feed(input.substr(i, 1));
+    }
+    push_tokenizer.finish();
+    expect(tokens == all_at_once_tokens, "Fed input resulted in different tokens", loc);
+    expect(errors == all_at_once_errors, "Fed input resulted in different errors", loc);
 
-    return {std::move(tokens), std::move(errors), std::move(loc)};
+    return {std::move(all_at_once_tokens), std::move(all_at_once_errors), std::move(loc)};
 }
 
 void expect_token(TokenizerOutput &output,
@@ -113,6 +138,26 @@ void expect_error(TokenizerOutput &output,
 }
 
 void data_tests() {
+    etest::test("data, characters are emitted in spans", [] {
+        std::vector<Token> tokens;
+        Tokenizer{"hello <b>world</b>&amp;!\0?"sv, [&](Tokenizer &, Token &&t) {
+            tokens.push_back(std::move(t));
+        }}.run();
+
+        expect_eq(tokens,
+                std::vector<Token>{
+                        CharacterSpanToken{"hello "},
+                        StartTagToken{.tag_name = "b"},
+                        CharacterSpanToken{"world"},
+                        EndTagToken{.tag_name = "b"},
+                        CharacterToken{'&'},
+                        CharacterSpanToken{"!"},
+                        CharacterToken{'\0'},
+                        CharacterSpanToken{"?"},
+                        EndOfFileToken{},
+                });
+    });
+
     etest::test("data, unexpected null", [] {
         auto tokens = run_tokenizer("<p>nullp\0"sv);
         expect_token(tokens, StartTagToken{.tag_name = "p"});
@@ -398,6 +443,19 @@ void source_location_tests() {
         expect_token(tokens, EndOfFileToken{});
     });
 
+    etest::test("src loc: long input", [] {
+        std::string input{};
+        for (int i = 0; i < 20000; ++i) {
+            input += "abc\n";
+        }
+        input += "xy\0"sv;
+
+        auto tokens = run_tokenizer(input);
+        expect_text(tokens, input);
+        expect_error(tokens, {ParseError::UnexpectedNullCharacter, {20001, 3}});
+        expect_token(tokens, EndOfFileToken{});
+    });
+
     etest::test("src loc: cdata eof", [] {
         auto tokens = run_tokenizer("\n", {.state_override = State::CdataSection});
         expect_token(tokens, CharacterToken{'\n'});
@@ -6,9 +6,11 @@
 
 #include <array>
 #include <csetjmp>
+#include <cstddef>
 #include <cstdint>
 #include <istream>
 #include <optional>
+#include <ostream>
 #include <utility>
 #include <vector>
 
@@ -28,6 +30,17 @@ void read_png_bytes(png_structp png, png_bytep data, png_size_t length) {
     }
 }
 
+void write_png_bytes(png_structp png, png_bytep data, png_size_t length) {
+    auto *os = reinterpret_cast<std::ostream *>(png_get_io_ptr(png));
+    if (!os->write(reinterpret_cast<char const *>(data), static_cast<std::streamsize>(length))) {
+        png_error(png, "failure while writing png data");
+    }
+}
+
+void flush_png_bytes(png_structp png) {
+    reinterpret_cast<std::ostream *>(png_get_io_ptr(png))->flush();
+}
+
 } // namespace
 
 std::optional<Png> Png::from(std::istream &is) {
@@ -89,4 +102,46 @@ std::optional<Png> Png::from(std::istream &is) {
     return ret;
 }
 
+bool Png::to(std::ostream &os) const {
+    if (bytes.size() != std::size_t{width} * height * 4) {
+        return false;
+    }
+
+    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    if (png == nullptr) {
+        return false;
+    }
+
+    png_infop info = png_create_info_struct(png);
+    if (info == nullptr) {
+        png_destroy_write_struct(&png, nullptr);
+        return false;
+    }
+
+    if (setjmp(png_jmpbuf(png))) {
+        png_destroy_write_struct(&png, &info);
+        return false;
+    }
+
+    png_set_write_fn(png, reinterpret_cast<void *>(&os), write_png_bytes, flush_png_bytes);
+    png_set_IHDR(png,
+            info,
+            width,
+            height,
+            8,
+            PNG_COLOR_TYPE_RGBA,
+            PNG_INTERLACE_NONE,
+            PNG_COMPRESSION_TYPE_DEFAULT,
+            PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(png, info);
+
+    for (std::uint32_t row = 0; row < height; ++row) {
+        png_write_row(png, bytes.data() + std::size_t{row} * width * 4);
+    }
+
+    png_write_end(png, nullptr);
+    png_destroy_write_struct(&png, &info);
+    return true;
+}
+
 } // namespace img
@@ -17,6 +17,10 @@ public:
     static std::optional<Png> from(std::istream &&is) { return from(is); }
     static std::optional<Png> from(std::istream &is);
 
+    // Writes the image as an 8-bit RGBA PNG. Returns false on failure.
+    [[nodiscard]] bool to(std::ostream &&os) const { return to(os); }
+    [[nodiscard]] bool to(std::ostream &os) const;
+
     std::uint32_t width{};
     std::uint32_t height{};
     std::vector<unsigned char> bytes{};
@@ -12,6 +12,7 @@
 #include <utility>
 #include <vector>
 
+using etest::expect;
 using etest::expect_eq;
 
 namespace {
@@ -49,5 +50,20 @@ int main() {
         expect_eq(img::Png::from(std::stringstream(std::move(truncated_bytes))), std::nullopt);
     });
 
+    etest::test("round trip", [] {
+        img::Png png{.width = 2, .height = 3};
+        for (std::size_t i = 0; i < 2 * 3 * 4; ++i) {
+            png.bytes.push_back(static_cast<unsigned char>(i * 10));
+        }
+
+        std::stringstream ss;
+        expect(png.to(ss));
+        expect_eq(img::Png::from(ss), png);
+
+        // The size doesn't match the number of bytes.
+        png.bytes.pop_back();
+        expect(!png.to(std::stringstream{}));
+    });
+
     return etest::run_all_tests();
 }
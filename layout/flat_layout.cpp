@@ -0,0 +1,99 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "layout/flat_layout.h"
+
+#include "layout/box_model.h"
+#include "layout/layout.h"
+
+#include "geom/geom.h"
+
+#include <cstddef>
+#include <optional>
+
+namespace layout {
+namespace {
+
+std::size_t count_boxes(LayoutBox const &box) {
+    std::size_t count = 1;
+    for (auto const &child : box.children) {
+        count += count_boxes(child);
+    }
+    return count;
+}
+
+} // namespace
+
+FlatLayout FlatLayout::from(LayoutBox const &root) {
+    // Counting the boxes first means that every array is only allocated once.
+    auto const count = count_boxes(root);
+    FlatLayout flat;
+    flat.nodes_.reserve(count);
+    flat.types_.reserve(count);
+    flat.parents_.reserve(count);
+    flat.first_children_.reserve(count);
+    flat.next_siblings_.reserve(count);
+    flat.subtree_ends_.reserve(count);
+    flat.content_.reserve(count);
+    flat.padding_.reserve(count);
+    flat.border_.reserve(count);
+    flat.margin_.reserve(count);
+
+    flat.append(root, kNoBox);
+    return flat;
+}
+
+void FlatLayout::append(LayoutBox const &box, Index parent) {
+    auto const index = size();
+    nodes_.push_back(box.node);
+    types_.push_back(box.type);
+    parents_.push_back(parent);
+    first_children_.push_back(box.children.empty() ? kNoBox : index + 1);
+    next_siblings_.push_back(kNoBox);
+    subtree_ends_.push_back(kNoBox);
+    content_.push_back(box.dimensions.content);
+    padding_.push_back(box.dimensions.padding);
+    border_.push_back(box.dimensions.border);
+    margin_.push_back(box.dimensions.margin);
+
+    Index previous_child = kNoBox;
+    for (auto const &child : box.children) {
+        auto const child_index = size();
+        if (previous_child != kNoBox) {
+            next_siblings_[previous_child] = child_index;
+        }
+
+        append(child, index);
+        previous_child = child_index;
+    }
+
+    subtree_ends_[index] = size();
+}
+
+// Same result as box_at_position for LayoutBox, but without recursion: once a
+// box containing the position has been found, only its subtree is searched.
+std::optional<FlatLayout::Index> box_at_position(FlatLayout const &layout, geom::Position p) {
+    std::optional<FlatLayout::Index> found;
+    auto end = layout.size();
+    for (FlatLayout::Index box = 0; box < end;) {
+        if (!layout.dimensions(box).contains(p)) {
+            box = layout.subtree_end(box);
+            continue;
+        }
+
+        // We don't want to end up in anonymous blocks, but their children may
+        // still be what we're looking for. If none of them is, the search
+        // continues with the boxes after the anonymous block.
+        if (layout.type(box) != LayoutType::AnonymousBlock) {
+            found = box;
+            end = layout.subtree_end(box);
+        }
+
+        ++box;
+    }
+
+    return found;
+}
+
+} // namespace layout
@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef LAYOUT_FLAT_LAYOUT_H_
+#define LAYOUT_FLAT_LAYOUT_H_
+
+#include "layout/box_model.h"
+#include "layout/layout.h"
+
+#include "geom/geom.h"
+#include "style/styled_node.h"
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace layout {
+
+// A laid out box tree stored in pre-order in flat arrays, with the links
+// between the boxes as indices, and the geometry of the boxes kept apart from
+// everything else so that walking the tree touches as little memory as
+// possible.
+class FlatLayout {
+public:
+    using Index = std::uint32_t;
+    static constexpr Index kNoBox = std::numeric_limits<Index>::max();
+
+    static FlatLayout from(LayoutBox const &root);
+
+    [[nodiscard]] Index size() const { return static_cast<Index>(nodes_.size()); }
+
+    [[nodiscard]] style::StyledNode const *node(Index box) const { return nodes_[box]; }
+    [[nodiscard]] LayoutType type(Index box) const { return types_[box]; }
+
+    [[nodiscard]] Index parent(Index box) const { return parents_[box]; }
+    [[nodiscard]] Index first_child(Index box) const { return first_children_[box]; }
+    [[nodiscard]] Index next_sibling(Index box) const { return next_siblings_[box]; }
+    // One past the last box in the subtree rooted at the box.
+    [[nodiscard]] Index subtree_end(Index box) const { return subtree_ends_[box]; }
+
+    [[nodiscard]] geom::Rect const &content(Index box) const { return content_[box]; }
+    [[nodiscard]] geom::EdgeSize const &padding(Index box) const { return padding_[box]; }
+    [[nodiscard]] geom::EdgeSize const &border(Index box) const { return border_[box]; }
+    [[nodiscard]] geom::EdgeSize const &margin(Index box) const { return margin_[box]; }
+    [[nodiscard]] BoxModel dimensions(Index box) const {
+        return {content_[box], padding_[box], border_[box], margin_[box]};
+    }
+
+private:
+    void append(LayoutBox const &, Index parent);
+
+    std::vector<style::StyledNode const *> nodes_;
+    std::vector<LayoutType> types_;
+
+    std::vector<Index> parents_;
+    std::vector<Index> first_children_;
+    std::vector<Index> next_siblings_;
+    std::vector<Index> subtree_ends_;
+
+    std::vector<geom::Rect> content_;
+    std::vector<geom::EdgeSize> padding_;
+    std::vector<geom::EdgeSize> border_;
+    std::vector<geom::EdgeSize> margin_;
+};
+
+std::optional<FlatLayout::Index> box_at_position(FlatLayout const &, geom::Position);
+
+} // namespace layout
+
+#endif
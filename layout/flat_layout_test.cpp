@@ -0,0 +1,156 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "layout/flat_layout.h"
+
+#include "layout/layout.h"
+
+#include "css/property_id.h"
+#include "dom/dom.h"
+#include "etest/etest.h"
+#include "geom/geom.h"
+#include "style/styled_node.h"
+
+#include <optional>
+
+using etest::expect;
+using etest::expect_eq;
+using etest::require;
+using etest::require_eq;
+using layout::FlatLayout;
+using layout::LayoutType;
+
+namespace {
+
+// Turns the result of the FlatLayout box_at_position into the LayoutBox it
+// corresponds to by following the same path down the tree.
+layout::LayoutBox const *to_box(FlatLayout const &flat, layout::LayoutBox const &root, FlatLayout::Index index) {
+    if (index == 0) {
+        return &root;
+    }
+
+    auto const *parent = to_box(flat, root, flat.parent(index));
+    auto child = flat.first_child(flat.parent(index));
+    for (auto const &box : parent->children) {
+        if (child == index) {
+            return &box;
+        }
+        child = flat.next_sibling(child);
+    }
+
+    return nullptr;
+}
+
+} // namespace
+
+int main() {
+    etest::test("from", [] {
+        auto layout = layout::LayoutBox{
+                .node = nullptr,
+                .type = LayoutType::Block,
+                .dimensions = {{0, 0, 100, 100}},
+                .children{
+                        {nullptr, LayoutType::Block, {{25, 25, 50, 50}, {1, 2, 3, 4}}, {
+                            {nullptr, LayoutType::AnonymousBlock, {{30, 30, 5, 5}}, {}},
+                            {nullptr, LayoutType::Block, {{45, 45, 5, 5}}, {}},
+                        }},
+                        {nullptr, LayoutType::Inline, {{0, 80, 5, 5}}, {}},
+                },
+        };
+
+        auto flat = FlatLayout::from(layout);
+        require_eq(flat.size(), FlatLayout::Index{5});
+
+        expect_eq(flat.type(0), LayoutType::Block);
+        expect_eq(flat.type(2), LayoutType::AnonymousBlock);
+        expect_eq(flat.type(4), LayoutType::Inline);
+
+        expect_eq(flat.parent(0), FlatLayout::kNoBox);
+        expect_eq(flat.parent(1), FlatLayout::Index{0});
+        expect_eq(flat.parent(3), FlatLayout::Index{1});
+        expect_eq(flat.parent(4), FlatLayout::Index{0});
+
+        expect_eq(flat.first_child(0), FlatLayout::Index{1});
+        expect_eq(flat.first_child(1), FlatLayout::Index{2});
+        expect_eq(flat.first_child(4), FlatLayout::kNoBox);
+
+        expect_eq(flat.next_sibling(0), FlatLayout::kNoBox);
+        expect_eq(flat.next_sibling(1), FlatLayout::Index{4});
+        expect_eq(flat.next_sibling(2), FlatLayout::Index{3});
+        expect_eq(flat.next_sibling(3), FlatLayout::kNoBox);
+
+        expect_eq(flat.subtree_end(0), FlatLayout::Index{5});
+        expect_eq(flat.subtree_end(1), FlatLayout::Index{4});
+        expect_eq(flat.subtree_end(2), FlatLayout::Index{3});
+
+        expect_eq(flat.dimensions(1), layout.children[0].dimensions);
+        expect_eq(flat.padding(1), geom::EdgeSize{1, 2, 3, 4});
+        expect_eq(flat.content(4), geom::Rect{0, 80, 5, 5});
+    });
+
+    etest::test("box_at_position", [] {
+        auto layout = layout::LayoutBox{
+                .node = nullptr,
+                .type = LayoutType::Block,
+                .dimensions = {{0, 0, 100, 100}},
+                .children{
+                        {nullptr, LayoutType::Block, {{25, 25, 50, 50}}, {
+                            {nullptr, LayoutType::AnonymousBlock, {{30, 30, 5, 5}}, {}},
+                            {nullptr, LayoutType::Block, {{45, 45, 5, 5}}, {}},
+                        }},
+                        {nullptr, LayoutType::AnonymousBlock, {{60, 60, 10, 10}}, {
+                            {nullptr, LayoutType::Inline, {{69, 69, 5, 5}}, {}},
+                        }},
+                        {nullptr, LayoutType::Block, {{65, 65, 10, 10}}, {}},
+                },
+        };
+        auto flat = FlatLayout::from(layout);
+
+        expect_eq(box_at_position(flat, {-1, -1}), std::nullopt);
+        expect_eq(box_at_position(flat, {101, 101}), std::nullopt);
+        expect_eq(box_at_position(flat, {0, 0}), std::optional<FlatLayout::Index>{0});
+        expect_eq(box_at_position(flat, {31, 31}), std::optional<FlatLayout::Index>{1});
+        expect_eq(box_at_position(flat, {47, 47}), std::optional<FlatLayout::Index>{3});
+
+        for (int y = -1; y <= 101; ++y) {
+            for (int x = -1; x <= 101; ++x) {
+                auto const *expected = box_at_position(layout, {x, y});
+                auto const found = box_at_position(flat, {x, y});
+                require(found.has_value() == (expected != nullptr));
+                if (found) {
+                    expect(to_box(flat, layout, *found) == expected);
+                }
+            }
+        }
+    });
+
+    etest::test("from create_layout", [] {
+        dom::Node dom = dom::Element{"html", {}, {dom::Element{"p"}, dom::Text{"hello"}, dom::Element{"p"}}};
+        auto const &children = std::get<dom::Element>(dom).children;
+        style::StyledNode styled{
+                .node = dom,
+                .properties{{css::PropertyId::Display, "block"}},
+                .children{
+                        {children[0], {{css::PropertyId::Display, "block"}, {css::PropertyId::Height, "10px"}}},
+                        {children[1]},
+                        {children[2], {{css::PropertyId::Display, "block"}, {css::PropertyId::Height, "5px"}}},
+                },
+        };
+        for (auto &child : styled.children) {
+            child.parent = &styled;
+        }
+
+        auto layout = layout::create_layout(styled, 100).value();
+        auto flat = FlatLayout::from(layout);
+        require_eq(flat.size(), FlatLayout::Index{5});
+        expect(flat.node(0) == &styled);
+        expect(flat.node(1) == &styled.children[0]);
+        expect(flat.node(2) == nullptr);
+        expect(flat.node(3) == &styled.children[1]);
+        expect(flat.node(4) == &styled.children[2]);
+        expect_eq(flat.dimensions(4), layout.children[2].dimensions);
+    });
+
+    return etest::run_all_tests();
+}
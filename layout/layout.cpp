@@ -5,23 +5,24 @@
 
 #include "layout/layout.h"
 
-#include "util/from_chars.h"
+#include "gfx/font.h"
+#include "style/computed_style.h"
+#include "type/naive.h"
+#include "type/type.h"
 #include "util/overloaded.h"
-
-#include <spdlog/spdlog.h>
+#include "util/work_stealing_pool.h"
 
 #include <algorithm>
 #include <cassert>
-#include <cerrno>
-#include <charconv>
+#include <cstddef>
 #include <cstdlib>
-#include <map>
+#include <iterator>
 #include <optional>
 #include <sstream>
 #include <string_view>
-#include <system_error>
 #include <utility>
 #include <variant>
+#include <vector>
 
 using namespace std::literals;
 
@@ -32,90 +33,71 @@ bool last_node_was_anonymous(LayoutBox const &box) {
     return !box.children.empty() && box.children.back().type == LayoutType::AnonymousBlock;
 }
 
-// https://www.w3.org/TR/CSS2/visuren.html#box-gen
-std::optional<LayoutBox> create_tree(style::StyledNode const &node) {
-    auto visitor = util::Overloaded{
-            [&node](dom::Element const &) -> std::optional<LayoutBox> {
-                auto display = node.get_property<css::PropertyId::Display>();
-                if (display == style::DisplayValue::None) {
-                    return std::nullopt;
-                }
-
-                LayoutBox box{&node, display == style::DisplayValue::Inline ? LayoutType::Inline : LayoutType::Block};
-
-                for (auto const &child : node.children) {
-                    auto child_box = create_tree(child);
-                    if (!child_box) {
-                        continue;
-                    }
-
-                    if (child_box->type == LayoutType::Inline && box.type != LayoutType::Inline) {
-                        if (!last_node_was_anonymous(box)) {
-                            box.children.push_back(LayoutBox{nullptr, LayoutType::AnonymousBlock});
-                        }
-
-                        box.children.back().children.push_back(std::move(*child_box));
-                    } else {
-                        box.children.push_back(std::move(*child_box));
-                    }
-                }
-
-                return box;
-            },
-            [&node](dom::Text const &) -> std::optional<LayoutBox> {
-                return LayoutBox{&node, LayoutType::Inline};
-            },
-    };
-
-    return std::visit(visitor, node.node);
+std::optional<LayoutType> box_type(style::StyledNode const &node) {
+    // Resolved for text nodes as well so that every box in the tree has its
+    // computed style ready before anything's laid out. See layout_parallel.
+    auto const &style = node.computed();
+    if (std::holds_alternative<dom::Text>(node.node)) {
+        return LayoutType::Inline;
+    }
+
+    switch (style.display) {
+        case style::DisplayValue::None:
+            return std::nullopt;
+        case style::DisplayValue::Inline:
+            return LayoutType::Inline;
+        case style::DisplayValue::Block:
+            return LayoutType::Block;
+    }
+
+    assert(false);
+    std::abort();
 }
 
-// TODO(robinlinden):
-// * margin, border, etc.
-// * Not all measurements have to be in pixels.
-// * %, rem
-int to_px(std::string_view property, int const font_size) {
-    // Special case for 0 since it won't ever have a unit that needs to be handled.
-    if (property == "0") {
-        return 0;
+// https://www.w3.org/TR/CSS2/visuren.html#box-gen
+std::optional<LayoutBox> create_tree(style::StyledNode const &node) {
+    auto type = box_type(node);
+    if (!type) {
+        return std::nullopt;
     }
 
-    float res{};
-    auto parse_result = util::from_chars(property.data(), property.data() + property.size(), res);
-    if (parse_result.ec != std::errc{}) {
-        spdlog::warn("Unable to parse property '{}' in to_px", property);
-        return 0;
+    LayoutBox box{&node, *type};
+    if (std::holds_alternative<dom::Text>(node.node)) {
+        return box;
     }
 
-    auto const parsed_length = std::distance(property.data(), parse_result.ptr);
-    auto const unit = property.substr(parsed_length);
+    for (auto const &child : node.children) {
+        auto child_box = create_tree(child);
+        if (!child_box) {
+            continue;
+        }
 
-    if (unit == "px") {
-        return static_cast<int>(res);
-    }
+        if (child_box->type == LayoutType::Inline && box.type != LayoutType::Inline) {
+            if (!last_node_was_anonymous(box)) {
+                box.children.push_back(LayoutBox{nullptr, LayoutType::AnonymousBlock});
+            }
 
-    if (unit == "em") {
-        res *= static_cast<float>(font_size);
-        return static_cast<int>(res);
+            box.children.back().children.push_back(std::move(*child_box));
+        } else {
+            box.children.push_back(std::move(*child_box));
+        }
     }
 
-    spdlog::warn("Bad property '{}' w/ unit '{}' in to_px", property, unit);
-    return static_cast<int>(res);
+    return box;
 }
 
 void calculate_left_and_right_margin(LayoutBox &box,
         geom::Rect const &parent,
-        std::string_view margin_left,
-        std::string_view margin_right,
-        int const font_size) {
-    if (margin_left == "auto" && margin_right == "auto") {
+        std::optional<int> const &margin_left,
+        std::optional<int> const &margin_right) {
+    if (!margin_left && !margin_right) {
         int margin_px = (parent.width - box.dimensions.border_box().width) / 2;
         box.dimensions.margin.left = box.dimensions.margin.right = margin_px;
-    } else if (margin_left == "auto" && margin_right != "auto") {
-        box.dimensions.margin.right = to_px(margin_right, font_size);
+    } else if (!margin_left && margin_right) {
+        box.dimensions.margin.right = *margin_right;
         box.dimensions.margin.left = parent.width - box.dimensions.margin_box().width;
-    } else if (margin_left != "auto" && margin_right == "auto") {
-        box.dimensions.margin.left = to_px(margin_left, font_size);
+    } else if (margin_left && !margin_right) {
+        box.dimensions.margin.left = *margin_left;
         box.dimensions.margin.right = parent.width - box.dimensions.margin_box().width;
     } else {
         // TODO(mkiael): Compute margin depending on direction property
@@ -123,44 +105,39 @@ void calculate_left_and_right_margin(LayoutBox &box,
 }
 
 // https://www.w3.org/TR/CSS2/visudet.html#blockwidth
-void calculate_width_and_margin(LayoutBox &box, geom::Rect const &parent, int const font_size) {
+void calculate_width_and_margin(LayoutBox &box, geom::Rect const &parent) {
     assert(box.node != nullptr);
+    auto const &style = box.node->computed();
 
-    auto margin_top = box.get_property<css::PropertyId::MarginTop>();
-    box.dimensions.margin.top = to_px(margin_top, font_size);
-
-    auto margin_bottom = box.get_property<css::PropertyId::MarginBottom>();
-    box.dimensions.margin.bottom = to_px(margin_bottom, font_size);
+    box.dimensions.margin.top = style.margin.top.value_or(0);
+    box.dimensions.margin.bottom = style.margin.bottom.value_or(0);
 
-    auto width = box.get_property<css::PropertyId::Width>();
-    auto margin_left = box.get_property<css::PropertyId::MarginLeft>();
-    auto margin_right = box.get_property<css::PropertyId::MarginRight>();
-    if (width == "auto") {
-        if (margin_left != "auto") {
-            box.dimensions.margin.left = to_px(margin_left, font_size);
+    auto const &margin_left = style.margin.left;
+    auto const &margin_right = style.margin.right;
+    if (!style.width) {
+        if (margin_left) {
+            box.dimensions.margin.left = *margin_left;
         }
-        if (margin_right != "auto") {
-            box.dimensions.margin.right = to_px(margin_right, font_size);
+        if (margin_right) {
+            box.dimensions.margin.right = *margin_right;
         }
         box.dimensions.content.width = parent.width - box.dimensions.margin_box().width;
     } else {
-        box.dimensions.content.width = to_px(width, font_size);
-        calculate_left_and_right_margin(box, parent, margin_left, margin_right, font_size);
+        box.dimensions.content.width = *style.width;
+        calculate_left_and_right_margin(box, parent, margin_left, margin_right);
     }
 
-    if (auto min = box.get_property<css::PropertyId::MinWidth>(); min != "auto") {
-        int min_width_px = to_px(min, font_size);
-        if (box.dimensions.content.width < min_width_px) {
-            box.dimensions.content.width = min_width_px;
-            calculate_left_and_right_margin(box, parent, margin_left, margin_right, font_size);
+    if (auto min = style.min_width) {
+        if (box.dimensions.content.width < *min) {
+            box.dimensions.content.width = *min;
+            calculate_left_and_right_margin(box, parent, margin_left, margin_right);
         }
     }
 
-    if (auto max = box.get_property<css::PropertyId::MaxWidth>(); max != "none") {
-        int max_width_px = to_px(max, font_size);
-        if (box.dimensions.content.width > max_width_px) {
-            box.dimensions.content.width = max_width_px;
-            calculate_left_and_right_margin(box, parent, margin_left, margin_right, font_size);
+    if (auto max = style.max_width) {
+        if (box.dimensions.content.width > *max) {
+            box.dimensions.content.width = *max;
+            calculate_left_and_right_margin(box, parent, margin_left, margin_right);
         }
     }
 }
@@ -172,119 +149,112 @@ void calculate_position(LayoutBox &box, geom::Rect const &parent) {
     box.dimensions.content.y = parent.y + parent.height + d.border.top + d.padding.top + d.margin.top;
 }
 
-void calculate_height(LayoutBox &box, int const font_size) {
+void calculate_inline_position(LayoutBox &box, geom::Rect const &bounds) {
+    if (box.node->parent) {
+        auto const &d = box.dimensions;
+        box.dimensions.content.x = bounds.x + d.padding.left + d.border.left + d.margin.left;
+        box.dimensions.content.y = bounds.y + d.border.top + d.padding.top + d.margin.top;
+    }
+}
+
+void calculate_height(LayoutBox &box) {
     assert(box.node != nullptr);
+    auto const &style = box.node->computed();
     if (auto const *text = std::get_if<dom::Text>(&box.node->node)) {
         int lines = static_cast<int>(std::ranges::count(text->text, '\n')) + 1;
-        box.dimensions.content.height = lines * font_size;
+        box.dimensions.content.height = lines * style.font_size;
     }
 
-    if (auto height = box.get_property<css::PropertyId::Height>(); height != "auto") {
-        box.dimensions.content.height = to_px(height, font_size);
+    if (style.height) {
+        box.dimensions.content.height = *style.height;
     }
 
-    if (auto min = box.get_property<css::PropertyId::MinHeight>(); min != "auto") {
-        box.dimensions.content.height = std::max(box.dimensions.content.height, to_px(min, font_size));
+    if (style.min_height) {
+        box.dimensions.content.height = std::max(box.dimensions.content.height, *style.min_height);
     }
 
-    if (auto max = box.get_property<css::PropertyId::MaxHeight>(); max != "none") {
-        box.dimensions.content.height = std::min(box.dimensions.content.height, to_px(max, font_size));
+    if (style.max_height) {
+        box.dimensions.content.height = std::min(box.dimensions.content.height, *style.max_height);
     }
 }
 
-void calculate_padding(LayoutBox &box, int const font_size) {
-    auto padding_left = box.get_property<css::PropertyId::PaddingLeft>();
-    box.dimensions.padding.left = to_px(padding_left, font_size);
-
-    auto padding_right = box.get_property<css::PropertyId::PaddingRight>();
-    box.dimensions.padding.right = to_px(padding_right, font_size);
-
-    auto padding_top = box.get_property<css::PropertyId::PaddingTop>();
-    box.dimensions.padding.top = to_px(padding_top, font_size);
-
-    auto padding_bottom = box.get_property<css::PropertyId::PaddingBottom>();
-    box.dimensions.padding.bottom = to_px(padding_bottom, font_size);
+void calculate_padding(LayoutBox &box) {
+    auto const &padding = box.node->computed().padding;
+    box.dimensions.padding.left = padding.left;
+    box.dimensions.padding.right = padding.right;
+    box.dimensions.padding.top = padding.top;
+    box.dimensions.padding.bottom = padding.bottom;
 }
 
-// https://w3c.github.io/csswg-drafts/css-backgrounds/#the-border-width
-std::map<std::string_view, int> const kBorderWidthKeywords{
-        {"thin", 3},
-        {"medium", 5},
-        {"thick", 7},
-};
-
-void calculate_border(LayoutBox &box, int const font_size) {
-    auto as_px = [&](std::string_view border_width_property) {
-        if (kBorderWidthKeywords.contains(border_width_property)) {
-            return kBorderWidthKeywords.at(border_width_property);
-        }
-
-        return to_px(border_width_property, font_size);
-    };
+void calculate_border(LayoutBox &box) {
+    auto const &style = box.node->computed();
+    if (style.border_style.left != style::BorderStyle::None) {
+        box.dimensions.border.left = style.border_width.left;
+    }
 
-    if (box.get_property<css::PropertyId::BorderLeftStyle>() != style::BorderStyle::None) {
-        auto border_width = box.get_property<css::PropertyId::BorderLeftWidth>();
-        box.dimensions.border.left = as_px(border_width);
+    if (style.border_style.right != style::BorderStyle::None) {
+        box.dimensions.border.right = style.border_width.right;
     }
 
-    if (box.get_property<css::PropertyId::BorderRightStyle>() != style::BorderStyle::None) {
-        auto border_width = box.get_property<css::PropertyId::BorderRightWidth>();
-        box.dimensions.border.right = as_px(border_width);
+    if (style.border_style.top != style::BorderStyle::None) {
+        box.dimensions.border.top = style.border_width.top;
     }
 
-    if (box.get_property<css::PropertyId::BorderTopStyle>() != style::BorderStyle::None) {
-        auto border_width = box.get_property<css::PropertyId::BorderTopWidth>();
-        box.dimensions.border.top = as_px(border_width);
+    if (style.border_style.bottom != style::BorderStyle::None) {
+        box.dimensions.border.bottom = style.border_width.bottom;
     }
+}
 
-    if (box.get_property<css::PropertyId::BorderBottomStyle>() != style::BorderStyle::None) {
-        auto border_width = box.get_property<css::PropertyId::BorderBottomWidth>();
-        box.dimensions.border.bottom = as_px(border_width);
+int measure_text(style::ComputedStyle const &style, std::string_view text, type::IType const &type) {
+    auto const font_style =
+            style.font_style == style::FontStyle::Normal ? gfx::FontStyle::Normal : gfx::FontStyle::Italic;
+    for (auto const &family : style.font_family) {
+        if (auto font = type.font(family)) {
+            return (*font)->measure(text, type::Px{style.font_size}, font_style).width;
+        }
     }
+
+    // None of the fonts are available, so guess.
+    return type::NaiveFont{}.measure(text, type::Px{style.font_size}, font_style).width;
 }
 
-void layout(LayoutBox &box, geom::Rect const &bounds) {
+using LayOutChild = void (*)(LayoutBox &, geom::Rect const &, type::IType const &);
+
+void layout_box(LayoutBox &box, geom::Rect const &bounds, type::IType const &type, LayOutChild lay_out_child) {
     switch (box.type) {
         case LayoutType::Inline: {
             assert(box.node);
-            auto font_size = box.get_property<css::PropertyId::FontSize>();
-            calculate_padding(box, font_size);
-            calculate_border(box, font_size);
+            calculate_padding(box);
+            calculate_border(box);
 
             if (auto const *text_node = std::get_if<dom::Text>(&box.node->node)) {
-                // TODO(robinlinden): Measure the text for real.
-                box.dimensions.content.width = static_cast<int>(text_node->text.size()) * font_size / 2;
+                box.dimensions.content.width = measure_text(box.node->computed(), text_node->text, type);
             }
 
-            if (box.node->parent) {
-                auto const &d = box.dimensions;
-                box.dimensions.content.x = bounds.x + d.padding.left + d.border.left + d.margin.left;
-                box.dimensions.content.y = bounds.y + d.border.top + d.padding.top + d.margin.top;
-            }
+            calculate_inline_position(box, bounds);
 
             int last_child_end{};
             for (auto &child : box.children) {
-                layout(child, box.dimensions.content.translated(last_child_end, 0));
+                lay_out_child(child, box.dimensions.content.translated(last_child_end, 0), type);
                 last_child_end += child.dimensions.margin_box().width;
                 box.dimensions.content.height =
                         std::max(box.dimensions.content.height, child.dimensions.margin_box().height);
                 box.dimensions.content.width += child.dimensions.margin_box().width;
             }
-            calculate_height(box, font_size);
+            calculate_height(box);
             return;
         }
         case LayoutType::Block: {
             assert(box.node);
-            auto font_size = box.get_property<css::PropertyId::FontSize>();
-            calculate_padding(box, font_size);
-            calculate_border(box, font_size);
-            calculate_width_and_margin(box, bounds, font_size);
+            calculate_padding(box);
+            calculate_border(box);
+            calculate_width_and_margin(box, bounds);
             calculate_position(box, bounds);
             for (auto &child : box.children) {
-                layout(child, box.dimensions.content);
+                lay_out_child(child, box.dimensions.content, type);
                 box.dimensions.content.height += child.dimensions.margin_box().height;
             }
-            calculate_height(box, font_size);
+            calculate_height(box);
             return;
         }
         // TODO(robinlinden): Children wider than the available area need to be split across multiple lines.
@@ -292,7 +262,7 @@ void layout(LayoutBox &box, geom::Rect const &bounds) {
             calculate_position(box, bounds);
             int last_child_end{};
             for (auto &child : box.children) {
-                layout(child, box.dimensions.content.translated(last_child_end, 0));
+                lay_out_child(child, box.dimensions.content.translated(last_child_end, 0), type);
                 last_child_end += child.dimensions.margin_box().width;
                 box.dimensions.content.height =
                         std::max(box.dimensions.content.height, child.dimensions.margin_box().height);
@@ -303,6 +273,152 @@ void layout(LayoutBox &box, geom::Rect const &bounds) {
     }
 }
 
+void layout(LayoutBox &box, geom::Rect const &bounds, type::IType const &type) {
+    layout_box(box, bounds, type, layout);
+}
+
+void translate(LayoutBox &box, int dx, int dy) {
+    if (dx == 0 && dy == 0) {
+        return;
+    }
+
+    box.dimensions.content = box.dimensions.content.translated(dx, dy);
+    for (auto &child : box.children) {
+        translate(child, dx, dy);
+    }
+}
+
+// Counts the boxes in a subtree, but stops counting at limit.
+std::size_t count_boxes(LayoutBox const &box, std::size_t limit) {
+    std::size_t count = 1;
+    for (auto const &child : box.children) {
+        if (count >= limit) {
+            break;
+        }
+        count += count_boxes(child, limit - count);
+    }
+    return std::min(count, limit);
+}
+
+// The children of a block box are stacked on top of each other, but nothing
+// else about their layout depends on their siblings. Each child is laid out
+// as if it were the first one in the box, in groups of at least
+// min_parallel_boxes boxes per task, and then moved down below its preceding
+// siblings. Children large enough to be worth it are laid out the same way.
+//
+// create_tree resolves the computed style of every node it creates a box
+// for, text nodes included, so the tasks only read the styled tree.
+void layout_parallel(LayoutBox &box,
+        geom::Rect const &bounds,
+        type::IType const &type,
+        util::WorkStealingPool &pool,
+        std::size_t min_parallel_boxes) {
+    if (box.type != LayoutType::Block) {
+        layout(box, bounds, type);
+        return;
+    }
+
+    assert(box.node);
+    calculate_padding(box);
+    calculate_border(box);
+    calculate_width_and_margin(box, bounds);
+    calculate_position(box, bounds);
+
+    // Split the children into runs of [begin, end) indices.
+    std::vector<std::pair<std::size_t, std::size_t>> tasks;
+    std::vector<bool> is_large(box.children.size());
+    std::size_t boxes_in_task{};
+    for (std::size_t i = 0; i < box.children.size(); ++i) {
+        auto const boxes = count_boxes(box.children[i], min_parallel_boxes);
+        is_large[i] = boxes >= min_parallel_boxes;
+        if (tasks.empty() || boxes_in_task >= min_parallel_boxes) {
+            tasks.emplace_back(i, i);
+            boxes_in_task = 0;
+        }
+        tasks.back().second = i + 1;
+        boxes_in_task += boxes;
+    }
+
+    auto const origin = geom::Rect{box.dimensions.content.x, box.dimensions.content.y, box.dimensions.content.width, 0};
+    pool.parallel_for(tasks.size(), [&](std::size_t task) {
+        for (auto i = tasks[task].first; i < tasks[task].second; ++i) {
+            if (is_large[i]) {
+                layout_parallel(box.children[i], origin, type, pool, min_parallel_boxes);
+            } else {
+                layout(box.children[i], origin, type);
+            }
+        }
+    });
+
+    std::vector<int> offsets(box.children.size());
+    for (std::size_t i = 0; i < box.children.size(); ++i) {
+        offsets[i] = box.dimensions.content.height;
+        box.dimensions.content.height += box.children[i].dimensions.margin_box().height;
+    }
+
+    pool.parallel_for(tasks.size(), [&](std::size_t task) {
+        for (auto i = tasks[task].first; i < tasks[task].second; ++i) {
+            translate(box.children[i], 0, offsets[i]);
+        }
+    });
+
+    calculate_height(box);
+}
+
+// Moves a box that has been laid out before to where it belongs inside of
+// bounds, if that's enough to bring its layout up to date.
+bool move_if_size_unchanged(LayoutBox &box, geom::Rect const &bounds) {
+    auto const previous = box.dimensions.content;
+    switch (box.type) {
+        case LayoutType::Block:
+            box.dimensions = {};
+            calculate_padding(box);
+            calculate_border(box);
+            calculate_width_and_margin(box, bounds);
+            calculate_position(box, bounds);
+            if (box.dimensions.content.width != previous.width) {
+                return false;
+            }
+
+            // The contents only depend on the width and position of the box,
+            // so they just have to be moved along with it.
+            box.dimensions.content.height = previous.height;
+            break;
+        // Inline boxes and anonymous blocks are sized after their contents,
+        // not after the box containing them.
+        case LayoutType::Inline:
+            calculate_inline_position(box, bounds);
+            break;
+        case LayoutType::AnonymousBlock:
+            calculate_position(box, bounds);
+            break;
+    }
+
+    for (auto &child : box.children) {
+        translate(child, box.dimensions.content.x - previous.x, box.dimensions.content.y - previous.y);
+    }
+    return true;
+}
+
+// Like layout, but reuses the geometry from the previous layout of the box
+// wherever the inputs it was calculated from are unchanged.
+void relayout(LayoutBox &box, geom::Rect const &bounds, type::IType const &type) {
+    if (box.needs_layout) {
+        assert(box.node);
+        box = create_tree(*box.node).value();
+        layout(box, bounds, type);
+        return;
+    }
+
+    if (!box.has_dirty_descendants && move_if_size_unchanged(box, bounds)) {
+        return;
+    }
+
+    box.dimensions = {};
+    box.has_dirty_descendants = false;
+    layout_box(box, bounds, type, relayout);
+}
+
 std::string_view to_str(LayoutType type) {
     switch (type) {
         case LayoutType::Inline:
@@ -358,21 +474,109 @@ void print_box(LayoutBox const &box, std::ostream &os, uint8_t depth = 0) {
 } // namespace
 
 std::pair<int, int> LayoutBox::get_border_radius_property(css::PropertyId id) const {
-    auto raw = node->get_raw_property(id);
-    auto [horizontal, vertical] = raw.contains('/') ? util::split_once(raw, "/") : std::pair{raw, raw};
+    auto const &style = node->computed();
+    switch (id) {
+        case css::PropertyId::BorderTopLeftRadius:
+            return style.border_top_left_radius;
+        case css::PropertyId::BorderTopRightRadius:
+            return style.border_top_right_radius;
+        case css::PropertyId::BorderBottomLeftRadius:
+            return style.border_bottom_left_radius;
+        case css::PropertyId::BorderBottomRightRadius:
+            return style.border_bottom_right_radius;
+        default:
+            break;
+    }
 
-    int font_size = node->get_property<css::PropertyId::FontSize>();
-    return {to_px(horizontal, font_size), to_px(vertical, font_size)};
+    assert(false);
+    std::abort();
 }
 
-std::optional<LayoutBox> create_layout(style::StyledNode const &node, int width) {
+std::optional<LayoutBox> create_layout(style::StyledNode const &node, int width, type::IType const &type) {
     auto tree = create_tree(node);
     if (!tree) {
         return {};
     }
 
-    layout(*tree, {0, 0, width, 0});
-    return *tree;
+    layout(*tree, {0, 0, width, 0}, type);
+    return tree;
+}
+
+std::optional<LayoutBox> create_layout(style::StyledNode const &node,
+        int width,
+        type::IType const &type,
+        util::WorkStealingPool &pool,
+        std::size_t min_parallel_boxes) {
+    auto tree = create_tree(node);
+    if (!tree) {
+        return {};
+    }
+
+    if (count_boxes(*tree, min_parallel_boxes) < min_parallel_boxes) {
+        layout(*tree, {0, 0, width, 0}, type);
+    } else {
+        layout_parallel(*tree, {0, 0, width, 0}, type, pool, min_parallel_boxes);
+    }
+
+    return tree;
+}
+
+void mark_for_relayout(LayoutBox &root, style::StyledNode const &changed) {
+    std::vector<style::StyledNode const *> styled_path{&changed};
+    while (styled_path.back() != root.node && styled_path.back()->parent != nullptr) {
+        styled_path.push_back(styled_path.back()->parent);
+    }
+    assert(styled_path.back() == root.node);
+
+    // Find the boxes from the root down to the one generated for the changed
+    // node, including any anonymous blocks in between.
+    std::vector<LayoutBox *> path{&root};
+    for (auto it = std::next(styled_path.rbegin()); it != styled_path.rend(); ++it) {
+        auto is_generated_by = [node = *it](LayoutBox const &box) { return box.node == node; };
+        auto &children = path.back()->children;
+        if (auto child = std::ranges::find_if(children, is_generated_by); child != end(children)) {
+            path.push_back(&*child);
+            continue;
+        }
+
+        auto anonymous = std::ranges::find_if(children, [&](LayoutBox const &child) {
+            return child.type == LayoutType::AnonymousBlock && std::ranges::any_of(child.children, is_generated_by);
+        });
+        if (anonymous != end(children)) {
+            path.push_back(&*anonymous);
+            path.push_back(&*std::ranges::find_if(anonymous->children, is_generated_by));
+            continue;
+        }
+
+        if (*it != &changed) {
+            // Something above the changed node doesn't generate a box, so
+            // neither will the changed node.
+            return;
+        }
+
+        // The changed node didn't generate a box before, but it might now, so
+        // its parent will have to be rebuilt.
+        path.push_back(nullptr);
+    }
+
+    // If the changed node now generates a different kind of box (or none at
+    // all), the box of its parent has to be rebuilt to put it in place.
+    if (path.back() == nullptr || path.back()->type != box_type(changed)) {
+        assert(path.size() > 1 && "the root box can't change type, use create_layout instead");
+        do {
+            path.pop_back();
+        } while (path.back()->type == LayoutType::AnonymousBlock);
+    }
+
+    path.back()->needs_layout = true;
+    path.pop_back();
+    for (auto *box : path) {
+        box->has_dirty_descendants = true;
+    }
+}
+
+void relayout(LayoutBox &box, int width, type::IType const &type) {
+    relayout(box, {0, 0, width, 0}, type);
 }
 
 LayoutBox const *box_at_position(LayoutBox const &box, geom::Position p) {
@@ -10,8 +10,12 @@
 #include "css/property_id.h"
 #include "geom/geom.h"
 #include "style/styled_node.h"
+#include "type/naive.h"
+#include "type/type.h"
+#include "util/work_stealing_pool.h"
 
 #include <cassert>
+#include <cstddef>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -32,6 +36,9 @@ struct LayoutBox {
     LayoutType type;
     BoxModel dimensions;
     std::vector<LayoutBox> children;
+    // Set by mark_for_relayout, and cleared by relayout.
+    bool needs_layout{};
+    bool has_dirty_descendants{};
     [[nodiscard]] bool operator==(LayoutBox const &) const = default;
 
     template<css::PropertyId T>
@@ -52,7 +59,32 @@ private:
     std::pair<int, int> get_border_radius_property(css::PropertyId) const;
 };
 
-std::optional<LayoutBox> create_layout(style::StyledNode const &node, int width);
+// Text is measured using the first font in the font-family of the text that
+// type has. The default is good enough for when the text isn't drawn.
+std::optional<LayoutBox> create_layout(
+        style::StyledNode const &node, int width, type::IType const &type = type::NaiveType{});
+
+// Lays out sibling subtrees of block boxes on the pool's threads. Subtrees
+// with fewer than min_parallel_boxes boxes are laid out on a single thread.
+// The resulting tree is identical to the one the other overload creates. type
+// must be safe to use from multiple threads at the same time.
+std::optional<LayoutBox> create_layout(style::StyledNode const &node,
+        int width,
+        type::IType const &type,
+        util::WorkStealingPool &pool,
+        std::size_t min_parallel_boxes = 1024);
+
+// Marks the boxes generated for a node as needing to be rebuilt and laid out
+// again after the style of the node has changed. Requires the parent pointers
+// of the styled nodes to be set up.
+void mark_for_relayout(LayoutBox &root, style::StyledNode const &changed);
+
+// Lays out a tree created by create_layout again at a new width, or at the
+// same width after nodes have been marked with mark_for_relayout. Only marked
+// subtrees and subtrees whose width changes are laid out again, everything
+// else is moved into place. Text has to be measured the same way as when the
+// tree was created.
+void relayout(LayoutBox &, int width, type::IType const &type = type::NaiveType{});
 
 LayoutBox const *box_at_position(LayoutBox const &, geom::Position);
 
@@ -0,0 +1,131 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "layout/layout.h"
+
+#include "css/property_id.h"
+#include "css/rule.h"
+#include "dom/dom.h"
+#include "layout/flat_layout.h"
+#include "layout/spatial_index.h"
+#include "style/style.h"
+#include "style/styled_node.h"
+#include "type/naive.h"
+#include "util/work_stealing_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+// ~56k block boxes, 6 levels deep.
+dom::Node generate_dom(int depth = 0) {
+    dom::Element element{"div"};
+    if (depth < 6) {
+        for (int i = 0; i < 6; ++i) {
+            element.children.push_back(generate_dom(depth + 1));
+        }
+    }
+    return element;
+}
+
+std::size_t count_boxes(layout::LayoutBox const &box) {
+    std::size_t count = 1;
+    for (auto const &child : box.children) {
+        count += count_boxes(child);
+    }
+    return count;
+}
+
+} // namespace
+
+// Lays out a generated document from scratch, both on one thread and on pools
+// of up to one thread per core, and then again after changing the style of one
+// of the leaves in it.
+int main() {
+    auto const dom = generate_dom();
+    std::vector<css::Rule> const stylesheet{{
+            .selectors{"div"},
+            .declarations{{css::PropertyId::Display, "block"}},
+    }};
+    auto styled = style::style_tree(dom, stylesheet);
+
+    auto time = [](auto const &fn) {
+        constexpr int kIterations = 20;
+        auto const start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kIterations; ++i) {
+            fn(i);
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+                / kIterations;
+    };
+
+    auto layout = layout::create_layout(*styled, 1000).value();
+    std::cout << count_boxes(layout) << " boxes\n";
+
+    auto const full = time([&](int) { return layout::create_layout(*styled, 1000); });
+    std::cout << "full layout: " << full << " ms\n";
+
+    for (unsigned threads = 1; threads <= std::max(1U, std::thread::hardware_concurrency()); ++threads) {
+        util::WorkStealingPool pool{threads};
+        auto const ms = time([&](int) { return layout::create_layout(*styled, 1000, type::NaiveType{}, pool); });
+        std::cout << "full layout, " << threads << " thread(s): " << ms << " ms, " << full / ms << "x\n";
+    }
+
+    // A leaf halfway through the tree, so that half of the tree comes after it
+    // and has to be moved when its height changes.
+    style::StyledNode *leaf = styled.get();
+    for (int depth = 0; depth < 6; ++depth) {
+        leaf = &leaf->children[depth == 0 ? 3 : 0];
+    }
+
+    auto change_leaf = [&](css::PropertyId property, std::string value) {
+        leaf->properties = {{css::PropertyId::Display, "block"}, {property, std::move(value)}};
+        leaf->invalidate_computed_style();
+        layout::mark_for_relayout(layout, *leaf);
+        layout::relayout(layout, 1000);
+    };
+
+    auto const same_size = time([&](int i) { change_leaf(css::PropertyId::Color, i % 2 == 0 ? "red" : "blue"); });
+    std::cout << "relayout, leaf keeps its size: " << same_size << " ms, " << full / same_size << "x\n";
+
+    auto const resized = time([&](int i) { change_leaf(css::PropertyId::Height, i % 2 == 0 ? "20px" : "10px"); });
+    std::cout << "relayout, leaf changes size: " << resized << " ms, " << full / resized << "x\n";
+
+    // Hit testing a column of positions down a long page with a lot of
+    // paragraphs in it.
+    dom::Element page{"html"};
+    for (int i = 0; i < 20'000; ++i) {
+        page.children.emplace_back(dom::Element{"p"});
+    }
+    std::vector<css::Rule> const page_stylesheet{
+            {.selectors{"html"}, .declarations{{css::PropertyId::Display, "block"}}},
+            {.selectors{"p"}, .declarations{{css::PropertyId::Display, "block"}, {css::PropertyId::Height, "20px"}}},
+    };
+    auto const page_node = dom::Node{std::move(page)};
+    auto const styled_page = style::style_tree(page_node, page_stylesheet);
+    auto const page_layout = layout::create_layout(*styled_page, 1000).value();
+    auto const flat = layout::FlatLayout::from(page_layout);
+    layout::SpatialIndex const index{flat};
+
+    auto const height = page_layout.dimensions.margin_box().height;
+    auto const walk = time([&](int i) {
+        for (int y = i; y < height; y += 1000) {
+            std::ignore = layout::box_at_position(page_layout, {500, y});
+        }
+    });
+    auto const indexed = time([&](int i) {
+        for (int y = i; y < height; y += 1000) {
+            std::ignore = index.box_at_position(flat, {500, y});
+        }
+    });
+    std::cout << "hit testing, tree walk: " << walk << " ms, spatial index: " << indexed << " ms, "
+              << walk / indexed << "x\n";
+}
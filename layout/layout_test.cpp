@@ -5,10 +5,21 @@
 
 #include "layout/layout.h"
 
+#include "css/rule.h"
 #include "etest/etest.h"
-
+#include "gfx/font.h"
+#include "style/style.h"
+#include "type/naive.h"
+#include "type/type.h"
+#include "util/work_stealing_pool.h"
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 using namespace std::literals;
 using etest::expect;
@@ -28,6 +39,24 @@ void set_up_parent_ptrs(style::StyledNode &parent) {
     }
 }
 
+class FakeFont : public type::IFont {
+public:
+    type::Size measure(std::string_view text, type::Px font_size, gfx::FontStyle) const override {
+        return {static_cast<int>(text.size()) * font_size.v * 3, font_size.v};
+    }
+};
+
+// Only knows about one font.
+class FakeType : public type::IType {
+public:
+    std::optional<std::shared_ptr<type::IFont const>> font(std::string_view name) const override {
+        if (name != "fake") {
+            return std::nullopt;
+        }
+        return std::make_shared<FakeFont>();
+    }
+};
+
 // TODO(robinlinden): Remove.
 dom::Node create_element_node(std::string_view name, dom::AttrMap attrs, std::vector<dom::Node> children) {
     return dom::Element{std::string{name}, std::move(attrs), std::move(children)};
@@ -1022,6 +1051,7 @@ int main() {
 
         auto medium_layout = layout::create_layout(style, 1000).value();
         style.properties = {{css::PropertyId::Display, "block"}, {css::PropertyId::FontSize, "xxx-large"}};
+        style.invalidate_computed_style();
         auto xxxlarge_layout = layout::create_layout(style, 1000).value();
 
         auto get_text_width = [](layout::LayoutBox const &layout) {
@@ -1167,5 +1197,190 @@ int main() {
         expect_eq(dom::nodes_by_xpath(layout, "//div"), NodeVec{&layout.children[0], &anon_block.children[1]});
     });
 
+    etest::test("text measurement", [] {
+        dom::Node dom = dom::Element{"html", {}, {dom::Text{"hello"}}};
+        auto const &children = std::get<dom::Element>(dom).children;
+        style::StyledNode styled{
+                .node = dom,
+                .properties{{css::PropertyId::Display, "block"}, {css::PropertyId::FontFamily, "missing, fake"}},
+                .children{{children[0]}},
+        };
+        set_up_parent_ptrs(styled);
+
+        auto text_width = [](layout::LayoutBox const &layout) {
+            return layout.children.at(0).children.at(0).dimensions.content.width;
+        };
+
+        // 5 characters, 10px font.
+        auto layout = layout::create_layout(styled, 100, FakeType{}).value();
+        expect_eq(text_width(layout), 5 * 10 * 3);
+        layout::relayout(layout, 50, FakeType{});
+        expect_eq(text_width(layout), 5 * 10 * 3);
+
+        // No font is available, so the width is estimated.
+        styled.properties[1].second = "missing";
+        styled.invalidate_computed_style();
+        expect_eq(text_width(layout::create_layout(styled, 100, FakeType{}).value()), 5 * 10 / 2);
+    });
+
+    etest::test("parallel layout", [] {
+        dom::Element html{"html"};
+        for (int i = 0; i < 10; ++i) {
+            dom::Element section{"section"};
+            for (int j = 0; j < i; ++j) {
+                section.children.emplace_back(dom::Element{"p", {}, {dom::Text{"hello"}, dom::Element{"span"}}});
+                section.children.emplace_back(dom::Text{std::string(j, 'a')});
+            }
+            html.children.emplace_back(std::move(section));
+        }
+        dom::Node const dom = std::move(html);
+        std::vector<css::Rule> const stylesheet{
+                {.selectors{"html", "section", "p"}, .declarations{{css::PropertyId::Display, "block"}}},
+                {.selectors{"section"},
+                        .declarations{
+                                {css::PropertyId::MarginTop, "3px"},
+                                {css::PropertyId::PaddingBottom, "7px"},
+                                {css::PropertyId::Width, "300px"},
+                        }},
+                {.selectors{"p"}, .declarations{{css::PropertyId::MinHeight, "25px"}}},
+                {.selectors{"span"}, .declarations{{css::PropertyId::PaddingLeft, "2px"}}},
+        };
+        auto const styled = style::style_tree(dom, stylesheet);
+        auto const expected = layout::create_layout(*styled, 500).value();
+
+        util::WorkStealingPool pool{4};
+        for (std::size_t min_parallel_boxes : {1, 2, 5, 20, 1000}) {
+            auto const layout = layout::create_layout(*styled, 500, type::NaiveType{}, pool, min_parallel_boxes);
+            expect_eq(layout, expected);
+        }
+
+        dom::Node const text = dom::Text{"hello"};
+        style::StyledNode const styled_text{.node = text};
+        expect_eq(layout::create_layout(styled_text, 500, type::NaiveType{}, pool, 1),
+                layout::create_layout(styled_text, 500));
+    });
+
+    etest::test("relayout", [] {
+        dom::Node p_node = dom::Element{"p"};
+        dom::Node text_node = dom::Text{"hello"};
+        dom::Node div_node = dom::Element{"div", {}, {p_node, text_node}};
+        dom::Node html_node = dom::Element{"html", {}, {div_node, p_node}};
+        style::StyledNode styled_node{
+                .node = html_node,
+                .properties{{css::PropertyId::Display, "block"}},
+                .children{
+                        style::StyledNode{
+                                .node = div_node,
+                                .properties{
+                                        {css::PropertyId::Display, "block"},
+                                        {css::PropertyId::Width, "50px"},
+                                        {css::PropertyId::MarginLeft, "auto"},
+                                        {css::PropertyId::MarginRight, "auto"},
+                                },
+                                .children{
+                                        style::StyledNode{
+                                                .node = p_node,
+                                                .properties{
+                                                        {css::PropertyId::Display, "block"},
+                                                        {css::PropertyId::Height, "10px"},
+                                                },
+                                        },
+                                        style::StyledNode{.node = text_node},
+                                },
+                        },
+                        style::StyledNode{
+                                .node = p_node,
+                                .properties{
+                                        {css::PropertyId::Display, "block"},
+                                        {css::PropertyId::PaddingLeft, "5px"},
+                                },
+                                .children{style::StyledNode{.node = text_node}},
+                        },
+                },
+        };
+        set_up_parent_ptrs(styled_node);
+
+        auto layout = layout::create_layout(styled_node, 100).value();
+        for (int width : {300, 300, 40, 60, 0, 100}) {
+            layout::relayout(layout, width);
+            expect_eq(layout, layout::create_layout(styled_node, width).value());
+        }
+    });
+
+    etest::test("mark_for_relayout", [] {
+        dom::Node p_node = dom::Element{"p"};
+        dom::Node text_node = dom::Text{"hello"};
+        dom::Node span_node = dom::Element{"span"};
+        dom::Node html_node = dom::Element{"html"};
+        style::StyledNode styled_node{
+                .node = html_node,
+                .properties{{css::PropertyId::Display, "block"}},
+                .children{
+                        style::StyledNode{
+                                .node = p_node,
+                                .properties{{css::PropertyId::Display, "block"}, {css::PropertyId::Height, "10px"}},
+                        },
+                        style::StyledNode{.node = text_node},
+                        style::StyledNode{
+                                .node = span_node,
+                                .properties{{css::PropertyId::Display, "inline"}},
+                                .children{style::StyledNode{.node = text_node}},
+                        },
+                        style::StyledNode{
+                                .node = p_node,
+                                .properties{{css::PropertyId::Display, "block"}},
+                                .children{style::StyledNode{.node = text_node}},
+                        },
+                },
+        };
+        set_up_parent_ptrs(styled_node);
+
+        auto layout = layout::create_layout(styled_node, 100).value();
+        auto &first_p = styled_node.children[0];
+        auto &span = styled_node.children[2];
+
+        auto change = [&](style::StyledNode &node, css::PropertyId property, std::string value) {
+            std::erase_if(node.properties, [&](auto const &p) { return p.first == property; });
+            node.properties.emplace_back(property, std::move(value));
+            node.invalidate_computed_style();
+            layout::mark_for_relayout(layout, node);
+        };
+
+        change(first_p, css::PropertyId::Height, "30px");
+        expect(layout.has_dirty_descendants);
+        expect(layout.children[0].needs_layout);
+        expect(!layout.children[1].needs_layout);
+        layout::relayout(layout, 100);
+        expect_eq(layout, layout::create_layout(styled_node, 100).value());
+
+        change(span, css::PropertyId::FontSize, "30px");
+        expect(layout.children[1].has_dirty_descendants);
+        layout::relayout(layout, 100);
+        expect_eq(layout, layout::create_layout(styled_node, 100).value());
+
+        // Changing the type of box a node generates rebuilds the parent box.
+        change(span, css::PropertyId::Display, "block");
+        expect(layout.needs_layout);
+        layout::relayout(layout, 100);
+        expect_eq(layout, layout::create_layout(styled_node, 100).value());
+
+        change(first_p, css::PropertyId::Display, "none");
+        layout::relayout(layout, 100);
+        expect_eq(layout, layout::create_layout(styled_node, 100).value());
+
+        change(first_p, css::PropertyId::Display, "block");
+        layout::relayout(layout, 100);
+        expect_eq(layout, layout::create_layout(styled_node, 100).value());
+
+        // Nodes whose parents don't generate boxes don't need layout.
+        change(first_p, css::PropertyId::Display, "none");
+        layout::relayout(layout, 100);
+        auto expected = layout;
+        change(first_p.children.emplace_back(style::StyledNode{.node = text_node, .parent = &first_p}),
+                css::PropertyId::FontSize,
+                "5px");
+        expect_eq(layout, expected);
+    });
+
     return etest::run_all_tests();
 }
@@ -0,0 +1,179 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "layout/spatial_index.h"
+
+#include "layout/flat_layout.h"
+#include "layout/layout.h"
+
+#include "geom/geom.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace layout {
+namespace {
+
+// Cells are made larger on huge pages to keep the grid from growing without bound.
+constexpr std::size_t kMaxCells = std::size_t{1} << 16;
+
+// Like geom::Rect::contains, the edges are part of the rectangles.
+bool overlaps(geom::Rect const &a, geom::Rect const &b) {
+    return a.left() <= b.right() && b.left() <= a.right() && a.top() <= b.bottom() && b.top() <= a.bottom();
+}
+
+} // namespace
+
+SpatialIndex::SpatialIndex(FlatLayout const &layout, int cell_size) : cell_size_{cell_size} {
+    assert(cell_size > 0);
+    border_boxes_.reserve(layout.size());
+    for (FlatLayout::Index box = 0; box < layout.size(); ++box) {
+        border_boxes_.push_back(layout.dimensions(box).border_box());
+    }
+
+    if (border_boxes_.empty()) {
+        return;
+    }
+
+    auto left = border_boxes_[0].left();
+    auto right = border_boxes_[0].right();
+    auto top = border_boxes_[0].top();
+    auto bottom = border_boxes_[0].bottom();
+    for (auto const &border_box : border_boxes_) {
+        left = std::min(left, border_box.left());
+        right = std::max(right, border_box.right());
+        top = std::min(top, border_box.top());
+        bottom = std::max(bottom, border_box.bottom());
+    }
+
+    bounds_ = {left, top, right - left, bottom - top};
+    auto cell_count = [&] {
+        return static_cast<std::size_t>(bounds_.width / cell_size_ + 1)
+                * static_cast<std::size_t>(bounds_.height / cell_size_ + 1);
+    };
+    while (cell_count() > kMaxCells) {
+        cell_size_ *= 2;
+    }
+
+    columns_ = bounds_.width / cell_size_ + 1;
+    rows_ = bounds_.height / cell_size_ + 1;
+
+    // Count the boxes in each cell first so that all of them fit in one array.
+    cell_starts_.assign(static_cast<std::size_t>(columns_) * static_cast<std::size_t>(rows_) + 1, 0);
+    for (auto const &border_box : border_boxes_) {
+        auto range = cells_overlapping(border_box).value();
+        for (int row = range.first_row; row <= range.last_row; ++row) {
+            for (int column = range.first_column; column <= range.last_column; ++column) {
+                cell_starts_[cell(column, row) + 1] += 1;
+            }
+        }
+    }
+
+    for (std::size_t i = 1; i < cell_starts_.size(); ++i) {
+        cell_starts_[i] += cell_starts_[i - 1];
+    }
+
+    auto next = cell_starts_;
+    cell_boxes_.resize(cell_starts_.back());
+    for (FlatLayout::Index box = 0; box < border_boxes_.size(); ++box) {
+        auto range = cells_overlapping(border_boxes_[box]).value();
+        for (int row = range.first_row; row <= range.last_row; ++row) {
+            for (int column = range.first_column; column <= range.last_column; ++column) {
+                cell_boxes_[next[cell(column, row)]++] = box;
+            }
+        }
+    }
+}
+
+std::optional<SpatialIndex::CellRange> SpatialIndex::cells_overlapping(geom::Rect const &area) const {
+    if (columns_ == 0 || !overlaps(area, bounds_)) {
+        return std::nullopt;
+    }
+
+    auto to_column = [&](int x) { return std::clamp((x - bounds_.left()) / cell_size_, 0, columns_ - 1); };
+    auto to_row = [&](int y) { return std::clamp((y - bounds_.top()) / cell_size_, 0, rows_ - 1); };
+    return CellRange{
+            .first_column = to_column(std::max(area.left(), bounds_.left())),
+            .last_column = to_column(area.right()),
+            .first_row = to_row(std::max(area.top(), bounds_.top())),
+            .last_row = to_row(area.bottom()),
+    };
+}
+
+std::size_t SpatialIndex::cell(int column, int row) const {
+    return static_cast<std::size_t>(row) * static_cast<std::size_t>(columns_) + static_cast<std::size_t>(column);
+}
+
+std::optional<FlatLayout::Index> SpatialIndex::box_at_position(FlatLayout const &layout, geom::Position p) const {
+    assert(layout.size() == border_boxes_.size());
+    auto range = cells_overlapping({p.x, p.y, 0, 0});
+    if (!range) {
+        return std::nullopt;
+    }
+
+    // The cell holds every box that could contain the position, in
+    // pre-order. Walk them like box_at_position walks the tree, but only
+    // descend into boxes whose parents were descended into.
+    auto const c = cell(range->first_column, range->first_row);
+    std::optional<FlatLayout::Index> found;
+    auto end = layout.size();
+    std::vector<FlatLayout::Index> path;
+    for (auto i = cell_starts_[c]; i < cell_starts_[c + 1]; ++i) {
+        auto const box = cell_boxes_[i];
+        if (box >= end) {
+            break;
+        }
+
+        if (!border_boxes_[box].contains(p)) {
+            continue;
+        }
+
+        while (!path.empty() && layout.subtree_end(path.back()) <= box) {
+            path.pop_back();
+        }
+
+        if (box != 0 && (path.empty() || path.back() != layout.parent(box))) {
+            continue;
+        }
+
+        path.push_back(box);
+        if (layout.type(box) != LayoutType::AnonymousBlock) {
+            found = box;
+            end = layout.subtree_end(box);
+        }
+    }
+
+    return found;
+}
+
+std::vector<FlatLayout::Index> SpatialIndex::boxes_in(FlatLayout const &layout, geom::Rect const &area) const {
+    assert(layout.size() == border_boxes_.size());
+    auto range = cells_overlapping(area);
+    if (!range) {
+        return {};
+    }
+
+    std::vector<FlatLayout::Index> boxes;
+    for (int row = range->first_row; row <= range->last_row; ++row) {
+        for (int column = range->first_column; column <= range->last_column; ++column) {
+            auto const c = cell(column, row);
+            for (auto i = cell_starts_[c]; i < cell_starts_[c + 1]; ++i) {
+                if (overlaps(border_boxes_[cell_boxes_[i]], area)) {
+                    boxes.push_back(cell_boxes_[i]);
+                }
+            }
+        }
+    }
+
+    // Boxes larger than a cell are in more than one of them.
+    std::ranges::sort(boxes);
+    auto [first, last] = std::ranges::unique(boxes);
+    boxes.erase(first, last);
+    return boxes;
+}
+
+} // namespace layout
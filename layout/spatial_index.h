@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef LAYOUT_SPATIAL_INDEX_H_
+#define LAYOUT_SPATIAL_INDEX_H_
+
+#include "layout/flat_layout.h"
+
+#include "geom/geom.h"
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace layout {
+
+// A uniform grid over the border boxes of a FlatLayout, used for finding the
+// boxes at a position or in an area without walking the entire tree.
+//
+// The index doesn't keep a reference to the layout it was built from, but
+// every query has to be given that same layout.
+class SpatialIndex {
+public:
+    static constexpr int kDefaultCellSize = 128;
+
+    explicit SpatialIndex(FlatLayout const &, int cell_size = kDefaultCellSize);
+
+    // Same result as box_at_position(FlatLayout const &, geom::Position).
+    [[nodiscard]] std::optional<FlatLayout::Index> box_at_position(FlatLayout const &, geom::Position) const;
+
+    // All boxes whose border boxes overlap the area, in pre-order.
+    [[nodiscard]] std::vector<FlatLayout::Index> boxes_in(FlatLayout const &, geom::Rect const &area) const;
+
+private:
+    struct CellRange {
+        int first_column{};
+        int last_column{};
+        int first_row{};
+        int last_row{};
+    };
+
+    [[nodiscard]] std::optional<CellRange> cells_overlapping(geom::Rect const &) const;
+    [[nodiscard]] std::size_t cell(int column, int row) const;
+
+    geom::Rect bounds_{};
+    int cell_size_{};
+    int columns_{};
+    int rows_{};
+
+    // The boxes in cell n are cell_boxes_[cell_starts_[n]] up to
+    // cell_boxes_[cell_starts_[n + 1]], in pre-order.
+    std::vector<std::size_t> cell_starts_;
+    std::vector<FlatLayout::Index> cell_boxes_;
+    std::vector<geom::Rect> border_boxes_;
+};
+
+} // namespace layout
+
+#endif
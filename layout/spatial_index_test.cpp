@@ -0,0 +1,104 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "layout/spatial_index.h"
+
+#include "layout/flat_layout.h"
+#include "layout/layout.h"
+
+#include "etest/etest.h"
+#include "geom/geom.h"
+
+#include <optional>
+#include <vector>
+
+using etest::expect;
+using etest::expect_eq;
+using layout::FlatLayout;
+using layout::LayoutType;
+using layout::SpatialIndex;
+
+namespace {
+
+layout::LayoutBox test_layout() {
+    return layout::LayoutBox{
+            .node = nullptr,
+            .type = LayoutType::Block,
+            .dimensions = {{0, 0, 100, 300}},
+            .children{
+                    {nullptr, LayoutType::Block, {{25, 25, 50, 50}, {}, {2, 2, 2, 2}}, {
+                        {nullptr, LayoutType::AnonymousBlock, {{30, 30, 5, 5}}, {}},
+                        {nullptr, LayoutType::Block, {{45, 45, 5, 5}}, {}},
+                    }},
+                    {nullptr, LayoutType::AnonymousBlock, {{60, 60, 10, 10}}, {
+                        {nullptr, LayoutType::Inline, {{69, 69, 5, 5}}, {}},
+                    }},
+                    {nullptr, LayoutType::Block, {{65, 65, 10, 10}}, {}},
+                    // Overflowing its parent, so it can't be hovered outside of it.
+                    {nullptr, LayoutType::Block, {{10, 200, 10, 10}}, {
+                        {nullptr, LayoutType::Block, {{0, 150, 150, 150}}, {}},
+                    }},
+            },
+    };
+}
+
+} // namespace
+
+int main() {
+    etest::test("box_at_position", [] {
+        auto const flat = FlatLayout::from(test_layout());
+        for (int cell_size : {1, 7, 64, SpatialIndex::kDefaultCellSize}) {
+            SpatialIndex const index{flat, cell_size};
+            for (int y = -5; y <= 305; ++y) {
+                for (int x = -5; x <= 155; ++x) {
+                    expect_eq(index.box_at_position(flat, {x, y}), box_at_position(flat, {x, y}));
+                }
+            }
+        }
+    });
+
+    etest::test("boxes_in", [] {
+        auto const flat = FlatLayout::from(test_layout());
+        SpatialIndex const index{flat, 16};
+
+        auto brute_force = [&](geom::Rect const &area) {
+            std::vector<FlatLayout::Index> boxes;
+            for (FlatLayout::Index box = 0; box < flat.size(); ++box) {
+                auto border_box = flat.dimensions(box).border_box();
+                if (border_box.left() <= area.right() && area.left() <= border_box.right()
+                        && border_box.top() <= area.bottom() && area.top() <= border_box.bottom()) {
+                    boxes.push_back(box);
+                }
+            }
+            return boxes;
+        };
+
+        for (auto const &area : {geom::Rect{0, 0, 10, 10},
+                     geom::Rect{-10, -10, 5, 5},
+                     geom::Rect{40, 40, 10, 10},
+                     geom::Rect{0, 100, 200, 100},
+                     geom::Rect{140, 290, 100, 100},
+                     geom::Rect{-50, -50, 500, 500}}) {
+            expect_eq(index.boxes_in(flat, area), brute_force(area));
+        }
+
+        expect(index.boxes_in(flat, {1000, 1000, 10, 10}).empty());
+    });
+
+    etest::test("huge layouts get larger cells", [] {
+        auto const flat = FlatLayout::from(layout::LayoutBox{
+                .node = nullptr,
+                .type = LayoutType::Block,
+                .dimensions = {{0, 0, 1'000'000, 1'000'000}},
+                .children{{nullptr, LayoutType::Block, {{500'000, 500'000, 10, 10}}, {}}},
+        });
+        SpatialIndex const index{flat, 1};
+
+        expect_eq(index.box_at_position(flat, {500'005, 500'005}), std::optional<FlatLayout::Index>{1});
+        expect_eq(index.box_at_position(flat, {5, 5}), std::optional<FlatLayout::Index>{0});
+        expect_eq(index.boxes_in(flat, {0, 0, 10, 10}), std::vector<FlatLayout::Index>{0});
+    });
+
+    return etest::run_all_tests();
+}
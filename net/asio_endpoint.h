@@ -0,0 +1,46 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef NET_ASIO_ENDPOINT_H_
+#define NET_ASIO_ENDPOINT_H_
+
+#include "net/dns_cache.h"
+
+#include <asio.hpp>
+
+#include <vector>
+
+namespace net {
+
+// Conversions between our endpoints and asio's. Only for use in the
+// implementation of the sockets, as asio isn't part of their interfaces.
+
+inline std::vector<Endpoint> from_asio(asio::ip::tcp::resolver::results_type const &results) {
+    std::vector<Endpoint> endpoints;
+    endpoints.reserve(results.size());
+    for (auto const &result : results) {
+        auto const &endpoint = result.endpoint();
+        endpoints.push_back({endpoint.address().to_string(), endpoint.port()});
+    }
+
+    return endpoints;
+}
+
+inline std::vector<asio::ip::tcp::endpoint> to_asio(std::vector<Endpoint> const &endpoints) {
+    std::vector<asio::ip::tcp::endpoint> result;
+    result.reserve(endpoints.size());
+    for (auto const &endpoint : endpoints) {
+        asio::error_code ec;
+        auto address = asio::ip::make_address(endpoint.address, ec);
+        if (!ec) {
+            result.emplace_back(address, endpoint.port);
+        }
+    }
+
+    return result;
+}
+
+} // namespace net
+
+#endif
@@ -0,0 +1,266 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "net/async_socket.h"
+
+#include "net/asio_endpoint.h"
+#include "net/dns_cache.h"
+
+#include <asio.hpp>
+#include <asio/ssl.hpp>
+#include <openssl/ssl.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace net {
+namespace {
+
+class BaseAsyncSocketImpl;
+
+// The sockets of a loop, so that their operations can be cancelled when the
+// loop is destroyed.
+class SocketRegistry {
+public:
+    void add(BaseAsyncSocketImpl *socket) {
+        std::scoped_lock lock{mtx_};
+        sockets_.insert(socket);
+    }
+
+    void remove(BaseAsyncSocketImpl *socket) {
+        std::scoped_lock lock{mtx_};
+        sockets_.erase(socket);
+    }
+
+    [[nodiscard]] bool stopping() const {
+        std::scoped_lock lock{mtx_};
+        return stopping_;
+    }
+
+    // Closes every socket, and any sockets created after this refuse to connect.
+    void close_all();
+
+private:
+    mutable std::mutex mtx_;
+    bool stopping_{false};
+    std::set<BaseAsyncSocketImpl *> sockets_;
+};
+
+class BaseAsyncSocketImpl {
+public:
+    explicit BaseAsyncSocketImpl(SocketRegistry &registry) : registry_{registry} { registry_.add(this); }
+    // Derived classes remove themselves from the registry in their destructors
+    // so that they aren't closed while they're being destroyed.
+    virtual ~BaseAsyncSocketImpl() = default;
+
+    BaseAsyncSocketImpl(BaseAsyncSocketImpl const &) = delete;
+    BaseAsyncSocketImpl &operator=(BaseAsyncSocketImpl const &) = delete;
+
+    // Cancels everything in flight, failing it.
+    virtual void close() = 0;
+
+    void connect(asio::ip::tcp::resolver &resolver,
+            asio::ip::tcp::socket &socket,
+            std::string_view host,
+            std::string_view service,
+            ConnectCallback on_connected) {
+        if (registry_.stopping()) {
+            asio::post(socket.get_executor(), [on_connected = std::move(on_connected)] { on_connected(false); });
+            return;
+        }
+
+        // Sockets connecting to the same host at the same time share a lookup.
+        system_dns_cache().resolve_async(
+                host,
+                service,
+                [&resolver](std::string_view h, std::string_view s, ResolveCallback on_resolved) {
+                    resolver.async_resolve(h,
+                            s,
+                            [on_resolved = std::move(on_resolved)](
+                                    asio::error_code const &ec, asio::ip::tcp::resolver::results_type const &results) {
+                                on_resolved(ec ? std::vector<Endpoint>{} : from_asio(results));
+                            });
+                },
+                [&socket, on_connected = std::move(on_connected)](std::vector<Endpoint> endpoints) {
+                    connect_to(socket, endpoints, on_connected);
+                });
+    }
+
+    static void connect_to(
+            asio::ip::tcp::socket &socket, std::vector<Endpoint> const &endpoints, ConnectCallback on_connected) {
+        auto asio_endpoints = to_asio(endpoints);
+        if (asio_endpoints.empty()) {
+            on_connected(false);
+            return;
+        }
+
+        asio::async_connect(socket,
+                asio_endpoints,
+                [on_connected = std::move(on_connected)](
+                        asio::error_code const &ec, asio::ip::tcp::endpoint const &) { on_connected(!ec); });
+    }
+
+    void write(auto &socket, std::string data, WriteCallback on_written) {
+        // The data has to stay alive until the write is done.
+        write_buffer = std::move(data);
+        asio::async_write(socket,
+                asio::buffer(write_buffer),
+                [on_written = std::move(on_written)](asio::error_code const &ec, std::size_t) { on_written(!ec); });
+    }
+
+    void read_some(auto &socket, std::size_t max_bytes, ReadCallback on_read) {
+        read_buffer.resize(std::max<std::size_t>(max_bytes, 1));
+        socket.async_read_some(asio::buffer(read_buffer),
+                [this, on_read = std::move(on_read)](asio::error_code const &, std::size_t bytes) {
+                    on_read(std::string_view{read_buffer}.substr(0, bytes));
+                });
+    }
+
+protected:
+    SocketRegistry &registry_;
+
+private:
+    std::string write_buffer{};
+    std::string read_buffer{};
+};
+
+void SocketRegistry::close_all() {
+    std::scoped_lock lock{mtx_};
+    stopping_ = true;
+    for (auto *socket : sockets_) {
+        socket->close();
+    }
+}
+
+} // namespace
+
+struct EventLoop::Impl {
+    asio::io_context io_ctx{};
+    // Keeps the threads waiting for work while there's nothing to do.
+    asio::executor_work_guard<asio::io_context::executor_type> work{asio::make_work_guard(io_ctx)};
+    std::vector<std::thread> threads{};
+    SocketRegistry sockets{};
+};
+
+EventLoop::EventLoop(std::size_t thread_count) : impl_(std::make_unique<Impl>()) {
+    thread_count = std::max<std::size_t>(thread_count, 1);
+    impl_->threads.reserve(thread_count);
+    for (std::size_t i = 0; i < thread_count; ++i) {
+        impl_->threads.emplace_back([&io_ctx = impl_->io_ctx] { io_ctx.run(); });
+    }
+}
+
+EventLoop::~EventLoop() {
+    impl_->work.reset();
+    impl_->io_ctx.stop();
+    for (auto &thread : impl_->threads) {
+        thread.join();
+    }
+
+    // With no handlers running, the sockets can be closed from here. This
+    // fails whatever they were doing, and running the loop one last time
+    // calls everyone back with that.
+    impl_->sockets.close_all();
+    impl_->io_ctx.restart();
+    impl_->io_ctx.run();
+}
+
+std::size_t EventLoop::thread_count() const {
+    return impl_->threads.size();
+}
+
+struct AsyncSocket::Impl : public BaseAsyncSocketImpl {
+    Impl(asio::io_context &io_ctx, SocketRegistry &registry)
+        : BaseAsyncSocketImpl{registry}, resolver{io_ctx}, socket{io_ctx} {}
+    ~Impl() override { registry_.remove(this); }
+
+    void close() override {
+        resolver.cancel();
+        asio::error_code ec;
+        socket.close(ec);
+    }
+
+    asio::ip::tcp::resolver resolver;
+    asio::ip::tcp::socket socket;
+};
+
+AsyncSocket::AsyncSocket(EventLoop &loop)
+    : impl_(std::make_unique<Impl>(loop.impl_->io_ctx, loop.impl_->sockets)) {}
+AsyncSocket::~AsyncSocket() = default;
+AsyncSocket::AsyncSocket(AsyncSocket &&) noexcept = default;
+AsyncSocket &AsyncSocket::operator=(AsyncSocket &&) noexcept = default;
+
+void AsyncSocket::connect(std::string_view host, std::string_view service, ConnectCallback on_connected) {
+    impl_->connect(impl_->resolver, impl_->socket, host, service, std::move(on_connected));
+}
+
+void AsyncSocket::write(std::string data, WriteCallback on_written) {
+    impl_->write(impl_->socket, std::move(data), std::move(on_written));
+}
+
+void AsyncSocket::read_some(std::size_t max_bytes, ReadCallback on_read) {
+    impl_->read_some(impl_->socket, max_bytes, std::move(on_read));
+}
+
+struct AsyncSecureSocket::Impl : public BaseAsyncSocketImpl {
+    Impl(asio::io_context &io_ctx, SocketRegistry &registry)
+        : BaseAsyncSocketImpl{registry}, resolver{io_ctx}, socket{io_ctx, ctx} {}
+    ~Impl() override { registry_.remove(this); }
+
+    void close() override {
+        resolver.cancel();
+        asio::error_code ec;
+        socket.lowest_layer().close(ec);
+    }
+
+    void connect(std::string_view host, std::string_view service, ConnectCallback on_connected) {
+        BaseAsyncSocketImpl::connect(resolver,
+                socket.next_layer(),
+                host,
+                service,
+                [this, null_terminated_host = std::string{host}, on_connected = std::move(on_connected)](
+                        bool connected) {
+                    if (!connected) {
+                        on_connected(false);
+                        return;
+                    }
+
+                    // Set SNI hostname. Many hosts reject the handshake if this isn't done.
+                    SSL_set_tlsext_host_name(socket.native_handle(), null_terminated_host.c_str());
+                    socket.async_handshake(asio::ssl::stream_base::handshake_type::client,
+                            [on_connected](asio::error_code const &ec) { on_connected(!ec); });
+                });
+    }
+
+    asio::ip::tcp::resolver resolver;
+    asio::ssl::context ctx{asio::ssl::context::method::sslv23_client};
+    asio::ssl::stream<asio::ip::tcp::socket> socket;
+};
+
+AsyncSecureSocket::AsyncSecureSocket(EventLoop &loop)
+    : impl_(std::make_unique<Impl>(loop.impl_->io_ctx, loop.impl_->sockets)) {}
+AsyncSecureSocket::~AsyncSecureSocket() = default;
+AsyncSecureSocket::AsyncSecureSocket(AsyncSecureSocket &&) noexcept = default;
+AsyncSecureSocket &AsyncSecureSocket::operator=(AsyncSecureSocket &&) noexcept = default;
+
+void AsyncSecureSocket::connect(std::string_view host, std::string_view service, ConnectCallback on_connected) {
+    impl_->connect(host, service, std::move(on_connected));
+}
+
+void AsyncSecureSocket::write(std::string data, WriteCallback on_written) {
+    impl_->write(impl_->socket, std::move(data), std::move(on_written));
+}
+
+void AsyncSecureSocket::read_some(std::size_t max_bytes, ReadCallback on_read) {
+    impl_->read_some(impl_->socket, max_bytes, std::move(on_read));
+}
+
+} // namespace net
@@ -0,0 +1,87 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef NET_ASYNC_SOCKET_H_
+#define NET_ASYNC_SOCKET_H_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace net {
+
+// A few threads running the operations of every asynchronous socket created
+// with the loop, so that waiting on any number of connections doesn't take a
+// thread each.
+class EventLoop {
+public:
+    explicit EventLoop(std::size_t thread_count = 1);
+    // Operations that are still in flight are cancelled, and their callbacks
+    // are called with the failure on this thread before this returns. Must
+    // not be called from one of the loop's threads, and the loop's sockets
+    // must not outlive it.
+    ~EventLoop();
+
+    EventLoop(EventLoop const &) = delete;
+    EventLoop &operator=(EventLoop const &) = delete;
+
+    [[nodiscard]] std::size_t thread_count() const;
+
+private:
+    friend class AsyncSocket;
+    friend class AsyncSecureSocket;
+
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// The callbacks are called from one of the event loop's threads. Only one
+// read and one write may be in flight at a time, and the socket must outlive
+// them.
+using ConnectCallback = std::function<void(bool connected)>;
+using WriteCallback = std::function<void(bool written)>;
+// Called with the data that was read, which is only valid during the call.
+// Empty on EOF or error.
+using ReadCallback = std::function<void(std::string_view data)>;
+
+class AsyncSocket {
+public:
+    explicit AsyncSocket(EventLoop &);
+    ~AsyncSocket();
+
+    AsyncSocket(AsyncSocket &&) noexcept;
+    AsyncSocket &operator=(AsyncSocket &&) noexcept;
+
+    void connect(std::string_view host, std::string_view service, ConnectCallback on_connected);
+    void write(std::string data, WriteCallback on_written);
+    // Reads at most max_bytes bytes once some data is available.
+    void read_some(std::size_t max_bytes, ReadCallback on_read);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+class AsyncSecureSocket {
+public:
+    explicit AsyncSecureSocket(EventLoop &);
+    ~AsyncSecureSocket();
+
+    AsyncSecureSocket(AsyncSecureSocket &&) noexcept;
+    AsyncSecureSocket &operator=(AsyncSecureSocket &&) noexcept;
+
+    void connect(std::string_view host, std::string_view service, ConnectCallback on_connected);
+    void write(std::string data, WriteCallback on_written);
+    void read_some(std::size_t max_bytes, ReadCallback on_read);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace net
+
+#endif
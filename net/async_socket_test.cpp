@@ -0,0 +1,194 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "net/async_socket.h"
+
+#include "net/dns_cache.h"
+
+#include "etest/etest.h"
+
+#include <asio.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using etest::expect;
+using etest::expect_eq;
+using etest::require;
+
+namespace {
+
+// Accepts `connections` connections, and answers each with the response once
+// it's received a line from it.
+[[nodiscard]] std::uint16_t start_server(std::string response, std::size_t connections = 1) {
+    std::promise<std::uint16_t> port_promise;
+    auto port_future = port_promise.get_future();
+
+    std::thread{[payload = std::move(response), connections, port = std::move(port_promise)]() mutable {
+        asio::io_context io_context;
+        constexpr int kAnyPort = 0;
+        asio::ip::tcp::acceptor a{io_context, asio::ip::tcp::endpoint{asio::ip::address_v4::loopback(), kAnyPort}};
+        port.set_value(a.local_endpoint().port());
+
+        // All connections are accepted before answering any of them so that
+        // they're all open at the same time.
+        std::vector<asio::ip::tcp::socket> socks;
+        for (std::size_t i = 0; i < connections; ++i) {
+            socks.push_back(a.accept());
+        }
+
+        for (auto &sock : socks) {
+            // The client may hang up without sending anything.
+            std::string request;
+            asio::error_code ec;
+            asio::read_until(sock, asio::dynamic_buffer(request), "\n", ec);
+            if (!ec) {
+                asio::write(sock, asio::buffer(payload, payload.size()), ec);
+            }
+        }
+    }}.detach();
+
+    return port_future.get();
+}
+
+// Connects, sends a line, and reads until the server closes the connection.
+class Exchange {
+public:
+    Exchange(net::EventLoop &loop, std::uint16_t port) : socket_{loop} {
+        socket_.connect("localhost", std::to_string(port), [this](bool connected) {
+            if (!connected) {
+                done_.set_value();
+                return;
+            }
+
+            socket_.write("hello\n", [this](bool written) {
+                if (!written) {
+                    done_.set_value();
+                    return;
+                }
+
+                read();
+            });
+        });
+    }
+
+    std::string get() {
+        done_.get_future().get();
+        return std::move(received_);
+    }
+
+private:
+    void read() {
+        socket_.read_some(2, [this](std::string_view data) {
+            if (data.empty()) {
+                done_.set_value();
+                return;
+            }
+
+            received_ += data;
+            read();
+        });
+    }
+
+    net::AsyncSocket socket_;
+    std::string received_;
+    std::promise<void> done_;
+};
+
+} // namespace
+
+int main() {
+    etest::test("AsyncSocket, connect, write, and read", [] {
+        auto port = start_server("hello back!");
+        net::EventLoop loop;
+        Exchange exchange{loop, port};
+        expect_eq(exchange.get(), "hello back!");
+    });
+
+    etest::test("AsyncSocket, connection refused", [] {
+        net::EventLoop loop;
+        net::AsyncSocket socket{loop};
+        std::promise<bool> connected;
+        socket.connect("localhost", "0", [&](bool ok) { connected.set_value(ok); });
+        expect(!connected.get_future().get());
+    });
+
+    etest::test("AsyncSocket, many connections on one thread", [] {
+        constexpr std::size_t kConnections = 16;
+        auto port = start_server("response", kConnections);
+        net::EventLoop loop{1};
+        expect_eq(loop.thread_count(), std::size_t{1});
+
+        // The server doesn't answer anyone until everyone's connected, so this
+        // only finishes if the one thread can wait on all connections at once.
+        std::vector<std::unique_ptr<Exchange>> exchanges;
+        for (std::size_t i = 0; i < kConnections; ++i) {
+            exchanges.push_back(std::make_unique<Exchange>(loop, port));
+        }
+
+        for (auto &exchange : exchanges) {
+            expect_eq(exchange->get(), "response");
+        }
+    });
+
+    etest::test("EventLoop, destroyed with a read in flight", [] {
+        // The server never answers, as it waits for a line that's never sent.
+        auto port = start_server("response");
+        auto loop = std::make_unique<net::EventLoop>();
+        std::promise<void> connected;
+        std::promise<std::string> read;
+
+        // The socket is kept alive by its own callbacks, like requests keep
+        // their connections alive.
+        auto socket = std::make_shared<net::AsyncSocket>(*loop);
+        socket->connect("localhost", std::to_string(port), [&, socket](bool ok) {
+            connected.set_value();
+            if (!ok) {
+                read.set_value("not connected");
+                return;
+            }
+
+            socket->read_some(10, [&, socket](std::string_view data) { read.set_value(std::string{data}); });
+        });
+        socket.reset();
+        connected.get_future().wait();
+
+        auto result = read.get_future();
+        loop.reset();
+        require(result.wait_for(std::chrono::seconds{0}) == std::future_status::ready);
+        expect_eq(result.get(), "");
+    });
+
+    etest::test("AsyncSocket, concurrent connects to one host share a lookup", [] {
+        constexpr std::size_t kConnections = 8;
+        auto port = start_server("response", kConnections);
+        net::EventLoop loop{4};
+        auto const before = net::system_dns_cache().stats();
+
+        std::vector<std::unique_ptr<Exchange>> exchanges;
+        for (std::size_t i = 0; i < kConnections; ++i) {
+            exchanges.push_back(std::make_unique<Exchange>(loop, port));
+        }
+
+        for (auto &exchange : exchanges) {
+            expect_eq(exchange->get(), "response");
+        }
+
+        // Depending on timing, the others either joined the first lookup or
+        // found its result in the cache.
+        auto const after = net::system_dns_cache().stats();
+        expect_eq(after.misses - before.misses, std::size_t{1});
+        expect_eq((after.hits + after.coalesced) - (before.hits + before.coalesced), kConnections - 1);
+    });
+
+    return etest::run_all_tests();
+}
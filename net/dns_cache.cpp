@@ -0,0 +1,182 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "net/dns_cache.h"
+
+#include "net/asio_endpoint.h"
+
+#include "util/string.h"
+
+#include <asio.hpp>
+
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace net {
+
+DnsCache::DnsCache(Resolver resolver, DnsCacheOptions opts)
+    : resolver_{std::move(resolver)}, opts_{std::move(opts)}, entries_{opts_.max_entries} {}
+
+std::vector<Endpoint> DnsCache::resolve(std::string_view host, std::string_view service) {
+    auto k = key(host, service);
+    auto in_flight = std::make_shared<InFlight>();
+    {
+        std::unique_lock lock{mtx_};
+        if (auto *entry = entries_.get(k)) {
+            if (entry->in_flight) {
+                stats_.coalesced += 1;
+                auto result = entry->in_flight->result;
+                lock.unlock();
+                return result.get();
+            }
+
+            if (Clock::now() < entry->expires_at) {
+                (entry->endpoints.empty() ? stats_.negative_hits : stats_.hits) += 1;
+                return entry->endpoints;
+            }
+        }
+
+        stats_.misses += 1;
+        entries_.put(k, Entry{.in_flight = in_flight});
+    }
+
+    std::vector<Endpoint> endpoints;
+    try {
+        endpoints = resolver_(host, service);
+    } catch (...) {
+        fail(k, *in_flight, std::current_exception());
+        throw;
+    }
+
+    finish(k, *in_flight, endpoints);
+    return endpoints;
+}
+
+void DnsCache::resolve_async(std::string_view host,
+        std::string_view service,
+        AsyncResolver const &start_resolve,
+        ResolveCallback on_resolved) {
+    auto k = key(host, service);
+    auto in_flight = std::make_shared<InFlight>();
+    {
+        std::unique_lock lock{mtx_};
+        if (auto *entry = entries_.get(k)) {
+            if (entry->in_flight) {
+                stats_.coalesced += 1;
+                entry->in_flight->waiters.push_back(std::move(on_resolved));
+                return;
+            }
+
+            if (Clock::now() < entry->expires_at) {
+                (entry->endpoints.empty() ? stats_.negative_hits : stats_.hits) += 1;
+                auto endpoints = entry->endpoints;
+                lock.unlock();
+                on_resolved(std::move(endpoints));
+                return;
+            }
+        }
+
+        stats_.misses += 1;
+        in_flight->waiters.push_back(std::move(on_resolved));
+        entries_.put(k, Entry{.in_flight = in_flight});
+    }
+
+    start_resolve(host, service, [this, k = std::move(k), in_flight](std::vector<Endpoint> endpoints) {
+        finish(k, *in_flight, std::move(endpoints));
+    });
+}
+
+std::optional<std::vector<Endpoint>> DnsCache::find(std::string_view host, std::string_view service) {
+    std::scoped_lock lock{mtx_};
+    auto const *entry = entries_.get(key(host, service));
+    if (entry == nullptr || entry->in_flight || Clock::now() >= entry->expires_at) {
+        return std::nullopt;
+    }
+
+    return entry->endpoints;
+}
+
+void DnsCache::insert(std::string_view host, std::string_view service, std::vector<Endpoint> endpoints) {
+    store(key(host, service), std::move(endpoints));
+}
+
+DnsCacheStats DnsCache::stats() const {
+    std::scoped_lock lock{mtx_};
+    return stats_;
+}
+
+void DnsCache::clear() {
+    std::scoped_lock lock{mtx_};
+    entries_.clear();
+}
+
+std::string DnsCache::key(std::string_view host, std::string_view service) {
+    // Host names are case-insensitive.
+    return util::lowercased(std::string{host}) + ':' + std::string{service};
+}
+
+void DnsCache::store(std::string k, std::vector<Endpoint> endpoints) {
+    std::scoped_lock lock{mtx_};
+    auto const ttl = endpoints.empty() ? opts_.negative_ttl : opts_.ttl;
+    entries_.put(std::move(k), Entry{.endpoints = std::move(endpoints), .expires_at = Clock::now() + ttl});
+}
+
+void DnsCache::finish(std::string const &k, InFlight &in_flight, std::vector<Endpoint> endpoints) {
+    std::vector<ResolveCallback> waiters;
+    {
+        std::scoped_lock lock{mtx_};
+        waiters = std::move(in_flight.waiters);
+        auto const ttl = endpoints.empty() ? opts_.negative_ttl : opts_.ttl;
+        entries_.put(k, Entry{.endpoints = endpoints, .expires_at = Clock::now() + ttl});
+    }
+
+    in_flight.promise.set_value(endpoints);
+    for (auto const &waiter : waiters) {
+        waiter(endpoints);
+    }
+}
+
+// Nothing is cached, so the next lookup of the name tries again. There's no
+// exception to give the resolve_async waiters, so to them it failed to resolve.
+void DnsCache::fail(std::string const &k, InFlight &in_flight, std::exception_ptr exception) {
+    std::vector<ResolveCallback> waiters;
+    {
+        std::scoped_lock lock{mtx_};
+        waiters = std::move(in_flight.waiters);
+        if (auto const *entry = entries_.get(k); entry != nullptr && entry->in_flight.get() == &in_flight) {
+            entries_.erase(k);
+        }
+    }
+
+    in_flight.promise.set_exception(std::move(exception));
+    for (auto const &waiter : waiters) {
+        waiter({});
+    }
+}
+
+DnsCache &system_dns_cache() {
+    static DnsCache cache{system_resolve};
+    return cache;
+}
+
+std::vector<Endpoint> system_resolve(std::string_view host, std::string_view service) {
+    asio::io_context io_ctx;
+    asio::ip::tcp::resolver resolver{io_ctx};
+    asio::error_code ec;
+    auto results = resolver.resolve(host, service, ec);
+    if (ec) {
+        return {};
+    }
+
+    return from_asio(results);
+}
+
+} // namespace net
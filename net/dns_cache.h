@@ -0,0 +1,129 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef NET_DNS_CACHE_H_
+#define NET_DNS_CACHE_H_
+
+#include "util/lru_cache.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace net {
+
+struct Endpoint {
+    std::string address;
+    std::uint16_t port{};
+
+    [[nodiscard]] bool operator==(Endpoint const &) const = default;
+};
+
+// Returns the endpoints a host and service resolve to, or nothing if they
+// couldn't be resolved.
+using Resolver = std::function<std::vector<Endpoint>(std::string_view host, std::string_view service)>;
+
+using ResolveCallback = std::function<void(std::vector<Endpoint>)>;
+// Starts resolving a host and service, calling the callback with the result
+// once it's done.
+using AsyncResolver = std::function<void(std::string_view host, std::string_view service, ResolveCallback)>;
+
+struct DnsCacheStats {
+    std::size_t hits{};
+    // Lookups answered by a cached failure.
+    std::size_t negative_hits{};
+    std::size_t misses{};
+    // Lookups that waited on a resolution another thread had already started.
+    std::size_t coalesced{};
+    [[nodiscard]] bool operator==(DnsCacheStats const &) const = default;
+};
+
+// The system resolver doesn't tell us how long answers are valid for, so
+// fixed times are used, similar to what browsers do.
+struct DnsCacheOptions {
+    std::chrono::steady_clock::duration ttl{std::chrono::minutes{1}};
+    // Failures are remembered for a shorter time, as they're more likely to
+    // be temporary.
+    std::chrono::steady_clock::duration negative_ttl{std::chrono::seconds{5}};
+    std::size_t max_entries{256};
+};
+
+// Remembers what hosts resolved to so that connecting to the same host again
+// doesn't require another lookup. Safe to use from multiple threads.
+class DnsCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit DnsCache(Resolver resolver, DnsCacheOptions opts = {});
+
+    // Returns the cached endpoints, or resolves them and caches the result.
+    // Only one thread at a time resolves any given name, with the others
+    // waiting for its answer. Empty if the name couldn't be resolved.
+    // If the resolver throws, nothing is cached and the exception is passed on
+    // to everyone waiting for the name.
+    [[nodiscard]] std::vector<Endpoint> resolve(std::string_view host, std::string_view service);
+
+    // resolve, but without blocking. on_resolved is called right away with
+    // cached endpoints, or else once start_resolve, or the resolution that
+    // someone else already started for the name, is done, from whatever thread
+    // finished it.
+    void resolve_async(std::string_view host,
+            std::string_view service,
+            AsyncResolver const &start_resolve,
+            ResolveCallback on_resolved);
+
+    // The cached result, if there is one, and storing the result of a
+    // resolution done elsewhere. find doesn't count towards the stats.
+    [[nodiscard]] std::optional<std::vector<Endpoint>> find(std::string_view host, std::string_view service);
+    void insert(std::string_view host, std::string_view service, std::vector<Endpoint>);
+
+    [[nodiscard]] DnsCacheStats stats() const;
+    void clear();
+
+private:
+    struct InFlight {
+        std::promise<std::vector<Endpoint>> promise;
+        std::shared_future<std::vector<Endpoint>> result{promise.get_future().share()};
+        // The resolve_async callers waiting for the result. Guarded by mtx_.
+        std::vector<ResolveCallback> waiters;
+    };
+
+    struct Entry {
+        std::vector<Endpoint> endpoints;
+        Clock::time_point expires_at;
+        // Set while the name is being resolved. Shared with whoever is
+        // resolving it so that the waiters are told even if the entry is
+        // evicted in the meantime.
+        std::shared_ptr<InFlight> in_flight;
+    };
+
+    [[nodiscard]] static std::string key(std::string_view host, std::string_view service);
+    void store(std::string key, std::vector<Endpoint>);
+    void finish(std::string const &key, InFlight &, std::vector<Endpoint>);
+    void fail(std::string const &key, InFlight &, std::exception_ptr);
+
+    Resolver resolver_;
+    DnsCacheOptions opts_;
+    mutable std::mutex mtx_;
+    util::LruCache<std::string, Entry> entries_;
+    DnsCacheStats stats_{};
+};
+
+// The cache shared by every socket in the process, using the system resolver.
+DnsCache &system_dns_cache();
+// Resolves using the system resolver, without any caching.
+std::vector<Endpoint> system_resolve(std::string_view host, std::string_view service);
+
+} // namespace net
+
+#endif
@@ -0,0 +1,243 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "net/dns_cache.h"
+
+#include "etest/etest.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+using etest::expect;
+using etest::expect_eq;
+using etest::require;
+using net::DnsCache;
+using net::DnsCacheStats;
+using net::Endpoint;
+
+namespace {
+
+// Answers from a hosts-file style table, counting how often it's asked.
+class StubResolver {
+public:
+    explicit StubResolver(std::map<std::string, std::vector<Endpoint>> hosts) : hosts_{std::move(hosts)} {}
+
+    net::Resolver resolver() {
+        return [this](std::string_view host, std::string_view) {
+            lookups_ += 1;
+            auto it = hosts_.find(std::string{host});
+            return it != end(hosts_) ? it->second : std::vector<Endpoint>{};
+        };
+    }
+
+    int lookups() const { return lookups_; }
+
+private:
+    std::map<std::string, std::vector<Endpoint>> hosts_;
+    std::atomic<int> lookups_{};
+};
+
+auto const kExampleEndpoints = std::vector<Endpoint>{{"192.0.2.1", 80}, {"2001:db8::1", 80}};
+
+} // namespace
+
+int main() {
+    etest::test("resolved names are cached", [] {
+        StubResolver stub{{{"example.com", kExampleEndpoints}}};
+        DnsCache cache{stub.resolver()};
+
+        expect_eq(cache.resolve("example.com", "http"), kExampleEndpoints);
+        expect_eq(cache.resolve("example.com", "http"), kExampleEndpoints);
+        // Host names are case-insensitive.
+        expect_eq(cache.resolve("EXAMPLE.com", "http"), kExampleEndpoints);
+        expect_eq(stub.lookups(), 1);
+
+        // But services may resolve to different ports.
+        expect_eq(cache.resolve("example.com", "https"), kExampleEndpoints);
+        expect_eq(stub.lookups(), 2);
+        expect_eq(cache.stats(), DnsCacheStats{.hits = 2, .misses = 2});
+
+        cache.clear();
+        expect_eq(cache.resolve("example.com", "http"), kExampleEndpoints);
+        expect_eq(stub.lookups(), 3);
+    });
+
+    etest::test("failures are cached", [] {
+        StubResolver stub{{}};
+        DnsCache cache{stub.resolver()};
+
+        expect(cache.resolve("example.com", "http").empty());
+        expect(cache.resolve("example.com", "http").empty());
+        expect_eq(stub.lookups(), 1);
+        expect_eq(cache.stats(), DnsCacheStats{.negative_hits = 1, .misses = 1});
+    });
+
+    etest::test("entries expire", [] {
+        StubResolver stub{{{"example.com", kExampleEndpoints}}};
+        DnsCache cache{stub.resolver(), {.ttl = 0s, .negative_ttl = 1h}};
+
+        expect_eq(cache.resolve("example.com", "http"), kExampleEndpoints);
+        expect_eq(cache.resolve("example.com", "http"), kExampleEndpoints);
+        expect_eq(stub.lookups(), 2);
+        expect_eq(cache.find("example.com", "http"), std::nullopt);
+
+        // Failures have a TTL of their own.
+        expect(cache.resolve("example.org", "http").empty());
+        expect(cache.resolve("example.org", "http").empty());
+        expect_eq(stub.lookups(), 3);
+        expect_eq(cache.find("example.org", "http"), std::vector<Endpoint>{});
+    });
+
+    etest::test("the least recently used entries are evicted", [] {
+        StubResolver stub{{{"a", kExampleEndpoints}, {"b", kExampleEndpoints}}};
+        DnsCache cache{stub.resolver(), {.max_entries = 1}};
+
+        std::ignore = cache.resolve("a", "http");
+        std::ignore = cache.resolve("b", "http");
+        expect_eq(cache.find("a", "http"), std::nullopt);
+        expect_eq(cache.find("b", "http"), kExampleEndpoints);
+    });
+
+    etest::test("results of asynchronous lookups can be inserted", [] {
+        StubResolver stub{{}};
+        DnsCache cache{stub.resolver()};
+
+        expect_eq(cache.find("example.com", "http"), std::nullopt);
+        cache.insert("example.com", "http", kExampleEndpoints);
+        expect_eq(cache.find("example.com", "http"), kExampleEndpoints);
+        expect_eq(cache.resolve("example.com", "http"), kExampleEndpoints);
+        expect_eq(stub.lookups(), 0);
+    });
+
+    etest::test("concurrent lookups of the same name are coalesced", [] {
+        constexpr std::size_t kWaiters = 4;
+        std::promise<void> release;
+        auto released = release.get_future().share();
+        std::atomic<int> lookups{};
+        DnsCache cache{[&](std::string_view, std::string_view) {
+            lookups += 1;
+            released.wait();
+            return kExampleEndpoints;
+        }};
+
+        std::vector<std::future<std::vector<Endpoint>>> results;
+        results.push_back(std::async(std::launch::async, [&] { return cache.resolve("example.com", "http"); }));
+        while (lookups == 0) {
+            std::this_thread::yield();
+        }
+
+        for (std::size_t i = 0; i < kWaiters; ++i) {
+            results.push_back(std::async(std::launch::async, [&] { return cache.resolve("example.com", "http"); }));
+        }
+
+        while (cache.stats().coalesced < kWaiters) {
+            std::this_thread::yield();
+        }
+
+        release.set_value();
+        for (auto &result : results) {
+            expect_eq(result.get(), kExampleEndpoints);
+        }
+
+        expect_eq(lookups.load(), 1);
+        expect_eq(cache.stats(), DnsCacheStats{.misses = 1, .coalesced = kWaiters});
+    });
+
+    etest::test("resolver exceptions aren't cached", [] {
+        int lookups{};
+        DnsCache cache{[&](std::string_view, std::string_view) -> std::vector<Endpoint> {
+            if (lookups++ == 0) {
+                throw std::runtime_error{"oh no"};
+            }
+            return kExampleEndpoints;
+        }};
+
+        bool threw{};
+        try {
+            std::ignore = cache.resolve("example.com", "http");
+        } catch (std::runtime_error const &) {
+            threw = true;
+        }
+
+        expect(threw);
+        expect_eq(cache.find("example.com", "http"), std::nullopt);
+        expect_eq(cache.resolve("example.com", "http"), kExampleEndpoints);
+        expect_eq(lookups, 2);
+    });
+
+    etest::test("resolve_async", [] {
+        StubResolver stub{{}};
+        DnsCache cache{stub.resolver()};
+        std::vector<std::pair<std::string, net::ResolveCallback>> started;
+        auto start_resolve = [&](std::string_view host, std::string_view, net::ResolveCallback on_resolved) {
+            started.emplace_back(std::string{host}, std::move(on_resolved));
+        };
+
+        std::vector<std::vector<Endpoint>> results;
+        auto on_resolved = [&](std::vector<Endpoint> endpoints) { results.push_back(std::move(endpoints)); };
+
+        // Lookups of a name that's already being resolved join that lookup.
+        cache.resolve_async("example.com", "http", start_resolve, on_resolved);
+        cache.resolve_async("example.com", "http", start_resolve, on_resolved);
+        cache.resolve_async("EXAMPLE.com", "http", start_resolve, on_resolved);
+        require(started.size() == 1);
+        expect_eq(started[0].first, "example.com");
+        expect(results.empty());
+        expect_eq(cache.stats(), DnsCacheStats{.misses = 1, .coalesced = 2});
+
+        started[0].second(kExampleEndpoints);
+        expect_eq(results, std::vector<std::vector<Endpoint>>(3, kExampleEndpoints));
+
+        // And once it's resolved, the cached result is used.
+        cache.resolve_async("example.com", "http", start_resolve, on_resolved);
+        expect_eq(started.size(), std::size_t{1});
+        expect_eq(results.size(), std::size_t{4});
+        expect_eq(cache.resolve("example.com", "http"), kExampleEndpoints);
+        expect_eq(stub.lookups(), 0);
+        expect_eq(cache.stats(), DnsCacheStats{.hits = 2, .misses = 1, .coalesced = 2});
+    });
+
+    etest::test("resolve waits for resolve_async lookups", [] {
+        StubResolver stub{{}};
+        DnsCache cache{stub.resolver()};
+        net::ResolveCallback finish;
+        cache.resolve_async(
+                "example.com",
+                "http",
+                [&](std::string_view, std::string_view, net::ResolveCallback on_resolved) {
+                    finish = std::move(on_resolved);
+                },
+                [](std::vector<Endpoint>) {});
+
+        auto result = std::async(std::launch::async, [&] { return cache.resolve("example.com", "http"); });
+        while (cache.stats().coalesced < 1) {
+            std::this_thread::yield();
+        }
+
+        finish(kExampleEndpoints);
+        expect_eq(result.get(), kExampleEndpoints);
+        expect_eq(stub.lookups(), 0);
+    });
+
+    etest::test("system resolver", [] {
+        auto endpoints = net::system_resolve("localhost", "80");
+        require(!endpoints.empty());
+        expect_eq(endpoints.front().port, std::uint16_t{80});
+    });
+
+    return etest::run_all_tests();
+}
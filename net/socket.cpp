@@ -5,10 +5,14 @@
 
 #include "net/socket.h"
 
+#include "net/asio_endpoint.h"
+#include "net/dns_cache.h"
+
 #include <asio.hpp>
 #include <asio/ssl.hpp>
 #include <openssl/ssl.h>
 
+#include <algorithm>
 #include <string>
 #include <utility>
 
@@ -16,12 +20,13 @@ namespace net {
 namespace {
 
 struct BaseSocketImpl {
-    bool connect(asio::ip::tcp::resolver &resolver,
-            asio::ip::tcp::socket &socket,
-            std::string_view host,
-            std::string_view service) {
+    bool connect(asio::ip::tcp::socket &socket, std::string_view host, std::string_view service) {
+        auto endpoints = to_asio(system_dns_cache().resolve(host, service));
+        if (endpoints.empty()) {
+            return false;
+        }
+
         asio::error_code ec;
-        auto endpoints = resolver.resolve(host, service, ec);
         asio::connect(socket, endpoints, ec);
         return !ec;
     }
@@ -40,12 +45,7 @@ struct BaseSocketImpl {
     std::string read_until(auto &socket, std::string_view delimiter) {
         asio::error_code ec;
         auto n = asio::read_until(socket, asio::dynamic_buffer(buffer), delimiter, ec);
-        std::string result{};
-        if (n > 0) {
-            result = buffer.substr(0, n);
-            buffer.erase(0, n);
-        }
-        return result;
+        return take_from_buffer(n);
     }
 
     std::string read_bytes(auto &socket, std::size_t bytes) {
@@ -55,10 +55,41 @@ struct BaseSocketImpl {
             asio::read(socket, asio::dynamic_buffer(buffer), asio::transfer_at_least(bytes_to_transfer), ec);
         }
 
-        std::string result = buffer.substr(0, bytes);
-        buffer.erase(0, bytes);
+        return take_from_buffer(bytes);
+    }
+
+    std::size_t read_some(auto &socket, std::string &out, std::size_t max_bytes) {
+        if (max_bytes == 0) {
+            return 0;
+        }
+
+        // Anything left over from an earlier delimited read has to be handed out first.
+        if (!buffer.empty()) {
+            auto n = std::min(buffer.size(), max_bytes);
+            out.append(buffer, 0, n);
+            buffer.erase(0, n);
+            return n;
+        }
+
+        // Read straight into the caller's string to avoid an extra copy.
+        auto old_size = out.size();
+        out.resize(old_size + max_bytes);
+        asio::error_code ec;
+        auto n = socket.read_some(asio::buffer(out.data() + old_size, max_bytes), ec);
+        out.resize(old_size + n);
+        return n;
+    }
+
+    std::string take_from_buffer(std::size_t n) {
+        if (n >= buffer.size()) {
+            return std::exchange(buffer, {});
+        }
+
+        std::string result = buffer.substr(0, n);
+        buffer.erase(0, n);
         return result;
     }
+
     std::string buffer{};
 };
 
@@ -66,7 +97,6 @@ struct BaseSocketImpl {
 
 struct Socket::Impl : public BaseSocketImpl {
     asio::io_context io_ctx{};
-    asio::ip::tcp::resolver resolver{io_ctx};
     asio::ip::tcp::socket socket{io_ctx};
 };
 
@@ -76,7 +106,7 @@ Socket::Socket(Socket &&) noexcept = default;
 Socket &Socket::operator=(Socket &&) noexcept = default;
 
 bool Socket::connect(std::string_view host, std::string_view service) {
-    return impl_->connect(impl_->resolver, impl_->socket, host, service);
+    return impl_->connect(impl_->socket, host, service);
 }
 
 std::size_t Socket::write(std::string_view data) {
@@ -95,10 +125,14 @@ std::string Socket::read_bytes(std::size_t bytes) {
     return impl_->read_bytes(impl_->socket, bytes);
 }
 
+std::size_t Socket::read_some(std::string &out, std::size_t max_bytes) {
+    return impl_->read_some(impl_->socket, out, max_bytes);
+}
+
 struct SecureSocket::Impl : public BaseSocketImpl {
     // TODO(robinlinden): Better error propagation.
     bool connect(std::string_view host, std::string_view service) {
-        if (BaseSocketImpl::connect(resolver, socket.next_layer(), host, service)) {
+        if (BaseSocketImpl::connect(socket.next_layer(), host, service)) {
             asio::error_code ec;
             // Set SNI hostname. Many hosts reject the handshake if this isn't done.
             std::string null_terminated_host{host};
@@ -110,7 +144,6 @@ struct SecureSocket::Impl : public BaseSocketImpl {
     }
 
     asio::io_context io_ctx{};
-    asio::ip::tcp::resolver resolver{io_ctx};
     asio::ssl::context ctx{asio::ssl::context::method::sslv23_client};
     asio::ssl::stream<asio::ip::tcp::socket> socket{io_ctx, ctx};
 };
@@ -140,4 +173,8 @@ std::string SecureSocket::read_bytes(std::size_t bytes) {
     return impl_->read_bytes(impl_->socket, bytes);
 }
 
+std::size_t SecureSocket::read_some(std::string &out, std::size_t max_bytes) {
+    return impl_->read_some(impl_->socket, out, max_bytes);
+}
+
 } // namespace net
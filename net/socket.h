@@ -25,6 +25,9 @@ public:
     std::string read_all();
     std::string read_until(std::string_view delimiter);
     std::string read_bytes(std::size_t bytes);
+    // Appends at most max_bytes bytes to out, blocking until some data is
+    // available. Returns the number of bytes appended, 0 on EOF or error.
+    std::size_t read_some(std::string &out, std::size_t max_bytes);
 
 private:
     struct Impl;
@@ -44,6 +47,7 @@ public:
     std::string read_all();
     std::string read_until(std::string_view delimiter);
     std::string read_bytes(std::size_t bytes);
+    std::size_t read_some(std::string &out, std::size_t max_bytes);
 
 private:
     struct Impl;
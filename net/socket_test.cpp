@@ -68,5 +68,18 @@ int main() {
         expect_eq(sock.read_bytes(4), "6789");
     });
 
+    etest::test("Socket::read_some", [] {
+        auto port = start_server("header\r\nbody");
+        net::Socket sock;
+        sock.connect("localhost", std::to_string(port));
+
+        expect_eq(sock.read_until("\r\n"), "header\r\n");
+
+        std::string out{"prefix:"};
+        while (sock.read_some(out, 2) > 0) {
+        }
+        expect_eq(out, "prefix:body");
+    });
+
     return etest::run_all_tests();
 }
@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2021-2022 Robin Lindén <dev@robinlinden.eu>
+// SPDX-FileCopyrightText: 2021-2023 Robin Lindén <dev@robinlinden.eu>
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
@@ -8,6 +8,9 @@
 #include <charconv>
 #include <cstdlib>
 #include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
 
 using namespace std::literals;
 
@@ -31,6 +34,18 @@ std::vector<std::string> font_paths() {
     return paths;
 }
 
+std::optional<std::string> cache_path() {
+    if (char const *xdg_cache_home = std::getenv("XDG_CACHE_HOME")) {
+        return xdg_cache_home + "/hastur"s;
+    }
+
+    if (char const *home = std::getenv("HOME")) {
+        return home + "/.cache/hastur"s;
+    }
+
+    return std::nullopt;
+}
+
 unsigned active_window_scale_factor() {
     // Hastur, Qt, Gnome, and Elementary in that order.
     // Environment variables from https://wiki.archlinux.org/title/HiDPI#GUI_toolkits
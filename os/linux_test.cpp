@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2022 Robin Lindén <dev@robinlinden.eu>
+// SPDX-FileCopyrightText: 2022-2023 Robin Lindén <dev@robinlinden.eu>
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
@@ -17,6 +17,9 @@
 // NOLINTNEXTLINE(modernize-deprecated-headers)
 #include <stdlib.h>
 
+#include <optional>
+#include <string>
+
 using etest::expect_eq;
 
 int main() {
@@ -43,5 +46,18 @@ int main() {
         expect_eq(os::active_window_scale_factor(), 50u);
     });
 
+    etest::test("cache_path", [] {
+        unsetenv("XDG_CACHE_HOME");
+        setenv("HOME", "/home/hastur", true);
+        expect_eq(os::cache_path(), std::optional<std::string>{"/home/hastur/.cache/hastur"});
+
+        setenv("XDG_CACHE_HOME", "/tmp/cache", true);
+        expect_eq(os::cache_path(), std::optional<std::string>{"/tmp/cache/hastur"});
+
+        unsetenv("XDG_CACHE_HOME");
+        unsetenv("HOME");
+        expect_eq(os::cache_path(), std::nullopt);
+    });
+
     return etest::run_all_tests();
 }
@@ -1,16 +1,19 @@
-// SPDX-FileCopyrightText: 2021-2022 Robin Lindén <dev@robinlinden.eu>
+// SPDX-FileCopyrightText: 2021-2023 Robin Lindén <dev@robinlinden.eu>
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
 #ifndef OS_OS_H_
 #define OS_OS_H_
 
+#include <optional>
 #include <string>
 #include <vector>
 
 namespace os {
 
 std::vector<std::string> font_paths();
+// Where Hastur may keep files between runs that are fine to lose.
+std::optional<std::string> cache_path();
 unsigned active_window_scale_factor();
 
 } // namespace os
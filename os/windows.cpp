@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2021-2022 Robin Lindén <dev@robinlinden.eu>
+// SPDX-FileCopyrightText: 2021-2023 Robin Lindén <dev@robinlinden.eu>
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
@@ -28,19 +28,46 @@
 #include <cstdlib>
 #include <cstring>
 #include <cwchar>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace os {
+namespace {
+
+std::optional<std::string> known_folder_path(KNOWNFOLDERID const &folder) {
+    PWSTR bad_path{nullptr};
+    if (SHGetKnownFolderPath(folder, 0, nullptr, &bad_path) != S_OK) {
+        CoTaskMemFree(bad_path);
+        return std::nullopt;
+    }
+
+    auto bad_path_len = static_cast<int>(std::wcslen(bad_path));
+    auto chars_needed = WideCharToMultiByte(CP_UTF8, 0, bad_path, bad_path_len, nullptr, 0, nullptr, nullptr);
+    std::string path;
+    path.resize(chars_needed);
+    WideCharToMultiByte(CP_UTF8, 0, bad_path, bad_path_len, path.data(), chars_needed, nullptr, nullptr);
+    CoTaskMemFree(bad_path);
+    return path;
+}
+
+} // namespace
 
 std::vector<std::string> font_paths() {
-    PWSTR bad_font_path{nullptr};
-    SHGetKnownFolderPath(FOLDERID_Fonts, 0, nullptr, &bad_font_path);
-    auto bad_font_path_len = static_cast<int>(std::wcslen(bad_font_path));
-    auto chars_needed = WideCharToMultiByte(CP_UTF8, 0, bad_font_path, bad_font_path_len, nullptr, 0, nullptr, nullptr);
-    std::string font_path;
-    font_path.resize(chars_needed);
-    WideCharToMultiByte(CP_UTF8, 0, bad_font_path, bad_font_path_len, font_path.data(), chars_needed, nullptr, nullptr);
-    CoTaskMemFree(bad_font_path);
-    return {font_path};
+    if (auto path = known_folder_path(FOLDERID_Fonts)) {
+        return {*std::move(path)};
+    }
+
+    return {};
+}
+
+std::optional<std::string> cache_path() {
+    if (auto path = known_folder_path(FOLDERID_LocalAppData)) {
+        return *path + "\\hastur";
+    }
+
+    return std::nullopt;
 }
 
 unsigned active_window_scale_factor() {
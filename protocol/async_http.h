@@ -0,0 +1,151 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef PROTOCOL_ASYNC_HTTP_H_
+#define PROTOCOL_ASYNC_HTTP_H_
+
+#include "protocol/connection_pool.h"
+#include "protocol/http.h"
+#include "protocol/http_response_parser.h"
+#include "protocol/response.h"
+
+#include "uri/uri.h"
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace protocol {
+
+// HTTP GET requests over sockets whose operations call back once they're done
+// instead of blocking, so that any number of requests can be in flight without
+// a thread each. Keep-alive connections are pooled the same way as in Http.
+template<typename SocketT>
+class AsyncHttp {
+public:
+    using SocketFactory = std::function<SocketT()>;
+
+    AsyncHttp(SocketFactory new_socket, std::optional<std::string> user_agent, ConnectionPoolOptions pool_options = {})
+        : client_{std::make_shared<Client>(std::move(new_socket), std::move(user_agent), std::move(pool_options))} {}
+
+    // on_done is called from whatever thread the socket calls back on. Requests
+    // still in flight when this is destroyed are finished as usual, unless the
+    // sockets' event loop is destroyed first, which finishes them with an
+    // error.
+    void get(uri::Uri uri, Headers request_headers, ResponseCallback on_done) {
+        auto request = std::make_shared<Request>(
+                client_, std::move(uri), std::move(request_headers), std::move(on_done));
+        request->start();
+    }
+
+    [[nodiscard]] ConnectionPoolStats connection_pool_stats() const { return client_->pool.stats(); }
+
+private:
+    struct Client {
+        Client(SocketFactory factory, std::optional<std::string> ua, ConnectionPoolOptions pool_options)
+            : new_socket{std::move(factory)}, user_agent{std::move(ua)}, pool{std::move(pool_options)} {}
+
+        SocketFactory new_socket;
+        std::optional<std::string> user_agent;
+        ConnectionPool<SocketT> pool;
+    };
+
+    class Request : public std::enable_shared_from_this<Request> {
+    public:
+        Request(std::shared_ptr<Client> client, uri::Uri uri, Headers request_headers, ResponseCallback on_done)
+            : client_{std::move(client)}, uri_{std::move(uri)}, origin_{Http::origin(uri_)},
+              request_headers_{std::move(request_headers)}, on_done_{std::move(on_done)} {}
+
+        void start() {
+            if (auto socket = client_->pool.take(origin_)) {
+                socket_.emplace(*std::move(socket));
+                reused_ = true;
+                send();
+                return;
+            }
+
+            connect();
+        }
+
+    private:
+        void connect() {
+            socket_.emplace(client_->new_socket());
+            reused_ = false;
+            auto const &service = Http::use_port(uri_) ? uri_.authority.port : uri_.scheme;
+            socket_->connect(uri_.authority.host, service, [self = this->shared_from_this()](bool connected) {
+                if (!connected) {
+                    self->on_done_(Response{Error::Unresolved});
+                    return;
+                }
+
+                self->send();
+            });
+        }
+
+        void send() {
+            parser_ = HttpResponseParser{};
+            auto request = Http::create_get_request(
+                    uri_, client_->user_agent, Http::Connection::KeepAlive, request_headers_);
+            socket_->write(std::move(request), [self = this->shared_from_this()](bool written) {
+                if (!written) {
+                    self->on_closed();
+                    return;
+                }
+
+                self->read();
+            });
+        }
+
+        void read() {
+            socket_->read_some(Http::kMaxReadSize, [self = this->shared_from_this()](std::string_view data) {
+                if (data.empty()) {
+                    self->on_closed();
+                } else if (self->parser_.feed(data)) {
+                    self->complete();
+                } else {
+                    self->read();
+                }
+            });
+        }
+
+        void on_closed() {
+            parser_.finish();
+            // If nothing at all was read, the server most likely closed the
+            // connection while it was idle, so we retry on a new connection.
+            if (reused_ && parser_.response().err == Error::Unresolved) {
+                connect();
+                return;
+            }
+
+            complete();
+        }
+
+        void complete() {
+            if (parser_.reusable()) {
+                client_->pool.put(origin_, *std::move(socket_));
+            }
+
+            on_done_(parser_.take_response());
+        }
+
+        std::shared_ptr<Client> client_;
+        uri::Uri uri_;
+        std::string origin_;
+        Headers request_headers_;
+        ResponseCallback on_done_;
+        std::optional<SocketT> socket_;
+        // If the connection came from the pool.
+        bool reused_{false};
+        HttpResponseParser parser_;
+    };
+
+    std::shared_ptr<Client> client_;
+};
+
+} // namespace protocol
+
+#endif
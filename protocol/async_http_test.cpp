@@ -0,0 +1,163 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "protocol/async_http.h"
+
+#include "protocol/connection_pool.h"
+#include "protocol/response.h"
+
+#include "etest/etest.h"
+#include "uri/uri.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+using etest::expect;
+using etest::expect_eq;
+using etest::require;
+using protocol::Error;
+
+namespace {
+
+// What the fake sockets see, shared so that it survives the sockets being
+// moved around.
+struct Server {
+    std::vector<std::string> hosts;
+    std::vector<std::string> requests;
+    bool refuse_connections{false};
+};
+
+// Calls back right away, answering each request with the next response,
+// handing it out 3 bytes at a time.
+class FakeAsyncSocket {
+public:
+    FakeAsyncSocket(std::shared_ptr<Server> server, std::vector<std::string> responses)
+        : server_{std::move(server)}, responses_{std::move(responses)} {}
+
+    void connect(std::string_view host, std::string_view service, std::function<void(bool)> const &on_connected) {
+        server_->hosts.push_back(std::string{host} + ":" + std::string{service});
+        on_connected(!server_->refuse_connections);
+    }
+
+    void write(std::string data, std::function<void(bool)> const &on_written) {
+        server_->requests.push_back(std::move(data));
+        if (!responses_.empty()) {
+            read_data_ += responses_.front();
+            responses_.erase(begin(responses_));
+        }
+        on_written(true);
+    }
+
+    void read_some(std::size_t max_bytes, std::function<void(std::string_view)> const &on_read) {
+        auto n = std::min({read_data_.size(), max_bytes, std::size_t{3}});
+        auto data = read_data_.substr(0, n);
+        read_data_.erase(0, n);
+        on_read(data);
+    }
+
+private:
+    std::shared_ptr<Server> server_;
+    std::vector<std::string> responses_;
+    std::string read_data_;
+};
+
+constexpr auto kKeepAliveResponse = "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello"sv;
+
+// Every new connection answers with the responses.
+protocol::AsyncHttp<FakeAsyncSocket> create_client(std::shared_ptr<Server> server, std::vector<std::string> responses) {
+    return protocol::AsyncHttp<FakeAsyncSocket>{
+            [server = std::move(server), responses = std::move(responses)] {
+                return FakeAsyncSocket{server, responses};
+            },
+            "hastur"};
+}
+
+std::optional<protocol::Response> get(
+        protocol::AsyncHttp<FakeAsyncSocket> &client, std::string url, protocol::Headers request_headers = {}) {
+    std::optional<protocol::Response> response;
+    client.get(uri::Uri::parse(std::move(url)), request_headers, [&](protocol::Response r) {
+        response = std::move(r);
+    });
+    return response;
+}
+
+} // namespace
+
+int main() {
+    etest::test("get", [] {
+        auto server = std::make_shared<Server>();
+        auto client = create_client(server, {std::string{kKeepAliveResponse}});
+
+        auto response = get(client, "http://example.com:8080/index.html");
+        require(response.has_value());
+        expect_eq(response->err, Error::Ok);
+        expect_eq(response->body, "hello");
+
+        expect_eq(server->hosts, std::vector{"example.com:8080"s});
+        require(server->requests.size() == 1);
+        expect(server->requests[0].starts_with("GET /index.html HTTP/1.1\r\n"));
+        expect(server->requests[0].contains("User-Agent: hastur\r\n"));
+    });
+
+    etest::test("request headers are sent", [] {
+        auto server = std::make_shared<Server>();
+        auto client = create_client(server, {std::string{kKeepAliveResponse}});
+
+        expect_eq(get(client, "http://example.com", {{"If-None-Match", "\"1234\""}})->body, "hello");
+        require(server->requests.size() == 1);
+        expect(server->requests[0].contains("If-None-Match: \"1234\"\r\n"));
+    });
+
+    etest::test("keep-alive connections are reused", [] {
+        auto server = std::make_shared<Server>();
+        auto client = create_client(server, {std::string{kKeepAliveResponse}, std::string{kKeepAliveResponse}});
+
+        expect_eq(get(client, "http://example.com")->body, "hello");
+        expect_eq(get(client, "http://example.com")->body, "hello");
+        expect_eq(server->hosts.size(), std::size_t{1});
+        expect_eq(server->requests.size(), std::size_t{2});
+        expect_eq(client.connection_pool_stats(), protocol::ConnectionPoolStats{.hits = 1, .misses = 1});
+    });
+
+    etest::test("stale pooled connection is replaced", [] {
+        auto server = std::make_shared<Server>();
+        auto client = create_client(server, {std::string{kKeepAliveResponse}});
+
+        // The first connection has nothing more to say once it's been reused,
+        // so the second request has to go over a new connection.
+        expect_eq(get(client, "http://example.com")->body, "hello");
+        expect_eq(get(client, "http://example.com")->body, "hello");
+        expect_eq(server->hosts.size(), std::size_t{2});
+        expect_eq(server->requests.size(), std::size_t{3});
+    });
+
+    etest::test("undelimited body isn't pooled", [] {
+        auto server = std::make_shared<Server>();
+        auto client = create_client(server, {"HTTP/1.1 200 OK\r\nServer: hastur\r\n\r\nhello"});
+
+        expect_eq(get(client, "http://example.com")->body, "hello");
+        expect_eq(get(client, "http://example.com")->body, "hello");
+        expect_eq(server->hosts.size(), std::size_t{2});
+        expect_eq(client.connection_pool_stats(), protocol::ConnectionPoolStats{.misses = 2});
+    });
+
+    etest::test("connection failure", [] {
+        auto server = std::make_shared<Server>();
+        server->refuse_connections = true;
+        auto client = create_client(server, {std::string{kKeepAliveResponse}});
+
+        expect_eq(get(client, "http://example.com"), protocol::Response{Error::Unresolved});
+        expect(server->requests.empty());
+    });
+
+    return etest::run_all_tests();
+}
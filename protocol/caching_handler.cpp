@@ -0,0 +1,294 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "protocol/caching_handler.h"
+
+#include "util/string.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+using namespace std::literals;
+
+namespace protocol {
+namespace {
+
+using Clock = std::chrono::system_clock;
+
+template<typename T>
+std::optional<T> to_int(std::string_view s) {
+    T value{};
+    if (auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+            ec != std::errc{} || ptr != s.data() + s.size()) {
+        return std::nullopt;
+    }
+
+    return value;
+}
+
+struct CacheControl {
+    bool no_store{};
+    bool no_cache{};
+    std::optional<std::chrono::seconds> max_age{};
+};
+
+CacheControl parse_cache_control(std::optional<std::string_view> header) {
+    CacheControl cache_control;
+    if (!header) {
+        return cache_control;
+    }
+
+    for (auto directive : util::split(*header, ",")) {
+        auto [name, value] = util::split_once(util::trim(directive), "=");
+        auto const lowercase_name = util::lowercased(std::string{util::trim(name)});
+        if (lowercase_name == "no-store") {
+            cache_control.no_store = true;
+        } else if (lowercase_name == "no-cache") {
+            cache_control.no_cache = true;
+        } else if (lowercase_name == "max-age") {
+            value = util::trim(value);
+            if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+                value = value.substr(1, value.size() - 2);
+            }
+
+            // An invalid max-age means the response is already stale.
+            cache_control.max_age = std::chrono::seconds{to_int<long long>(value).value_or(0)};
+        }
+    }
+
+    return cache_control;
+}
+
+// Only the IMF-fixdate format is handled, e.g. "Sun, 06 Nov 1994 08:49:37 GMT",
+// as that's what every server sends these days.
+std::optional<Clock::time_point> parse_http_date(std::optional<std::string_view> date) {
+    if (!date) {
+        return std::nullopt;
+    }
+
+    auto fields = util::split(util::trim(*date), " ");
+    if (fields.size() != 6 || fields[5] != "GMT") {
+        return std::nullopt;
+    }
+
+    static constexpr std::array kMonths{
+            "Jan"sv, "Feb"sv, "Mar"sv, "Apr"sv, "May"sv, "Jun"sv, "Jul"sv, "Aug"sv, "Sep"sv, "Oct"sv, "Nov"sv, "Dec"sv};
+    auto month = std::ranges::find(kMonths, fields[2]);
+    auto day = to_int<unsigned>(fields[1]);
+    auto year = to_int<int>(fields[3]);
+    auto time = util::split(fields[4], ":");
+    if (month == kMonths.end() || !day || !year || time.size() != 3) {
+        return std::nullopt;
+    }
+
+    auto hours = to_int<int>(time[0]);
+    auto minutes = to_int<int>(time[1]);
+    auto seconds = to_int<int>(time[2]);
+    std::chrono::year_month_day const ymd{std::chrono::year{*year},
+            std::chrono::month{static_cast<unsigned>(month - kMonths.begin() + 1)},
+            std::chrono::day{*day}};
+    if (!ymd.ok() || !hours || !minutes || !seconds) {
+        return std::nullopt;
+    }
+
+    return std::chrono::sys_days{ymd} + std::chrono::hours{*hours} + std::chrono::minutes{*minutes}
+            + std::chrono::seconds{*seconds};
+}
+
+// How long the response is fresh for after the server sent it.
+Clock::duration freshness_lifetime(CachedResponse const &cached) {
+    auto const &headers = cached.response.headers;
+    if (auto max_age = parse_cache_control(headers.get("cache-control"sv)).max_age) {
+        return *max_age;
+    }
+
+    auto const date = parse_http_date(headers.get("date"sv)).value_or(cached.stored_at);
+    if (auto expires = headers.get("expires"sv)) {
+        // An invalid date, often "0", means the response is already stale.
+        auto expires_at = parse_http_date(expires);
+        return expires_at ? std::max(*expires_at - date, Clock::duration::zero()) : Clock::duration::zero();
+    }
+
+    // Without any explicit lifetime, a response that hasn't changed in a long
+    // time probably won't change for a while, so like other browsers, we
+    // consider it fresh for 10% of the time since it was last modified.
+    if (auto last_modified = parse_http_date(headers.get("last-modified"sv))) {
+        return std::max((date - *last_modified) / 10, Clock::duration::zero());
+    }
+
+    return Clock::duration::zero();
+}
+
+bool is_fresh(CachedResponse const &cached, Clock::time_point now) {
+    if (parse_cache_control(cached.response.headers.get("cache-control"sv)).no_cache) {
+        return false;
+    }
+
+    auto age = now - cached.stored_at;
+    if (auto age_header = cached.response.headers.get("age"sv)) {
+        age += std::chrono::seconds{to_int<long long>(util::trim(*age_header)).value_or(0)};
+    }
+
+    return age < freshness_lifetime(cached);
+}
+
+bool is_storable(Response const &response) {
+    if (response.err != Error::Ok || response.status_line.status_code != 200) {
+        return false;
+    }
+
+    auto const &headers = response.headers;
+    auto const cache_control = parse_cache_control(headers.get("cache-control"sv));
+    if (cache_control.no_store || headers.get("vary"sv) == "*"sv) {
+        return false;
+    }
+
+    // Responses that would always be stale and that can't be revalidated are useless.
+    return cache_control.max_age || headers.get("expires"sv) || headers.get("etag"sv)
+            || headers.get("last-modified"sv);
+}
+
+bool is_cacheable(uri::Uri const &uri) {
+    return uri.scheme == "http" || uri.scheme == "https";
+}
+
+bool is_not_modified(Response const &response) {
+    return response.err == Error::Ok && response.status_line.status_code == 304;
+}
+
+// Adds what's needed to ask the server if the cached response has changed.
+Headers with_validators(Headers headers, std::optional<CachedResponse> const &cached) {
+    if (!cached) {
+        return headers;
+    }
+
+    if (auto etag = cached->response.headers.get("etag"sv)) {
+        headers.add({"If-None-Match"sv, *etag});
+    }
+
+    if (auto last_modified = cached->response.headers.get("last-modified"sv)) {
+        headers.add({"If-Modified-Since"sv, *last_modified});
+    }
+
+    return headers;
+}
+
+// The headers in a 304 response replace the cached ones, except for the ones
+// describing the body, which the 304 response doesn't have.
+Headers updated_headers(Headers const &cached, Headers const &not_modified) {
+    Headers headers;
+    for (auto const &[name, value] : not_modified) {
+        if (!util::no_case_compare(name, "content-length"sv) && !util::no_case_compare(name, "transfer-encoding"sv)) {
+            headers.add({name, value});
+        }
+    }
+
+    // Headers that are already there are kept as-is.
+    for (auto const &[name, value] : cached) {
+        headers.add({name, value});
+    }
+
+    return headers;
+}
+
+} // namespace
+
+Response CachingHandler::request(
+        uri::Uri const &uri, Headers const &request_headers, BodyDataCallback const &on_body_data) {
+    if (!is_cacheable(uri)) {
+        return handler_->request(uri, request_headers, on_body_data);
+    }
+
+    auto cached = cache_->get(uri.uri);
+    if (cached && is_fresh(*cached, Clock::now())) {
+        {
+            std::lock_guard lock{stats_mtx_};
+            ++stats_.hits;
+        }
+
+        if (on_body_data && !cached->response.body.empty()) {
+            on_body_data(cached->response, cached->response.body);
+        }
+        return std::move(cached->response);
+    }
+
+    auto response = handler_->request(uri, with_validators(request_headers, cached), on_body_data);
+
+    // Nothing was streamed for a 304 response, so the cached body has to be.
+    bool const revalidated = cached.has_value() && is_not_modified(response);
+    auto result = on_response(uri, std::move(cached), std::move(response));
+    if (revalidated && on_body_data && !result.body.empty()) {
+        on_body_data(result, result.body);
+    }
+
+    return result;
+}
+
+void CachingHandler::fetch(uri::Uri const &uri, Headers const &request_headers, ResponseCallback on_done) {
+    if (!is_cacheable(uri)) {
+        handler_->fetch(uri, request_headers, std::move(on_done));
+        return;
+    }
+
+    auto cached = cache_->get(uri.uri);
+    if (cached && is_fresh(*cached, Clock::now())) {
+        {
+            std::lock_guard lock{stats_mtx_};
+            ++stats_.hits;
+        }
+
+        on_done(std::move(cached->response));
+        return;
+    }
+
+    auto headers = with_validators(request_headers, cached);
+    handler_->fetch(uri,
+            headers,
+            [this, uri, cached = std::move(cached), on_done = std::move(on_done)](Response response) mutable {
+                on_done(on_response(uri, std::move(cached), std::move(response)));
+            });
+}
+
+CachingHandlerStats CachingHandler::stats() const {
+    std::lock_guard lock{stats_mtx_};
+    return stats_;
+}
+
+Response CachingHandler::on_response(uri::Uri const &uri, std::optional<CachedResponse> cached, Response response) {
+    if (cached && is_not_modified(response)) {
+        {
+            std::lock_guard lock{stats_mtx_};
+            ++stats_.revalidated;
+        }
+
+        cached->response.headers = updated_headers(cached->response.headers, response.headers);
+        cached->stored_at = Clock::now();
+        cache_->put(uri.uri, *cached);
+        return std::move(cached->response);
+    }
+
+    {
+        std::lock_guard lock{stats_mtx_};
+        ++stats_.misses;
+    }
+
+    if (is_storable(response)) {
+        cache_->put(uri.uri, CachedResponse{response, Clock::now()});
+    } else if (cached && response.err == Error::Ok) {
+        cache_->remove(uri.uri);
+    }
+
+    return response;
+}
+
+} // namespace protocol
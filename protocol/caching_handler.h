@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef PROTOCOL_CACHING_HANDLER_H_
+#define PROTOCOL_CACHING_HANDLER_H_
+
+#include "protocol/http_cache.h"
+#include "protocol/iprotocol_handler.h"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace protocol {
+
+struct CachingHandlerStats {
+    // Responses served from the cache without asking the server.
+    std::size_t hits{};
+    // Cached responses the server said were still usable.
+    std::size_t revalidated{};
+    std::size_t misses{};
+
+    [[nodiscard]] bool operator==(CachingHandlerStats const &) const = default;
+};
+
+// Serves HTTP(S) responses from a cache for as long as Cache-Control and
+// Expires say they're fresh, and once they aren't, asks the server if they
+// have changed using the ETag and Last-Modified they were sent with. Every
+// other request is passed on to the wrapped handler as-is.
+class CachingHandler final : public IProtocolHandler {
+public:
+    CachingHandler(std::unique_ptr<IProtocolHandler> handler, std::unique_ptr<HttpCache> cache)
+        : cache_{std::move(cache)}, handler_{std::move(handler)} {}
+
+    [[nodiscard]] Response handle(uri::Uri const &uri) override { return request(uri, {}, {}); }
+    [[nodiscard]] Response stream(uri::Uri const &uri, BodyDataCallback const &on_body_data) override {
+        return request(uri, {}, on_body_data);
+    }
+    [[nodiscard]] Response request(uri::Uri const &, Headers const &, BodyDataCallback const &) override;
+    void fetch(uri::Uri const &, Headers const &, ResponseCallback) override;
+
+    [[nodiscard]] CachingHandlerStats stats() const;
+
+private:
+    // The response to hand over once the server has answered, with the cache
+    // updated using the answer.
+    [[nodiscard]] Response on_response(uri::Uri const &, std::optional<CachedResponse>, Response);
+
+    std::unique_ptr<HttpCache> cache_;
+    mutable std::mutex stats_mtx_;
+    CachingHandlerStats stats_{};
+    // Destroyed first so that no fetch callbacks are running once the rest of
+    // the handler is destroyed.
+    std::unique_ptr<IProtocolHandler> handler_;
+};
+
+} // namespace protocol
+
+#endif
@@ -0,0 +1,248 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "protocol/caching_handler.h"
+
+#include "protocol/http_cache.h"
+#include "protocol/iprotocol_handler.h"
+#include "protocol/response.h"
+
+#include "etest/etest.h"
+#include "etest/tmp_dir.h"
+#include "uri/uri.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+using etest::expect;
+using etest::expect_eq;
+using etest::require;
+using etest::TmpDir;
+using protocol::CachingHandler;
+using protocol::CachingHandlerStats;
+using protocol::Error;
+using protocol::Headers;
+using protocol::Response;
+
+namespace {
+
+// What the fake server saw, shared so that it outlives the handler.
+struct Server {
+    std::vector<Headers> requests;
+    std::vector<Response> responses;
+};
+
+// Answers each request with the next response.
+class FakeProtocolHandler final : public protocol::IProtocolHandler {
+public:
+    explicit FakeProtocolHandler(std::shared_ptr<Server> server) : server_{std::move(server)} {}
+
+    [[nodiscard]] Response handle(uri::Uri const &uri) override { return request(uri, {}, {}); }
+    [[nodiscard]] Response request(
+            uri::Uri const &, Headers const &headers, protocol::BodyDataCallback const &on_body_data) override {
+        server_->requests.push_back(headers);
+        if (server_->responses.empty()) {
+            return {Error::Unresolved};
+        }
+
+        auto response = std::move(server_->responses.front());
+        server_->responses.erase(server_->responses.begin());
+        if (on_body_data && !response.body.empty()) {
+            on_body_data(response, response.body);
+        }
+        return response;
+    }
+    void fetch(uri::Uri const &uri, Headers const &headers, protocol::ResponseCallback on_done) override {
+        on_done(request(uri, headers, {}));
+    }
+
+private:
+    std::shared_ptr<Server> server_;
+};
+
+Response ok(Headers headers, std::string body = "hello") {
+    return Response{
+            .status_line{"HTTP/1.1", 200, "OK"},
+            .headers = std::move(headers),
+            .body = std::move(body),
+    };
+}
+
+Response not_modified(Headers headers = {}) {
+    return Response{
+            .status_line{"HTTP/1.1", 304, "Not Modified"},
+            .headers = std::move(headers),
+    };
+}
+
+struct Fixture {
+    TmpDir dir;
+    std::shared_ptr<Server> server = std::make_shared<Server>();
+    CachingHandler handler{
+            std::make_unique<FakeProtocolHandler>(server), std::make_unique<protocol::HttpCache>(dir.path())};
+};
+
+auto const kUri = uri::Uri::parse("http://example.com/");
+
+} // namespace
+
+int main() {
+    etest::test("fresh responses are served from the cache", [] {
+        Fixture f;
+        f.server->responses = {ok({{"Cache-Control", "max-age=3600"}})};
+
+        expect_eq(f.handler.handle(kUri).body, "hello");
+        expect_eq(f.handler.handle(kUri).body, "hello");
+        expect_eq(protocol::fetch(f.handler, kUri).get().body, "hello");
+        expect_eq(f.server->requests.size(), std::size_t{1});
+        expect_eq(f.handler.stats(), CachingHandlerStats{.hits = 2, .misses = 1});
+    });
+
+    etest::test("cached responses are streamed", [] {
+        Fixture f;
+        f.server->responses = {ok({{"Cache-Control", "max-age=3600"}})};
+        expect_eq(f.handler.handle(kUri).body, "hello");
+
+        std::string streamed;
+        auto response = f.handler.stream(kUri, [&](Response const &r, std::string_view data) {
+            expect_eq(r.status_line.status_code, 200);
+            streamed += data;
+        });
+        expect_eq(response.body, "hello");
+        expect_eq(streamed, "hello");
+    });
+
+    etest::test("cached responses survive the handler", [] {
+        TmpDir dir;
+        auto server = std::make_shared<Server>();
+        server->responses = {ok({{"Cache-Control", "max-age=3600"}})};
+        {
+            CachingHandler handler{
+                    std::make_unique<FakeProtocolHandler>(server), std::make_unique<protocol::HttpCache>(dir.path())};
+            expect_eq(handler.handle(kUri).body, "hello");
+        }
+
+        CachingHandler handler{
+                std::make_unique<FakeProtocolHandler>(server), std::make_unique<protocol::HttpCache>(dir.path())};
+        expect_eq(handler.handle(kUri).body, "hello");
+        expect_eq(server->requests.size(), std::size_t{1});
+    });
+
+    etest::test("expires", [] {
+        Fixture f;
+        f.server->responses = {
+                ok({{"Expires", "Fri, 01 Jan 2100 00:00:00 GMT"}}),
+                ok({{"Expires", "Thu, 01 Jan 1970 00:00:00 GMT"}}, "goodbye"),
+                ok({{"Expires", "0"}}, "hello again"),
+        };
+        auto const other_uri = uri::Uri::parse("http://example.com/other");
+
+        expect_eq(f.handler.handle(kUri).body, "hello");
+        expect_eq(f.handler.handle(kUri).body, "hello");
+        expect_eq(f.handler.handle(other_uri).body, "goodbye");
+        expect_eq(f.handler.handle(other_uri).body, "hello again");
+        expect_eq(f.server->requests.size(), std::size_t{3});
+    });
+
+    etest::test("stale responses are revalidated", [] {
+        Fixture f;
+        f.server->responses = {
+                ok({{"Cache-Control", "max-age=0"},
+                        {"ETag", "\"1234\""},
+                        {"Last-Modified", "Sun, 06 Nov 1994 08:49:37 GMT"},
+                        {"Content-Length", "5"}}),
+                not_modified({{"Cache-Control", "max-age=3600"}, {"Content-Length", "0"}}),
+        };
+
+        expect_eq(f.handler.handle(kUri).body, "hello");
+
+        std::string streamed;
+        auto response = f.handler.stream(kUri, [&](Response const &, std::string_view data) { streamed += data; });
+        expect_eq(response.status_line.status_code, 200);
+        expect_eq(response.body, "hello");
+        expect_eq(response.headers.get("content-length"), "5");
+        expect_eq(streamed, "hello");
+
+        require(f.server->requests.size() == 2);
+        expect_eq(f.server->requests[1].get("if-none-match"), "\"1234\"");
+        expect_eq(f.server->requests[1].get("if-modified-since"), "Sun, 06 Nov 1994 08:49:37 GMT");
+
+        // The 304 made the response fresh.
+        expect_eq(f.handler.handle(kUri).body, "hello");
+        expect_eq(f.server->requests.size(), std::size_t{2});
+        expect_eq(f.handler.stats(), CachingHandlerStats{.hits = 1, .revalidated = 1, .misses = 1});
+    });
+
+    etest::test("changed responses replace cached ones", [] {
+        Fixture f;
+        f.server->responses = {
+                ok({{"Cache-Control", "no-cache"}, {"ETag", "\"1\""}}),
+                ok({{"Cache-Control", "no-cache"}, {"ETag", "\"2\""}}, "goodbye"),
+                not_modified(),
+        };
+
+        expect_eq(f.handler.handle(kUri).body, "hello");
+        expect_eq(protocol::fetch(f.handler, kUri).get().body, "goodbye");
+        expect_eq(protocol::fetch(f.handler, kUri).get().body, "goodbye");
+        require(f.server->requests.size() == 3);
+        expect_eq(f.server->requests[1].get("if-none-match"), "\"1\"");
+        expect_eq(f.server->requests[2].get("if-none-match"), "\"2\"");
+    });
+
+    etest::test("no-store", [] {
+        Fixture f;
+        f.server->responses = {
+                ok({{"Cache-Control", "max-age=3600, no-store"}}),
+                ok({{"Cache-Control", "max-age=3600"}}),
+        };
+
+        expect_eq(f.handler.handle(kUri).body, "hello");
+        expect_eq(f.handler.handle(kUri).body, "hello");
+        expect_eq(f.server->requests.size(), std::size_t{2});
+        expect_eq(f.server->requests[1].size(), std::size_t{0});
+    });
+
+    etest::test("responses without caching information aren't stored", [] {
+        Fixture f;
+        f.server->responses = {ok({{"Content-Type", "text/html"}}), ok({{"Content-Type", "text/html"}})};
+
+        expect_eq(f.handler.handle(kUri).body, "hello");
+        expect_eq(f.handler.handle(kUri).body, "hello");
+        expect_eq(f.server->requests.size(), std::size_t{2});
+    });
+
+    etest::test("heuristic freshness", [] {
+        Fixture f;
+        f.server->responses = {
+                ok({{"Date", "Sun, 06 Nov 1994 08:49:37 GMT"}, {"Last-Modified", "Sun, 06 Nov 1994 08:49:37 GMT"}}),
+                ok({{"Date", "Sun, 06 Nov 2044 08:49:37 GMT"}, {"Last-Modified", "Sun, 06 Nov 1994 08:49:37 GMT"}}),
+        };
+
+        // Unmodified for 0s, so fresh for 0s.
+        expect_eq(f.handler.handle(kUri).body, "hello");
+        expect_eq(f.handler.handle(kUri).body, "hello");
+        // Unmodified for 50 years, so fresh for 5 more.
+        expect_eq(f.handler.handle(kUri).body, "hello");
+        expect_eq(f.server->requests.size(), std::size_t{2});
+    });
+
+    etest::test("errors and other schemes aren't cached", [] {
+        Fixture f;
+        f.server->responses = {ok({{"Cache-Control", "max-age=3600"}}), ok({{"Cache-Control", "max-age=3600"}})};
+        auto const file_uri = uri::Uri::parse("file:///index.html");
+
+        expect_eq(f.handler.handle(file_uri).body, "hello");
+        expect_eq(f.handler.handle(file_uri).body, "hello");
+        expect_eq(f.handler.handle(file_uri).err, Error::Unresolved);
+        expect_eq(f.handler.handle(kUri).err, Error::Unresolved);
+        expect_eq(f.handler.stats(), CachingHandlerStats{.misses = 1});
+    });
+
+    return etest::run_all_tests();
+}
@@ -0,0 +1,111 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef PROTOCOL_CONNECTION_POOL_H_
+#define PROTOCOL_CONNECTION_POOL_H_
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace protocol {
+
+struct ConnectionPoolStats {
+    std::size_t hits{};
+    std::size_t misses{};
+    std::size_t evictions{};
+    [[nodiscard]] bool operator==(ConnectionPoolStats const &) const = default;
+};
+
+struct ConnectionPoolOptions {
+    std::size_t max_idle_per_origin{6};
+    std::chrono::steady_clock::duration idle_timeout{std::chrono::seconds{30}};
+};
+
+// Keeps idle keep-alive connections around, keyed on (scheme, host, port),
+// so that sequential requests to the same origin can skip the connection
+// setup. Safe to use from multiple threads.
+template<typename SocketT>
+class ConnectionPool {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit ConnectionPool(ConnectionPoolOptions opts = {}) : opts_{std::move(opts)} {}
+
+    // Returns an idle connection to the origin if one is available. Counts as
+    // a hit if one was found, otherwise as a miss.
+    [[nodiscard]] std::optional<SocketT> take(std::string_view origin) {
+        std::scoped_lock lock{mtx_};
+        auto now = Clock::now();
+        evict_expired(now);
+
+        auto it = idle_.find(origin);
+        if (it == end(idle_) || it->second.empty()) {
+            stats_.misses += 1;
+            return std::nullopt;
+        }
+
+        // Most recently used connections are the least likely to have been
+        // closed by the server.
+        auto socket = std::move(it->second.back().socket);
+        it->second.pop_back();
+        stats_.hits += 1;
+        return socket;
+    }
+
+    void put(std::string origin, SocketT socket) {
+        std::scoped_lock lock{mtx_};
+        auto &connections = idle_[std::move(origin)];
+        connections.push_back({std::move(socket), Clock::now()});
+        while (connections.size() > opts_.max_idle_per_origin) {
+            connections.erase(begin(connections));
+            stats_.evictions += 1;
+        }
+    }
+
+    [[nodiscard]] std::size_t idle_connections() const {
+        std::scoped_lock lock{mtx_};
+        std::size_t count{};
+        for (auto const &[_, connections] : idle_) {
+            count += connections.size();
+        }
+        return count;
+    }
+
+    [[nodiscard]] ConnectionPoolStats stats() const {
+        std::scoped_lock lock{mtx_};
+        return stats_;
+    }
+
+private:
+    struct IdleConnection {
+        SocketT socket;
+        Clock::time_point idle_since;
+    };
+
+    void evict_expired(Clock::time_point now) {
+        for (auto it = begin(idle_); it != end(idle_);) {
+            stats_.evictions += std::erase_if(
+                    it->second, [&](auto const &c) { return now - c.idle_since >= opts_.idle_timeout; });
+            it = it->second.empty() ? idle_.erase(it) : std::next(it);
+        }
+    }
+
+    ConnectionPoolOptions opts_;
+    mutable std::mutex mtx_;
+    std::map<std::string, std::vector<IdleConnection>, std::less<>> idle_;
+    ConnectionPoolStats stats_{};
+};
+
+} // namespace protocol
+
+#endif
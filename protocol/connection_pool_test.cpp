@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "protocol/connection_pool.h"
+
+#include "etest/etest.h"
+
+#include <chrono>
+
+using etest::expect;
+using etest::expect_eq;
+using etest::require;
+using protocol::ConnectionPool;
+using protocol::ConnectionPoolStats;
+
+namespace {
+
+struct FakeSocket {
+    int id{};
+};
+
+} // namespace
+
+int main() {
+    etest::test("empty pool", [] {
+        ConnectionPool<FakeSocket> pool;
+        expect(!pool.take("http://example.com").has_value());
+        expect_eq(pool.stats(), ConnectionPoolStats{.misses = 1});
+    });
+
+    etest::test("connections are keyed on origin", [] {
+        ConnectionPool<FakeSocket> pool;
+        pool.put("http://example.com", FakeSocket{1});
+        pool.put("https://example.com", FakeSocket{2});
+        expect_eq(pool.idle_connections(), std::size_t{2});
+
+        auto socket = pool.take("https://example.com");
+        require(socket.has_value());
+        expect_eq(socket->id, 2);
+        expect(!pool.take("https://example.com").has_value());
+        expect(!pool.take("http://example.com:8080").has_value());
+
+        socket = pool.take("http://example.com");
+        require(socket.has_value());
+        expect_eq(socket->id, 1);
+
+        expect_eq(pool.stats(), ConnectionPoolStats{.hits = 2, .misses = 2});
+        expect_eq(pool.idle_connections(), std::size_t{0});
+    });
+
+    etest::test("most recently used connection is reused first", [] {
+        ConnectionPool<FakeSocket> pool;
+        pool.put("http://example.com", FakeSocket{1});
+        pool.put("http://example.com", FakeSocket{2});
+        expect_eq(pool.take("http://example.com")->id, 2);
+        expect_eq(pool.take("http://example.com")->id, 1);
+    });
+
+    etest::test("max idle connections per origin", [] {
+        ConnectionPool<FakeSocket> pool{{.max_idle_per_origin = 2}};
+        pool.put("http://example.com", FakeSocket{1});
+        pool.put("http://example.com", FakeSocket{2});
+        pool.put("http://example.com", FakeSocket{3});
+        pool.put("http://example.org", FakeSocket{4});
+
+        expect_eq(pool.idle_connections(), std::size_t{3});
+        expect_eq(pool.stats(), ConnectionPoolStats{.evictions = 1});
+        expect_eq(pool.take("http://example.com")->id, 3);
+        expect_eq(pool.take("http://example.com")->id, 2);
+        expect(!pool.take("http://example.com").has_value());
+    });
+
+    etest::test("idle timeout", [] {
+        ConnectionPool<FakeSocket> pool{{.idle_timeout = std::chrono::seconds{0}}};
+        pool.put("http://example.com", FakeSocket{1});
+        pool.put("http://example.org", FakeSocket{2});
+
+        expect(!pool.take("http://example.com").has_value());
+        expect_eq(pool.idle_connections(), std::size_t{0});
+        expect_eq(pool.stats(), ConnectionPoolStats{.misses = 1, .evictions = 2});
+    });
+
+    return etest::run_all_tests();
+}
@@ -0,0 +1,155 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "protocol/content_decoder.h"
+
+#include "util/string.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace protocol {
+namespace {
+
+// https://github.com/madler/zlib/blob/v1.2.13/zlib.h#L832
+// The windowBits parameter is the base two logarithm of the
+// maximum window size (the size of the history buffer). It
+// should be in the range 8..15 for this version of the library.
+// <...>
+// windowBits can also be greater than 15 for optional gzip
+// decoding. Add 32 to windowBits to enable zlib and gzip
+// decoding with automatic header detection, or add 16 to decode
+// only the gzip format <...>.
+constexpr int kWindowBits = 15;
+constexpr int kEnableGzip = 32;
+
+// How much the output grows by at a time. Compressed text tends to inflate to
+// a few times its size.
+constexpr std::size_t kMinGrowth{std::size_t{4} * 1024};
+constexpr std::size_t kMaxGrowth{std::size_t{1024} * 1024};
+
+} // namespace
+
+struct ContentDecoder::Impl {
+    Impl() = default;
+    Impl(Impl const &) = delete;
+    Impl &operator=(Impl const &) = delete;
+    ~Impl() {
+        if (initialized) {
+            inflateEnd(&stream);
+        }
+    }
+
+    bool inflate(std::string_view data, std::string &out) {
+        stream.next_in = reinterpret_cast<Bytef const *>(data.data());
+        stream.avail_in = static_cast<uInt>(data.size());
+        do {
+            // Inflated straight into the end of the output, which is then
+            // shrunk to what was actually inflated.
+            auto const old_size = out.size();
+            auto const room = std::clamp(std::size_t{stream.avail_in} * 4, kMinGrowth, kMaxGrowth);
+            out.resize(old_size + room);
+            stream.next_out = reinterpret_cast<Bytef *>(out.data() + old_size);
+            stream.avail_out = static_cast<uInt>(room);
+            int const ret = ::inflate(&stream, Z_NO_FLUSH);
+            out.resize(old_size + room - stream.avail_out);
+
+            if (ret == Z_STREAM_END) {
+                done = true;
+                may_be_raw = false;
+                input_so_far.clear();
+                return true;
+            }
+
+            if (ret == Z_DATA_ERROR && may_be_raw) {
+                return retry_as_raw(out);
+            }
+
+            // No progress was possible, which is fine if everything's been consumed.
+            if (ret == Z_BUF_ERROR) {
+                return stream.avail_in == 0;
+            }
+
+            if (ret != Z_OK) {
+                return false;
+            }
+
+            if (may_be_raw && stream.total_out > 0) {
+                may_be_raw = false;
+                input_so_far = {};
+            }
+        } while (stream.avail_in > 0 || stream.avail_out == 0);
+
+        return true;
+    }
+
+    // Starts over, treating everything received so far as raw deflate data.
+    bool retry_as_raw(std::string &out) {
+        may_be_raw = false;
+        if (inflateReset2(&stream, -kWindowBits) != Z_OK) {
+            return false;
+        }
+
+        auto const input = std::move(input_so_far);
+        return inflate(input, out);
+    }
+
+    z_stream stream{};
+    bool initialized{};
+    bool done{};
+    // deflate is supposed to be zlib-wrapped, but some servers send it raw,
+    // which is only noticed once the zlib header fails to parse, so the input
+    // is kept around until then.
+    bool may_be_raw{};
+    std::string input_so_far{};
+};
+
+std::optional<ContentDecoder> ContentDecoder::create(std::string_view encoding) {
+    // https://developer.mozilla.org/en-US/docs/Web/HTTP/Headers/Content-Encoding#directives
+    encoding = util::trim(encoding);
+    bool const gzip = util::no_case_compare(encoding, "gzip") || util::no_case_compare(encoding, "x-gzip");
+    bool const deflate = util::no_case_compare(encoding, "deflate");
+    if (!gzip && !deflate) {
+        return std::nullopt;
+    }
+
+    auto impl = std::make_unique<Impl>();
+    if (inflateInit2(&impl->stream, kWindowBits + kEnableGzip) != Z_OK) {
+        return std::nullopt;
+    }
+
+    impl->initialized = true;
+    impl->may_be_raw = deflate;
+    return ContentDecoder{std::move(impl)};
+}
+
+ContentDecoder::ContentDecoder(std::unique_ptr<Impl> impl) : impl_{std::move(impl)} {}
+ContentDecoder::~ContentDecoder() = default;
+ContentDecoder::ContentDecoder(ContentDecoder &&) noexcept = default;
+ContentDecoder &ContentDecoder::operator=(ContentDecoder &&) noexcept = default;
+
+bool ContentDecoder::decode(std::string_view data, std::string &out) {
+    if (impl_->done || data.empty()) {
+        return true;
+    }
+
+    if (impl_->may_be_raw) {
+        impl_->input_so_far.append(data);
+    }
+
+    return impl_->inflate(data, out);
+}
+
+bool ContentDecoder::done() const {
+    return impl_->done;
+}
+
+} // namespace protocol
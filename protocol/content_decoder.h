@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef PROTOCOL_CONTENT_DECODER_H_
+#define PROTOCOL_CONTENT_DECODER_H_
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace protocol {
+
+// Undoes the Content-Encoding of a body as it's received, however it happens
+// to be split up, decoding straight into the end of the body.
+class ContentDecoder {
+public:
+    // Supports gzip, x-gzip, and deflate. Nothing for any other encoding.
+    [[nodiscard]] static std::optional<ContentDecoder> create(std::string_view encoding);
+
+    ~ContentDecoder();
+    ContentDecoder(ContentDecoder &&) noexcept;
+    ContentDecoder &operator=(ContentDecoder &&) noexcept;
+
+    // Appends what the data decodes to to out. False if the data is invalid.
+    // Anything following the end of the encoded data is ignored.
+    [[nodiscard]] bool decode(std::string_view data, std::string &out);
+    // If the end of the encoded data has been decoded.
+    [[nodiscard]] bool done() const;
+
+private:
+    struct Impl;
+    explicit ContentDecoder(std::unique_ptr<Impl>);
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace protocol
+
+#endif
@@ -0,0 +1,141 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "protocol/content_decoder.h"
+
+#include "etest/etest.h"
+
+#include <zlib.h>
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+using namespace std::literals;
+using etest::expect;
+using etest::expect_eq;
+using etest::require;
+using protocol::ContentDecoder;
+
+namespace {
+
+auto const kCss = "p { font-size: 123em; }\n"s;
+
+auto const kGzipped =
+        "\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\x03\x2b\x50\xa8\x56\x48\xcb\xcf\x2b\xd1\x2d\xce\xac\x4a\xb5\x52\x30\x34\x32\x4e\xcd\xb5\x56\xa8\xe5\x02\x00\x0c\x97\x72\x35\x18\x00\x00\x00"s;
+auto const kZlibWrapped =
+        "\x78\x9c\x2b\x50\xa8\x56\x48\xcb\xcf\x2b\xd1\x2d\xce\xac\x4a\xb5\x52\x30\x34\x32\x4e\xcd\xb5\x56\xa8\xe5\x02\x00\x63\xc3\x07\x6f"s;
+auto const kRawDeflate =
+        "\x2b\x50\xa8\x56\x48\xcb\xcf\x2b\xd1\x2d\xce\xac\x4a\xb5\x52\x30\x34\x32\x4e\xcd\xb5\x56\xa8\xe5\x02\x00"s;
+
+std::optional<std::string> decode(std::string_view encoding, std::string_view data) {
+    auto decoder = ContentDecoder::create(encoding);
+    std::string out;
+    if (!decoder || !decoder->decode(data, out) || !decoder->done()) {
+        return std::nullopt;
+    }
+
+    return out;
+}
+
+std::optional<std::string> decode_bytewise(std::string_view encoding, std::string_view data) {
+    auto decoder = ContentDecoder::create(encoding);
+    std::string out;
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        if (!decoder || !decoder->decode(data.substr(i, 1), out)) {
+            return std::nullopt;
+        }
+    }
+
+    return out;
+}
+
+} // namespace
+
+int main() {
+    etest::test("unsupported encodings", [] {
+        expect(!ContentDecoder::create("br").has_value());
+        expect(!ContentDecoder::create("identity").has_value());
+        expect(!ContentDecoder::create("gzip, br").has_value());
+    });
+
+    etest::test("gzip", [] {
+        expect_eq(decode("gzip", kGzipped), kCss);
+        expect_eq(decode("x-gzip", kGzipped), kCss);
+        expect_eq(decode(" GZip ", kGzipped), kCss);
+        expect_eq(decode_bytewise("gzip", kGzipped), kCss);
+    });
+
+    etest::test("deflate", [] {
+        expect_eq(decode("deflate", kZlibWrapped), kCss);
+        expect_eq(decode_bytewise("deflate", kZlibWrapped), kCss);
+    });
+
+    etest::test("deflate, without the zlib wrapping", [] {
+        expect_eq(decode("deflate", kRawDeflate), kCss);
+        expect_eq(decode_bytewise("deflate", kRawDeflate), kCss);
+        // Only deflate is sent raw.
+        expect_eq(decode("gzip", kRawDeflate), std::nullopt);
+    });
+
+    etest::test("bad header", [] {
+        auto gzipped = kGzipped;
+        gzipped[1] += 1;
+        expect_eq(decode("gzip", gzipped), std::nullopt);
+    });
+
+    etest::test("crc32 mismatch", [] {
+        auto gzipped = kGzipped;
+        gzipped[20] += 1;
+        expect_eq(decode("gzip", gzipped), std::nullopt);
+    });
+
+    etest::test("truncated data", [] {
+        auto decoder = ContentDecoder::create("gzip");
+        require(decoder.has_value());
+
+        std::string out;
+        expect(decoder->decode(std::string_view{kGzipped}.substr(0, 20), out));
+        expect(!decoder->done());
+    });
+
+    etest::test("data after the end is ignored", [] {
+        auto decoder = ContentDecoder::create("gzip");
+        require(decoder.has_value());
+
+        std::string out;
+        expect(decoder->decode(kGzipped + "garbage", out));
+        expect(decoder->done());
+        expect(decoder->decode("more garbage", out));
+        expect_eq(out, kCss);
+    });
+
+    etest::test("output is appended", [] {
+        std::string out = "hello";
+        auto decoder = ContentDecoder::create("gzip");
+        require(decoder.has_value());
+        expect(decoder->decode(kGzipped, out));
+        expect_eq(out, "hello" + kCss);
+    });
+
+    etest::test("highly compressed data", [] {
+        std::string const original(std::size_t{4} * 1024 * 1024, 'a');
+        std::string compressed(compressBound(static_cast<uLong>(original.size())), '\0');
+        auto compressed_size = static_cast<uLongf>(compressed.size());
+        require(compress(reinterpret_cast<Bytef *>(compressed.data()),
+                        &compressed_size,
+                        reinterpret_cast<Bytef const *>(original.data()),
+                        static_cast<uLong>(original.size()))
+                == Z_OK);
+        compressed.resize(compressed_size);
+
+        auto decoded = decode("deflate", compressed);
+        require(decoded.has_value());
+        expect_eq(decoded->size(), original.size());
+        expect(*decoded == original);
+    });
+
+    return etest::run_all_tests();
+}
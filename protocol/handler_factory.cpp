@@ -4,20 +4,37 @@
 
 #include "protocol/handler_factory.h"
 
+#include "protocol/caching_handler.h"
 #include "protocol/file_handler.h"
+#include "protocol/http_cache.h"
 #include "protocol/http_handler.h"
 #include "protocol/https_handler.h"
+#include "protocol/multi_protocol_handler.h"
 
+#include "net/async_socket.h"
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
 #include <utility>
 
 namespace protocol {
 
-std::unique_ptr<MultiProtocolHandler> HandlerFactory::create(std::optional<std::string> user_agent) {
+std::unique_ptr<IProtocolHandler> HandlerFactory::create(
+        std::optional<std::string> user_agent, std::optional<std::filesystem::path> cache_directory) {
+    // One thread is enough to wait on every request made with fetch.
+    auto loop = std::make_shared<net::EventLoop>(1);
     auto handler = std::make_unique<MultiProtocolHandler>();
-    handler->add("http", std::make_unique<HttpHandler>(user_agent));
-    handler->add("https", std::make_unique<HttpsHandler>(std::move(user_agent)));
+    handler->add("http", std::make_unique<HttpHandler>(user_agent, ConnectionPoolOptions{}, loop));
+    handler->add("https", std::make_unique<HttpsHandler>(std::move(user_agent), ConnectionPoolOptions{}, loop));
     handler->add("file", std::make_unique<FileHandler>());
-    return handler;
+    if (!cache_directory) {
+        return handler;
+    }
+
+    return std::make_unique<CachingHandler>(
+            std::move(handler), std::make_unique<HttpCache>(*std::move(cache_directory)));
 }
 
 } // namespace protocol
@@ -5,8 +5,9 @@
 #ifndef PROTOCOL_HANDLER_FACTORY_H_
 #define PROTOCOL_HANDLER_FACTORY_H_
 
-#include "protocol/multi_protocol_handler.h"
+#include "protocol/iprotocol_handler.h"
 
+#include <filesystem>
 #include <memory>
 #include <optional>
 #include <string>
@@ -15,8 +16,9 @@ namespace protocol {
 
 class HandlerFactory {
 public:
-    [[nodiscard]] static std::unique_ptr<MultiProtocolHandler> create(
-            std::optional<std::string> user_agent = std::nullopt);
+    // HTTP(S) responses are cached in the cache directory if there is one.
+    [[nodiscard]] static std::unique_ptr<IProtocolHandler> create(std::optional<std::string> user_agent = std::nullopt,
+            std::optional<std::filesystem::path> cache_directory = std::nullopt);
 };
 
 } // namespace protocol
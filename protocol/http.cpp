@@ -10,7 +10,11 @@
 #include <fmt/format.h>
 
 #include <charconv>
+#include <cstddef>
+#include <optional>
 #include <sstream>
+#include <string_view>
+#include <system_error>
 #include <utility>
 
 using namespace std::string_view_literals;
@@ -30,7 +34,18 @@ bool Http::use_port(uri::Uri const &uri) {
     return false;
 }
 
-std::string Http::create_get_request(uri::Uri const &uri, std::optional<std::string_view> user_agent) {
+std::string Http::origin(uri::Uri const &uri) {
+    if (Http::use_port(uri)) {
+        return fmt::format("{}://{}:{}", uri.scheme, uri.authority.host, uri.authority.port);
+    }
+
+    return fmt::format("{}://{}", uri.scheme, uri.authority.host);
+}
+
+std::string Http::create_get_request(uri::Uri const &uri,
+        std::optional<std::string_view> user_agent,
+        Connection connection,
+        Headers const &request_headers) {
     std::stringstream ss;
     ss << fmt::format("GET {} HTTP/1.1\r\n", uri.path);
     if (Http::use_port(uri)) {
@@ -39,11 +54,17 @@ std::string Http::create_get_request(uri::Uri const &uri, std::optional<std::str
         ss << fmt::format("Host: {}\r\n", uri.authority.host);
     }
     ss << "Accept: text/html\r\n";
-    ss << "Connection: close\r\n";
+    // Decoded by HttpResponseParser.
+    ss << "Accept-Encoding: gzip, deflate\r\n";
+    ss << (connection == Connection::KeepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
     if (user_agent) {
         ss << fmt::format("User-Agent: {}\r\n", *user_agent);
     }
 
+    for (auto const &[name, value] : request_headers) {
+        ss << fmt::format("{}: {}\r\n", name, value);
+    }
+
     ss << "\r\n";
 
     return std::move(ss).str();
@@ -85,4 +106,27 @@ Headers Http::parse_headers(std::string_view header) {
     return headers;
 }
 
+std::optional<std::size_t> Http::parse_content_length(std::string_view content_length) {
+    content_length = util::trim(content_length);
+    std::size_t length{};
+    auto res = std::from_chars(content_length.data(), content_length.data() + content_length.size(), length);
+    if (res.ec != std::errc{} || res.ptr != content_length.data() + content_length.size()) {
+        return std::nullopt;
+    }
+
+    return length;
+}
+
+// https://www.rfc-editor.org/rfc/rfc9112#section-6.3
+bool Http::has_body(int status_code) {
+    return !(status_code / 100 == 1 || status_code == 204 || status_code == 304);
+}
+
+// https://www.rfc-editor.org/rfc/rfc9112#section-9.3
+bool Http::is_keep_alive(StatusLine const &status_line, Headers const &headers) {
+    // We don't bother with HTTP/1.0 keep-alive.
+    auto connection = headers.get("connection"sv);
+    return status_line.version == "HTTP/1.1"sv && (!connection || !util::no_case_compare(*connection, "close"sv));
+}
+
 } // namespace protocol
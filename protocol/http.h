@@ -6,12 +6,14 @@
 #ifndef PROTOCOL_HTTP_H_
 #define PROTOCOL_HTTP_H_
 
+#include "protocol/connection_pool.h"
+#include "protocol/http_response_parser.h"
 #include "protocol/response.h"
 
 #include "uri/uri.h"
-#include "util/string.h"
 
-#include <charconv>
+#include <algorithm>
+#include <cstddef>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -21,94 +23,109 @@ namespace protocol {
 
 class Http {
 public:
-    static Response get(auto &&socket, uri::Uri const &uri, std::optional<std::string_view> user_agent) {
-        using namespace std::string_view_literals;
-
-        if (socket.connect(uri.authority.host, Http::use_port(uri) ? uri.authority.port : uri.scheme)) {
-            socket.write(Http::create_get_request(uri, std::move(user_agent)));
-            auto data = socket.read_until("\r\n"sv);
-            if (data.empty()) {
-                return {Error::Unresolved};
-            }
-            auto status_line = Http::parse_status_line(data.substr(0, data.size() - 2));
-            if (!status_line) {
-                return {Error::InvalidResponse};
-            }
-            data = socket.read_until("\r\n\r\n"sv);
-            if (data.empty()) {
-                return {Error::InvalidResponse, std::move(*status_line)};
-            }
-            auto headers = Http::parse_headers(data.substr(0, data.size() - 4));
-            if (headers.size() == 0) {
-                return {Error::InvalidResponse, std::move(*status_line)};
-            }
-            auto encoding = headers.get("transfer-encoding"sv);
-            if (encoding == "chunked"sv) {
-                if (auto body = Http::get_chunked_body(socket)) {
-                    data = *body;
-                } else {
-                    return {Error::InvalidResponse, std::move(*status_line)};
-                }
-            } else {
-                data = socket.read_all();
-            }
-            return {Error::Ok, std::move(*status_line), std::move(headers), std::move(data)};
+    static Response get(auto &&socket,
+            uri::Uri const &uri,
+            std::optional<std::string_view> user_agent,
+            BodyDataCallback const &on_body_data = {}) {
+        if (!socket.connect(uri.authority.host, Http::use_port(uri) ? uri.authority.port : uri.scheme)) {
+            return {Error::Unresolved};
         }
 
-        return {Error::Unresolved};
+        socket.write(Http::create_get_request(uri, std::move(user_agent), Connection::Close));
+        return Http::read_response(socket, on_body_data).response;
     }
 
-private:
-    static std::optional<std::string> get_chunked_body(auto &socket) {
-        using namespace std::literals;
-
-        std::string body{};
-        while (true) {
-            // Read first part of chunk
-            std::string bytes = socket.read_until("\r\n"sv);
-            bytes = util::trim(bytes);
-            if (bytes.empty()) {
-                break;
+    // Same as above, but reuses and returns keep-alive connections to the pool.
+    template<typename SocketT>
+    static Response get(ConnectionPool<SocketT> &pool,
+            uri::Uri const &uri,
+            std::optional<std::string_view> user_agent,
+            BodyDataCallback const &on_body_data = {},
+            Headers const &request_headers = {}) {
+        auto origin = Http::origin(uri);
+        auto request = Http::create_get_request(uri, std::move(user_agent), Connection::KeepAlive, request_headers);
+
+        if (auto socket = pool.take(origin)) {
+            socket->write(request);
+            auto result = Http::read_response(*socket, on_body_data);
+            // If nothing at all was read, the server most likely closed the
+            // connection while it was idle, so we retry on a new connection.
+            if (result.response.err != Error::Unresolved) {
+                if (result.reusable) {
+                    pool.put(std::move(origin), *std::move(socket));
+                }
+                return std::move(result.response);
             }
+        }
 
-            // TODO(mkiael): Handle chunk extensions
+        SocketT socket{};
+        if (!socket.connect(uri.authority.host, Http::use_port(uri) ? uri.authority.port : uri.scheme)) {
+            return {Error::Unresolved};
+        }
 
-            // Decode chunk size
-            std::size_t chunk_size{};
-            auto result = std::from_chars(bytes.data(), bytes.data() + bytes.size(), chunk_size, 16);
-            if (result.ec != std::errc()) {
-                break;
-            }
+        socket.write(request);
+        auto result = Http::read_response(socket, on_body_data);
+        if (result.reusable) {
+            pool.put(std::move(origin), std::move(socket));
+        }
 
-            // Check if this is the last chunk
-            if (chunk_size == 0) {
-                // TODO(mkiael): Handle trailer part
-                socket.read_until("\r\n"sv);
-                return body;
-            }
+        return std::move(result.response);
+    }
 
-            // Read chunk from socket
-            bytes = socket.read_bytes(chunk_size);
-            if (bytes.size() != chunk_size) {
-                break;
+private:
+    friend class HttpResponseParser;
+    template<typename>
+    friend class AsyncHttp;
+
+    enum class Connection {
+        Close,
+        KeepAlive,
+    };
+
+    struct ReadResult {
+        Response response;
+        // If the connection can be used for another request.
+        bool reusable{false};
+    };
+
+    static constexpr std::size_t kMaxReadSize{std::size_t{64} * 1024};
+
+    static ReadResult read_response(auto &socket, BodyDataCallback const &on_body_data) {
+        HttpResponseParser parser{on_body_data};
+        std::string data;
+        while (!parser.done()) {
+            // Reading exactly what the parser is waiting for leaves the
+            // connection at the start of the next response.
+            if (auto delimiter = parser.awaited_delimiter()) {
+                data = socket.read_until(*delimiter);
+            } else {
+                data.clear();
+                socket.read_some(data, std::min(parser.awaited_body_bytes(), kMaxReadSize));
             }
 
-            // Append chunk to body
-            body += bytes;
-
-            // Read trailing \r\n before continuing with the next chunk
-            bytes = socket.read_bytes(2);
-            if (bytes != "\r\n"s) {
+            if (data.empty()) {
+                parser.finish();
                 break;
             }
+
+            parser.feed(data);
         }
-        return std::nullopt;
+
+        bool reusable = parser.reusable();
+        return {parser.take_response(), reusable};
     }
 
     static bool use_port(uri::Uri const &uri);
-    static std::string create_get_request(uri::Uri const &uri, std::optional<std::string_view> user_agent);
+    static std::string origin(uri::Uri const &uri);
+    static std::string create_get_request(uri::Uri const &uri,
+            std::optional<std::string_view> user_agent,
+            Connection connection,
+            Headers const &request_headers = {});
     static std::optional<StatusLine> parse_status_line(std::string_view status_line);
     static Headers parse_headers(std::string_view header);
+    static std::optional<std::size_t> parse_content_length(std::string_view);
+    static bool has_body(int status_code);
+    static bool is_keep_alive(StatusLine const &, Headers const &);
 };
 
 } // namespace protocol
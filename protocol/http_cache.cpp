@@ -0,0 +1,405 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "protocol/http_cache.h"
+
+#include "util/string.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+using namespace std::literals;
+
+namespace protocol {
+namespace {
+
+// The index is a list of added, removed, and used entries, oldest first, so
+// replaying it puts the most recently used entries first.
+constexpr auto kIndexHeader = "hastur http cache index 3"sv;
+constexpr auto kAdded = "+"sv;
+constexpr auto kRemoved = "-"sv;
+constexpr auto kUsed = "~"sv;
+// Fewer stale lines than this aren't worth rewriting the index for.
+constexpr std::size_t kMinStaleIndexLines{256};
+constexpr auto kEntryHeader = "hastur http cache entry 1"sv;
+constexpr auto kIndexFileName = "index"sv;
+
+template<typename T>
+std::optional<T> to_int(std::string_view s) {
+    T value{};
+    if (auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+            ec != std::errc{} || ptr != s.data() + s.size()) {
+        return std::nullopt;
+    }
+
+    return value;
+}
+
+// FNV-1a, as the file names have to stay the same between runs.
+std::uint64_t hash(std::string_view s) {
+    std::uint64_t h{0xcbf29ce484222325};
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 0x100000001b3;
+    }
+    return h;
+}
+
+// Entries are saved as lines of tab-separated fields followed by the body.
+bool is_saveable(std::string_view s) {
+    return s.find_first_of("\n\r") == std::string_view::npos;
+}
+
+std::optional<std::string> serialize(std::string_view url, CachedResponse const &cached) {
+    auto const &response = cached.response;
+    if (!is_saveable(url) || !is_saveable(response.status_line.version) || !is_saveable(response.status_line.reason)) {
+        return std::nullopt;
+    }
+
+    auto const stored_at =
+            std::chrono::duration_cast<std::chrono::seconds>(cached.stored_at.time_since_epoch()).count();
+    std::string out = fmt::format("{}\n{}\n{}\n{}\t{}\t{}\n{}\n",
+            kEntryHeader,
+            url,
+            stored_at,
+            response.status_line.version,
+            response.status_line.status_code,
+            response.status_line.reason,
+            response.headers.size());
+    for (auto const &[name, value] : response.headers) {
+        if (!is_saveable(name) || !is_saveable(value) || name.find('\t') != std::string::npos) {
+            return std::nullopt;
+        }
+        out += fmt::format("{}\t{}\n", name, value);
+    }
+
+    out += fmt::format("{}\n", response.body.size());
+    out += response.body;
+    return out;
+}
+
+// The URL an entry file was saved for.
+std::optional<std::string> stored_url(std::filesystem::path const &path) {
+    std::ifstream in{path, std::ios::binary};
+    std::string line;
+    if (!std::getline(in, line) || line != kEntryHeader || !std::getline(in, line)) {
+        return std::nullopt;
+    }
+
+    return line;
+}
+
+std::optional<CachedResponse> deserialize(std::string_view url, std::istream &in) {
+    std::string line;
+    if (!std::getline(in, line) || line != kEntryHeader) {
+        return std::nullopt;
+    }
+
+    // Different URLs may hash to the same file.
+    if (!std::getline(in, line) || line != url) {
+        return std::nullopt;
+    }
+
+    std::optional<std::int64_t> stored_at;
+    if (!std::getline(in, line) || !(stored_at = to_int<std::int64_t>(line))) {
+        return std::nullopt;
+    }
+
+    CachedResponse cached{.stored_at = std::chrono::system_clock::time_point{std::chrono::seconds{*stored_at}}};
+    auto &response = cached.response;
+
+    if (!std::getline(in, line)) {
+        return std::nullopt;
+    }
+    auto status_fields = util::split(line, "\t");
+    std::optional<int> status_code;
+    if (status_fields.size() != 3 || !(status_code = to_int<int>(status_fields[1]))) {
+        return std::nullopt;
+    }
+    response.status_line = {std::string{status_fields[0]}, *status_code, std::string{status_fields[2]}};
+
+    std::optional<std::size_t> header_count;
+    if (!std::getline(in, line) || !(header_count = to_int<std::size_t>(line))) {
+        return std::nullopt;
+    }
+    for (std::size_t i = 0; i < *header_count; ++i) {
+        if (!std::getline(in, line)) {
+            return std::nullopt;
+        }
+        response.headers.add(util::split_once(line, "\t"));
+    }
+
+    std::optional<std::size_t> body_size;
+    if (!std::getline(in, line) || !(body_size = to_int<std::size_t>(line))) {
+        return std::nullopt;
+    }
+    response.body.resize(*body_size);
+    if (!in.read(response.body.data(), static_cast<std::streamsize>(response.body.size()))) {
+        return std::nullopt;
+    }
+
+    return cached;
+}
+
+} // namespace
+
+HttpCache::HttpCache(std::filesystem::path directory, std::size_t max_size)
+    : directory_{std::move(directory)}, max_size_{max_size} {
+    std::error_code errc;
+    std::filesystem::create_directories(directory_, errc);
+
+    {
+        std::ifstream file{directory_ / kIndexFileName};
+        std::string line;
+        if (std::getline(file, line) && line == kIndexHeader) {
+            while (std::getline(file, line)) {
+                auto [op, fields] = util::split_once(line, "\t");
+                if (op == kUsed) {
+                    if (auto it = index_.find(fields); it != index_.end()) {
+                        entries_.splice(entries_.begin(), entries_, it->second);
+                    }
+                    continue;
+                }
+
+                auto [size, url] = op == kAdded ? util::split_once(fields, "\t") : std::pair{""sv, fields};
+                if (auto it = index_.find(url); it != index_.end()) {
+                    forget(it->second);
+                }
+
+                auto entry_size = to_int<std::size_t>(size);
+                if (op != kAdded || !entry_size) {
+                    continue;
+                }
+
+                insert(std::string{url}, *entry_size);
+            }
+        }
+    }
+
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        auto next = std::next(it);
+        if (!std::filesystem::exists(file_path(it->url), errc)) {
+            forget(it);
+        }
+        it = next;
+    }
+
+    // The limit may have been lowered since the index was saved.
+    evict();
+    save_index();
+}
+
+HttpCache::~HttpCache() {
+    std::lock_guard lock{mtx_};
+    save_index();
+}
+
+std::optional<CachedResponse> HttpCache::get(std::string_view url) {
+    std::uint64_t generation{};
+    {
+        std::lock_guard lock{mtx_};
+        auto it = index_.find(url);
+        if (it == index_.end()) {
+            return std::nullopt;
+        }
+
+        generation = it->second->generation;
+        use(it->second);
+    }
+
+    // Read without holding the lock. Files are only ever replaced by renaming
+    // a complete one over them, and one that's removed while being read stays
+    // readable until it's closed.
+    std::ifstream file{file_path(url), std::ios::binary};
+    auto cached = deserialize(url, file);
+    if (!cached) {
+        std::lock_guard lock{mtx_};
+        // Unless the entry was replaced while it was being read.
+        if (auto it = index_.find(url); it != index_.end() && it->second->generation == generation) {
+            erase(it->second);
+        }
+    }
+
+    return cached;
+}
+
+void HttpCache::put(std::string const &url, CachedResponse const &cached) {
+    auto data = serialize(url, cached);
+    if (!data || data->size() > max_size_) {
+        remove(url);
+        return;
+    }
+
+    // Written to a temporary file first so that no one reads a half-written
+    // entry, and without holding the lock. Each put gets its own file, as
+    // there may be several of the same URL going on at once.
+    auto const path = file_path(url);
+    auto tmp = path;
+    tmp += fmt::format(".{}.tmp", tmp_files_++);
+    {
+        std::ofstream file{tmp, std::ios::binary | std::ios::trunc};
+        if (!file.write(data->data(), static_cast<std::streamsize>(data->size())) || !file.flush()) {
+            file.close();
+            std::error_code errc;
+            std::filesystem::remove(tmp, errc);
+            remove(url);
+            return;
+        }
+    }
+
+    // Another URL with the same hash loses its entry to this one. If the file
+    // changes hands again before the lock is taken, the stale entry is
+    // dropped the next time it's read.
+    auto const other = stored_url(path);
+
+    // The old entry's file is left for the rename to replace, so that readers
+    // always find one of them.
+    std::lock_guard lock{mtx_};
+    if (auto it = index_.find(url); it != index_.end()) {
+        forget(it->second);
+    }
+
+    if (other && *other != url) {
+        if (auto it = index_.find(*other); it != index_.end()) {
+            append_to_index(fmt::format("{}\t{}", kRemoved, *other));
+            forget(it->second);
+        }
+    }
+
+    std::error_code errc;
+    std::filesystem::rename(tmp, path, errc);
+    if (errc) {
+        std::filesystem::remove(tmp, errc);
+        if (stored_url(path) == url) {
+            std::filesystem::remove(path, errc);
+        }
+        return;
+    }
+
+    insert(url, data->size());
+    append_to_index(fmt::format("{}\t{}\t{}", kAdded, data->size(), url));
+    evict();
+    compact_index_if_stale();
+}
+
+void HttpCache::remove(std::string_view url) {
+    std::lock_guard lock{mtx_};
+    if (auto it = index_.find(url); it != index_.end()) {
+        erase(it->second);
+    }
+}
+
+std::size_t HttpCache::size() const {
+    std::lock_guard lock{mtx_};
+    return size_;
+}
+
+std::size_t HttpCache::entry_count() const {
+    std::lock_guard lock{mtx_};
+    return entries_.size();
+}
+
+std::filesystem::path HttpCache::file_path(std::string_view url) const {
+    return directory_ / fmt::format("{:016x}", hash(url));
+}
+
+void HttpCache::erase(std::list<Entry>::iterator it) {
+    auto const path = file_path(it->url);
+    if (stored_url(path) == it->url) {
+        std::error_code errc;
+        std::filesystem::remove(path, errc);
+    }
+
+    append_to_index(fmt::format("{}\t{}", kRemoved, it->url));
+    forget(it);
+}
+
+void HttpCache::insert(std::string url, std::size_t size) {
+    entries_.push_front(Entry{std::move(url), size, next_generation_++});
+    index_.emplace(entries_.front().url, entries_.begin());
+    size_ += size;
+}
+
+void HttpCache::use(std::list<Entry>::iterator it) {
+    if (it == entries_.begin()) {
+        return;
+    }
+
+    entries_.splice(entries_.begin(), entries_, it);
+    // Not flushed, as losing the last few uses if the program crashes is
+    // better than a write for every one of them.
+    index_file_ << kUsed << '\t' << it->url << '\n';
+    ++index_lines_;
+    compact_index_if_stale();
+}
+
+void HttpCache::forget(std::list<Entry>::iterator it) {
+    size_ -= it->size;
+    index_.erase(it->url);
+    entries_.erase(it);
+}
+
+void HttpCache::evict() {
+    while (size_ > max_size_ && !entries_.empty()) {
+        erase(std::prev(entries_.end()));
+    }
+}
+
+void HttpCache::append_to_index(std::string_view line) {
+    index_file_ << line << '\n';
+    index_file_.flush();
+    ++index_lines_;
+}
+
+void HttpCache::compact_index_if_stale() {
+    if (index_lines_ > std::max(entries_.size() * 2, kMinStaleIndexLines)) {
+        save_index();
+    }
+}
+
+void HttpCache::save_index() {
+    index_file_.close();
+    index_lines_ = 0;
+
+    auto const path = directory_ / kIndexFileName;
+    auto tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream file{tmp, std::ios::trunc};
+        file << kIndexHeader << '\n';
+        for (auto it = entries_.rbegin(); it != entries_.rend(); ++it) {
+            file << kAdded << '\t' << it->size << '\t' << it->url << '\n';
+        }
+
+        if (!file.flush()) {
+            return;
+        }
+    }
+
+    std::error_code errc;
+    std::filesystem::rename(tmp, path, errc);
+    if (errc) {
+        return;
+    }
+
+    index_file_.open(path, std::ios::app);
+    index_lines_ = entries_.size();
+}
+
+} // namespace protocol
@@ -0,0 +1,98 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef PROTOCOL_HTTP_CACHE_H_
+#define PROTOCOL_HTTP_CACHE_H_
+
+#include "protocol/response.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace protocol {
+
+struct CachedResponse {
+    Response response;
+    // When the response was received, or last revalidated.
+    std::chrono::system_clock::time_point stored_at;
+
+    [[nodiscard]] bool operator==(CachedResponse const &) const = default;
+};
+
+// Responses stored on disk, one file per URL, with an index listing them in
+// the order they were last used so that the least recently used ones can be
+// evicted to keep the cache below its size limit. Additions, removals, and
+// uses are appended to the index as they happen, and it's only rewritten from
+// scratch once it's mostly stale lines, or when the cache is closed. Safe to
+// use from multiple threads, and responses are read and written without
+// blocking other threads, but only one cache may use a directory at a time.
+class HttpCache {
+public:
+    static constexpr std::size_t kDefaultMaxSize{std::size_t{64} * 1024 * 1024};
+
+    // Picks up whatever an earlier cache left in the directory.
+    explicit HttpCache(std::filesystem::path directory, std::size_t max_size = kDefaultMaxSize);
+    ~HttpCache();
+
+    HttpCache(HttpCache const &) = delete;
+    HttpCache &operator=(HttpCache const &) = delete;
+
+    [[nodiscard]] std::optional<CachedResponse> get(std::string_view url);
+    // Responses larger than the whole cache aren't stored.
+    void put(std::string const &url, CachedResponse const &);
+    void remove(std::string_view url);
+
+    // The total size of the stored responses in bytes.
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] std::size_t entry_count() const;
+
+private:
+    struct Entry {
+        std::string url;
+        std::size_t size{};
+        // Tells apart the entries a URL has had over time.
+        std::uint64_t generation{};
+    };
+
+    [[nodiscard]] std::filesystem::path file_path(std::string_view url) const;
+    // Drops the entry from the index, and its file if no other URL with the
+    // same hash has replaced it since.
+    void erase(std::list<Entry>::iterator);
+    // Adds an entry as the most recently used one.
+    void insert(std::string url, std::size_t size);
+    // Makes the entry the most recently used one.
+    void use(std::list<Entry>::iterator);
+    void forget(std::list<Entry>::iterator);
+    void evict();
+    void append_to_index(std::string_view line);
+    void compact_index_if_stale();
+    void save_index();
+
+    std::filesystem::path directory_;
+    std::size_t max_size_;
+    mutable std::mutex mtx_;
+    // The most recently used first.
+    std::list<Entry> entries_;
+    std::map<std::string, std::list<Entry>::iterator, std::less<>> index_;
+    std::size_t size_{};
+    std::ofstream index_file_;
+    std::size_t index_lines_{};
+    std::uint64_t next_generation_{};
+    std::atomic<std::uint64_t> tmp_files_{};
+};
+
+} // namespace protocol
+
+#endif
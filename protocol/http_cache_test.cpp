@@ -0,0 +1,260 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "protocol/http_cache.h"
+
+#include "protocol/response.h"
+
+#include "etest/etest.h"
+#include "etest/tmp_dir.h"
+
+#include <fmt/format.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace std::literals;
+using etest::expect;
+using etest::expect_eq;
+using etest::require;
+using etest::TmpDir;
+using protocol::CachedResponse;
+using protocol::HttpCache;
+
+namespace {
+
+CachedResponse cached_response(std::string body) {
+    return CachedResponse{
+            .response{
+                    .status_line{"HTTP/1.1", 200, "OK"},
+                    .headers{{"ETag", "\"1234\""}, {"Cache-Control", "max-age=60"}},
+                    .body = std::move(body),
+            },
+            .stored_at = std::chrono::system_clock::time_point{std::chrono::seconds{1700000000}},
+    };
+}
+
+} // namespace
+
+int main() {
+    etest::test("put and get", [] {
+        TmpDir dir;
+        HttpCache cache{dir.path()};
+        expect_eq(cache.get("http://example.com/"), std::nullopt);
+
+        auto const response = cached_response("hello\r\nworld\n\0!"s);
+        cache.put("http://example.com/", response);
+        expect_eq(cache.get("http://example.com/"), response);
+        expect_eq(cache.get("http://example.com/other"), std::nullopt);
+        expect_eq(cache.entry_count(), std::size_t{1});
+    });
+
+    etest::test("entries are replaced", [] {
+        TmpDir dir;
+        HttpCache cache{dir.path()};
+        cache.put("http://example.com/", cached_response("hello"));
+        auto const size = cache.size();
+
+        cache.put("http://example.com/", cached_response("goodbye"));
+        expect_eq(cache.get("http://example.com/")->response.body, "goodbye");
+        expect_eq(cache.entry_count(), std::size_t{1});
+        expect_eq(cache.size(), size + 2);
+    });
+
+    etest::test("remove", [] {
+        TmpDir dir;
+        HttpCache cache{dir.path()};
+        cache.put("http://example.com/", cached_response("hello"));
+        cache.remove("http://example.com/");
+        expect_eq(cache.get("http://example.com/"), std::nullopt);
+        expect_eq(cache.size(), std::size_t{0});
+    });
+
+    etest::test("entries are kept between runs", [] {
+        TmpDir dir;
+        auto const response = cached_response("hello");
+        HttpCache{dir.path()}.put("http://example.com/", response);
+
+        HttpCache cache{dir.path()};
+        expect_eq(cache.entry_count(), std::size_t{1});
+        expect_eq(cache.get("http://example.com/"), response);
+    });
+
+    etest::test("least recently used entries are evicted", [] {
+        TmpDir dir;
+        std::size_t entry_size{};
+        {
+            HttpCache cache{dir.path()};
+            cache.put("http://example.com/", cached_response("hello"));
+            entry_size = cache.size();
+        }
+
+        // Room for 2 entries.
+        HttpCache cache{dir.path(), entry_size * 5 / 2};
+
+        cache.put("http://example.com/a", cached_response("hello"));
+        cache.put("http://example.com/b", cached_response("hello"));
+        expect_eq(cache.get("http://example.com/"), std::nullopt);
+        expect(cache.get("http://example.com/a").has_value());
+
+        cache.put("http://example.com/c", cached_response("hello"));
+        expect(cache.get("http://example.com/a").has_value());
+        expect_eq(cache.get("http://example.com/b"), std::nullopt);
+        expect(cache.get("http://example.com/c").has_value());
+        expect_eq(cache.entry_count(), std::size_t{2});
+    });
+
+    etest::test("the order entries were used in is kept between runs", [] {
+        TmpDir dir;
+        std::size_t entry_size{};
+        {
+            HttpCache cache{dir.path()};
+            cache.put("http://example.com/a", cached_response("hello"));
+            cache.put("http://example.com/b", cached_response("hello"));
+            expect(cache.get("http://example.com/a").has_value());
+            entry_size = cache.size() / 2;
+        }
+
+        // Only room for 1 entry, so the least recently used one is dropped.
+        HttpCache cache{dir.path(), entry_size};
+        expect_eq(cache.entry_count(), std::size_t{1});
+        expect(cache.get("http://example.com/a").has_value());
+    });
+
+    etest::test("the index is kept up to date while the cache is open", [] {
+        TmpDir dir;
+        TmpDir copy;
+        HttpCache cache{dir.path()};
+        cache.put("http://example.com/a", cached_response("hello"));
+        cache.put("http://example.com/b", cached_response("hello"));
+        cache.remove("http://example.com/a");
+
+        // As if the first cache never got to save its index when closing.
+        fs::copy(dir.path(), copy.path(), fs::copy_options::recursive | fs::copy_options::overwrite_existing);
+        HttpCache copied{copy.path()};
+        expect_eq(copied.entry_count(), std::size_t{1});
+        expect_eq(copied.size(), cache.size());
+        expect(copied.get("http://example.com/b").has_value());
+    });
+
+    etest::test("uses are added to the index while the cache is open", [] {
+        TmpDir dir;
+        TmpDir copy;
+        HttpCache cache{dir.path()};
+        cache.put("http://example.com/a", cached_response("hello"));
+        auto const entry_size = cache.size();
+        cache.put("http://example.com/b", cached_response("hello"));
+        expect(cache.get("http://example.com/a").has_value());
+        cache.put("http://example.com/c", cached_response("hello"));
+
+        // Room for 2 entries, so the least recently used one, b, is dropped.
+        fs::copy(dir.path(), copy.path(), fs::copy_options::recursive | fs::copy_options::overwrite_existing);
+        HttpCache copied{copy.path(), entry_size * 5 / 2};
+        expect_eq(copied.entry_count(), std::size_t{2});
+        expect(copied.get("http://example.com/a").has_value());
+        expect(copied.get("http://example.com/c").has_value());
+    });
+
+    etest::test("concurrent gets and puts", [] {
+        TmpDir dir;
+        HttpCache cache{dir.path()};
+        std::atomic<int> failed_gets{};
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; ++i) {
+            threads.emplace_back([&cache, &failed_gets, i] {
+                for (int j = 0; j < 50; ++j) {
+                    auto const url = fmt::format("http://example.com/{}", j % 5);
+                    cache.put(url, cached_response(std::to_string(i)));
+                    // Another thread may have replaced it, but never with half a response.
+                    if (auto cached = cache.get(url); !cached || cached->response.body.size() != 1) {
+                        ++failed_gets;
+                    }
+                }
+            });
+        }
+
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        expect_eq(failed_gets.load(), 0);
+        expect_eq(cache.entry_count(), std::size_t{5});
+        std::size_t files{};
+        for (auto const &file : fs::directory_iterator{dir.path()}) {
+            files += file.path().filename() != "index" ? 1 : 0;
+        }
+        expect_eq(files, std::size_t{5});
+    });
+
+    etest::test("entries taken over by a URL with the same hash aren't deleted", [] {
+        TmpDir dir;
+        TmpDir other_dir;
+        auto const response = cached_response("hello");
+        HttpCache{other_dir.path()}.put("http://example.com/b", response);
+
+        HttpCache cache{dir.path()};
+        cache.put("http://example.com/a", cached_response("hello"));
+
+        // Make a's file look like it belongs to b, as if their hashes collided.
+        for (auto const &file : fs::directory_iterator{dir.path()}) {
+            if (file.path().filename() != "index") {
+                for (auto const &other_file : fs::directory_iterator{other_dir.path()}) {
+                    if (other_file.path().filename() != "index") {
+                        fs::copy_file(other_file.path(), file.path(), fs::copy_options::overwrite_existing);
+                    }
+                }
+            }
+        }
+
+        expect_eq(cache.get("http://example.com/a"), std::nullopt);
+        expect_eq(cache.entry_count(), std::size_t{0});
+        std::size_t files{};
+        for (auto const &file : fs::directory_iterator{dir.path()}) {
+            files += file.path().filename() != "index" ? 1 : 0;
+        }
+        expect_eq(files, std::size_t{1});
+    });
+
+    etest::test("entries larger than the cache aren't stored", [] {
+        TmpDir dir;
+        HttpCache cache{dir.path(), 10};
+        cache.put("http://example.com/", cached_response("hello"));
+        expect_eq(cache.get("http://example.com/"), std::nullopt);
+        expect_eq(cache.size(), std::size_t{0});
+    });
+
+    etest::test("broken entries are dropped", [] {
+        TmpDir dir;
+        HttpCache cache{dir.path()};
+        cache.put("http://example.com/", cached_response("hello"));
+
+        for (auto const &file : fs::directory_iterator{dir.path()}) {
+            if (file.path().filename() != "index") {
+                std::ofstream{file.path(), std::ios::trunc} << "hastur http cache entry 1\nhttp://example.com/\n";
+            }
+        }
+
+        expect_eq(cache.get("http://example.com/"), std::nullopt);
+        expect_eq(cache.entry_count(), std::size_t{0});
+    });
+
+    etest::test("unusable directory", [] {
+        TmpDir dir;
+        std::ofstream{dir.path() / "file"} << "not a directory";
+        HttpCache cache{dir.path() / "file"};
+        cache.put("http://example.com/", cached_response("hello"));
+        expect_eq(cache.get("http://example.com/"), std::nullopt);
+        require(fs::is_regular_file(dir.path() / "file"));
+    });
+
+    return etest::run_all_tests();
+}
@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2021-2022 Robin Lindén <dev@robinlinden.eu>
+// SPDX-FileCopyrightText: 2021-2023 Robin Lindén <dev@robinlinden.eu>
 // SPDX-FileCopyrightText: 2021 Mikael Larsson <c.mikael.larsson@gmail.com>
 //
 // SPDX-License-Identifier: BSD-2-Clause
@@ -8,10 +8,25 @@
 #include "net/socket.h"
 #include "protocol/http.h"
 
+#include <utility>
+
 namespace protocol {
 
 Response HttpHandler::handle(uri::Uri const &uri) {
-    return Http::get(net::Socket{}, uri, user_agent_);
+    return Http::get(pool_, uri, user_agent_);
+}
+
+Response HttpHandler::stream(uri::Uri const &uri, BodyDataCallback const &on_body_data) {
+    return Http::get(pool_, uri, user_agent_, on_body_data);
+}
+
+Response HttpHandler::request(
+        uri::Uri const &uri, Headers const &request_headers, BodyDataCallback const &on_body_data) {
+    return Http::get(pool_, uri, user_agent_, on_body_data, request_headers);
+}
+
+void HttpHandler::fetch(uri::Uri const &uri, Headers const &request_headers, ResponseCallback on_done) {
+    async_.get(uri, request_headers, std::move(on_done));
 }
 
 } // namespace protocol
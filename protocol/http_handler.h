@@ -1,12 +1,18 @@
-// SPDX-FileCopyrightText: 2022 Robin Lindén <dev@robinlinden.eu>
+// SPDX-FileCopyrightText: 2022-2023 Robin Lindén <dev@robinlinden.eu>
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
 #ifndef PROTOCOL_HTTP_HANDLER_H_
 #define PROTOCOL_HTTP_HANDLER_H_
 
+#include "protocol/async_http.h"
+#include "protocol/connection_pool.h"
 #include "protocol/iprotocol_handler.h"
 
+#include "net/async_socket.h"
+#include "net/socket.h"
+
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
@@ -15,12 +21,26 @@ namespace protocol {
 
 class HttpHandler final : public IProtocolHandler {
 public:
-    explicit HttpHandler(std::optional<std::string> user_agent) : user_agent_{std::move(user_agent)} {}
+    // Requests made using fetch share the event loop's threads with every
+    // other handler using the same loop.
+    explicit HttpHandler(std::optional<std::string> user_agent,
+            ConnectionPoolOptions pool_options = {},
+            std::shared_ptr<net::EventLoop> loop = std::make_shared<net::EventLoop>())
+        : user_agent_{user_agent}, pool_{pool_options}, loop_{std::move(loop)},
+          async_{[&l = *loop_] { return net::AsyncSocket{l}; }, std::move(user_agent), std::move(pool_options)} {}
 
     [[nodiscard]] Response handle(uri::Uri const &) override;
+    [[nodiscard]] Response stream(uri::Uri const &, BodyDataCallback const &) override;
+    [[nodiscard]] Response request(uri::Uri const &, Headers const &, BodyDataCallback const &) override;
+    void fetch(uri::Uri const &, Headers const &, ResponseCallback) override;
+
+    [[nodiscard]] ConnectionPoolStats connection_pool_stats() const { return pool_.stats(); }
 
 private:
     std::optional<std::string> user_agent_;
+    ConnectionPool<net::Socket> pool_;
+    std::shared_ptr<net::EventLoop> loop_;
+    AsyncHttp<net::AsyncSocket> async_;
 };
 
 } // namespace protocol
@@ -0,0 +1,311 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "protocol/http_response_parser.h"
+
+#include "protocol/http.h"
+
+#include "util/string.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+using namespace std::literals;
+
+namespace protocol {
+namespace {
+
+// Upper bound for how much we allocate up front based on what the server
+// tells us the body size will be.
+constexpr std::size_t kMaxBodyReservation{std::size_t{16} * 1024 * 1024};
+
+} // namespace
+
+bool HttpResponseParser::feed(std::string_view data) {
+    while (stage_ != Stage::Done) {
+        switch (stage_) {
+            case Stage::StatusLine: {
+                auto line = take_until(data, "\r\n"sv);
+                if (!line) {
+                    return false;
+                }
+
+                auto status_line = Http::parse_status_line(*line);
+                if (!status_line) {
+                    fail(Error::InvalidResponse);
+                    break;
+                }
+
+                response_.status_line = *std::move(status_line);
+                stage_ = Stage::Headers;
+                break;
+            }
+            case Stage::Headers: {
+                auto headers = take_until(data, "\r\n\r\n"sv);
+                if (!headers) {
+                    return false;
+                }
+
+                response_.headers = Http::parse_headers(*headers);
+                if (response_.headers.size() == 0) {
+                    fail(Error::InvalidResponse);
+                    break;
+                }
+
+                on_headers_parsed();
+                break;
+            }
+            case Stage::Body:
+                append_body(data, remaining_);
+                if (done()) {
+                    break;
+                }
+
+                if (remaining_ > 0) {
+                    return false;
+                }
+
+                complete(true);
+                break;
+            case Stage::BodyUntilClose:
+                append_body(data, data.size());
+                return done();
+            case Stage::ChunkSize: {
+                auto line = take_until(data, "\r\n"sv);
+                if (!line) {
+                    return false;
+                }
+
+                // TODO(mkiael): Handle chunk extensions
+                auto size = util::trim(*line);
+                std::size_t chunk_size{};
+                if (size.empty()
+                        || std::from_chars(size.data(), size.data() + size.size(), chunk_size, 16).ec != std::errc{}) {
+                    fail(Error::InvalidResponse);
+                    break;
+                }
+
+                remaining_ = chunk_size;
+                stage_ = chunk_size == 0 ? Stage::Trailer : Stage::ChunkData;
+                break;
+            }
+            case Stage::ChunkData:
+                append_body(data, remaining_);
+                if (done()) {
+                    break;
+                }
+
+                if (remaining_ > 0) {
+                    return false;
+                }
+
+                stage_ = Stage::ChunkEnd;
+                break;
+            case Stage::ChunkEnd: {
+                // The chunk has to be followed by an empty line.
+                auto line = take_until(data, "\r\n"sv);
+                if (!line) {
+                    return false;
+                }
+
+                if (!line->empty()) {
+                    fail(Error::InvalidResponse);
+                    break;
+                }
+
+                stage_ = Stage::ChunkSize;
+                break;
+            }
+            case Stage::Trailer: {
+                // https://www.rfc-editor.org/rfc/rfc9112#section-7.1.2
+                // Any number of trailer fields, ended by an empty line. They
+                // all have to be read so that the connection can be reused.
+                // TODO(mkiael): Do something with the trailer fields.
+                auto line = take_until(data, "\r\n"sv);
+                if (!line) {
+                    return false;
+                }
+
+                if (line->empty()) {
+                    complete(true);
+                }
+                break;
+            }
+            case Stage::Done:
+                break;
+        }
+    }
+
+    return true;
+}
+
+std::optional<std::string_view> HttpResponseParser::awaited_delimiter() const {
+    switch (stage_) {
+        case Stage::StatusLine:
+        case Stage::ChunkSize:
+        case Stage::ChunkEnd:
+        case Stage::Trailer:
+            return "\r\n"sv;
+        case Stage::Headers:
+            return "\r\n\r\n"sv;
+        case Stage::Body:
+        case Stage::BodyUntilClose:
+        case Stage::ChunkData:
+        case Stage::Done:
+            break;
+    }
+
+    return std::nullopt;
+}
+
+std::size_t HttpResponseParser::awaited_body_bytes() const {
+    switch (stage_) {
+        case Stage::Body:
+        case Stage::ChunkData:
+            return remaining_;
+        case Stage::BodyUntilClose:
+            return std::numeric_limits<std::size_t>::max();
+        case Stage::StatusLine:
+        case Stage::Headers:
+        case Stage::ChunkSize:
+        case Stage::ChunkEnd:
+        case Stage::Trailer:
+        case Stage::Done:
+            break;
+    }
+
+    return 0;
+}
+
+void HttpResponseParser::finish() {
+    switch (stage_) {
+        case Stage::StatusLine:
+            // Nothing at all was received.
+            fail(Error::Unresolved);
+            break;
+        case Stage::Headers:
+        case Stage::ChunkSize:
+        case Stage::ChunkData:
+        case Stage::ChunkEnd:
+            fail(Error::InvalidResponse);
+            break;
+        // A truncated body is still handed over, but the connection is left in an unknown state.
+        case Stage::Body:
+        case Stage::BodyUntilClose:
+        case Stage::Trailer:
+            complete(false);
+            break;
+        case Stage::Done:
+            break;
+    }
+}
+
+void HttpResponseParser::on_headers_parsed() {
+    auto encoding = response_.headers.get("transfer-encoding"sv);
+    if (!Http::has_body(response_.status_line.status_code)) {
+        complete(true);
+    } else if (encoding == "chunked"sv) {
+        stage_ = Stage::ChunkSize;
+    } else if (auto content_length = response_.headers.get("content-length"sv)) {
+        auto length = Http::parse_content_length(*content_length);
+        if (!length) {
+            fail(Error::InvalidResponse);
+            return;
+        }
+
+        response_.body.reserve(std::min(*length, kMaxBodyReservation));
+        remaining_ = *length;
+        stage_ = Stage::Body;
+    } else {
+        stage_ = Stage::BodyUntilClose;
+    }
+
+    if (stage_ != Stage::Done) {
+        start_decoding();
+    }
+}
+
+void HttpResponseParser::start_decoding() {
+    auto encoding = response_.headers.get("content-encoding"sv);
+    if (!encoding) {
+        return;
+    }
+
+    decoder_ = ContentDecoder::create(*encoding);
+    if (decoder_) {
+        response_.headers.erase("content-encoding"sv);
+        response_.headers.erase("content-length"sv);
+    }
+}
+
+void HttpResponseParser::append_body(std::string_view &data, std::size_t max_bytes) {
+    auto bytes = data.substr(0, max_bytes);
+    data.remove_prefix(bytes.size());
+    if (bytes.empty()) {
+        return;
+    }
+
+    if (stage_ != Stage::BodyUntilClose) {
+        remaining_ -= bytes.size();
+    }
+
+    auto const old_size = response_.body.size();
+    if (!decoder_) {
+        response_.body.append(bytes);
+    } else if (!decoder_->decode(bytes, response_.body)) {
+        fail(Error::InvalidResponse);
+        return;
+    }
+
+    auto const appended = std::string_view{response_.body}.substr(old_size);
+    if (on_body_data_ && !appended.empty()) {
+        on_body_data_(response_, appended);
+    }
+}
+
+std::optional<std::string> HttpResponseParser::take_until(std::string_view &data, std::string_view delimiter) {
+    // The delimiter may have been split between this and an earlier read, in
+    // which case it starts in the last few bytes of the buffer.
+    auto const kept = std::min(buffer_.size(), delimiter.size() - 1);
+    auto const boundary = buffer_.substr(buffer_.size() - kept).append(data.substr(0, delimiter.size() - 1));
+
+    std::size_t taken{};
+    if (auto pos = boundary.find(delimiter); pos != std::string::npos) {
+        taken = pos + delimiter.size() - kept;
+    } else if (pos = data.find(delimiter); pos != std::string_view::npos) {
+        taken = pos + delimiter.size();
+    } else {
+        buffer_.append(data);
+        data = {};
+        return std::nullopt;
+    }
+
+    buffer_.append(data.substr(0, taken));
+    data.remove_prefix(taken);
+    auto result = std::exchange(buffer_, {});
+    result.resize(result.size() - delimiter.size());
+    return result;
+}
+
+void HttpResponseParser::complete(bool delimited) {
+    stage_ = Stage::Done;
+    reusable_ = delimited && Http::is_keep_alive(response_.status_line, response_.headers);
+}
+
+void HttpResponseParser::fail(Error err) {
+    stage_ = Stage::Done;
+    reusable_ = false;
+    buffer_.clear();
+    decoder_.reset();
+    response_ = Response{.err = err, .status_line = std::move(response_.status_line)};
+}
+
+} // namespace protocol
@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef PROTOCOL_HTTP_RESPONSE_PARSER_H_
+#define PROTOCOL_HTTP_RESPONSE_PARSER_H_
+
+#include "protocol/content_decoder.h"
+#include "protocol/response.h"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace protocol {
+
+// Builds a response out of the data read from a connection, however it
+// happens to be split up, so that it doesn't matter if the reading blocks
+// or is done asynchronously. gzip and deflate encoded bodies are decoded as
+// they're received, with the Content-Encoding and Content-Length headers
+// removed as they no longer describe the body.
+class HttpResponseParser {
+public:
+    explicit HttpResponseParser(BodyDataCallback on_body_data = {}) : on_body_data_{std::move(on_body_data)} {}
+
+    // Returns true once the response is complete. Anything fed after that is
+    // ignored.
+    bool feed(std::string_view data);
+    // To be called if the connection is closed before the response is complete.
+    void finish();
+
+    // What the parser is waiting for, for readers that want to avoid reading
+    // past the end of the response: either everything up to and including a
+    // delimiter, or at most a number of body bytes.
+    [[nodiscard]] std::optional<std::string_view> awaited_delimiter() const;
+    [[nodiscard]] std::size_t awaited_body_bytes() const;
+
+    [[nodiscard]] bool done() const { return stage_ == Stage::Done; }
+    // If the connection can be used for another request once done.
+    [[nodiscard]] bool reusable() const { return reusable_; }
+
+    [[nodiscard]] Response const &response() const { return response_; }
+    [[nodiscard]] Response take_response() { return std::move(response_); }
+
+private:
+    enum class Stage {
+        StatusLine,
+        Headers,
+        Body,
+        BodyUntilClose,
+        ChunkSize,
+        ChunkData,
+        ChunkEnd,
+        Trailer,
+        Done,
+    };
+
+    void on_headers_parsed();
+    void start_decoding();
+    void append_body(std::string_view &data, std::size_t max_bytes);
+    // Takes everything up to and including the delimiter from data and what's
+    // been buffered from earlier calls, returning it without the delimiter.
+    [[nodiscard]] std::optional<std::string> take_until(std::string_view &data, std::string_view delimiter);
+    void complete(bool delimited);
+    void fail(Error);
+
+    BodyDataCallback on_body_data_;
+    Stage stage_{Stage::StatusLine};
+    // Incomplete lines left over from earlier calls.
+    std::string buffer_;
+    // The bytes left in the body or in the current chunk.
+    std::size_t remaining_{};
+    Response response_{};
+    bool reusable_{false};
+    std::optional<ContentDecoder> decoder_{};
+};
+
+} // namespace protocol
+
+#endif
@@ -0,0 +1,192 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "protocol/http_response_parser.h"
+
+#include "protocol/response.h"
+
+#include "etest/etest.h"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+using namespace std::literals;
+using etest::expect;
+using etest::expect_eq;
+using protocol::Error;
+using protocol::HttpResponseParser;
+
+namespace {
+
+// Feeds the response one byte at a time, making sure every delimiter is split
+// between two calls at some point.
+bool feed_bytewise(HttpResponseParser &parser, std::string_view response) {
+    for (std::size_t i = 0; i < response.size(); ++i) {
+        if (parser.feed(response.substr(i, 1))) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace
+
+int main() {
+    etest::test("content-length, all at once and byte by byte", [] {
+        auto const response = "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello"sv;
+
+        HttpResponseParser parser;
+        expect(parser.feed(response));
+        expect(parser.reusable());
+        expect_eq(parser.response().status_line, protocol::StatusLine{"HTTP/1.1", 200, "OK"});
+        expect_eq(parser.take_response().body, "hello");
+
+        HttpResponseParser bytewise;
+        expect(feed_bytewise(bytewise, response));
+        expect_eq(bytewise.response().headers.get("content-length"sv), "5"sv);
+        expect_eq(bytewise.take_response().body, "hello");
+    });
+
+    etest::test("chunked, byte by byte", [] {
+        std::string streamed;
+        HttpResponseParser parser{[&](protocol::Response const &, std::string_view data) { streamed += data; }};
+        expect(feed_bytewise(parser,
+                "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+                "4\r\nWiki\r\n"
+                "5\r\npedia\r\n"
+                "0\r\n\r\n"sv));
+
+        expect(parser.reusable());
+        expect_eq(streamed, "Wikipedia");
+        expect_eq(parser.take_response().body, "Wikipedia");
+    });
+
+    etest::test("chunked, with trailer fields", [] {
+        auto const response =
+                "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+                "4\r\nWiki\r\n"
+                "0\r\n"
+                "Expires: Wed, 21 Oct 2015 07:28:00 GMT\r\n"
+                "Server-Timing: total;dur=123.4\r\n"
+                "\r\n"sv;
+
+        HttpResponseParser parser;
+        // The response isn't done until the empty line ending the trailer.
+        expect(!parser.feed(response.substr(0, response.size() - 2)));
+        expect(!parser.done());
+        expect(parser.feed("\r\n"sv));
+        expect(parser.reusable());
+        expect_eq(parser.take_response().body, "Wiki");
+
+        HttpResponseParser bytewise;
+        expect(feed_bytewise(bytewise, response));
+        expect(bytewise.reusable());
+        expect_eq(bytewise.take_response().body, "Wiki");
+    });
+
+    etest::test("data after the response is ignored", [] {
+        HttpResponseParser parser;
+        expect(parser.feed("HTTP/1.1 204 No Content\r\nEtag: \"1234\"\r\n\r\nHTTP/1.1 200 OK"sv));
+        expect(parser.feed("more data"sv));
+        expect_eq(parser.take_response().body, "");
+    });
+
+    etest::test("closed before the status line", [] {
+        HttpResponseParser parser;
+        expect(!parser.feed("HTTP/1.1 2"sv));
+        parser.finish();
+        expect(parser.done());
+        expect_eq(parser.take_response(), protocol::Response{Error::Unresolved});
+    });
+
+    etest::test("closed in the middle of the headers", [] {
+        HttpResponseParser parser;
+        expect(!parser.feed("HTTP/1.1 200 OK\r\nContent-Len"sv));
+        parser.finish();
+        expect_eq(parser.take_response(),
+                protocol::Response{Error::InvalidResponse, protocol::StatusLine{"HTTP/1.1", 200, "OK"}});
+    });
+
+    etest::test("closed in the middle of a chunk", [] {
+        HttpResponseParser parser;
+        expect(!parser.feed("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhel"sv));
+        parser.finish();
+        expect_eq(parser.take_response().err, Error::InvalidResponse);
+        expect(!parser.reusable());
+    });
+
+    etest::test("truncated and undelimited bodies aren't reusable", [] {
+        HttpResponseParser truncated;
+        expect(!truncated.feed("HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhel"sv));
+        truncated.finish();
+        expect(!truncated.reusable());
+        expect_eq(truncated.take_response().body, "hel");
+
+        HttpResponseParser undelimited;
+        expect(!undelimited.feed("HTTP/1.1 200 OK\r\nServer: hastur\r\n\r\nhello"sv));
+        expect(!undelimited.feed(" world"sv));
+        undelimited.finish();
+        expect(!undelimited.reusable());
+        expect_eq(undelimited.take_response().body, "hello world");
+    });
+
+    etest::test("gzip body is decoded as it's received", [] {
+        // "hello, world!", gzipped.
+        auto const body =
+                "\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\x03\xcb\x48\xcd\xc9\xc9\xd7\x51\x28\xcf\x2f\xca\x49\x51\x04\x00\x13\x8d\x98\x58\x0d\x00\x00\x00"s;
+        std::string streamed;
+        HttpResponseParser parser{[&](protocol::Response const &head, std::string_view data) {
+            expect_eq(head.headers.get("content-encoding"sv), std::nullopt);
+            streamed += data;
+        }};
+        expect(feed_bytewise(parser,
+                "HTTP/1.1 200 OK\r\nContent-Encoding: gzip\r\nContent-Length: " + std::to_string(body.size())
+                        + "\r\n\r\n" + body));
+        expect(parser.reusable());
+        expect_eq(streamed, "hello, world!");
+
+        auto response = parser.take_response();
+        expect_eq(response.err, Error::Ok);
+        expect_eq(response.body, "hello, world!");
+        expect_eq(response.headers.get("content-length"sv), std::nullopt);
+    });
+
+    etest::test("chunked deflate body", [] {
+        // "hello, world!", deflated.
+        auto const body = "\x78\x9c\xcb\x48\xcd\xc9\xc9\xd7\x51\x28\xcf\x2f\xca\x49\x51\x04\x00\x21\xfe\x04\xaa"s;
+        HttpResponseParser parser;
+        expect(feed_bytewise(parser,
+                "HTTP/1.1 200 OK\r\nContent-Encoding: deflate\r\nTransfer-Encoding: chunked\r\n\r\n"
+                        + "5\r\n"s + body.substr(0, 5) + "\r\n"
+                        + "10\r\n"s + body.substr(5) + "\r\n"
+                        + "0\r\n\r\n"s));
+        expect_eq(parser.take_response().body, "hello, world!");
+    });
+
+    etest::test("invalid encoded body", [] {
+        HttpResponseParser parser;
+        expect(parser.feed("HTTP/1.1 200 OK\r\nContent-Encoding: gzip\r\nContent-Length: 5\r\n\r\nhello"sv));
+        expect(!parser.reusable());
+        expect_eq(parser.take_response().err, Error::InvalidResponse);
+    });
+
+    etest::test("unsupported encodings are left alone", [] {
+        HttpResponseParser parser;
+        expect(parser.feed("HTTP/1.1 200 OK\r\nContent-Encoding: br\r\nContent-Length: 5\r\n\r\nhello"sv));
+        auto response = parser.take_response();
+        expect_eq(response.body, "hello");
+        expect_eq(response.headers.get("content-encoding"sv), "br");
+    });
+
+    etest::test("invalid status line", [] {
+        HttpResponseParser parser;
+        expect(parser.feed("not http\r\n"sv));
+        expect_eq(parser.take_response(), protocol::Response{Error::InvalidResponse});
+    });
+
+    return etest::run_all_tests();
+}
@@ -6,10 +6,16 @@
 
 #include "etest/etest.h"
 
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 using namespace std::string_view_literals;
 
+using etest::expect;
 using etest::expect_eq;
 using etest::require;
 
@@ -46,12 +52,21 @@ struct FakeSocket {
         return result;
     }
 
+    std::size_t read_some(std::string &out, std::size_t max_bytes) {
+        auto n = std::min({read_data.size(), max_bytes, max_read_size});
+        out.append(read_data, 0, n);
+        read_data.erase(0, n);
+        return n;
+    }
+
     std::string host{};
     std::string service{};
     std::string write_data{};
     std::string read_data{};
     std::string delimiter{};
     bool connect_result{true};
+    // Simulates data trickling in from the network.
+    std::size_t max_read_size{std::numeric_limits<std::size_t>::max()};
 };
 
 uri::Uri create_uri(std::string url = "http://example.com") {
@@ -74,7 +89,7 @@ int main() {
         FakeSocket socket;
         socket.read_data =
                 "HTTP/1.1 200 OK\r\n"
-                "Content-Encoding: gzip\r\n"
+                "Content-Encoding: identity\r\n"
                 "Accept-Ranges: bytes\r\n"
                 "Age: 367849\r\n"
                 "Cache-Control: max-age=604800\r\n"
@@ -103,7 +118,7 @@ int main() {
         expect_eq(response.status_line.version, "HTTP/1.1");
         expect_eq(response.status_line.status_code, 200);
         expect_eq(response.status_line.reason, "OK");
-        expect_eq(response.headers.get("Content-Encoding"sv).value(), "gzip");
+        expect_eq(response.headers.get("Content-Encoding"sv).value(), "identity");
         expect_eq(response.headers.get("Accept-Ranges"sv).value(), "bytes");
         expect_eq(response.headers.get("Age"sv).value(), "367849");
         expect_eq(response.headers.get("Cache-Control"sv).value(), "max-age=604800");
@@ -250,6 +265,209 @@ int main() {
         expect_eq(response.err, protocol::Error::InvalidResponse);
     });
 
+    etest::test("content-length delimits the body", [] {
+        FakeSocket socket;
+        socket.read_data =
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Length: 5\r\n"
+                "\r\n"
+                "hello"
+                "HTTP/1.1 200 OK\r\n";
+
+        auto response = protocol::Http::get(socket, create_uri(), std::nullopt);
+
+        expect_eq(response.err, protocol::Error::Ok);
+        expect_eq(response.body, "hello");
+        expect(socket.write_data.contains("Connection: close\r\n"));
+    });
+
+    etest::test("compressed responses are asked for", [] {
+        FakeSocket socket;
+        socket.read_data = "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello";
+
+        std::ignore = protocol::Http::get(socket, create_uri(), std::nullopt);
+
+        expect(socket.write_data.contains("Accept-Encoding: gzip, deflate\r\n"));
+    });
+
+    etest::test("content-length body is streamed", [] {
+        FakeSocket socket;
+        socket.max_read_size = 2;
+        socket.read_data =
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Length: 5\r\n"
+                "\r\n"
+                "hello";
+
+        std::vector<std::string> pieces;
+        auto on_body_data = [&](protocol::Response const &head, std::string_view data) {
+            expect_eq(head.status_line.status_code, 200);
+            expect_eq(head.headers.get("content-length"), "5");
+            pieces.emplace_back(data);
+        };
+        auto response = protocol::Http::get(socket, create_uri(), std::nullopt, on_body_data);
+
+        expect_eq(response.err, protocol::Error::Ok);
+        expect_eq(response.body, "hello");
+        expect(pieces == std::vector<std::string>{"he", "ll", "o"});
+    });
+
+    etest::test("chunked body is streamed", [] {
+        auto socket = create_chunked_socket(
+                "5\r\nhello\r\n"
+                "6\r\n world\r\n"
+                "0\r\n\r\n");
+        socket.max_read_size = 4;
+
+        std::vector<std::string> pieces;
+        auto on_body_data = [&](protocol::Response const &, std::string_view data) { pieces.emplace_back(data); };
+        auto response = protocol::Http::get(socket, create_uri(), std::nullopt, on_body_data);
+
+        expect_eq(response.err, protocol::Error::Ok);
+        expect_eq(response.body, "hello world");
+        expect(pieces == std::vector<std::string>{"hell", "o", " wor", "ld"});
+    });
+
+    etest::test("undelimited body is streamed", [] {
+        FakeSocket socket;
+        socket.max_read_size = 3;
+        socket.read_data =
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Type: text/html\r\n"
+                "\r\n"
+                "<html>";
+
+        std::vector<std::string> pieces;
+        auto on_body_data = [&](protocol::Response const &, std::string_view data) { pieces.emplace_back(data); };
+        auto response = protocol::Http::get(socket, create_uri(), std::nullopt, on_body_data);
+
+        expect_eq(response.err, protocol::Error::Ok);
+        expect_eq(response.body, "<html>");
+        expect(pieces == std::vector<std::string>{"<ht", "ml>"});
+    });
+
+    etest::test("invalid content-length", [] {
+        FakeSocket socket;
+        socket.read_data =
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Length: five\r\n"
+                "\r\n"
+                "hello";
+
+        auto response = protocol::Http::get(socket, create_uri(), std::nullopt);
+
+        expect_eq(response.err, protocol::Error::InvalidResponse);
+    });
+
+    etest::test("no body in 204 and 304 responses", [] {
+        for (auto status : {"204 No Content"sv, "304 Not Modified"sv}) {
+            FakeSocket socket;
+            socket.read_data = std::string{"HTTP/1.1 "}.append(status).append("\r\nEtag: \"1234\"\r\n\r\n");
+
+            auto response = protocol::Http::get(socket, create_uri(), std::nullopt);
+
+            expect_eq(response.err, protocol::Error::Ok);
+            expect_eq(response.body, "");
+        }
+    });
+
+    etest::test("pooled keep-alive connection is reused", [] {
+        protocol::ConnectionPool<FakeSocket> pool;
+        FakeSocket socket;
+        socket.read_data =
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Length: 5\r\n"
+                "\r\n"
+                "hello";
+        pool.put("http://example.com", std::move(socket));
+
+        auto response = protocol::Http::get(pool, create_uri(), std::nullopt);
+
+        expect_eq(response.body, "hello");
+        expect_eq(pool.stats(), protocol::ConnectionPoolStats{.hits = 1});
+
+        // The connection should have been handed back to the pool.
+        auto reused = pool.take("http://example.com");
+        require(reused.has_value());
+        expect(reused->write_data.contains("Connection: keep-alive\r\n"));
+        expect(reused->host.empty());
+    });
+
+    etest::test("pooled connection is reused after a chunked response with trailer fields", [] {
+        protocol::ConnectionPool<FakeSocket> pool;
+        FakeSocket socket;
+        socket.read_data =
+                "HTTP/1.1 200 OK\r\n"
+                "Transfer-Encoding: chunked\r\n"
+                "\r\n"
+                "5\r\nhello\r\n"
+                "0\r\n"
+                "Expires: Wed, 21 Oct 2015 07:28:00 GMT\r\n"
+                "Server-Timing: total;dur=123.4\r\n"
+                "\r\n"
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Length: 7\r\n"
+                "\r\n"
+                "goodbye";
+        pool.put("http://example.com", std::move(socket));
+
+        auto first = protocol::Http::get(pool, create_uri(), std::nullopt);
+        expect_eq(first.err, protocol::Error::Ok);
+        expect_eq(first.body, "hello");
+
+        // The trailer has been read in full, so the next response starts at its status line.
+        auto second = protocol::Http::get(pool, create_uri(), std::nullopt);
+        expect_eq(second.err, protocol::Error::Ok);
+        expect_eq(second.body, "goodbye");
+        expect_eq(pool.stats(), protocol::ConnectionPoolStats{.hits = 2});
+    });
+
+    etest::test("pooled connection closed by the server isn't reused", [] {
+        protocol::ConnectionPool<FakeSocket> pool;
+        FakeSocket socket;
+        socket.read_data =
+                "HTTP/1.1 200 OK\r\n"
+                "Connection: close\r\n"
+                "Content-Length: 5\r\n"
+                "\r\n"
+                "hello";
+        pool.put("http://example.com", std::move(socket));
+
+        auto response = protocol::Http::get(pool, create_uri(), std::nullopt);
+
+        expect_eq(response.body, "hello");
+        expect_eq(pool.idle_connections(), std::size_t{0});
+    });
+
+    etest::test("undelimited body isn't pooled", [] {
+        protocol::ConnectionPool<FakeSocket> pool;
+        FakeSocket socket;
+        socket.read_data =
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Type: text/html\r\n"
+                "\r\n"
+                "hello";
+        pool.put("http://example.com", std::move(socket));
+
+        auto response = protocol::Http::get(pool, create_uri(), std::nullopt);
+
+        expect_eq(response.body, "hello");
+        expect_eq(pool.idle_connections(), std::size_t{0});
+    });
+
+    etest::test("stale pooled connection is replaced", [] {
+        protocol::ConnectionPool<FakeSocket> pool;
+        pool.put("http://example.com", FakeSocket{});
+
+        // The stale connection returns nothing, and so does the fresh one
+        // since FakeSocket doesn't have a server behind it.
+        auto response = protocol::Http::get(pool, create_uri(), std::nullopt);
+
+        expect_eq(response.err, protocol::Error::Unresolved);
+        expect_eq(pool.stats(), protocol::ConnectionPoolStats{.hits = 1});
+        expect_eq(pool.idle_connections(), std::size_t{0});
+    });
+
     etest::test("404 no headers no body", [] {
         FakeSocket socket;
         socket.read_data = "HTTP/1.1 404 Not Found\r\n\r\n";
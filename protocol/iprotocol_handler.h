@@ -9,14 +9,52 @@
 
 #include "uri/uri.h"
 
+#include <future>
+#include <memory>
+#include <utility>
+
 namespace protocol {
 
 class IProtocolHandler {
 public:
     virtual ~IProtocolHandler() = default;
     [[nodiscard]] virtual Response handle(uri::Uri const &) = 0;
+
+    // Same as handle(), but the body is also handed over as it's received.
+    // Handlers that can't do any better hand it over all at once in the end.
+    [[nodiscard]] virtual Response stream(uri::Uri const &uri, BodyDataCallback const &on_body_data) {
+        auto response = handle(uri);
+        if (response.err == Error::Ok && !response.body.empty() && on_body_data) {
+            on_body_data(response, response.body);
+        }
+        return response;
+    }
+
+    // Same as stream(), but also sending the request headers, like the ones
+    // used for revalidating cached responses. Handlers that can't send any
+    // headers ignore them.
+    [[nodiscard]] virtual Response request(
+            uri::Uri const &uri, Headers const &, BodyDataCallback const &on_body_data) {
+        return stream(uri, on_body_data);
+    }
+
+    // Same as handle(), but returns right away and hands the response to
+    // on_done once it's been received, possibly from another thread. Handlers
+    // that can't do any better handle the request before returning, without
+    // the request headers.
+    virtual void fetch(uri::Uri const &uri, Headers const &, ResponseCallback on_done) { on_done(handle(uri)); }
 };
 
+[[nodiscard]] inline std::future<Response> fetch(
+        IProtocolHandler &handler, uri::Uri const &uri, Headers const &request_headers = {}) {
+    auto promise = std::make_shared<std::promise<Response>>();
+    auto response = promise->get_future();
+    handler.fetch(uri, request_headers, [promise = std::move(promise)](Response r) {
+        promise->set_value(std::move(r));
+    });
+    return response;
+}
+
 } // namespace protocol
 
 #endif
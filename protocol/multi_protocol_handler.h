@@ -26,6 +26,32 @@ public:
         return handlers_[uri.scheme]->handle(uri);
     }
 
+    [[nodiscard]] Response stream(uri::Uri const &uri, BodyDataCallback const &on_body_data) override {
+        if (!handlers_.contains(uri.scheme)) {
+            return {Error::Unhandled};
+        }
+
+        return handlers_[uri.scheme]->stream(uri, on_body_data);
+    }
+
+    [[nodiscard]] Response request(
+            uri::Uri const &uri, Headers const &request_headers, BodyDataCallback const &on_body_data) override {
+        if (!handlers_.contains(uri.scheme)) {
+            return {Error::Unhandled};
+        }
+
+        return handlers_[uri.scheme]->request(uri, request_headers, on_body_data);
+    }
+
+    void fetch(uri::Uri const &uri, Headers const &request_headers, ResponseCallback on_done) override {
+        if (!handlers_.contains(uri.scheme)) {
+            on_done({Error::Unhandled});
+            return;
+        }
+
+        handlers_[uri.scheme]->fetch(uri, request_headers, std::move(on_done));
+    }
+
 private:
     std::map<std::string, std::unique_ptr<IProtocolHandler>, std::less<>> handlers_;
 };
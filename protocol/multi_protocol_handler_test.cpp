@@ -7,6 +7,8 @@
 #include "etest/etest.h"
 
 #include <memory>
+#include <string>
+#include <string_view>
 
 using etest::expect_eq;
 using protocol::MultiProtocolHandler;
@@ -33,5 +35,25 @@ int main() {
         expect_eq(handler.handle(uri::Uri{.scheme = "hax"}).err, protocol::Error::Ok);
     });
 
+    etest::test("streamed protocols are handled", [] {
+        MultiProtocolHandler handler;
+        std::string streamed{};
+        auto on_body_data = [&](protocol::Response const &, std::string_view data) { streamed += data; };
+        expect_eq(handler.stream(uri::Uri{.scheme = "hax"}, on_body_data).err, protocol::Error::Unhandled);
+
+        handler.add("hax",
+                std::make_unique<FakeProtocolHandler>(protocol::Response{.err = protocol::Error::Ok, .body{"hi"}}));
+        expect_eq(handler.stream(uri::Uri{.scheme = "hax"}, on_body_data).body, "hi");
+        expect_eq(streamed, "hi");
+    });
+
+    etest::test("fetched protocols are handled", [] {
+        MultiProtocolHandler handler;
+        expect_eq(protocol::fetch(handler, uri::Uri{.scheme = "hax"}).get().err, protocol::Error::Unhandled);
+
+        handler.add("hax", std::make_unique<FakeProtocolHandler>(protocol::Response{protocol::Error::Ok}));
+        expect_eq(protocol::fetch(handler, uri::Uri{.scheme = "hax"}).get().err, protocol::Error::Ok);
+    });
+
     return etest::run_all_tests();
 }
@@ -32,6 +32,12 @@ std::string Headers::to_string() const {
     return std::move(ss).str();
 }
 
+void Headers::erase(std::string_view name) {
+    if (auto it = headers_.find(name); it != headers_.end()) {
+        headers_.erase(it);
+    }
+}
+
 std::size_t Headers::size() const {
     return headers_.size();
 }
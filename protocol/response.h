@@ -7,6 +7,7 @@
 #define PROTOCOL_RESPONSE_H_
 
 #include <cstddef>
+#include <functional>
 #include <initializer_list>
 #include <map>
 #include <optional>
@@ -37,10 +38,14 @@ public:
     Headers(std::initializer_list<std::map<std::string, std::string>::value_type> init) : headers_{std::move(init)} {}
 
     void add(std::pair<std::string_view, std::string_view> nv);
+    void erase(std::string_view name);
     [[nodiscard]] std::optional<std::string_view> get(std::string_view name) const;
     [[nodiscard]] std::string to_string() const;
     [[nodiscard]] std::size_t size() const;
 
+    [[nodiscard]] auto begin() const { return headers_.cbegin(); }
+    [[nodiscard]] auto end() const { return headers_.cend(); }
+
     [[nodiscard]] bool operator==(Headers const &) const = default;
 
 private:
@@ -60,6 +65,14 @@ struct Response {
     [[nodiscard]] bool operator==(Response const &) const = default;
 };
 
+// Called with each piece of the response body as it's received. The status
+// line and headers of the response are filled in by the time this is called.
+// The data is only valid until the next call.
+using BodyDataCallback = std::function<void(Response const &, std::string_view data)>;
+
+// Called with the response once it's been received in full.
+using ResponseCallback = std::function<void(Response)>;
+
 } // namespace protocol
 
 #endif
@@ -0,0 +1,115 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "render/display_list.h"
+
+#include "geom/geom.h"
+#include "gfx/canvas_command_saver.h"
+#include "gfx/icanvas.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace render {
+namespace {
+
+// Bands are made taller on huge pages to keep the index from growing without bound.
+constexpr std::size_t kMaxBands = std::size_t{1} << 16;
+
+// Like geom::Rect::contains, the edges are part of the rectangles.
+bool overlaps(geom::Rect const &a, geom::Rect const &b) {
+    return a.left() <= b.right() && b.left() <= a.right() && a.top() <= b.bottom() && b.top() <= a.bottom();
+}
+
+} // namespace
+
+DisplayList::DisplayList(std::vector<DisplayItem> items, int band_height)
+    : items_{std::move(items)}, band_height_{band_height} {
+    assert(band_height > 0);
+    if (items_.empty()) {
+        return;
+    }
+
+    top_ = items_[0].bounds.top();
+    auto bottom = items_[0].bounds.bottom();
+    for (auto const &item : items_) {
+        top_ = std::min(top_, item.bounds.top());
+        bottom = std::max(bottom, item.bounds.bottom());
+    }
+
+    while (static_cast<std::size_t>((bottom - top_) / band_height_ + 1) > kMaxBands) {
+        band_height_ *= 2;
+    }
+
+    auto const band_count = static_cast<std::size_t>((bottom - top_) / band_height_ + 1);
+    auto band = [&](int y) { return static_cast<std::size_t>((y - top_) / band_height_); };
+
+    // Count the items in each band first so that all of them fit in one array.
+    band_starts_.assign(band_count + 1, 0);
+    for (auto const &item : items_) {
+        for (auto b = band(item.bounds.top()); b <= band(item.bounds.bottom()); ++b) {
+            band_starts_[b + 1] += 1;
+        }
+    }
+
+    for (std::size_t i = 1; i < band_starts_.size(); ++i) {
+        band_starts_[i] += band_starts_[i - 1];
+    }
+
+    auto next = band_starts_;
+    band_items_.resize(band_starts_.back());
+    for (std::size_t i = 0; i < items_.size(); ++i) {
+        for (auto b = band(items_[i].bounds.top()); b <= band(items_[i].bounds.bottom()); ++b) {
+            band_items_[next[b]++] = i;
+        }
+    }
+}
+
+std::vector<std::size_t> DisplayList::items_in(geom::Rect const &area) const {
+    if (band_starts_.empty()) {
+        return {};
+    }
+
+    auto const bands = static_cast<int>(band_starts_.size() - 1);
+    auto const first_band = std::max((area.top() - top_) / band_height_, 0);
+    auto const last_band = std::min((area.bottom() - top_) / band_height_, bands - 1);
+    if (area.bottom() < top_ || first_band > last_band) {
+        return {};
+    }
+
+    std::vector<std::size_t> found;
+    for (auto b = static_cast<std::size_t>(first_band); b <= static_cast<std::size_t>(last_band); ++b) {
+        for (auto i = band_starts_[b]; i < band_starts_[b + 1]; ++i) {
+            if (overlaps(items_[band_items_[i]].bounds, area)) {
+                found.push_back(band_items_[i]);
+            }
+        }
+    }
+
+    // Items taller than a band are in more than one of them.
+    std::ranges::sort(found);
+    auto [first, last] = std::ranges::unique(found);
+    found.erase(first, last);
+    return found;
+}
+
+void DisplayList::replay(gfx::ICanvas &canvas) const {
+    gfx::CanvasCommandVisitor visitor{canvas};
+    for (auto const &item : items_) {
+        std::visit(visitor, item.command);
+    }
+}
+
+void DisplayList::replay(gfx::ICanvas &canvas, geom::Rect const &viewport) const {
+    gfx::CanvasCommandVisitor visitor{canvas};
+    for (auto i : items_in(viewport)) {
+        std::visit(visitor, items_[i].command);
+    }
+}
+
+} // namespace render
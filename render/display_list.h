@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef RENDER_DISPLAY_LIST_H_
+#define RENDER_DISPLAY_LIST_H_
+
+#include "geom/geom.h"
+#include "gfx/canvas_command_saver.h"
+#include "gfx/icanvas.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace render {
+
+struct DisplayItem {
+    // Everything the command draws is inside of this.
+    geom::Rect bounds{};
+    gfx::CanvasCommand command;
+
+    [[nodiscard]] bool operator==(DisplayItem const &) const = default;
+};
+
+// Draw commands with everything needed to draw them already resolved, indexed
+// by the vertical band of the page they draw to so that only the items in
+// view have to be looked at when replaying them.
+class DisplayList {
+public:
+    static constexpr int kDefaultBandHeight = 256;
+
+    DisplayList() = default;
+    explicit DisplayList(std::vector<DisplayItem> items, int band_height = kDefaultBandHeight);
+
+    [[nodiscard]] std::vector<DisplayItem> const &items() const { return items_; }
+
+    // The indices of all items whose bounds overlap the area, in the order
+    // they're drawn in.
+    [[nodiscard]] std::vector<std::size_t> items_in(geom::Rect const &area) const;
+
+    void replay(gfx::ICanvas &) const;
+    void replay(gfx::ICanvas &, geom::Rect const &viewport) const;
+
+private:
+    std::vector<DisplayItem> items_;
+
+    int top_{};
+    int band_height_{kDefaultBandHeight};
+
+    // The items in band n are band_items_[band_starts_[n]] up to
+    // band_items_[band_starts_[n + 1]], in drawing order.
+    std::vector<std::size_t> band_starts_;
+    std::vector<std::size_t> band_items_;
+};
+
+} // namespace render
+
+#endif
@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "render/display_list.h"
+
+#include "etest/etest.h"
+#include "geom/geom.h"
+#include "gfx/canvas_command_saver.h"
+#include "gfx/color.h"
+
+#include <cstddef>
+#include <vector>
+
+using etest::expect_eq;
+
+using CanvasCommands = std::vector<gfx::CanvasCommand>;
+
+namespace {
+
+render::DisplayItem fill(geom::Rect const &rect) {
+    return {rect, gfx::FillRectCmd{rect, gfx::Color{}}};
+}
+
+} // namespace
+
+int main() {
+    etest::test("empty", [] {
+        render::DisplayList const list;
+        expect_eq(list.items_in({0, 0, 100, 100}), std::vector<std::size_t>{});
+
+        gfx::CanvasCommandSaver saver;
+        list.replay(saver, {0, 0, 100, 100});
+        expect_eq(saver.take_commands(), CanvasCommands{});
+    });
+
+    etest::test("items in area", [] {
+        render::DisplayList const list{{
+                                               fill({0, 0, 100, 1000}),
+                                               fill({0, 10, 100, 10}),
+                                               fill({0, 600, 100, 10}),
+                                               fill({200, 600, 100, 10}),
+                                               fill({0, -50, 100, 10}),
+                                       },
+                32};
+
+        expect_eq(list.items_in({0, 0, 100, 100}), std::vector<std::size_t>{0, 1});
+        expect_eq(list.items_in({0, 550, 100, 100}), std::vector<std::size_t>{0, 2});
+        expect_eq(list.items_in({0, 550, 300, 100}), std::vector<std::size_t>{0, 2, 3});
+        expect_eq(list.items_in({0, -100, 100, 60}), std::vector<std::size_t>{4});
+        expect_eq(list.items_in({0, -100, 100, 10}), std::vector<std::size_t>{});
+        expect_eq(list.items_in({0, 2000, 100, 10}), std::vector<std::size_t>{});
+        expect_eq(list.items_in({-100, -100, 1000, 2000}), std::vector<std::size_t>{0, 1, 2, 3, 4});
+    });
+
+    etest::test("replay", [] {
+        render::DisplayList const list{{fill({0, 0, 10, 10}), fill({0, 500, 10, 10}), fill({0, 20, 10, 10})}};
+
+        gfx::CanvasCommandSaver saver;
+        list.replay(saver);
+        expect_eq(saver.take_commands(),
+                CanvasCommands{
+                        gfx::FillRectCmd{{0, 0, 10, 10}},
+                        gfx::FillRectCmd{{0, 500, 10, 10}},
+                        gfx::FillRectCmd{{0, 20, 10, 10}},
+                });
+
+        // Scrolling down a bit.
+        list.replay(saver, {0, 15, 100, 100});
+        expect_eq(saver.take_commands(), CanvasCommands{gfx::FillRectCmd{{0, 20, 10, 10}}});
+    });
+
+    etest::test("huge page", [] {
+        render::DisplayList const list{{fill({0, 0, 10, 100'000'000}), fill({0, 99'999'000, 10, 10})}, 1};
+        expect_eq(list.items_in({0, 99'999'005, 10, 10}), std::vector<std::size_t>{0, 1});
+    });
+
+    return etest::run_all_tests();
+}
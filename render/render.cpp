@@ -7,7 +7,15 @@
 
 #include "css/property_id.h"
 #include "dom/dom.h"
+#include "gfx/canvas_command_saver.h"
 #include "gfx/color.h"
+#include "gfx/font.h"
+#include "gfx/painter.h"
+#include "layout/box_model.h"
+#include "layout/flat_layout.h"
+#include "layout/layout.h"
+#include "render/display_list.h"
+#include "style/styled_node.h"
 #include "util/from_chars.h"
 #include "util/string.h"
 
@@ -19,7 +27,10 @@
 #include <cstring>
 #include <sstream>
 #include <string_view>
+#include <type_traits>
+#include <utility>
 #include <variant>
+#include <vector>
 
 using namespace std::literals;
 
@@ -30,8 +41,8 @@ bool has_any_border(geom::EdgeSize const &border) {
     return border != geom::EdgeSize{};
 }
 
-dom::Text const *try_get_text(layout::LayoutBox const &layout) {
-    return std::get_if<dom::Text>(&layout.node->node);
+dom::Text const *try_get_text(style::StyledNode const &node) {
+    return std::get_if<dom::Text>(&node.node);
 }
 
 constexpr bool is_fully_transparent(gfx::Color const &c) {
@@ -69,69 +80,64 @@ gfx::FontStyle to_gfx(std::vector<style::TextDecorationLine> const &decorations)
     return style;
 }
 
-void render_text(gfx::Painter &painter, layout::LayoutBox const &layout, dom::Text const &text) {
-    auto font_families = layout.get_property<css::PropertyId::FontFamily>();
-    auto fonts = [&font_families] {
-        std::vector<gfx::Font> fs;
-        std::ranges::transform(font_families, std::back_inserter(fs), [](auto f) { return gfx::Font{f}; });
-        return fs;
-    }();
-    auto font_size = gfx::FontSize{.px = layout.get_property<css::PropertyId::FontSize>()};
-    auto style = to_gfx(layout.get_property<css::PropertyId::FontStyle>());
-    auto color = layout.get_property<css::PropertyId::Color>();
-    auto text_decoration_line = to_gfx(layout.get_property<css::PropertyId::TextDecorationLine>());
-    style |= text_decoration_line;
-    painter.draw_text(layout.dimensions.content.position(), text.text, fonts, font_size, style, color);
+void render_text(gfx::Painter &painter,
+        style::StyledNode const &node,
+        layout::BoxModel const &dimensions,
+        dom::Text const &text) {
+    auto const &style = node.computed();
+    std::vector<gfx::Font> fonts;
+    std::ranges::transform(style.font_family, std::back_inserter(fonts), [](auto const &f) { return gfx::Font{f}; });
+    auto font_size = gfx::FontSize{.px = style.font_size};
+    auto font_style = to_gfx(style.font_style);
+    font_style |= to_gfx(style.text_decoration_line);
+    painter.draw_text(dimensions.content.position(), text.text, fonts, font_size, font_style, style.color);
 }
 
-void render_element(gfx::Painter &painter, layout::LayoutBox const &layout) {
-    auto background_color = layout.get_property<css::PropertyId::BackgroundColor>();
-    auto const &border_size = layout.dimensions.border;
+void render_element(gfx::Painter &painter, style::StyledNode const &node, layout::BoxModel const &dimensions) {
+    auto const &style = node.computed();
+    auto const &background_color = style.background_color;
+    auto const &border_size = dimensions.border;
 
     gfx::Corners corners{};
-    auto top_left = layout.get_property<css::PropertyId::BorderTopLeftRadius>();
-    corners.top_left = {top_left.first, top_left.second};
-    auto top_right = layout.get_property<css::PropertyId::BorderTopRightRadius>();
-    corners.top_right = {top_right.first, top_right.second};
-    auto bottom_left = layout.get_property<css::PropertyId::BorderBottomLeftRadius>();
-    corners.bottom_left = {bottom_left.first, bottom_left.second};
-    auto bottom_right = layout.get_property<css::PropertyId::BorderBottomRightRadius>();
-    corners.bottom_right = {bottom_right.first, bottom_right.second};
+    corners.top_left = {style.border_top_left_radius.first, style.border_top_left_radius.second};
+    corners.top_right = {style.border_top_right_radius.first, style.border_top_right_radius.second};
+    corners.bottom_left = {style.border_bottom_left_radius.first, style.border_bottom_left_radius.second};
+    corners.bottom_right = {style.border_bottom_right_radius.first, style.border_bottom_right_radius.second};
 
     if (has_any_border(border_size)) {
         gfx::Borders borders{};
-        borders.left.color = layout.get_property<css::PropertyId::BorderLeftColor>();
+        borders.left.color = style.border_color.left;
         borders.left.size = border_size.left;
-        borders.right.color = layout.get_property<css::PropertyId::BorderRightColor>();
+        borders.right.color = style.border_color.right;
         borders.right.size = border_size.right;
-        borders.top.color = layout.get_property<css::PropertyId::BorderTopColor>();
+        borders.top.color = style.border_color.top;
         borders.top.size = border_size.top;
-        borders.bottom.color = layout.get_property<css::PropertyId::BorderBottomColor>();
+        borders.bottom.color = style.border_color.bottom;
         borders.bottom.size = border_size.bottom;
 
-        painter.draw_rect(layout.dimensions.padding_box(), background_color, borders, corners);
+        painter.draw_rect(dimensions.padding_box(), background_color, borders, corners);
     } else if (!is_fully_transparent(background_color)) {
-        painter.draw_rect(layout.dimensions.padding_box(), background_color, gfx::Borders{}, corners);
+        painter.draw_rect(dimensions.padding_box(), background_color, gfx::Borders{}, corners);
     }
 }
 
-void do_render(gfx::Painter &painter, layout::LayoutBox const &layout) {
-    if (auto const *text = try_get_text(layout)) {
-        render_text(painter, layout, *text);
+void do_render(gfx::Painter &painter, style::StyledNode const &node, layout::BoxModel const &dimensions) {
+    if (auto const *text = try_get_text(node)) {
+        render_text(painter, node, dimensions, *text);
     } else {
-        render_element(painter, layout);
+        render_element(painter, node, dimensions);
     }
 }
 
-bool should_render(layout::LayoutBox const &layout) {
-    return layout.type == layout::LayoutType::Block || layout.type == layout::LayoutType::Inline;
+bool should_render(layout::LayoutType type) {
+    return type == layout::LayoutType::Block || type == layout::LayoutType::Inline;
 }
 
 } // namespace
 
 void render_layout(gfx::Painter &painter, layout::LayoutBox const &layout) {
-    if (should_render(layout)) {
-        do_render(painter, layout);
+    if (should_render(layout.type)) {
+        do_render(painter, *layout.node, layout.dimensions);
     }
 
     for (auto const &child : layout.children) {
@@ -139,6 +145,46 @@ void render_layout(gfx::Painter &painter, layout::LayoutBox const &layout) {
     }
 }
 
+// Boxes are stored in pre-order, so they're already in the order they're painted in.
+void render_layout(gfx::Painter &painter, layout::FlatLayout const &layout) {
+    for (layout::FlatLayout::Index box = 0; box < layout.size(); ++box) {
+        if (should_render(layout.type(box))) {
+            do_render(painter, *layout.node(box), layout.dimensions(box));
+        }
+    }
+}
+
+DisplayList build_display_list(layout::FlatLayout const &layout) {
+    gfx::CanvasCommandSaver saver;
+    gfx::Painter painter{saver};
+    std::vector<DisplayItem> items;
+    items.reserve(layout.size());
+    for (layout::FlatLayout::Index box = 0; box < layout.size(); ++box) {
+        if (!should_render(layout.type(box))) {
+            continue;
+        }
+
+        auto const &dimensions = layout.dimensions(box);
+        do_render(painter, *layout.node(box), dimensions);
+        for (auto &command : saver.take_commands()) {
+            // Text is culled the same way gfx::TiledCanvas bins it into tiles.
+            auto bounds = std::visit(
+                    [&]<typename CommandT>(CommandT const &c) {
+                        if constexpr (std::is_same_v<CommandT, gfx::DrawTextCmd>
+                                || std::is_same_v<CommandT, gfx::DrawTextWithFontOptionsCmd>) {
+                            return gfx::padded_text_bounds(dimensions.content, gfx::FontSize{c.size});
+                        } else {
+                            return dimensions.border_box();
+                        }
+                    },
+                    command);
+            items.push_back({bounds, std::move(command)});
+        }
+    }
+
+    return DisplayList{std::move(items)};
+}
+
 namespace debug {
 
 void render_layout_depth(gfx::Painter &painter, layout::LayoutBox const &layout) {
@@ -148,5 +194,11 @@ void render_layout_depth(gfx::Painter &painter, layout::LayoutBox const &layout)
     }
 }
 
+void render_layout_depth(gfx::Painter &painter, layout::FlatLayout const &layout) {
+    for (layout::FlatLayout::Index box = 0; box < layout.size(); ++box) {
+        painter.fill_rect(layout.dimensions(box).padding_box(), {0xFF, 0xFF, 0xFF, 0x30});
+    }
+}
+
 } // namespace debug
 } // namespace render
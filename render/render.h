@@ -6,14 +6,22 @@
 #define RENDER_RENDER_H_
 
 #include "gfx/painter.h"
+#include "layout/flat_layout.h"
 #include "layout/layout.h"
+#include "render/display_list.h"
 
 namespace render {
 
 void render_layout(gfx::Painter &, layout::LayoutBox const &);
+void render_layout(gfx::Painter &, layout::FlatLayout const &);
+
+// Draws the same thing as render_layout when replayed, but without having to
+// look at the layout or its styles again.
+DisplayList build_display_list(layout::FlatLayout const &);
 
 namespace debug {
 void render_layout_depth(gfx::Painter &, layout::LayoutBox const &);
+void render_layout_depth(gfx::Painter &, layout::FlatLayout const &);
 } // namespace debug
 } // namespace render
 
@@ -9,9 +9,12 @@
 #include "gfx/canvas_command_saver.h"
 #include "gfx/color.h"
 #include "gfx/icanvas.h"
+#include "layout/flat_layout.h"
 #include "layout/layout.h"
 #include "style/styled_node.h"
 
+#include <cstddef>
+
 using etest::expect_eq;
 
 using CanvasCommands = std::vector<gfx::CanvasCommand>;
@@ -212,24 +215,28 @@ int main() {
 
         // #rgba
         styled.properties = {{css::PropertyId::BackgroundColor, "#abcd"}};
+        styled.invalidate_computed_style();
         auto cmd = gfx::DrawRectCmd{.rect{0, 0, 20, 20}, .color{gfx::Color{0xaa, 0xbb, 0xcc, 0xdd}}};
         render::render_layout(painter, layout);
         expect_eq(saver.take_commands(), CanvasCommands{std::move(cmd)});
 
         // #rrggbbaa
         styled.properties = {{css::PropertyId::BackgroundColor, "#12345678"}};
+        styled.invalidate_computed_style();
         cmd = gfx::DrawRectCmd{.rect{0, 0, 20, 20}, .color{gfx::Color{0x12, 0x34, 0x56, 0x78}}};
         render::render_layout(painter, layout);
         expect_eq(saver.take_commands(), CanvasCommands{std::move(cmd)});
 
         // #rgb
         styled.properties = {{css::PropertyId::BackgroundColor, "#abc"}};
+        styled.invalidate_computed_style();
         cmd = gfx::DrawRectCmd{.rect{0, 0, 20, 20}, .color{gfx::Color{0xaa, 0xbb, 0xcc}}};
         render::render_layout(painter, layout);
         expect_eq(saver.take_commands(), CanvasCommands{std::move(cmd)});
 
         // #rrggbb
         styled.properties = {{css::PropertyId::BackgroundColor, "#123456"}};
+        styled.invalidate_computed_style();
         cmd = gfx::DrawRectCmd{.rect{0, 0, 20, 20}, .color{gfx::Color{0x12, 0x34, 0x56}}};
         render::render_layout(painter, layout);
         expect_eq(saver.take_commands(), CanvasCommands{std::move(cmd)});
@@ -249,60 +256,70 @@ int main() {
 
         // rgb, working
         styled.properties = {{css::PropertyId::BackgroundColor, "rgb(1, 2, 3)"}};
+        styled.invalidate_computed_style();
         auto cmd = gfx::DrawRectCmd{.rect{0, 0, 20, 20}, .color{gfx::Color{1, 2, 3}}};
         render::render_layout(painter, layout);
         expect_eq(saver.take_commands(), CanvasCommands{std::move(cmd)});
 
         // rgb, rgba should be an alias of rgb
         styled.properties = {{css::PropertyId::BackgroundColor, "rgba(100, 200, 255)"}};
+        styled.invalidate_computed_style();
         cmd = gfx::DrawRectCmd{.rect{0, 0, 20, 20}, .color{gfx::Color{100, 200, 255}}};
         render::render_layout(painter, layout);
         expect_eq(saver.take_commands(), CanvasCommands{std::move(cmd)});
 
         // rgb, with alpha
         styled.properties = {{css::PropertyId::BackgroundColor, "rgb(1, 2, 3, 0.5)"}};
+        styled.invalidate_computed_style();
         cmd = gfx::DrawRectCmd{.rect{0, 0, 20, 20}, .color{gfx::Color{1, 2, 3, 127}}};
         render::render_layout(painter, layout);
         expect_eq(saver.take_commands(), CanvasCommands{std::move(cmd)});
 
         // rgb, with alpha
         styled.properties = {{css::PropertyId::BackgroundColor, "rgb(1, 2, 3, 0.2)"}};
+        styled.invalidate_computed_style();
         cmd = gfx::DrawRectCmd{.rect{0, 0, 20, 20}, .color{gfx::Color{1, 2, 3, 51}}};
         render::render_layout(painter, layout);
         expect_eq(saver.take_commands(), CanvasCommands{std::move(cmd)});
 
         // rgb, alpha out of range
         styled.properties = {{css::PropertyId::BackgroundColor, "rgb(1, 2, 3, 2)"}};
+        styled.invalidate_computed_style();
         cmd = gfx::DrawRectCmd{.rect{0, 0, 20, 20}, .color{gfx::Color{1, 2, 3, 0xFF}}};
         render::render_layout(painter, layout);
         expect_eq(saver.take_commands(), CanvasCommands{std::move(cmd)});
 
         // rgb, garbage values in alpha
         styled.properties = {{css::PropertyId::BackgroundColor, "rgb(1, 2, 3, blergh)"}};
+        styled.invalidate_computed_style();
         cmd = gfx::DrawRectCmd{.rect{0, 0, 20, 20}, .color{kInvalidColor}};
         render::render_layout(painter, layout);
         expect_eq(saver.take_commands(), CanvasCommands{std::move(cmd)});
 
         // rgb, missing closing paren
         styled.properties = {{css::PropertyId::BackgroundColor, "rgb(1, 2, 3"}};
+        styled.invalidate_computed_style();
         cmd = gfx::DrawRectCmd{.rect{0, 0, 20, 20}, .color{kInvalidColor}};
         render::render_layout(painter, layout);
         expect_eq(saver.take_commands(), CanvasCommands{std::move(cmd)});
 
         // rgb, value out of range
         styled.properties = {{css::PropertyId::BackgroundColor, "rgb(-1, 2, 3)"}};
+        styled.invalidate_computed_style();
         render::render_layout(painter, layout);
         cmd = gfx::DrawRectCmd{.rect{0, 0, 20, 20}, .color{kInvalidColor}};
         expect_eq(saver.take_commands(), CanvasCommands{std::move(cmd)});
 
         // rgb, wrong number of arguments
         styled.properties = {{css::PropertyId::BackgroundColor, "rgb(1, 2)"}};
+        styled.invalidate_computed_style();
         render::render_layout(painter, layout);
         cmd = gfx::DrawRectCmd{.rect{0, 0, 20, 20}, .color{kInvalidColor}};
         expect_eq(saver.take_commands(), CanvasCommands{std::move(cmd)});
 
         // rgb, garbage value
         styled.properties = {{css::PropertyId::BackgroundColor, "rgb(a, 2, 3)"}};
+        styled.invalidate_computed_style();
         render::render_layout(painter, layout);
         cmd = gfx::DrawRectCmd{.rect{0, 0, 20, 20}, .color{kInvalidColor}};
         expect_eq(saver.take_commands(), CanvasCommands{std::move(cmd)});
@@ -334,6 +351,7 @@ int main() {
 
         styled.properties[0].second = "underline";
         styled.properties.push_back({css::PropertyId::FontStyle, "italic"});
+        styled.invalidate_computed_style();
 
         render::render_layout(painter, layout);
         expect_eq(saver.take_commands(),
@@ -347,6 +365,7 @@ int main() {
                 }});
 
         styled.properties[0].second = "blink";
+        styled.invalidate_computed_style();
 
         render::render_layout(painter, layout);
         expect_eq(saver.take_commands(),
@@ -360,5 +379,86 @@ int main() {
                 }});
     });
 
+    etest::test("flat layout", [] {
+        dom::Node dom = dom::Element{"div", {}, {dom::Element{"p"}, dom::Text{"hello"}}};
+        auto const &children = std::get<dom::Element>(dom).children;
+        auto styled = style::StyledNode{
+                .node = dom,
+                .properties = {{css::PropertyId::Display, "block"}, {css::PropertyId::BackgroundColor, "#0A0B0C"}},
+                .children{
+                        {children[0], {{css::PropertyId::Display, "block"}, {css::PropertyId::Color, "red"}}},
+                        {children[1], {{css::PropertyId::Display, "inline"}}},
+                },
+        };
+
+        auto layout = layout::LayoutBox{
+                .node = &styled,
+                .type = layout::LayoutType::Block,
+                .dimensions = {{0, 0, 20, 10}},
+                .children{
+                        {&styled.children[0], layout::LayoutType::Block, {{0, 0, 20, 5}, {}, {1, 1, 1, 1}}},
+                        {nullptr, layout::LayoutType::AnonymousBlock, {{0, 5, 20, 5}}, {
+                            {&styled.children[1], layout::LayoutType::Inline, {{0, 5, 20, 5}}},
+                        }},
+                },
+        };
+
+        gfx::CanvasCommandSaver saver;
+        gfx::Painter painter{saver};
+        render::render_layout(painter, layout);
+        auto expected = saver.take_commands();
+        expect_eq(expected.size(), std::size_t{3});
+
+        render::render_layout(painter, layout::FlatLayout::from(layout));
+        expect_eq(saver.take_commands(), expected);
+
+        render::debug::render_layout_depth(painter, layout);
+        expected = saver.take_commands();
+        render::debug::render_layout_depth(painter, layout::FlatLayout::from(layout));
+        expect_eq(saver.take_commands(), expected);
+    });
+
+    etest::test("display list", [] {
+        dom::Node dom = dom::Element{"div", {}, {dom::Element{"p"}, dom::Text{"hello"}}};
+        auto const &children = std::get<dom::Element>(dom).children;
+        auto styled = style::StyledNode{
+                .node = dom,
+                .properties = {{css::PropertyId::Display, "block"}, {css::PropertyId::BackgroundColor, "#0A0B0C"}},
+                .children{
+                        {children[0], {{css::PropertyId::Display, "block"}, {css::PropertyId::Color, "red"}}},
+                        {children[1], {{css::PropertyId::Display, "inline"}}},
+                },
+        };
+
+        auto layout = layout::LayoutBox{
+                .node = &styled,
+                .type = layout::LayoutType::Block,
+                .dimensions = {{0, 0, 20, 10}},
+                .children{
+                        {&styled.children[0], layout::LayoutType::Block, {{0, 0, 20, 5}, {}, {1, 1, 1, 1}}},
+                        {nullptr, layout::LayoutType::AnonymousBlock, {{0, 5, 20, 5}}, {
+                            {&styled.children[1], layout::LayoutType::Inline, {{0, 5, 20, 5}}},
+                        }},
+                },
+        };
+
+        gfx::CanvasCommandSaver saver;
+        gfx::Painter painter{saver};
+        render::render_layout(painter, layout);
+        auto const expected = saver.take_commands();
+
+        auto const display_list = render::build_display_list(layout::FlatLayout::from(layout));
+        display_list.replay(saver);
+        expect_eq(saver.take_commands(), expected);
+
+        // The p's border box ends at y=6.
+        display_list.replay(saver, {0, 7, 20, 10});
+        expect_eq(saver.take_commands(), CanvasCommands{expected[0], expected[2]});
+
+        // Glyphs may reach below the text's box, so it's kept a bit longer than the div's background.
+        display_list.replay(saver, {0, 12, 20, 2});
+        expect_eq(saver.take_commands(), CanvasCommands{expected[2]});
+    });
+
     return etest::run_all_tests();
 }
@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef STYLE_COMPUTED_STYLE_H_
+#define STYLE_COMPUTED_STYLE_H_
+
+#include "gfx/color.h"
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace style {
+
+enum class BorderStyle {
+    None,
+    Hidden,
+    Dotted,
+    Dashed,
+    Solid,
+    Double,
+    Groove,
+    Ridge,
+    Inset,
+    Outset,
+};
+
+enum class DisplayValue {
+    None,
+    Inline,
+    Block,
+};
+
+enum class FontStyle {
+    Normal,
+    Italic,
+    Oblique,
+};
+
+enum class TextDecorationLine {
+    None,
+    Underline,
+    Overline,
+    LineThrough,
+    Blink,
+};
+
+template<typename T>
+struct Sides {
+    T top{};
+    T right{};
+    T bottom{};
+    T left{};
+    [[nodiscard]] bool operator==(Sides const &) const = default;
+};
+
+// The values of all properties we handle for a node, parsed, with keywords
+// like inherit and currentcolor and font-relative lengths resolved.
+struct ComputedStyle {
+    DisplayValue display{DisplayValue::Inline};
+
+    gfx::Color color{};
+    gfx::Color background_color{};
+
+    std::vector<std::string> font_family{};
+    int font_size{};
+    FontStyle font_style{FontStyle::Normal};
+    std::vector<TextDecorationLine> text_decoration_line{};
+
+    // std::nullopt means auto.
+    Sides<std::optional<int>> margin{};
+    Sides<int> padding{};
+    Sides<BorderStyle> border_style{};
+    Sides<int> border_width{};
+    Sides<gfx::Color> border_color{};
+
+    // {horizontal, vertical}
+    std::pair<int, int> border_top_left_radius{};
+    std::pair<int, int> border_top_right_radius{};
+    std::pair<int, int> border_bottom_left_radius{};
+    std::pair<int, int> border_bottom_right_radius{};
+
+    // std::nullopt means auto for width and min-width, and none for max-width.
+    std::optional<int> width{};
+    std::optional<int> min_width{};
+    std::optional<int> max_width{};
+
+    // std::nullopt means auto for height and min-height, and none for max-height.
+    std::optional<int> height{};
+    std::optional<int> min_height{};
+    std::optional<int> max_height{};
+
+    [[nodiscard]] bool operator==(ComputedStyle const &) const = default;
+};
+
+} // namespace style
+
+#endif
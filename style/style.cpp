@@ -5,11 +5,17 @@
 #include "style/style.h"
 
 #include "css/media_query.h"
+#include "style/stylesheet_index.h"
 #include "util/string.h"
+#include "util/work_stealing_pool.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <iterator>
+#include <tuple>
 #include <utility>
+#include <variant>
+#include <vector>
 
 namespace style {
 namespace {
@@ -93,7 +99,7 @@ std::vector<std::pair<css::PropertyId, std::string>> matching_rules(
 namespace {
 void style_tree_impl(StyledNode &current,
         dom::Node const &root,
-        std::vector<css::Rule> const &stylesheet,
+        StylesheetIndex const &stylesheet,
         css::MediaQuery::Context const &ctx) {
     if (auto const *element = std::get_if<dom::Element>(&root)) {
         current.children.reserve(element->children.size());
@@ -107,16 +113,84 @@ void style_tree_impl(StyledNode &current,
     }
 
     if (auto const *element = std::get_if<dom::Element>(&root)) {
-        current.properties = matching_rules(*element, stylesheet, ctx);
+        current.properties = stylesheet.matching_rules(*element, ctx);
+    }
+}
+
+void compute_styles(StyledNode const &node) {
+    std::ignore = node.computed();
+    for (auto const &child : node.children) {
+        compute_styles(child);
+    }
+}
+
+// Below this, handing the work out to other threads costs more than it saves.
+constexpr std::size_t kMinElementsForParallelStyling = 1024;
+constexpr std::size_t kElementsPerTask = 256;
+
+// Creates the StyledNode tree without matching any rules, collecting the
+// element nodes in tree order so that consecutive runs of them, i.e. mostly
+// whole subtrees, can be styled as separate tasks.
+void create_tree_structure(StyledNode &current, dom::Node const &root, std::vector<StyledNode *> &elements) {
+    auto const *element = std::get_if<dom::Element>(&root);
+    if (element == nullptr) {
+        return;
+    }
+
+    elements.push_back(&current);
+    // The reservation keeps the pointers collected in elements valid.
+    current.children.reserve(element->children.size());
+    for (auto const &child : element->children) {
+        // TODO(robinlinden): emplace_back once Clang supports it (C++20/p0960). Not supported as of Clang 14.
+        current.children.push_back({child});
+        auto &child_node = current.children.back();
+        create_tree_structure(child_node, child, elements);
+        child_node.parent = &current;
     }
 }
 } // namespace
 
 std::unique_ptr<StyledNode> style_tree(
         dom::Node const &root, std::vector<css::Rule> const &stylesheet, css::MediaQuery::Context const &ctx) {
+    return style_tree(root, StylesheetIndex{stylesheet}, ctx);
+}
+
+std::unique_ptr<StyledNode> style_tree(
+        dom::Node const &root, StylesheetIndex const &stylesheet, css::MediaQuery::Context const &ctx) {
     // TODO(robinlinden): std::make_unique once Clang supports it (C++20/p0960). Not supported as of Clang 14.
     auto tree_root = std::unique_ptr<StyledNode>(new StyledNode{root});
     style_tree_impl(*tree_root, root, stylesheet, ctx);
+    compute_styles(*tree_root);
+    return tree_root;
+}
+
+std::unique_ptr<StyledNode> style_tree(dom::Node const &root,
+        StylesheetIndex const &stylesheet,
+        css::MediaQuery::Context const &ctx,
+        util::WorkStealingPool &pool) {
+    // TODO(robinlinden): std::make_unique once Clang supports it (C++20/p0960). Not supported as of Clang 14.
+    auto tree_root = std::unique_ptr<StyledNode>(new StyledNode{root});
+    std::vector<StyledNode *> elements;
+    create_tree_structure(*tree_root, root, elements);
+
+    auto style_elements = [&](std::size_t first, std::size_t last) {
+        for (auto i = first; i < last; ++i) {
+            elements[i]->properties = stylesheet.matching_rules(std::get<dom::Element>(elements[i]->node), ctx);
+        }
+    };
+
+    if (elements.size() < kMinElementsForParallelStyling) {
+        style_elements(0, elements.size());
+    } else {
+        auto const tasks = (elements.size() + kElementsPerTask - 1) / kElementsPerTask;
+        pool.parallel_for(tasks, [&](std::size_t task) {
+            style_elements(task * kElementsPerTask, std::min((task + 1) * kElementsPerTask, elements.size()));
+        });
+    }
+
+    // Every node's computed style depends on its parent's, so this is done
+    // top-down once all rules have been matched.
+    compute_styles(*tree_root);
     return tree_root;
 }
 
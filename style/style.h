@@ -10,6 +10,8 @@
 #include "css/rule.h"
 #include "dom/dom.h"
 #include "style/styled_node.h"
+#include "style/stylesheet_index.h"
+#include "util/work_stealing_pool.h"
 
 #include <memory>
 #include <string>
@@ -27,6 +29,16 @@ std::vector<std::pair<css::PropertyId, std::string>> matching_rules(
 std::unique_ptr<StyledNode> style_tree(
         dom::Node const &root, std::vector<css::Rule> const &stylesheet, css::MediaQuery::Context const & = {});
 
+std::unique_ptr<StyledNode> style_tree(
+        dom::Node const &root, StylesheetIndex const &stylesheet, css::MediaQuery::Context const & = {});
+
+// Matches rules for different parts of the tree on the pool's threads. The
+// resulting tree is identical to the one the single-threaded overloads create.
+std::unique_ptr<StyledNode> style_tree(dom::Node const &root,
+        StylesheetIndex const &stylesheet,
+        css::MediaQuery::Context const &,
+        util::WorkStealingPool &);
+
 } // namespace style
 
 #endif
@@ -0,0 +1,93 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "style/style.h"
+#include "style/stylesheet_index.h"
+
+#include "css/property_id.h"
+#include "css/rule.h"
+#include "dom/dom.h"
+#include "util/work_stealing_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// A few thousand rules, a mix of tag, class, and id selectors.
+std::vector<css::Rule> generate_stylesheet() {
+    std::vector<css::Rule> stylesheet;
+    for (int i = 0; i < 3000; ++i) {
+        auto selector = i % 3 == 0 ? ".c" + std::to_string(i % 200)
+                : i % 3 == 1       ? "#id" + std::to_string(i)
+                                   : "t" + std::to_string(i % 50);
+        stylesheet.push_back(css::Rule{
+                .selectors{std::move(selector)},
+                .declarations{{css::PropertyId::Color, "red"}, {css::PropertyId::Width, "10px"}},
+        });
+    }
+    return stylesheet;
+}
+
+// ~100k elements, 10 levels deep.
+dom::Node generate_dom() {
+    int id = 0;
+    auto generate = [&](auto &self, int depth) -> dom::Node {
+        dom::Element element{"t" + std::to_string(id % 60),
+                {{"class", "c" + std::to_string(id % 300) + " c" + std::to_string(id % 7)},
+                        {"id", "id" + std::to_string(id)}},
+                {}};
+        ++id;
+        if (depth < 10) {
+            for (int i = 0; i < (depth < 4 ? 4 : 2); ++i) {
+                element.children.push_back(self(self, depth + 1));
+            }
+            element.children.emplace_back(dom::Text{"Lorem ipsum"});
+        }
+        return element;
+    };
+
+    return generate(generate, 0);
+}
+
+} // namespace
+
+// Usage: style_bench [max threads]
+// Styles a generated document using the single-threaded style_tree, and then
+// with 1 up to [max threads] threads, defaulting to the number of cores.
+int main(int argc, char **argv) {
+    auto max_threads = std::max(1U, std::thread::hardware_concurrency());
+    if (argc > 1) {
+        max_threads = static_cast<unsigned>(std::atoi(argv[1]));
+    }
+
+    auto const stylesheet = generate_stylesheet();
+    style::StylesheetIndex const index{stylesheet};
+    auto const dom = generate_dom();
+
+    auto time = [](auto const &fn) {
+        constexpr int kIterations = 5;
+        auto const start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kIterations; ++i) {
+            fn();
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+                / kIterations;
+    };
+
+    auto const single_threaded = time([&] { return style::style_tree(dom, index); });
+    std::cout << "single-threaded: " << single_threaded << " ms\n";
+
+    for (unsigned threads = 1; threads <= max_threads; ++threads) {
+        util::WorkStealingPool pool{threads};
+        auto const ms = time([&] { return style::style_tree(dom, index, {}, pool); });
+        std::cout << threads << " thread(s): " << ms << " ms, " << single_threaded / ms << "x\n";
+    }
+}
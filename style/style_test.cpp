@@ -7,6 +7,7 @@
 
 #include "css/rule.h"
 #include "etest/etest.h"
+#include "util/work_stealing_pool.h"
 
 #include <fmt/format.h>
 
@@ -182,5 +183,52 @@ int main() {
         expect(check_parents(*style::style_tree(root, stylesheet), expected));
     });
 
+    etest::test("style_tree: computed styles are filled in", [] {
+        dom::Node root = dom::Element{"html", {}, {dom::Element{"p", {}, {dom::Text{"hello"}}}}};
+        std::vector<css::Rule> stylesheet{
+                {.selectors = {"html"}, .declarations = {{css::PropertyId::FontSize, "20px"}}},
+                {.selectors = {"p"}, .declarations = {{css::PropertyId::Width, "2em"}}},
+        };
+
+        auto styled = style::style_tree(root, stylesheet);
+        auto const &p = styled->children.at(0);
+        auto const &text = p.children.at(0);
+        require(styled->computed_style.has_value());
+        require(p.computed_style.has_value());
+        require(text.computed_style.has_value());
+        expect_eq(p.computed_style->font_size, 20);
+        expect_eq(p.computed_style->width, std::optional{40});
+        expect(*text.computed_style == *p.computed_style);
+    });
+
+    etest::test("style_tree: parallel", [] {
+        dom::Node root_node = dom::Element{"html", {}, {}};
+        auto &root = std::get<dom::Element>(root_node);
+        for (int i = 0; i < 100; ++i) {
+            auto &div = std::get<dom::Element>(root.children.emplace_back(dom::Element{"div", {}, {}}));
+            for (int j = 0; j < 20; ++j) {
+                div.children.emplace_back(dom::Element{"p", {{"class", fmt::format("c{}", j)}}, {}});
+                div.children.emplace_back(dom::Text{"hello"});
+            }
+        }
+
+        std::vector<css::Rule> stylesheet{
+                {.selectors = {"p"}, .declarations = {{css::PropertyId::Height, "100px"}}},
+                {.selectors = {".c3", ".c7"}, .declarations = {{css::PropertyId::Color, "red"}}},
+                {.selectors = {"div"}, .declarations = {{css::PropertyId::FontSize, "500em"}}},
+        };
+
+        auto expected = style::style_tree(root_node, stylesheet);
+        util::WorkStealingPool pool{4};
+        auto styled = style::style_tree(root_node, style::StylesheetIndex{stylesheet}, {}, pool);
+        expect(*styled == *expected);
+        expect(check_parents(*styled, *expected));
+
+        // Small trees are styled on the calling thread.
+        auto small = dom::Element{"html", {}, {dom::Element{"p"}}};
+        expect(*style::style_tree(small, style::StylesheetIndex{stylesheet}, {}, pool)
+                == *style::style_tree(small, stylesheet));
+    });
+
     return etest::run_all_tests();
 }
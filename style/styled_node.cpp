@@ -10,15 +10,23 @@
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <array>
 #include <charconv>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <iterator>
 #include <map>
+#include <mutex>
 #include <optional>
 #include <sstream>
+#include <string>
 #include <string_view>
+#include <system_error>
 #include <utility>
+#include <variant>
+#include <vector>
 
 #include "util/from_chars.h"
 
@@ -250,54 +258,7 @@ std::optional<std::pair<float, std::string_view>> split_into_value_and_unit(std:
     return std::pair{res, unit};
 }
 
-} // namespace
-
-std::string_view StyledNode::get_raw_property(css::PropertyId property) const {
-    // We don't support selector specificity yet, so the last property is found
-    // in order to allow website style to override the browser built-in style.
-    auto it = std::ranges::find_if(
-            rbegin(properties), rend(properties), [=](auto const &p) { return p.first == property; });
-
-    // TODO(robinlinden): Having a special case for dom::Text here doesn't feel good.
-    // You can't set properties on text nodes in HTML (even though we do in
-    // tests), so let's grab this from the parent node.
-    if (it == rend(properties) && std::holds_alternative<dom::Text>(node) && parent != nullptr) {
-        return parent->get_raw_property(property);
-    }
-
-    if (it == rend(properties) || it->second == "unset") {
-        // https://developer.mozilla.org/en-US/docs/Web/CSS/unset
-        if (is_inherited(property) && parent != nullptr) {
-            return parent->get_raw_property(property);
-        }
-
-        return kInitialValues.at(property);
-    } else if (it->second == "initial") {
-        // https://developer.mozilla.org/en-US/docs/Web/CSS/initial
-        return kInitialValues.at(property);
-    } else if (it->second == "inherit") {
-        // https://developer.mozilla.org/en-US/docs/Web/CSS/inherit
-        return get_parent_raw_property(*this, property);
-    } else if (it->second == "currentcolor") {
-        // https://developer.mozilla.org/en-US/docs/Web/CSS/color_value#currentcolor_keyword
-        // If the "color" property has the value "currentcolor", treat it as "inherit".
-        if (it->first == css::PropertyId::Color) {
-            return get_parent_raw_property(*this, property);
-        }
-
-        // Even though we return the correct value here, if a property has
-        // "currentcolor" as its initial value, the caller have to manually look
-        // up the value of "color". This will be cleaned up along with the rest
-        // of the property management soon.
-        return get_raw_property(css::PropertyId::Color);
-    }
-
-    return it->second;
-}
-
-BorderStyle StyledNode::get_border_style_property(css::PropertyId property) const {
-    auto raw = get_raw_property(property);
-
+BorderStyle parse_border_style(std::string_view raw) {
     if (raw == "none") {
         return BorderStyle::None;
     } else if (raw == "hidden") {
@@ -324,19 +285,7 @@ BorderStyle StyledNode::get_border_style_property(css::PropertyId property) cons
     return BorderStyle::None;
 }
 
-gfx::Color StyledNode::get_color_property(css::PropertyId property) const {
-    auto color_text = get_raw_property(property);
-
-    // https://developer.mozilla.org/en-US/docs/Web/CSS/color_value#currentcolor_keyword
-    if (color_text == "currentcolor") {
-        color_text = get_raw_property(css::PropertyId::Color);
-    }
-
-    return parse_color(color_text);
-}
-
-DisplayValue StyledNode::get_display_property() const {
-    auto raw = get_raw_property(css::PropertyId::Display);
+DisplayValue parse_display(std::string_view raw) {
     if (raw == "none") {
         return DisplayValue::None;
     } else if (raw == "inline") {
@@ -349,8 +298,7 @@ DisplayValue StyledNode::get_display_property() const {
     return DisplayValue::Block;
 }
 
-FontStyle StyledNode::get_font_style_property() const {
-    auto raw = get_raw_property(css::PropertyId::FontStyle);
+FontStyle parse_font_style(std::string_view raw) {
     if (raw == "normal") {
         return FontStyle::Normal;
     } else if (raw == "italic") {
@@ -363,7 +311,7 @@ FontStyle StyledNode::get_font_style_property() const {
     return FontStyle::Normal;
 }
 
-std::vector<TextDecorationLine> StyledNode::get_text_decoration_line_property() const {
+std::vector<TextDecorationLine> parse_text_decoration_line(std::string_view raw) {
     auto into = [](std::string_view v) -> std::optional<TextDecorationLine> {
         if (v == "none") {
             return TextDecorationLine::None;
@@ -383,7 +331,7 @@ std::vector<TextDecorationLine> StyledNode::get_text_decoration_line_property()
 
     std::vector<TextDecorationLine> lines;
 
-    auto parts = util::split(get_raw_property(css::PropertyId::TextDecorationLine), " ");
+    auto parts = util::split(raw, " ");
     for (auto const &part : parts) {
         if (auto line = into(part)) {
             lines.push_back(*line);
@@ -395,7 +343,7 @@ std::vector<TextDecorationLine> StyledNode::get_text_decoration_line_property()
     return lines;
 }
 
-static int const kDefaultFontSize{10};
+constexpr int kDefaultFontSize{10};
 // https://w3c.github.io/csswg-drafts/css-fonts-4/#absolute-size-mapping
 constexpr int kMediumFontSize = kDefaultFontSize;
 std::map<std::string_view, float> const kFontSizeAbsoluteSizeKeywords{
@@ -409,32 +357,117 @@ std::map<std::string_view, float> const kFontSizeAbsoluteSizeKeywords{
         {"xxx-large", 3 / 1.f},
 };
 
-int StyledNode::get_font_size_property() const {
-    auto get_closest_font_size_and_owner =
-            [](StyledNode const *starting_node) -> std::optional<std::pair<std::string_view, StyledNode const *>> {
-        for (auto const *n = starting_node; n != nullptr; n = n->parent) {
-            auto it = std::ranges::find_if(rbegin(n->properties), rend(n->properties), [](auto const &v) {
-                return v.first == css::PropertyId::FontSize;
-            });
-            if (it != rend(n->properties)) {
-                return {{it->second, n}};
-            }
-        }
+// TODO(robinlinden):
+// * margin, border, etc.
+// * Not all measurements have to be in pixels.
+// * %, rem
+int to_px(std::string_view property, int const font_size) {
+    // Special case for 0 since it won't ever have a unit that needs to be handled.
+    if (property == "0") {
+        return 0;
+    }
+
+    float res{};
+    auto parse_result = util::from_chars(property.data(), property.data() + property.size(), res);
+    if (parse_result.ec != std::errc{}) {
+        spdlog::warn("Unable to parse property '{}' in to_px", property);
+        return 0;
+    }
+
+    auto const parsed_length = std::distance(property.data(), parse_result.ptr);
+    auto const unit = property.substr(parsed_length);
+
+    if (unit == "px") {
+        return static_cast<int>(res);
+    }
+
+    if (unit == "em") {
+        res *= static_cast<float>(font_size);
+        return static_cast<int>(res);
+    }
 
+    spdlog::warn("Bad property '{}' w/ unit '{}' in to_px", property, unit);
+    return static_cast<int>(res);
+}
+
+// https://w3c.github.io/csswg-drafts/css-backgrounds/#the-border-width
+std::map<std::string_view, int> const kBorderWidthKeywords{
+        {"thin", 3},
+        {"medium", 5},
+        {"thick", 7},
+};
+
+std::vector<std::string> parse_font_family(std::string_view raw) {
+    std::vector<std::string> families;
+    std::ranges::transform(util::split(raw, ","), std::back_inserter(families), [](auto family) {
+        return std::string{util::trim(family)};
+    });
+    return families;
+}
+
+std::optional<std::string_view> declared_value(StyledNode const &node, css::PropertyId property) {
+    // The last declaration wins, see StyledNode::get_raw_property.
+    auto it = std::ranges::find_if(
+            rbegin(node.properties), rend(node.properties), [=](auto const &p) { return p.first == property; });
+    if (it == rend(node.properties)) {
         return std::nullopt;
-    };
+    }
 
-    auto closest = get_closest_font_size_and_owner(this);
-    if (!closest) {
-        return kDefaultFontSize;
+    return it->second;
+}
+
+// Resolves a property the same way as StyledNode::get_raw_property, except
+// that inherited values are taken from the parent's computed style instead
+// of being looked up and parsed again.
+template<typename GetT, typename ParseT>
+auto compute_property(StyledNode const &node,
+        ComputedStyle const *parent,
+        css::PropertyId property,
+        GetT const &get,
+        ParseT const &parse) -> decltype(parse(std::string_view{})) {
+    auto const value = declared_value(node, property);
+
+    // You can't set properties on text nodes in HTML (even though we do in
+    // tests), so everything comes from the parent node.
+    if (!value && std::holds_alternative<dom::Text>(node.node) && parent != nullptr) {
+        return get(*parent);
+    }
+
+    // https://developer.mozilla.org/en-US/docs/Web/CSS/unset
+    if (!value || *value == "unset") {
+        if (css::is_inherited(property) && parent != nullptr) {
+            return get(*parent);
+        }
+
+        return parse(kInitialValues.at(property));
+    }
+
+    // https://developer.mozilla.org/en-US/docs/Web/CSS/initial
+    if (*value == "initial") {
+        return parse(kInitialValues.at(property));
+    }
+
+    // https://developer.mozilla.org/en-US/docs/Web/CSS/inherit
+    // If the "color" property has the value "currentcolor", treat it as "inherit".
+    if (*value == "inherit" || (*value == "currentcolor" && property == css::PropertyId::Color)) {
+        return parent != nullptr ? get(*parent) : parse(kInitialValues.at(property));
     }
-    auto raw_value = closest->first;
 
-    if (kFontSizeAbsoluteSizeKeywords.contains(raw_value)) {
-        return std::lround(kFontSizeAbsoluteSizeKeywords.at(raw_value) * kMediumFontSize);
+    return parse(*value);
+}
+
+int compute_font_size(StyledNode const &node) {
+    auto const parent_font_size = node.parent != nullptr ? node.parent->computed().font_size : kDefaultFontSize;
+    auto const raw_value = declared_value(node, css::PropertyId::FontSize);
+    if (!raw_value) {
+        return parent_font_size;
+    }
+
+    if (kFontSizeAbsoluteSizeKeywords.contains(*raw_value)) {
+        return std::lround(kFontSizeAbsoluteSizeKeywords.at(*raw_value) * kMediumFontSize);
     }
 
-    auto value_and_unit = split_into_value_and_unit(raw_value);
+    auto value_and_unit = split_into_value_and_unit(*raw_value);
     if (!value_and_unit) {
         return kDefaultFontSize;
     }
@@ -448,37 +481,225 @@ int StyledNode::get_font_size_property() const {
         return static_cast<int>(value);
     }
 
-    auto parent_or_default_font_size = [&] {
-        auto const *owner = closest->second;
-        if (owner->parent == nullptr) {
-            return kDefaultFontSize;
-        }
-
-        return owner->parent->get_font_size_property();
-    };
-
     if (unit == "em") {
-        return static_cast<int>(value * parent_or_default_font_size());
+        return static_cast<int>(value * parent_font_size);
     }
 
     if (unit == "%") {
-        return static_cast<int>(value / 100.f * parent_or_default_font_size());
+        return static_cast<int>(value / 100.f * parent_font_size);
     }
 
     if (unit == "rem") {
-        auto const *root = [&] {
-            auto const *n = closest->second;
-            while (n->parent) {
-                n = n->parent;
-            }
-            return n;
-        }();
-        auto root_font_size = root && root != this ? root->get_font_size_property() : kDefaultFontSize;
-        return static_cast<int>(value * root_font_size);
+        if (node.parent == nullptr) {
+            return static_cast<int>(value * kDefaultFontSize);
+        }
+
+        auto const *root = node.parent;
+        while (root->parent != nullptr) {
+            root = root->parent;
+        }
+        return static_cast<int>(value * root->computed().font_size);
     }
 
     spdlog::warn("Unhandled unit '{}'", unit);
     return 0;
 }
 
+ComputedStyle compute_style(StyledNode const &node) {
+    // Text nodes without any properties of their own, i.e. all of them outside
+    // of tests, look exactly like their parents.
+    if (node.parent != nullptr && node.properties.empty() && std::holds_alternative<dom::Text>(node.node)) {
+        return node.parent->computed();
+    }
+
+    using css::PropertyId;
+    auto const *parent = node.parent != nullptr ? &node.parent->computed() : nullptr;
+    auto compute = [&](PropertyId property, auto field, auto const &parse) {
+        return compute_property(node, parent, property, [&](ComputedStyle const &s) { return s.*field; }, parse);
+    };
+
+    ComputedStyle style;
+    style.display = compute(PropertyId::Display, &ComputedStyle::display, parse_display);
+
+    style.color = compute(PropertyId::Color, &ComputedStyle::color, parse_color);
+    // https://developer.mozilla.org/en-US/docs/Web/CSS/color_value#currentcolor_keyword
+    auto color_or_current_color = [&](std::string_view raw) {
+        return raw == "currentcolor" ? style.color : parse_color(raw);
+    };
+    style.background_color =
+            compute(PropertyId::BackgroundColor, &ComputedStyle::background_color, color_or_current_color);
+
+    style.font_size = compute_font_size(node);
+    style.font_family = compute(PropertyId::FontFamily, &ComputedStyle::font_family, parse_font_family);
+    style.font_style = compute(PropertyId::FontStyle, &ComputedStyle::font_style, parse_font_style);
+    style.text_decoration_line = compute(
+            PropertyId::TextDecorationLine, &ComputedStyle::text_decoration_line, parse_text_decoration_line);
+
+    auto length = [&](std::string_view raw) {
+        return to_px(raw, style.font_size);
+    };
+    auto length_or = [&](std::string_view keyword) {
+        return [&, keyword](std::string_view raw) -> std::optional<int> {
+            if (raw == keyword) {
+                return std::nullopt;
+            }
+            return length(raw);
+        };
+    };
+    auto border_width = [&](std::string_view raw) {
+        if (auto it = kBorderWidthKeywords.find(raw); it != kBorderWidthKeywords.end()) {
+            return it->second;
+        }
+        return length(raw);
+    };
+    auto border_radius = [&](std::string_view raw) {
+        auto [horizontal, vertical] = raw.contains('/') ? util::split_once(raw, "/") : std::pair{raw, raw};
+        return std::pair{length(util::trim(horizontal)), length(util::trim(vertical))};
+    };
+
+    // Properties are given in top, right, bottom, left order.
+    auto compute_sides = [&]<typename T>(Sides<T> ComputedStyle::*sides,
+                                 std::array<PropertyId, 4> const &properties,
+                                 auto const &parse) {
+        std::array<T Sides<T>::*, 4> const fields{
+                &Sides<T>::top, &Sides<T>::right, &Sides<T>::bottom, &Sides<T>::left};
+        for (std::size_t i = 0; i < fields.size(); ++i) {
+            auto get = [&](ComputedStyle const &s) {
+                return (s.*sides).*fields[i];
+            };
+            (style.*sides).*fields[i] = compute_property(node, parent, properties[i], get, parse);
+        }
+    };
+
+    compute_sides(&ComputedStyle::margin,
+            {PropertyId::MarginTop, PropertyId::MarginRight, PropertyId::MarginBottom, PropertyId::MarginLeft},
+            length_or("auto"));
+    compute_sides(&ComputedStyle::padding,
+            {PropertyId::PaddingTop, PropertyId::PaddingRight, PropertyId::PaddingBottom, PropertyId::PaddingLeft},
+            length);
+    compute_sides(&ComputedStyle::border_style,
+            {PropertyId::BorderTopStyle,
+                    PropertyId::BorderRightStyle,
+                    PropertyId::BorderBottomStyle,
+                    PropertyId::BorderLeftStyle},
+            parse_border_style);
+    compute_sides(&ComputedStyle::border_width,
+            {PropertyId::BorderTopWidth,
+                    PropertyId::BorderRightWidth,
+                    PropertyId::BorderBottomWidth,
+                    PropertyId::BorderLeftWidth},
+            border_width);
+    compute_sides(&ComputedStyle::border_color,
+            {PropertyId::BorderTopColor,
+                    PropertyId::BorderRightColor,
+                    PropertyId::BorderBottomColor,
+                    PropertyId::BorderLeftColor},
+            color_or_current_color);
+
+    style.border_top_left_radius =
+            compute(PropertyId::BorderTopLeftRadius, &ComputedStyle::border_top_left_radius, border_radius);
+    style.border_top_right_radius =
+            compute(PropertyId::BorderTopRightRadius, &ComputedStyle::border_top_right_radius, border_radius);
+    style.border_bottom_left_radius =
+            compute(PropertyId::BorderBottomLeftRadius, &ComputedStyle::border_bottom_left_radius, border_radius);
+    style.border_bottom_right_radius =
+            compute(PropertyId::BorderBottomRightRadius, &ComputedStyle::border_bottom_right_radius, border_radius);
+
+    style.width = compute(PropertyId::Width, &ComputedStyle::width, length_or("auto"));
+    style.min_width = compute(PropertyId::MinWidth, &ComputedStyle::min_width, length_or("auto"));
+    style.max_width = compute(PropertyId::MaxWidth, &ComputedStyle::max_width, length_or("none"));
+    style.height = compute(PropertyId::Height, &ComputedStyle::height, length_or("auto"));
+    style.min_height = compute(PropertyId::MinHeight, &ComputedStyle::min_height, length_or("auto"));
+    style.max_height = compute(PropertyId::MaxHeight, &ComputedStyle::max_height, length_or("none"));
+
+    return style;
+}
+
+} // namespace
+
+CachedComputedStyle::CachedComputedStyle(CachedComputedStyle const &other) {
+    std::lock_guard lock{other.mtx_};
+    style_ = other.style_;
+    ready_.store(style_.has_value(), std::memory_order_relaxed);
+}
+
+CachedComputedStyle &CachedComputedStyle::operator=(CachedComputedStyle const &other) {
+    if (this != &other) {
+        std::scoped_lock lock{mtx_, other.mtx_};
+        style_ = other.style_;
+        ready_.store(style_.has_value(), std::memory_order_release);
+    }
+
+    return *this;
+}
+
+// Nothing else may be using a style that's being moved from.
+CachedComputedStyle::CachedComputedStyle(CachedComputedStyle &&other) noexcept
+    : style_{std::move(other.style_)}, ready_{style_.has_value()} {}
+
+CachedComputedStyle &CachedComputedStyle::operator=(CachedComputedStyle &&other) noexcept {
+    style_ = std::move(other.style_);
+    ready_.store(style_.has_value(), std::memory_order_release);
+    return *this;
+}
+
+void CachedComputedStyle::reset() {
+    ready_.store(false, std::memory_order_relaxed);
+    style_.reset();
+}
+
+ComputedStyle const &StyledNode::computed() const {
+    return computed_style.get_or_compute([this] { return compute_style(*this); });
+}
+
+void StyledNode::invalidate_computed_style() {
+    computed_style.reset();
+    for (auto &child : children) {
+        child.invalidate_computed_style();
+    }
+}
+
+std::string_view StyledNode::get_raw_property(css::PropertyId property) const {
+    // We don't support selector specificity yet, so the last property is found
+    // in order to allow website style to override the browser built-in style.
+    auto it = std::ranges::find_if(
+            rbegin(properties), rend(properties), [=](auto const &p) { return p.first == property; });
+
+    // TODO(robinlinden): Having a special case for dom::Text here doesn't feel good.
+    // You can't set properties on text nodes in HTML (even though we do in
+    // tests), so let's grab this from the parent node.
+    if (it == rend(properties) && std::holds_alternative<dom::Text>(node) && parent != nullptr) {
+        return parent->get_raw_property(property);
+    }
+
+    if (it == rend(properties) || it->second == "unset") {
+        // https://developer.mozilla.org/en-US/docs/Web/CSS/unset
+        if (is_inherited(property) && parent != nullptr) {
+            return parent->get_raw_property(property);
+        }
+
+        return kInitialValues.at(property);
+    } else if (it->second == "initial") {
+        // https://developer.mozilla.org/en-US/docs/Web/CSS/initial
+        return kInitialValues.at(property);
+    } else if (it->second == "inherit") {
+        // https://developer.mozilla.org/en-US/docs/Web/CSS/inherit
+        return get_parent_raw_property(*this, property);
+    } else if (it->second == "currentcolor") {
+        // https://developer.mozilla.org/en-US/docs/Web/CSS/color_value#currentcolor_keyword
+        // If the "color" property has the value "currentcolor", treat it as "inherit".
+        if (it->first == css::PropertyId::Color) {
+            return get_parent_raw_property(*this, property);
+        }
+
+        // Even though we return the correct value here, if a property has
+        // "currentcolor" as its initial value, the caller have to manually look
+        // up the value of "color". This will be cleaned up along with the rest
+        // of the property management soon.
+        return get_raw_property(css::PropertyId::Color);
+    }
+
+    return it->second;
+}
+
 } // namespace style
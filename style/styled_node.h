@@ -8,9 +8,11 @@
 #include "css/property_id.h"
 #include "dom/dom.h"
 #include "gfx/color.h"
-#include "util/string.h"
+#include "style/computed_style.h"
 
-#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -19,37 +21,43 @@
 
 namespace style {
 
-enum class BorderStyle {
-    None,
-    Hidden,
-    Dotted,
-    Dashed,
-    Solid,
-    Double,
-    Groove,
-    Ridge,
-    Inset,
-    Outset,
-};
+// A computed style that's filled in the first time it's needed. Several
+// threads may ask for it at once, e.g. when laying out sibling subtrees in
+// parallel, and only one of them will compute it. Copies bring the style
+// along if it's been computed.
+class CachedComputedStyle {
+public:
+    CachedComputedStyle() = default;
+    CachedComputedStyle(CachedComputedStyle const &);
+    CachedComputedStyle &operator=(CachedComputedStyle const &);
+    CachedComputedStyle(CachedComputedStyle &&) noexcept;
+    CachedComputedStyle &operator=(CachedComputedStyle &&) noexcept;
+    ~CachedComputedStyle() = default;
+
+    template<typename ComputeT>
+    ComputedStyle const &get_or_compute(ComputeT const &compute) const {
+        if (!ready_.load(std::memory_order_acquire)) {
+            std::lock_guard lock{mtx_};
+            if (!style_) {
+                style_ = compute();
+                ready_.store(true, std::memory_order_release);
+            }
+        }
 
-enum class DisplayValue {
-    None,
-    Inline,
-    Block,
-};
+        return *style_;
+    }
 
-enum class FontStyle {
-    Normal,
-    Italic,
-    Oblique,
-};
+    // Not safe to call while other threads are reading the style.
+    void reset();
+
+    bool has_value() const { return ready_.load(std::memory_order_acquire); }
+    ComputedStyle const &operator*() const { return *style_; }
+    ComputedStyle const *operator->() const { return &*style_; }
 
-enum class TextDecorationLine {
-    None,
-    Underline,
-    Overline,
-    LineThrough,
-    Blink,
+private:
+    mutable std::mutex mtx_;
+    mutable std::optional<ComputedStyle> style_;
+    mutable std::atomic<bool> ready_{false};
 };
 
 struct StyledNode {
@@ -57,50 +65,58 @@ struct StyledNode {
     std::vector<std::pair<css::PropertyId, std::string>> properties;
     std::vector<StyledNode> children;
     StyledNode const *parent{nullptr};
+    // Cache for computed(). style_tree fills this in for every node.
+    CachedComputedStyle computed_style{};
+
+    // The typed values of all properties with inheritance resolved. Computed
+    // once and then cached, so changing the properties of a node after calling
+    // this requires a call to invalidate_computed_style(). Safe to call from
+    // several threads at once.
+    ComputedStyle const &computed() const;
+
+    // Drops the cached computed style of this node and all of its descendants.
+    void invalidate_computed_style();
 
     std::string_view get_raw_property(css::PropertyId) const;
 
+    // Typed properties come from computed(), so the same caching rules apply.
     template<css::PropertyId T>
     auto get_property() const {
-        // Some of these branches have the same content, but we still want to
-        // keep related properties grouped together and away from unrelated
-        // ones, e.g. all border-<side>-color properties in the same branch.
-        // NOLINTNEXTLINE(bugprone-branch-clone)
-        if constexpr (T == css::PropertyId::BackgroundColor) {
-            return get_color_property(T);
-        } else if constexpr (T == css::PropertyId::BorderBottomColor || T == css::PropertyId::BorderLeftColor
-                || T == css::PropertyId::BorderRightColor || T == css::PropertyId::BorderTopColor) {
-            return get_color_property(T);
-        } else if constexpr (T == css::PropertyId::BorderBottomStyle || T == css::PropertyId::BorderLeftStyle
-                || T == css::PropertyId::BorderRightStyle || T == css::PropertyId::BorderTopStyle) {
-            return get_border_style_property(T);
-        } else if constexpr (T == css::PropertyId::Color) {
-            return get_color_property(T);
-        } else if constexpr (T == css::PropertyId::Display) {
-            return get_display_property();
-        } else if constexpr (T == css::PropertyId::FontFamily) {
-            auto raw_font_family = get_raw_property(T);
-            auto families = util::split(raw_font_family, ",");
-            std::ranges::for_each(families, [](auto &family) { family = util::trim(family); });
-            return families;
-        } else if constexpr (T == css::PropertyId::FontSize) {
-            return get_font_size_property();
-        } else if constexpr (T == css::PropertyId::FontStyle) {
-            return get_font_style_property();
-        } else if constexpr (T == css::PropertyId::TextDecorationLine) {
-            return get_text_decoration_line_property();
+        using css::PropertyId;
+        if constexpr (T == PropertyId::BackgroundColor) {
+            return computed().background_color;
+        } else if constexpr (T == PropertyId::BorderBottomColor) {
+            return computed().border_color.bottom;
+        } else if constexpr (T == PropertyId::BorderLeftColor) {
+            return computed().border_color.left;
+        } else if constexpr (T == PropertyId::BorderRightColor) {
+            return computed().border_color.right;
+        } else if constexpr (T == PropertyId::BorderTopColor) {
+            return computed().border_color.top;
+        } else if constexpr (T == PropertyId::BorderBottomStyle) {
+            return computed().border_style.bottom;
+        } else if constexpr (T == PropertyId::BorderLeftStyle) {
+            return computed().border_style.left;
+        } else if constexpr (T == PropertyId::BorderRightStyle) {
+            return computed().border_style.right;
+        } else if constexpr (T == PropertyId::BorderTopStyle) {
+            return computed().border_style.top;
+        } else if constexpr (T == PropertyId::Color) {
+            return computed().color;
+        } else if constexpr (T == PropertyId::Display) {
+            return computed().display;
+        } else if constexpr (T == PropertyId::FontFamily) {
+            return computed().font_family;
+        } else if constexpr (T == PropertyId::FontSize) {
+            return computed().font_size;
+        } else if constexpr (T == PropertyId::FontStyle) {
+            return computed().font_style;
+        } else if constexpr (T == PropertyId::TextDecorationLine) {
+            return computed().text_decoration_line;
         } else {
             return get_raw_property(T);
         }
     }
-
-private:
-    BorderStyle get_border_style_property(css::PropertyId) const;
-    gfx::Color get_color_property(css::PropertyId) const;
-    DisplayValue get_display_property() const;
-    FontStyle get_font_style_property() const;
-    int get_font_size_property() const;
-    std::vector<TextDecorationLine> get_text_decoration_line_property() const;
 };
 
 [[nodiscard]] inline bool operator==(style::StyledNode const &a, style::StyledNode const &b) noexcept {
@@ -6,9 +6,12 @@
 
 #include "etest/etest.h"
 
+#include <optional>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 using namespace std::literals;
 using etest::expect;
@@ -95,6 +98,7 @@ int main() {
 
         // inherit, no parent node.
         child.parent = nullptr;
+        child.invalidate_computed_style();
         expect_eq(child.get_property<css::PropertyId::BackgroundColor>(), gfx::Color::from_css_name("transparent"));
     });
 
@@ -125,6 +129,7 @@ int main() {
 
         // unset, inherited, no parent node.
         child.parent = nullptr;
+        child.invalidate_computed_style();
         expect_eq(child.get_property<css::PropertyId::Color>(), gfx::Color::from_css_name("canvastext"));
     });
 
@@ -150,6 +155,7 @@ int main() {
 
         // "color: currentcolor" should be treated as inherit.
         child.properties.push_back({css::PropertyId::Color, "currentcolor"s});
+        child.invalidate_computed_style();
         expect_eq(child.get_property<css::PropertyId::Color>(), gfx::Color::from_css_name("blue"));
     });
 
@@ -161,7 +167,7 @@ int main() {
     });
 
     etest::test("get_font_family_property", [] {
-        expect_property_eq<css::PropertyId::FontFamily>("abc, def", std::vector<std::string_view>{"abc", "def"});
+        expect_property_eq<css::PropertyId::FontFamily>("abc, def", std::vector<std::string>{"abc", "def"});
     });
 
     etest::test("get_font_size_property", [] {
@@ -187,8 +193,10 @@ int main() {
 
         // %
         child.properties[0] = {css::PropertyId::FontSize, "100%"};
+        root.invalidate_computed_style();
         expect_eq(child.get_property<css::PropertyId::FontSize>(), 50);
         child.properties[0] = {css::PropertyId::FontSize, "50%"};
+        root.invalidate_computed_style();
         expect_eq(child.get_property<css::PropertyId::FontSize>(), 25);
 
         // rem
@@ -196,29 +204,37 @@ int main() {
                 style::StyledNode{.node{dom_node}, .properties{{css::PropertyId::FontSize, "2rem"}}, .parent = &child});
         expect_eq(child2.get_property<css::PropertyId::FontSize>(), 50 * 2);
         child2.properties[0] = {css::PropertyId::FontSize, "0.5rem"};
+        root.invalidate_computed_style();
         expect_eq(child2.get_property<css::PropertyId::FontSize>(), 25);
 
         // em
         child.properties[0] = {css::PropertyId::FontSize, "2em"};
+        root.invalidate_computed_style();
         expect_eq(child.get_property<css::PropertyId::FontSize>(), 50 * 2);
         root.properties[0] = {css::PropertyId::FontSize, "25px"};
+        root.invalidate_computed_style();
         expect_eq(child.get_property<css::PropertyId::FontSize>(), 25 * 2);
         root.properties[0] = {css::PropertyId::FontSize, "2em"};
+        root.invalidate_computed_style();
         expect_eq(child.get_property<css::PropertyId::FontSize>(), default_font_size * 2 * 2);
         root.properties.clear();
+        root.invalidate_computed_style();
         expect_eq(child.get_property<css::PropertyId::FontSize>(), default_font_size * 2);
 
         // unhandled units
         child.properties[0] = {css::PropertyId::FontSize, "1asdf"};
+        root.invalidate_computed_style();
         expect_eq(child.get_property<css::PropertyId::FontSize>(), 0);
 
         // 0
         child.properties[0] = {css::PropertyId::FontSize, "0"};
+        root.invalidate_computed_style();
         expect_eq(child.get_property<css::PropertyId::FontSize>(), 0);
 
         // Invalid, shouldn't crash.
         // TODO(robinlinden): Make this do whatever other browsers do.
         child.properties[0] = {css::PropertyId::FontSize, "abcd"};
+        root.invalidate_computed_style();
         std::ignore = child.get_property<css::PropertyId::FontSize>();
     });
 
@@ -309,5 +325,83 @@ int main() {
                 std::vector{style::TextDecorationLine::Blink});
     });
 
+    etest::test("computed, initial values", [] {
+        dom::Node dom = dom::Element{"div"};
+        style::StyledNode styled_node{.node = dom};
+        auto const &style = styled_node.computed();
+
+        expect_eq(style.display, style::DisplayValue::Inline);
+        expect_eq(style.color, gfx::Color::from_css_name("canvastext").value());
+        expect_eq(style.background_color, gfx::Color::from_css_name("transparent").value());
+        expect_eq(style.border_color.left, style.color);
+        expect_eq(style.font_size, 10);
+        expect_eq(style.font_family, std::vector{"arial"s});
+        expect_eq(style.margin.top, std::optional{0});
+        expect_eq(style.border_style.top, style::BorderStyle::None);
+        expect_eq(style.border_width.top, 5);
+        expect_eq(style.width, std::nullopt);
+        expect_eq(style.max_width, std::nullopt);
+    });
+
+    etest::test("computed, inheritance and font-relative lengths", [] {
+        dom::Node dom = dom::Element{"div"};
+        style::StyledNode root{
+                .node = dom,
+                .properties{
+                        {css::PropertyId::FontSize, "20px"s},
+                        {css::PropertyId::Color, "blue"s},
+                        {css::PropertyId::Width, "10em"s},
+                        {css::PropertyId::BorderLeftColor, "red"s},
+                },
+        };
+        auto &child = root.children.emplace_back(style::StyledNode{
+                .node = dom,
+                .properties{
+                        {css::PropertyId::FontSize, "2em"s},
+                        {css::PropertyId::MarginLeft, "1em"s},
+                        {css::PropertyId::MarginRight, "auto"s},
+                        {css::PropertyId::BorderTopLeftRadius, "1em / 5px"s},
+                        {css::PropertyId::BorderLeftColor, "inherit"s},
+                },
+                .parent = &root,
+        });
+
+        expect_eq(root.computed().width, std::optional{200});
+
+        auto const &style = child.computed();
+        expect_eq(style.font_size, 40);
+        expect_eq(style.color, gfx::Color::from_css_name("blue").value());
+        expect_eq(style.border_color.left, gfx::Color::from_css_name("red").value());
+        expect_eq(style.border_color.right, gfx::Color::from_css_name("blue").value());
+        expect_eq(style.width, std::nullopt);
+        expect_eq(style.margin.left, std::optional{40});
+        expect_eq(style.margin.right, std::nullopt);
+        expect_eq(style.border_top_left_radius, std::pair{40, 5});
+    });
+
+    etest::test("computed, text nodes", [] {
+        dom::Node dom = dom::Element{"div"};
+        dom::Node text = dom::Text{"hello"};
+        style::StyledNode root{
+                .node = dom,
+                .properties{{css::PropertyId::Display, "block"s}, {css::PropertyId::PaddingTop, "4px"s}},
+        };
+        auto &child = root.children.emplace_back(style::StyledNode{.node = text, .parent = &root});
+        expect(child.computed() == root.computed());
+    });
+
+    etest::test("computed, cached until invalidated", [] {
+        dom::Node dom = dom::Element{"div"};
+        style::StyledNode root{.node = dom, .properties{{css::PropertyId::FontSize, "20px"s}}};
+        auto &child = root.children.emplace_back(style::StyledNode{.node = dom, .parent = &root});
+        expect_eq(child.computed().font_size, 20);
+
+        root.properties[0].second = "30px";
+        expect_eq(child.computed().font_size, 20);
+
+        root.invalidate_computed_style();
+        expect_eq(child.computed().font_size, 30);
+    });
+
     return etest::run_all_tests();
 }
@@ -0,0 +1,135 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "style/stylesheet_index.h"
+
+#include "css/media_query.h"
+#include "css/property_id.h"
+#include "css/rule.h"
+#include "dom/dom.h"
+#include "util/string.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace style {
+namespace {
+bool is_link(dom::Element const &element) {
+    return (element.name == "a" || element.name == "area") && element.attributes.contains("href");
+}
+} // namespace
+
+StylesheetIndex::StylesheetIndex(std::vector<css::Rule> const &stylesheet) : stylesheet_{&stylesheet} {
+    for (std::size_t i = 0; i < stylesheet.size(); ++i) {
+        for (auto const &selector : stylesheet[i].selectors) {
+            add(selector, i);
+        }
+
+        if (auto const &query = stylesheet[i].media_query) {
+            std::visit(
+                    [this](css::MediaQuery::Width const &width) {
+                        width_breakpoints_.push_back(width.min);
+                        if (width.max != std::numeric_limits<int>::max()) {
+                            width_breakpoints_.push_back(width.max + 1);
+                        }
+                    },
+                    query->query);
+        }
+    }
+
+    std::ranges::sort(width_breakpoints_);
+    auto [first, last] = std::ranges::unique(width_breakpoints_);
+    width_breakpoints_.erase(first, last);
+}
+
+// This has to agree with style::is_match on what matches what.
+void StylesheetIndex::add(std::string_view selector, std::size_t rule) {
+    // https://developer.mozilla.org/en-US/docs/Web/CSS/Pseudo-classes
+    auto [simple_selector, psuedo_class] = util::split_once(selector, ":");
+
+    bool requires_link = false;
+    if (!psuedo_class.empty()) {
+        if (psuedo_class != "link" && psuedo_class != "any-link") {
+            // Unhandled psuedo-classes never match, so there's no need to index them.
+            return;
+        }
+
+        requires_link = true;
+        if (simple_selector.empty()) {
+            by_tag_["a"].push_back({rule, requires_link});
+            by_tag_["area"].push_back({rule, requires_link});
+            return;
+        }
+    }
+
+    if (simple_selector == "*") {
+        universal_.push_back({rule, requires_link});
+    } else if (simple_selector.starts_with('.')) {
+        by_class_[std::string{simple_selector.substr(1)}].push_back({rule, requires_link});
+    } else if (simple_selector.starts_with('#')) {
+        by_id_[std::string{simple_selector.substr(1)}].push_back({rule, requires_link});
+    } else {
+        by_tag_[std::string{simple_selector}].push_back({rule, requires_link});
+    }
+}
+
+std::vector<std::pair<css::PropertyId, std::string>> StylesheetIndex::matching_rules(
+        dom::Element const &element, css::MediaQuery::Context const &ctx) const {
+    std::vector<std::size_t> candidates;
+    bool const element_is_link = is_link(element);
+    auto add_candidates = [&](Buckets const &buckets, std::string_view key) {
+        if (auto it = buckets.find(key); it != buckets.end()) {
+            for (auto const &selector : it->second) {
+                if (!selector.requires_link || element_is_link) {
+                    candidates.push_back(selector.rule);
+                }
+            }
+        }
+    };
+
+    if (auto id = element.attributes.find("id"); id != element.attributes.end()) {
+        add_candidates(by_id_, id->second);
+    }
+
+    if (auto classes = element.attributes.find("class"); classes != element.attributes.end()) {
+        for (auto const &class_name : util::split(classes->second, " ")) {
+            add_candidates(by_class_, class_name);
+        }
+    }
+
+    add_candidates(by_tag_, element.name);
+
+    for (auto const &selector : universal_) {
+        if (!selector.requires_link || element_is_link) {
+            candidates.push_back(selector.rule);
+        }
+    }
+
+    // A rule matching through several of its selectors, or through several of
+    // the element's classes, still only applies once.
+    std::ranges::sort(candidates);
+    auto [first, last] = std::ranges::unique(candidates);
+    candidates.erase(first, last);
+
+    std::vector<std::pair<css::PropertyId, std::string>> matched_rules;
+    for (auto rule_index : candidates) {
+        auto const &rule = (*stylesheet_)[rule_index];
+        if (rule.media_query.has_value() && !rule.media_query->evaluate(ctx)) {
+            continue;
+        }
+
+        std::ranges::copy(rule.declarations, std::back_inserter(matched_rules));
+    }
+
+    return matched_rules;
+}
+
+} // namespace style
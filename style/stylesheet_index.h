@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef STYLE_STYLESHEET_INDEX_H_
+#define STYLE_STYLESHEET_INDEX_H_
+
+#include "css/media_query.h"
+#include "css/property_id.h"
+#include "css/rule.h"
+#include "dom/dom.h"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace style {
+
+// The rules of a stylesheet bucketed on the id, class, or tag their selectors
+// require, so that styling an element only has to look at the rules that could
+// possibly match it instead of at every selector in the stylesheet.
+class StylesheetIndex {
+public:
+    // The stylesheet must outlive the index.
+    explicit StylesheetIndex(std::vector<css::Rule> const &stylesheet);
+
+    // The declarations of all matching rules, in stylesheet order.
+    [[nodiscard]] std::vector<std::pair<css::PropertyId, std::string>> matching_rules(
+            dom::Element const &, css::MediaQuery::Context const & = {}) const;
+
+    [[nodiscard]] std::vector<css::Rule> const &stylesheet() const { return *stylesheet_; }
+
+    // The window widths at which a media query in the stylesheet starts or
+    // stops matching, sorted. Styling the same tree at two window widths gives
+    // the same result unless a breakpoint lies in (narrower, wider].
+    [[nodiscard]] std::vector<int> const &width_breakpoints() const { return width_breakpoints_; }
+
+private:
+    struct IndexedSelector {
+        std::size_t rule{};
+        // :link and :any-link.
+        bool requires_link{};
+    };
+
+    struct StringHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    using Buckets = std::unordered_map<std::string, std::vector<IndexedSelector>, StringHash, std::equal_to<>>;
+
+    void add(std::string_view selector, std::size_t rule);
+
+    std::vector<css::Rule> const *stylesheet_{};
+    Buckets by_id_;
+    Buckets by_class_;
+    Buckets by_tag_;
+    std::vector<IndexedSelector> universal_;
+    std::vector<int> width_breakpoints_;
+};
+
+} // namespace style
+
+#endif
@@ -0,0 +1,129 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "style/stylesheet_index.h"
+
+#include "css/media_query.h"
+#include "css/property_id.h"
+#include "css/rule.h"
+#include "dom/dom.h"
+#include "etest/etest.h"
+#include "style/style.h"
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+
+using etest::expect;
+using etest::expect_eq;
+
+namespace {
+using Declarations = std::vector<std::pair<css::PropertyId, std::string>>;
+
+// What matching_rules did before there was an index.
+Declarations match_all_rules(dom::Element const &element, std::vector<css::Rule> const &stylesheet) {
+    Declarations matched_rules;
+    for (auto const &rule : stylesheet) {
+        if (std::ranges::any_of(rule.selectors, [&](auto const &s) { return style::is_match(element, s); })) {
+            std::ranges::copy(rule.declarations, std::back_inserter(matched_rules));
+        }
+    }
+    return matched_rules;
+}
+
+css::Rule rule(std::vector<std::string> selectors, std::string width) {
+    return css::Rule{.selectors = std::move(selectors), .declarations{{css::PropertyId::Width, std::move(width)}}};
+}
+} // namespace
+
+int main() {
+    etest::test("rules are returned in stylesheet order", [] {
+        std::vector<css::Rule> stylesheet{
+                rule({"*"}, "1"),
+                rule({"#a"}, "2"),
+                rule({"p"}, "3"),
+                rule({".b"}, "4"),
+                rule({"span"}, "5"),
+        };
+        style::StylesheetIndex index{stylesheet};
+
+        dom::Element p{"p", {{"id", "a"}, {"class", "b"}}, {}};
+        expect_eq(index.matching_rules(p),
+                Declarations{
+                        {css::PropertyId::Width, "1"},
+                        {css::PropertyId::Width, "2"},
+                        {css::PropertyId::Width, "3"},
+                        {css::PropertyId::Width, "4"},
+                });
+    });
+
+    etest::test("rules only apply once", [] {
+        std::vector<css::Rule> stylesheet{rule({"p", ".a", ".b", "*"}, "1")};
+        style::StylesheetIndex index{stylesheet};
+
+        dom::Element p{"p", {{"class", "a b a"}}, {}};
+        expect_eq(index.matching_rules(p), Declarations{{css::PropertyId::Width, "1"}});
+    });
+
+    etest::test("media queries", [] {
+        std::vector<css::Rule> stylesheet{rule({"p"}, "1")};
+        stylesheet[0].media_query = css::MediaQuery::parse("(min-width: 700px)");
+        style::StylesheetIndex index{stylesheet};
+
+        expect(index.matching_rules(dom::Element{"p"}).empty());
+        expect_eq(index.matching_rules(dom::Element{"p"}, {.window_width = 700}),
+                Declarations{{css::PropertyId::Width, "1"}});
+    });
+
+    etest::test("width breakpoints", [] {
+        std::vector<css::Rule> stylesheet{rule({"p"}, "1"), rule({"p"}, "2"), rule({"p"}, "3"), rule({"p"}, "4")};
+        stylesheet[0].media_query = css::MediaQuery::parse("(min-width: 700px)");
+        stylesheet[1].media_query = css::MediaQuery::parse("(max-width: 300px)");
+        stylesheet[2].media_query = css::MediaQuery::parse("(width: 700px)");
+        style::StylesheetIndex index{stylesheet};
+
+        expect_eq(index.width_breakpoints(), std::vector{0, 301, 700, 701});
+    });
+
+    etest::test("same matches as is_match", [] {
+        std::vector<css::Rule> stylesheet{
+                rule({"*"}, "*"),
+                rule({"a", "div"}, "a, div"),
+                rule({".a", ".b"}, ".a, .b"),
+                rule({"#a", "#b"}, "#a, #b"),
+                rule({":link"}, ":link"),
+                rule({"a:any-link"}, "a:any-link"),
+                rule({"area:link"}, "area:link"),
+                rule({".a:link"}, ".a:link"),
+                rule({"#b:link"}, "#b:link"),
+                rule({"*:link"}, "*:link"),
+                rule({":hover"}, ":hover"),
+                rule({"a:hover"}, "a:hover"),
+                rule({"div p"}, "div p"),
+        };
+        style::StylesheetIndex index{stylesheet};
+
+        std::vector<dom::Element> elements{
+                dom::Element{"div"},
+                dom::Element{"p", {{"class", "a"}}, {}},
+                dom::Element{"p", {{"class", "c  b"}}, {}},
+                dom::Element{"p", {{"id", "a"}}, {}},
+                dom::Element{"a"},
+                dom::Element{"a", {{"href", ""}}, {}},
+                dom::Element{"a", {{"href", ""}, {"class", "a"}, {"id", "b"}}, {}},
+                dom::Element{"area", {{"href", ""}}, {}},
+                dom::Element{"p", {{"href", ""}}, {}},
+        };
+
+        for (auto const &element : elements) {
+            expect_eq(index.matching_rules(element), match_all_rules(element, stylesheet));
+        }
+    });
+
+    return etest::run_all_tests();
+}
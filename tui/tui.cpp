@@ -10,7 +10,9 @@
 
 #include <cstdlib>
 #include <string>
+#include <utility>
 #include <variant>
+#include <vector>
 
 namespace tui {
 namespace {
@@ -42,14 +44,44 @@ ftxui::Element element_from_node(layout::LayoutBox const &box) {
     std::abort(); // unreachable
 }
 
-} // namespace
-
-std::string render(layout::LayoutBox const &root) {
-    auto document = element_from_node(root);
+std::string render_document(ftxui::Element document) {
     document = document | ftxui::size(ftxui::WIDTH, ftxui::LESS_THAN, 80);
     auto screen = ftxui::Screen::Create(ftxui::Dimension::Fixed(80), ftxui::Dimension::Fixed(10));
     ftxui::Render(screen, document);
     return screen.ToString();
 }
 
+} // namespace
+
+std::string render(layout::LayoutBox const &root) {
+    return render_document(element_from_node(root));
+}
+
+std::string render(layout::FlatLayout const &layout) {
+    using Index = layout::FlatLayout::Index;
+
+    // Children come after their parents, so walking the boxes backwards means
+    // that all children have been turned into elements before their parent.
+    std::vector<ftxui::Element> elements(layout.size());
+    for (Index box = layout.size(); box-- > 0;) {
+        if (layout.type(box) == layout::LayoutType::Inline) {
+            if (auto const *text = std::get_if<dom::Text>(&layout.node(box)->node)) {
+                elements[box] = ftxui::paragraph(text->text);
+                continue;
+            }
+        }
+
+        ftxui::Elements children;
+        for (Index child = layout.first_child(box); child != layout::FlatLayout::kNoBox;
+                child = layout.next_sibling(child)) {
+            children.push_back(std::move(elements[child]));
+        }
+
+        elements[box] = layout.type(box) == layout::LayoutType::Inline ? hbox(std::move(children))
+                                                                        : flex(vbox(std::move(children)));
+    }
+
+    return render_document(std::move(elements.at(0)));
+}
+
 } // namespace tui
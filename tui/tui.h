@@ -5,6 +5,7 @@
 #ifndef TUI_TUI_H_
 #define TUI_TUI_H_
 
+#include "layout/flat_layout.h"
 #include "layout/layout.h"
 
 #include <string>
@@ -12,6 +13,7 @@
 namespace tui {
 
 std::string render(layout::LayoutBox const &root);
+std::string render(layout::FlatLayout const &);
 
 } // namespace tui
 
@@ -0,0 +1,118 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "type/font_finder.h"
+
+#include "type/font_index.h"
+
+#include "os/os.h"
+
+#include <spdlog/spdlog.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <utility>
+
+namespace type {
+namespace {
+
+std::optional<std::filesystem::path> default_font_index_directory() {
+    if (std::getenv("HST_DISABLE_DISK_IO") != nullptr) {
+        return std::nullopt;
+    }
+
+    auto cache_path = os::cache_path();
+    if (!cache_path) {
+        return std::nullopt;
+    }
+
+    return std::filesystem::path{*std::move(cache_path)};
+}
+
+std::mutex font_index_directory_mtx;
+// Set once set_font_index_directory has been called, and nullopt inside if
+// the index shouldn't be saved.
+std::optional<std::optional<std::filesystem::path>> font_index_directory_override;
+
+std::optional<std::filesystem::path> font_index_directory() {
+    std::lock_guard lock{font_index_directory_mtx};
+    return font_index_directory_override ? *font_index_directory_override : default_font_index_directory();
+}
+
+FontIndex load_or_scan_system_fonts() {
+    auto directories = os::font_paths();
+    auto const index_directory = font_index_directory();
+    if (!index_directory) {
+        return FontIndex::scan(std::move(directories));
+    }
+
+    auto const index_path = *index_directory / "font_index";
+    if (auto index = FontIndex::load(index_path, directories)) {
+        return *std::move(index);
+    }
+
+    auto index = FontIndex::scan(std::move(directories));
+    std::error_code errc;
+    std::filesystem::create_directories(*index_directory, errc);
+    if (errc || !index.save(index_path)) {
+        spdlog::warn("Unable to save the font index to {}", index_path.string());
+    }
+
+    return index;
+}
+
+std::shared_future<FontIndex> const &system_font_index_future() {
+    static auto const index = std::async(std::launch::async, load_or_scan_system_fonts).share();
+    return index;
+}
+
+} // namespace
+
+void set_font_index_directory(std::optional<std::filesystem::path> directory) {
+    std::lock_guard lock{font_index_directory_mtx};
+    font_index_directory_override = std::move(directory);
+}
+
+void start_indexing_system_fonts() {
+    std::ignore = system_font_index_future();
+}
+
+FontIndex const &system_font_index() {
+    return system_font_index_future().get();
+}
+
+std::optional<FontFace> find_font(std::string_view name) {
+    auto face = system_font_index().find(name);
+    if (face) {
+        spdlog::info("Found font {} ({} {}) for {}", face->path, face->family, face->style, name);
+    }
+
+    return face;
+}
+
+std::optional<std::string> find_path_to_font(std::string_view name) {
+    if (auto face = find_font(name)) {
+        return std::move(face->path);
+    }
+
+    return std::nullopt;
+}
+
+std::optional<std::string> find_path_to_fallback_font() {
+    if (auto face = system_font_index().fallback()) {
+        spdlog::info("Using fallback {}", face->path);
+        return std::move(face->path);
+    }
+
+    return std::nullopt;
+}
+
+} // namespace type
@@ -0,0 +1,36 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef TYPE_FONT_FINDER_H_
+#define TYPE_FONT_FINDER_H_
+
+#include "type/font_index.h"
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace type {
+
+// Where the system font index is saved, os::cache_path() unless
+// HST_DISABLE_DISK_IO is set. Nothing is saved if this is nullopt. Has to be
+// called before the fonts are indexed to have any effect.
+void set_font_index_directory(std::optional<std::filesystem::path>);
+
+// Starts indexing the system's fonts in the background, so that they're
+// hopefully indexed by the time the first font is needed. The index is saved
+// in the font index directory and only rebuilt when the font directories
+// change.
+void start_indexing_system_fonts();
+// Waits for the fonts to have been indexed if they haven't been already.
+FontIndex const &system_font_index();
+
+std::optional<FontFace> find_font(std::string_view name);
+std::optional<std::string> find_path_to_font(std::string_view name);
+std::optional<std::string> find_path_to_fallback_font();
+
+} // namespace type
+
+#endif
@@ -0,0 +1,309 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "type/font_index.h"
+
+#include "util/string.h"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+
+namespace type {
+namespace {
+
+constexpr auto kHeader = "hastur font index 1"sv;
+// What a directory that doesn't exist is saved as having been modified.
+constexpr auto kMissing = std::numeric_limits<std::int64_t>::min();
+
+std::int64_t modification_time(std::filesystem::path const &directory) {
+    std::error_code errc;
+    auto const time = std::filesystem::last_write_time(directory, errc);
+    if (errc) {
+        return kMissing;
+    }
+
+    return static_cast<std::int64_t>(time.time_since_epoch().count());
+}
+
+bool is_regular(FontFace const &face) {
+    auto const style = util::lowercased(face.style);
+    return style == "regular" || style == "book" || style == "normal" || style == "roman";
+}
+
+bool is_truetype(FontFace const &face) {
+    return util::lowercased(face.path).ends_with(".ttf");
+}
+
+// The index is saved as lines of tab-separated fields.
+bool is_saveable(std::string_view s) {
+    return s.find_first_of("\t\n\r") == std::string_view::npos;
+}
+
+std::string sanitized(char const *name) {
+    std::string s{name != nullptr ? name : ""};
+    std::ranges::replace_if(s, [](char c) { return c == '\t' || c == '\n' || c == '\r'; }, ' ');
+    return s;
+}
+
+template<typename T>
+std::optional<T> to_int(std::string_view s) {
+    T value{};
+    if (auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+            ec != std::errc{} || ptr != s.data() + s.size()) {
+        return std::nullopt;
+    }
+
+    return value;
+}
+
+class FaceReader {
+public:
+    FaceReader() {
+        if (auto error = FT_Init_FreeType(&library_); error != 0) {
+            spdlog::error("Unable to initialize FreeType: {}", error);
+            library_ = nullptr;
+        }
+    }
+
+    ~FaceReader() {
+        if (library_ != nullptr) {
+            FT_Done_FreeType(library_);
+        }
+    }
+
+    FaceReader(FaceReader const &) = delete;
+    FaceReader &operator=(FaceReader const &) = delete;
+
+    void read(std::string const &path, std::vector<FontFace> &faces) const {
+        if (library_ == nullptr) {
+            return;
+        }
+
+        // A negative face index only checks if FreeType can read the file,
+        // and how many faces there are in it.
+        FT_Face face{};
+        if (FT_New_Face(library_, path.c_str(), -1, &face) != 0) {
+            return;
+        }
+
+        auto const face_count = face->num_faces;
+        FT_Done_Face(face);
+
+        for (FT_Long i = 0; i < face_count; ++i) {
+            if (FT_New_Face(library_, path.c_str(), i, &face) != 0) {
+                continue;
+            }
+
+            if (face->family_name != nullptr) {
+                faces.push_back(FontFace{
+                        .path = path,
+                        .index = static_cast<int>(i),
+                        .family = sanitized(face->family_name),
+                        .style = sanitized(face->style_name),
+                });
+            }
+
+            FT_Done_Face(face);
+        }
+    }
+
+private:
+    FT_Library library_{};
+};
+
+} // namespace
+
+FontIndex FontIndex::scan(std::vector<std::string> directories) {
+    FontIndex index;
+    FaceReader const reader;
+    for (auto const &root : directories) {
+        index.directories_.emplace_back(root, modification_time(root));
+
+        std::error_code errc;
+        auto it = std::filesystem::recursive_directory_iterator(
+                root, std::filesystem::directory_options::skip_permission_denied, errc);
+        for (; !errc && it != std::filesystem::recursive_directory_iterator{}; it.increment(errc)) {
+            auto path = it->path().string();
+            if (!is_saveable(path)) {
+                continue;
+            }
+
+            if (it->is_directory(errc)) {
+                index.directories_.emplace_back(path, modification_time(it->path()));
+            } else if (it->is_regular_file(errc)) {
+                reader.read(path, index.faces_);
+            }
+        }
+    }
+
+    index.roots_ = std::move(directories);
+    index.build_lookups();
+    spdlog::info("Indexed {} font faces in {} directories", index.faces_.size(), index.directories_.size());
+    return index;
+}
+
+std::optional<FontIndex> FontIndex::load(
+        std::filesystem::path const &path, std::vector<std::string> const &directories) {
+    std::ifstream file{path};
+    std::string line;
+    if (!std::getline(file, line) || line != kHeader) {
+        return std::nullopt;
+    }
+
+    FontIndex index;
+    while (std::getline(file, line)) {
+        auto const fields = util::split(line, "\t");
+        if (fields[0] == "root" && fields.size() == 2) {
+            index.roots_.emplace_back(fields[1]);
+        } else if (fields[0] == "dir" && fields.size() == 3) {
+            auto const time = to_int<std::int64_t>(fields[1]);
+            if (!time || modification_time(fields[2]) != *time) {
+                return std::nullopt;
+            }
+            index.directories_.emplace_back(fields[2], *time);
+        } else if (fields[0] == "face" && fields.size() == 5) {
+            auto const face_index = to_int<int>(fields[1]);
+            if (!face_index) {
+                return std::nullopt;
+            }
+            index.faces_.push_back(FontFace{
+                    .path = std::string{fields[4]},
+                    .index = *face_index,
+                    .family = std::string{fields[2]},
+                    .style = std::string{fields[3]},
+            });
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    if (index.roots_ != directories) {
+        return std::nullopt;
+    }
+
+    index.build_lookups();
+    return index;
+}
+
+bool FontIndex::save(std::filesystem::path const &path) const {
+    // Written to a temporary file first so that no one reads a half-written index.
+    auto tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream file{tmp, std::ios::trunc};
+        file << kHeader << '\n';
+        for (auto const &root : roots_) {
+            file << "root\t" << root << '\n';
+        }
+
+        for (auto const &[directory, time] : directories_) {
+            file << "dir\t" << time << '\t' << directory << '\n';
+        }
+
+        for (auto const &face : faces_) {
+            file << "face\t" << face.index << '\t' << face.family << '\t' << face.style << '\t' << face.path << '\n';
+        }
+
+        if (!file.flush()) {
+            return false;
+        }
+    }
+
+    std::error_code errc;
+    std::filesystem::rename(tmp, path, errc);
+    return !errc;
+}
+
+std::optional<FontFace> FontIndex::find(std::string_view name) const {
+    auto key = util::lowercased(std::string{name});
+    if (auto it = families_.find(key); it != end(families_)) {
+        return faces_[it->second];
+    }
+
+    if (auto i = find_by_file_name(key)) {
+        return faces_[*i];
+    }
+
+    return std::nullopt;
+}
+
+std::optional<FontFace> FontIndex::find(std::string_view family, std::string_view style) const {
+    auto key = util::lowercased(std::string{family} + '\t' + std::string{style});
+    if (auto it = families_and_styles_.find(key); it != end(families_and_styles_)) {
+        return faces_[it->second];
+    }
+
+    return std::nullopt;
+}
+
+std::optional<FontFace> FontIndex::fallback() const {
+    if (!fallback_) {
+        return std::nullopt;
+    }
+
+    return faces_[*fallback_];
+}
+
+void FontIndex::build_lookups() {
+    std::ranges::sort(faces_, {}, [](FontFace const &face) { return std::tie(face.path, face.index); });
+
+    for (std::size_t i = 0; i < faces_.size(); ++i) {
+        auto const &face = faces_[i];
+        auto const regular = is_regular(face);
+
+        auto [family, inserted] = families_.try_emplace(util::lowercased(face.family), i);
+        if (!inserted && regular && !is_regular(faces_[family->second])) {
+            family->second = i;
+        }
+
+        families_and_styles_.try_emplace(util::lowercased(face.family + '\t' + face.style), i);
+
+        if (is_truetype(face) && (!fallback_ || (regular && !is_regular(faces_[*fallback_])))) {
+            fallback_ = i;
+        }
+    }
+}
+
+std::optional<std::size_t> FontIndex::find_by_file_name(std::string const &name) const {
+    std::scoped_lock lock{file_name_lookups_->mtx};
+    if (auto it = file_name_lookups_->results.find(name); it != end(file_name_lookups_->results)) {
+        return it->second;
+    }
+
+    std::optional<std::size_t> result;
+    for (std::size_t i = 0; i < faces_.size(); ++i) {
+        auto const file_name = util::lowercased(std::filesystem::path{faces_[i].path}.filename().string());
+        if (file_name.find(name) == std::string::npos) {
+            continue;
+        }
+
+        if (!result || (is_regular(faces_[i]) && !is_regular(faces_[*result]))) {
+            result = i;
+        }
+    }
+
+    file_name_lookups_->results.emplace(name, result);
+    return result;
+}
+
+} // namespace type
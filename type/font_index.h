@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef TYPE_FONT_INDEX_H_
+#define TYPE_FONT_INDEX_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace type {
+
+struct FontFace {
+    std::string path{};
+    // Which of the faces in the file this is, as font collections may have
+    // more than one.
+    int index{};
+    std::string family{};
+    std::string style{};
+
+    [[nodiscard]] bool operator==(FontFace const &) const = default;
+};
+
+// Every font face in a set of directories, looked up by the family and style
+// names in the fonts rather than by file names.
+class FontIndex {
+public:
+    // Reads the names of every font in the directories and their
+    // subdirectories. Files that aren't fonts are skipped.
+    [[nodiscard]] static FontIndex scan(std::vector<std::string> directories);
+
+    // Reads an index saved by save, unless it's for other directories, or if
+    // any of the directories have changed since it was saved.
+    [[nodiscard]] static std::optional<FontIndex> load(
+            std::filesystem::path const &, std::vector<std::string> const &directories);
+    [[nodiscard]] bool save(std::filesystem::path const &) const;
+
+    // Looks the name up as a family name, and if there's no such family, as a
+    // part of a file name. Regular faces are preferred over bold and italic ones.
+    [[nodiscard]] std::optional<FontFace> find(std::string_view name) const;
+    [[nodiscard]] std::optional<FontFace> find(std::string_view family, std::string_view style) const;
+    // A regular TrueType face, or any TrueType face if there's no regular one.
+    [[nodiscard]] std::optional<FontFace> fallback() const;
+
+    [[nodiscard]] std::vector<FontFace> const &faces() const { return faces_; }
+
+private:
+    FontIndex() = default;
+    void build_lookups();
+    [[nodiscard]] std::optional<std::size_t> find_by_file_name(std::string const &name) const;
+
+    std::vector<std::string> roots_;
+    // Every directory that was scanned, and when it was last modified. A font
+    // being added or removed changes the modification time of its directory.
+    std::vector<std::pair<std::string, std::int64_t>> directories_;
+    // Sorted by path and face index.
+    std::vector<FontFace> faces_;
+
+    // Lowercase names to indices into faces_.
+    std::unordered_map<std::string, std::size_t> families_;
+    std::unordered_map<std::string, std::size_t> families_and_styles_;
+    std::optional<std::size_t> fallback_;
+
+    // Results of looking names up by file name, which requires going through
+    // all faces, so that it only happens once per name.
+    struct FileNameLookups {
+        std::mutex mtx;
+        std::unordered_map<std::string, std::optional<std::size_t>> results;
+    };
+    std::unique_ptr<FileNameLookups> file_name_lookups_{std::make_unique<FileNameLookups>()};
+};
+
+} // namespace type
+
+#endif
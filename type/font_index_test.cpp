@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "type/font_index.h"
+
+#include "type/font_finder.h"
+
+#include "etest/etest.h"
+#include "etest/tmp_dir.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+using etest::expect;
+using etest::expect_eq;
+using etest::require;
+using etest::TmpDir;
+
+namespace {
+
+void write_file(fs::path const &path, std::string const &contents) {
+    std::ofstream{path} << contents;
+}
+
+} // namespace
+
+int main() {
+    // Keeps the system font index out of the real cache directory.
+    TmpDir const index_dir;
+    type::set_font_index_directory(index_dir.path());
+
+    etest::test("the system font index is saved in the font index directory", [&] {
+        std::ignore = type::system_font_index();
+        expect(fs::exists(index_dir.path() / "font_index"));
+    });
+
+    etest::test("directories without fonts", [] {
+        TmpDir dir;
+        write_file(dir.path() / "font.ttf", "not actually a font");
+        auto const missing = (dir.path() / "missing").string();
+
+        auto const index = type::FontIndex::scan({dir.path().string(), missing});
+        expect(index.faces().empty());
+        expect_eq(index.find("font"), std::nullopt);
+        expect_eq(index.fallback(), std::nullopt);
+    });
+
+    etest::test("saving and loading", [] {
+        TmpDir dir;
+        fs::create_directories(dir.path() / "fonts" / "sub");
+        auto const directories = std::vector{(dir.path() / "fonts").string(), (dir.path() / "missing").string()};
+        auto const index_path = dir.path() / "index";
+
+        auto const index = type::FontIndex::scan(directories);
+        require(index.save(index_path));
+
+        auto loaded = type::FontIndex::load(index_path, directories);
+        require(loaded.has_value());
+        expect_eq(loaded->faces(), index.faces());
+
+        // The index is for other directories.
+        expect_eq(type::FontIndex::load(index_path, {directories[0]}), std::nullopt);
+        expect_eq(type::FontIndex::load(dir.path() / "no index here", directories), std::nullopt);
+
+        // Something was added to one of the directories.
+        write_file(dir.path() / "fonts" / "sub" / "font.ttf", "");
+        expect_eq(type::FontIndex::load(index_path, directories), std::nullopt);
+
+        // One of the directories appeared.
+        require(type::FontIndex::scan(directories).save(index_path));
+        expect(type::FontIndex::load(index_path, directories).has_value());
+        fs::create_directories(directories[1]);
+        expect_eq(type::FontIndex::load(index_path, directories), std::nullopt);
+
+        write_file(index_path, "not an index");
+        expect_eq(type::FontIndex::load(index_path, directories), std::nullopt);
+    });
+
+    auto font = type::system_font_index().fallback();
+    if (!font) {
+        std::cerr << "No fonts installed, skipping tests using real fonts\n";
+        return etest::run_all_tests();
+    }
+
+    etest::test("looking fonts up", [font = *std::move(font)] {
+        TmpDir dir;
+        fs::create_directories(dir.path() / "sub");
+        auto const path = dir.path() / "sub" / "Hastur-Test-Font.ttf";
+        fs::copy_file(font.path, path);
+
+        auto const index = type::FontIndex::scan({dir.path().string()});
+        require(!index.faces().empty());
+
+        auto const expected = type::FontFace{path.string(), font.index, font.family, font.style};
+        expect_eq(index.faces().front(), expected);
+        expect_eq(index.fallback(), expected);
+
+        // Family names are compared case-insensitively.
+        expect_eq(index.find(font.family), expected);
+        expect_eq(index.find(font.family + "  "), std::nullopt);
+        expect_eq(index.find(font.family, font.style), expected);
+        expect_eq(index.find(font.family, "Not a style"), std::nullopt);
+
+        // Falls back to looking at file names.
+        expect_eq(index.find("test-font"), expected);
+        expect_eq(index.find("TEST-FONT"), expected);
+        expect_eq(index.find("not a font"), std::nullopt);
+    });
+
+    return etest::run_all_tests();
+}
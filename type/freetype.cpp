@@ -0,0 +1,329 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "type/freetype.h"
+
+#include "type/font_finder.h"
+
+#include "gfx/font.h"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_SYNTHESIS_H
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace type {
+
+struct FreeTypeType::Library {
+    FT_Library library{};
+    // FreeType libraries may not be used by multiple threads at once.
+    std::mutex mtx;
+
+    ~Library() { FT_Done_FreeType(library); }
+};
+
+namespace {
+
+constexpr char32_t kReplacementCharacter = 0xFFFD;
+
+// Decodes one code point, advancing pos past it. Invalid sequences decode to
+// the replacement character one byte at a time.
+char32_t next_code_point(std::string_view text, std::size_t &pos) {
+    auto const lead = static_cast<std::uint8_t>(text[pos++]);
+    int length{};
+    if (lead < 0x80) {
+        length = 0;
+    } else if ((lead >> 5) == 0b110) {
+        length = 1;
+    } else if ((lead >> 4) == 0b1110) {
+        length = 2;
+    } else if ((lead >> 3) == 0b11110) {
+        length = 3;
+    } else {
+        return kReplacementCharacter;
+    }
+
+    char32_t code_point = length == 0 ? lead : lead & (0x3F >> length);
+    for (int i = 0; i < length; ++i) {
+        if (pos >= text.size() || (static_cast<std::uint8_t>(text[pos]) >> 6) != 0b10) {
+            return kReplacementCharacter;
+        }
+        code_point = (code_point << 6) | (static_cast<std::uint8_t>(text[pos++]) & 0x3F);
+    }
+
+    return code_point;
+}
+
+class FreeTypeFont final : public IFont {
+public:
+    FreeTypeFont(std::shared_ptr<FreeTypeType::Library> library, FT_Face face)
+        : library_{std::move(library)}, face_{face} {}
+    ~FreeTypeFont() override {
+        std::scoped_lock lock{library_->mtx};
+        FT_Done_Face(face_);
+    }
+
+    FreeTypeFont(FreeTypeFont const &) = delete;
+    FreeTypeFont &operator=(FreeTypeFont const &) = delete;
+
+    [[nodiscard]] Size measure(std::string_view text, Px font_size, gfx::FontStyle style) const override {
+        std::scoped_lock lock{mtx_};
+        auto const height = line_height(font_size);
+        auto key = std::tuple{std::string{text}, font_size.v, style};
+        if (auto it = widths_.find(key); it != end(widths_)) {
+            return {it->second, height};
+        }
+
+        auto &advances = advances_[{font_size.v, style}];
+        FT_Pos width{};
+        for (std::size_t pos = 0; pos < text.size();) {
+            auto const code_point = next_code_point(text, pos);
+            auto advance = advances.find(code_point);
+            if (advance == end(advances)) {
+                advance = advances.emplace(code_point, glyph_advance(code_point, font_size, style)).first;
+            }
+            width += advance->second;
+        }
+
+        // Don't let the cache grow forever on pages with a lot of unique text.
+        if (widths_.size() >= kMaxCachedWidths) {
+            widths_.clear();
+        }
+
+        // Advances are in 26.6 fixed point.
+        auto const px = static_cast<int>((width + 32) >> 6);
+        widths_.emplace(std::move(key), px);
+        return {px, height};
+    }
+
+    [[nodiscard]] RasterizedText rasterize(std::string_view text, Px font_size, gfx::FontStyle style) const override {
+        std::scoped_lock lock{mtx_};
+        set_size(font_size);
+        auto const baseline = static_cast<int>((face_->size->metrics.ascender + 32) >> 6);
+        auto &glyphs = glyphs_[{font_size.v, style}];
+
+        // Place the glyphs first to know how large the mask has to be.
+        std::vector<std::pair<Glyph const *, int>> placed;
+        FT_Pos pen{};
+        int left{};
+        int right{};
+        int top{};
+        int bottom{};
+        for (std::size_t pos = 0; pos < text.size();) {
+            auto const code_point = next_code_point(text, pos);
+            auto glyph = glyphs.find(code_point);
+            if (glyph == end(glyphs)) {
+                glyph = glyphs.emplace(code_point, render_glyph(code_point, style)).first;
+            }
+
+            auto const &g = glyph->second;
+            auto const x = static_cast<int>((pen + 32) >> 6) + g.left;
+            auto const y = baseline - g.top;
+            pen += g.advance;
+            if (g.width == 0 || g.rows == 0) {
+                continue;
+            }
+
+            if (placed.empty()) {
+                left = x;
+                right = x + g.width;
+                top = y;
+                bottom = y + g.rows;
+            } else {
+                left = std::min(left, x);
+                right = std::max(right, x + g.width);
+                top = std::min(top, y);
+                bottom = std::max(bottom, y + g.rows);
+            }
+            placed.emplace_back(&g, x);
+        }
+
+        RasterizedText rasterized{
+                .bounds{left, top, right - left, bottom - top},
+                .coverage = std::vector<std::uint8_t>(static_cast<std::size_t>((right - left) * (bottom - top))),
+                .baseline = baseline,
+                .advance = static_cast<int>((pen + 32) >> 6),
+        };
+
+        for (auto const &[glyph, x] : placed) {
+            auto const y = baseline - glyph->top;
+            for (int row = 0; row < glyph->rows; ++row) {
+                auto const *src = glyph->coverage.data() + static_cast<std::size_t>(row * glyph->width);
+                auto *dst = rasterized.coverage.data()
+                        + static_cast<std::size_t>((y - top + row) * rasterized.bounds.width + x - left);
+                // Glyphs may overlap a bit.
+                for (int column = 0; column < glyph->width; ++column) {
+                    dst[column] = std::max(dst[column], src[column]);
+                }
+            }
+        }
+
+        return rasterized;
+    }
+
+private:
+    static constexpr std::size_t kMaxCachedWidths = 100'000;
+
+    struct Glyph {
+        // Offset of the bitmap from the pen position on the baseline, with
+        // positive values being up.
+        int left{};
+        int top{};
+        int width{};
+        int rows{};
+        FT_Pos advance{};
+        std::vector<std::uint8_t> coverage{};
+    };
+
+    struct WidthKeyHash {
+        std::size_t operator()(std::tuple<std::string, int, gfx::FontStyle> const &key) const {
+            auto const &[text, size, style] = key;
+            return std::hash<std::string>{}(text) ^ (std::hash<int>{}(size) << 1)
+                    ^ (std::hash<int>{}(static_cast<int>(style)) << 2);
+        }
+    };
+
+    void set_size(Px font_size) const {
+        if (font_size != current_size_) {
+            FT_Set_Pixel_Sizes(face_, 0, static_cast<FT_UInt>(font_size.v));
+            current_size_ = font_size;
+        }
+    }
+
+    int line_height(Px font_size) const {
+        set_size(font_size);
+        return static_cast<int>((face_->size->metrics.height + 32) >> 6);
+    }
+
+    FT_Pos glyph_advance(char32_t code_point, Px font_size, gfx::FontStyle style) const {
+        set_size(font_size);
+        if (FT_Load_Char(face_, code_point, FT_LOAD_DEFAULT) != 0) {
+            return 0;
+        }
+
+        if ((style & gfx::FontStyle::Bold) != gfx::FontStyle::Normal) {
+            FT_GlyphSlot_Embolden(face_->glyph);
+        }
+
+        return face_->glyph->advance.x;
+    }
+
+    // Requires the size to have been set.
+    Glyph render_glyph(char32_t code_point, gfx::FontStyle style) const {
+        if (FT_Load_Char(face_, code_point, FT_LOAD_DEFAULT) != 0) {
+            return {};
+        }
+
+        auto *slot = face_->glyph;
+        if ((style & gfx::FontStyle::Bold) != gfx::FontStyle::Normal) {
+            FT_GlyphSlot_Embolden(slot);
+        }
+
+        if ((style & gfx::FontStyle::Italic) != gfx::FontStyle::Normal) {
+            FT_GlyphSlot_Oblique(slot);
+        }
+
+        Glyph glyph{.advance = slot->advance.x};
+        if (FT_Render_Glyph(slot, FT_RENDER_MODE_NORMAL) != 0) {
+            return glyph;
+        }
+
+        auto const &bitmap = slot->bitmap;
+        glyph.left = slot->bitmap_left;
+        glyph.top = slot->bitmap_top;
+        glyph.width = static_cast<int>(bitmap.width);
+        glyph.rows = static_cast<int>(bitmap.rows);
+        glyph.coverage.reserve(static_cast<std::size_t>(glyph.width * glyph.rows));
+        for (int row = 0; row < glyph.rows; ++row) {
+            auto const *src = bitmap.buffer + static_cast<std::ptrdiff_t>(row) * bitmap.pitch;
+            glyph.coverage.insert(end(glyph.coverage), src, src + glyph.width);
+        }
+
+        return glyph;
+    }
+
+    std::shared_ptr<FreeTypeType::Library> library_;
+    FT_Face face_;
+
+    mutable std::mutex mtx_;
+    mutable Px current_size_{};
+    // Glyph advances per font size and style.
+    mutable std::map<std::pair<int, gfx::FontStyle>, std::unordered_map<char32_t, FT_Pos>> advances_;
+    mutable std::unordered_map<std::tuple<std::string, int, gfx::FontStyle>, int, WidthKeyHash> widths_;
+    // Rendered glyphs per font size and style.
+    mutable std::map<std::pair<int, gfx::FontStyle>, std::unordered_map<char32_t, Glyph>> glyphs_;
+};
+
+} // namespace
+
+FreeTypeType::FreeTypeType() {
+    FT_Library library{};
+    if (auto error = FT_Init_FreeType(&library); error != 0) {
+        spdlog::error("Unable to initialize FreeType: {}", error);
+        return;
+    }
+
+    library_ = std::make_shared<Library>();
+    library_->library = library;
+}
+
+std::optional<std::shared_ptr<IFont const>> FreeTypeType::font(std::string_view name) const {
+    {
+        std::scoped_lock lock{mtx_};
+        if (auto const *font = fonts_.get(name)) {
+            return *font ? std::optional{*font} : std::nullopt;
+        }
+    }
+
+    auto face = find_font(name);
+    auto font = face ? font_from_file(face->path, face->index) : std::nullopt;
+
+    std::scoped_lock lock{mtx_};
+    fonts_.put(std::string{name}, font.value_or(nullptr));
+    return font;
+}
+
+std::optional<std::shared_ptr<IFont const>> FreeTypeType::font_from_file(
+        std::string const &path, int face_index) const {
+    if (!library_) {
+        return std::nullopt;
+    }
+
+    FT_Face face{};
+    {
+        std::scoped_lock lock{library_->mtx};
+        if (auto error = FT_New_Face(library_->library, path.c_str(), face_index, &face); error != 0) {
+            spdlog::warn("Unable to load font '{}': {}", path, error);
+            return std::nullopt;
+        }
+    }
+
+    return std::make_shared<FreeTypeFont const>(library_, face);
+}
+
+std::optional<std::shared_ptr<IFont const>> FreeTypeType::fallback_font() const {
+    auto face = system_font_index().fallback();
+    if (!face) {
+        return std::nullopt;
+    }
+
+    return font_from_file(face->path, face->index);
+}
+
+} // namespace type
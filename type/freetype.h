@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef TYPE_FREETYPE_H_
+#define TYPE_FREETYPE_H_
+
+#include "type/type.h"
+
+#include "util/lru_cache.h"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace type {
+
+// Measures text using the glyph advances of real fonts. Glyph advances are
+// cached per font, size, and style, and the widths of measured strings are
+// cached as well, so laying out the same text again is cheap.
+class FreeTypeType : public IType {
+public:
+    FreeTypeType();
+
+    // Looks the font up on the system, see type::find_font.
+    [[nodiscard]] std::optional<std::shared_ptr<IFont const>> font(std::string_view name) const override;
+
+    [[nodiscard]] std::optional<std::shared_ptr<IFont const>> font_from_file(
+            std::string const &path, int face_index = 0) const;
+
+    // Loads the font to use when none of the ones asked for exist, see
+    // type::FontIndex::fallback.
+    [[nodiscard]] std::optional<std::shared_ptr<IFont const>> fallback_font() const;
+
+    struct Library;
+
+private:
+    static constexpr std::size_t kMaxCachedFonts = 64;
+
+    std::shared_ptr<Library> library_;
+
+    mutable std::mutex mtx_;
+    // Fonts that couldn't be found are cached as nullptr.
+    mutable util::LruCache<std::string, std::shared_ptr<IFont const>> fonts_{kMaxCachedFonts};
+};
+
+} // namespace type
+
+#endif
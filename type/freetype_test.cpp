@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "type/freetype.h"
+
+#include "type/font_finder.h"
+
+#include "etest/etest.h"
+#include "gfx/font.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+using etest::expect;
+using etest::expect_eq;
+using etest::require;
+
+int main() {
+    type::set_font_index_directory(std::nullopt);
+
+    etest::test("missing font", [] {
+        type::FreeTypeType type;
+        expect(!type.font("this font really does not exist").has_value());
+        expect(!type.font("this font really does not exist").has_value());
+        expect(!type.font_from_file("/this/file/does/not/exist.ttf").has_value());
+    });
+
+    auto path = type::find_path_to_fallback_font();
+    if (!path) {
+        std::cerr << "No fonts installed, skipping measurement tests\n";
+        return etest::run_all_tests();
+    }
+
+    etest::test("measure", [path = *path] {
+        type::FreeTypeType type;
+        auto font = type.font_from_file(path);
+        require(font.has_value());
+
+        auto width = [&](std::string_view text, int px = 16, gfx::FontStyle style = gfx::FontStyle::Normal) {
+            return (*font)->measure(text, type::Px{px}, style).width;
+        };
+
+        expect_eq(width(""), 0);
+        expect(width("a") > 0);
+        expect(width("aaaa") > width("aa"));
+        expect(std::abs(width("ab") - (width("a") + width("b"))) <= 1);
+        expect(width("hello", 32) > width("hello", 16));
+        expect(width("hello", 16, gfx::FontStyle::Bold) >= width("hello", 16));
+
+        // Measured widths are cached, so this must be the same no matter what
+        // was measured in between.
+        auto const hello = width("hello");
+        std::ignore = width("hello", 12, gfx::FontStyle::Italic);
+        expect_eq(width("hello"), hello);
+        expect(width("h\xc3\xa4llo") > 0);
+        expect(width("\xff\xc3") > 0);
+
+        expect((*font)->measure("a", type::Px{16}, gfx::FontStyle::Normal).height >= 16);
+    });
+
+    etest::test("rasterize", [path = *path] {
+        type::FreeTypeType type;
+        auto font = type.font_from_file(path);
+        require(font.has_value());
+
+        auto const empty = (*font)->rasterize("", type::Px{16}, gfx::FontStyle::Normal);
+        expect_eq(empty.coverage.size(), std::size_t{0});
+        expect_eq(empty.advance, 0);
+
+        auto const text = (*font)->rasterize("Hello", type::Px{16}, gfx::FontStyle::Normal);
+        expect_eq(text.advance, (*font)->measure("Hello", type::Px{16}, gfx::FontStyle::Normal).width);
+        expect(text.bounds.width > 0 && text.bounds.width <= text.advance + 2);
+        expect(text.bounds.height > 0 && text.bounds.height <= 20);
+        expect(text.baseline > 0 && text.bounds.top() < text.baseline && text.bounds.bottom() <= text.baseline + 5);
+        expect_eq(text.coverage.size(), static_cast<std::size_t>(text.bounds.width * text.bounds.height));
+        expect(std::ranges::any_of(text.coverage, [](auto c) { return c == 0xFF; }));
+
+        // Rendered glyphs are cached, so this must be the same no matter what
+        // was drawn in between.
+        std::ignore = (*font)->rasterize("Hello", type::Px{30}, gfx::FontStyle::Bold);
+        expect_eq((*font)->rasterize("Hello", type::Px{16}, gfx::FontStyle::Normal), text);
+    });
+
+    etest::test("fonts are cached", [path = *path] {
+        type::FreeTypeType type;
+        auto name = path.substr(path.find_last_of('/') + 1);
+        auto font = type.font(name);
+        require(font.has_value());
+        expect_eq(*type.font(name), *font);
+    });
+
+    return etest::run_all_tests();
+}
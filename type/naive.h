@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef TYPE_NAIVE_H_
+#define TYPE_NAIVE_H_
+
+#include "type/type.h"
+
+#include "gfx/font.h"
+
+#include <memory>
+#include <optional>
+#include <string_view>
+
+namespace type {
+
+// Pretends that every character is half as wide as it is tall, for when
+// there's no real font to measure text with.
+class NaiveFont : public IFont {
+public:
+    [[nodiscard]] Size measure(std::string_view text, Px font_size, gfx::FontStyle) const override {
+        return Size{static_cast<int>(text.size()) * font_size.v / 2, font_size.v};
+    }
+};
+
+class NaiveType : public IType {
+public:
+    [[nodiscard]] std::optional<std::shared_ptr<IFont const>> font(std::string_view) const override {
+        return font_;
+    }
+
+private:
+    std::shared_ptr<NaiveFont const> font_{std::make_shared<NaiveFont>()};
+};
+
+} // namespace type
+
+#endif
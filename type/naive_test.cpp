@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "type/naive.h"
+
+#include "etest/etest.h"
+#include "gfx/font.h"
+
+using etest::expect_eq;
+using etest::require;
+
+int main() {
+    etest::test("every font is the same font", [] {
+        type::NaiveType type;
+        auto arial = type.font("arial");
+        auto comic_sans = type.font("comic sans");
+        require(arial.has_value() && comic_sans.has_value());
+        expect_eq(*arial, *comic_sans);
+    });
+
+    etest::test("measure", [] {
+        type::NaiveFont font;
+        expect_eq(font.measure("hello", type::Px{10}, gfx::FontStyle::Normal), type::Size{25, 10});
+        expect_eq(font.measure("", type::Px{10}, gfx::FontStyle::Italic), type::Size{0, 10});
+    });
+
+    etest::test("rasterize", [] {
+        type::NaiveFont font;
+        expect_eq(font.rasterize("hello", type::Px{10}, gfx::FontStyle::Normal), type::RasterizedText{});
+    });
+
+    return etest::run_all_tests();
+}
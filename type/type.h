@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef TYPE_TYPE_H_
+#define TYPE_TYPE_H_
+
+#include "geom/geom.h"
+#include "gfx/font.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace type {
+
+struct Px {
+    int v{};
+    [[nodiscard]] bool operator==(Px const &) const = default;
+};
+
+struct Size {
+    int width{};
+    int height{};
+    [[nodiscard]] bool operator==(Size const &) const = default;
+};
+
+// Text drawn in a single color, as an 8-bit coverage mask.
+struct RasterizedText {
+    // Where the mask goes, relative to the top-left corner of the line the
+    // text is drawn on.
+    geom::Rect bounds{};
+    // bounds.width * bounds.height values, row by row.
+    std::vector<std::uint8_t> coverage{};
+    // Distance from the top of the line to the baseline.
+    int baseline{};
+    // How far the pen moved, i.e. where text following this would start.
+    int advance{};
+    [[nodiscard]] bool operator==(RasterizedText const &) const = default;
+};
+
+class IFont {
+public:
+    virtual ~IFont() = default;
+    [[nodiscard]] virtual Size measure(std::string_view text, Px font_size, gfx::FontStyle) const = 0;
+
+    // Fonts that are only good for measuring text don't draw anything.
+    [[nodiscard]] virtual RasterizedText rasterize(std::string_view, Px, gfx::FontStyle) const { return {}; }
+};
+
+// Provides fonts for measuring text. Implementations must be safe to use from
+// multiple threads at once.
+class IType {
+public:
+    virtual ~IType() = default;
+    [[nodiscard]] virtual std::optional<std::shared_ptr<IFont const>> font(std::string_view name) const = 0;
+};
+
+} // namespace type
+
+#endif
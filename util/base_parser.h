@@ -6,8 +6,10 @@
 #ifndef UTIL_BASE_PARSER_H_
 #define UTIL_BASE_PARSER_H_
 
+#include "util/find_first_of.h"
 #include "util/string.h"
 
+#include <algorithm>
 #include <concepts>
 #include <cstddef>
 #include <string_view>
@@ -51,6 +53,17 @@ public:
         return input_.substr(start, pos_ - start);
     }
 
+    // Consumes everything up until any of the delimiters or the end of the input.
+    constexpr std::string_view consume_until_any_of(std::string_view delimiters) {
+        if (is_eof()) {
+            return {};
+        }
+
+        std::size_t start = pos_;
+        pos_ = std::min(util::find_first_of(input_, delimiters, pos_), input_.size());
+        return input_.substr(start, pos_ - start);
+    }
+
     constexpr void skip_whitespace() {
         while (!is_eof() && util::is_whitespace(peek())) {
             advance(1);
@@ -48,6 +48,21 @@ int main() {
         expect_eq(p.consume_char(), 'd');
     });
 
+    etest::test("consume_until_any_of", [] {
+        auto p = BaseParser("ab{cd;e");
+        expect_eq(p.consume_until_any_of("{;"), "ab");
+        expect_eq(p.consume_until_any_of("{;"), "");
+        expect_eq(p.consume_char(), '{');
+        expect_eq(p.consume_until_any_of("{;"), "cd");
+        expect_eq(p.consume_char(), ';');
+        expect_eq(p.consume_until_any_of("{;"), "e");
+        expect(p.is_eof());
+        expect_eq(p.consume_until_any_of("{;"), "");
+
+        constexpr auto kConsumed = BaseParser("hello world").consume_until_any_of(" ");
+        expect_eq(kConsumed, "hello");
+    });
+
     etest::test("consume_while", [] {
         auto p = BaseParser("abcd");
         expect_eq(p.consume_while([](char c) { return c != 'c'; }), "ab");
@@ -0,0 +1,127 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef UTIL_FIND_FIRST_OF_H_
+#define UTIL_FIND_FIRST_OF_H_
+
+#include <bit>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define HASTUR_UTIL_FIND_FIRST_OF_SSE2
+// Picking between implementations at runtime needs __builtin_cpu_supports and
+// the target attribute.
+#if defined(__GNUC__)
+#define HASTUR_UTIL_FIND_FIRST_OF_AVX2
+#endif
+#endif
+
+namespace util {
+namespace detail {
+
+// More needles than this and the vectorized versions aren't worth it.
+inline constexpr std::size_t kMaxVectorizedNeedles = 8;
+
+constexpr std::size_t find_first_of_scalar(std::string_view haystack, std::string_view needles, std::size_t pos) {
+    for (; pos < haystack.size(); ++pos) {
+        if (needles.find(haystack[pos]) != std::string_view::npos) {
+            return pos;
+        }
+    }
+
+    return std::string_view::npos;
+}
+
+#if defined(HASTUR_UTIL_FIND_FIRST_OF_SSE2)
+inline std::size_t find_first_of_sse2(std::string_view haystack, std::string_view needles, std::size_t pos) {
+    // NOLINTNEXTLINE(modernize-avoid-c-arrays): std::array drops the vector type's alignment attributes.
+    __m128i splatted_needles[kMaxVectorizedNeedles]{};
+    for (std::size_t i = 0; i < needles.size(); ++i) {
+        splatted_needles[i] = _mm_set1_epi8(needles[i]);
+    }
+
+    for (; pos + sizeof(__m128i) <= haystack.size(); pos += sizeof(__m128i)) {
+        auto block = _mm_loadu_si128(reinterpret_cast<__m128i const *>(haystack.data() + pos));
+        auto matches = _mm_setzero_si128();
+        for (std::size_t i = 0; i < needles.size(); ++i) {
+            matches = _mm_or_si128(matches, _mm_cmpeq_epi8(block, splatted_needles[i]));
+        }
+
+        if (auto mask = static_cast<unsigned>(_mm_movemask_epi8(matches)); mask != 0) {
+            return pos + std::countr_zero(mask);
+        }
+    }
+
+    return find_first_of_scalar(haystack, needles, pos);
+}
+#endif
+
+#if defined(HASTUR_UTIL_FIND_FIRST_OF_AVX2)
+[[gnu::target("avx2")]] inline std::size_t find_first_of_avx2(
+        std::string_view haystack, std::string_view needles, std::size_t pos) {
+    // NOLINTNEXTLINE(modernize-avoid-c-arrays): std::array drops the vector type's alignment attributes.
+    __m256i splatted_needles[kMaxVectorizedNeedles]{};
+    for (std::size_t i = 0; i < needles.size(); ++i) {
+        splatted_needles[i] = _mm256_set1_epi8(needles[i]);
+    }
+
+    for (; pos + sizeof(__m256i) <= haystack.size(); pos += sizeof(__m256i)) {
+        auto block = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(haystack.data() + pos));
+        auto matches = _mm256_setzero_si256();
+        for (std::size_t i = 0; i < needles.size(); ++i) {
+            matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(block, splatted_needles[i]));
+        }
+
+        if (auto mask = static_cast<unsigned>(_mm256_movemask_epi8(matches)); mask != 0) {
+            return pos + std::countr_zero(mask);
+        }
+    }
+
+    return find_first_of_sse2(haystack, needles, pos);
+}
+#endif
+
+using FindFirstOfFn = std::size_t (*)(std::string_view, std::string_view, std::size_t);
+
+inline FindFirstOfFn select_find_first_of() {
+#if defined(HASTUR_UTIL_FIND_FIRST_OF_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        return &find_first_of_avx2;
+    }
+#endif
+
+#if defined(HASTUR_UTIL_FIND_FIRST_OF_SSE2)
+    // SSE2 is always available on x86-64.
+    return &find_first_of_sse2;
+#else
+    return [](std::string_view haystack, std::string_view needles, std::size_t pos) {
+        return find_first_of_scalar(haystack, needles, pos);
+    };
+#endif
+}
+
+inline std::size_t find_first_of_runtime(std::string_view haystack, std::string_view needles, std::size_t pos) {
+    static auto const impl = select_find_first_of();
+    return impl(haystack, needles, pos);
+}
+
+} // namespace detail
+
+// Like std::string_view::find_first_of, but checks 16 or 32 characters at a
+// time when the CPU supports it. Meant for finding the next character of
+// interest in long runs of characters parsers don't care about.
+constexpr std::size_t find_first_of(std::string_view haystack, std::string_view needles, std::size_t pos = 0) {
+    if (std::is_constant_evaluated() || needles.size() > detail::kMaxVectorizedNeedles) {
+        return detail::find_first_of_scalar(haystack, needles, pos);
+    }
+
+    return detail::find_first_of_runtime(haystack, needles, pos);
+}
+
+} // namespace util
+
+#endif
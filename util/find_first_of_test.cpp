@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "util/find_first_of.h"
+
+#include "etest/etest.h"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+using namespace std::literals;
+using etest::expect_eq;
+
+namespace {
+
+// Checks every position of the needle in haystacks long enough to hit both the
+// vectorized loop and the scalar tail.
+void expect_same_as_std(auto find_first_of) {
+    for (std::size_t size = 0; size < 100; ++size) {
+        std::string haystack(size, 'a');
+        expect_eq(find_first_of(haystack, "<&\0"sv, 0), std::string_view::npos);
+
+        for (std::size_t i = 0; i < size; ++i) {
+            haystack[i] = '&';
+            for (std::size_t pos = 0; pos < size; pos += 7) {
+                expect_eq(find_first_of(haystack, "<&\0"sv, pos), haystack.find_first_of("<&\0"sv, pos));
+            }
+            haystack[i] = 'a';
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    etest::test("find_first_of", [] {
+        expect_eq(util::find_first_of("hello <b>", "<&"), std::size_t{6});
+        expect_eq(util::find_first_of("hello <b>", "<&", 7), std::string_view::npos);
+        expect_eq(util::find_first_of("", "<&"), std::string_view::npos);
+        expect_eq(util::find_first_of("hello", ""), std::string_view::npos);
+        expect_eq(util::find_first_of("hello", "abcdefghijklmnopqrstuvwxyz", 2), std::size_t{2});
+    });
+
+    etest::test("find_first_of, constexpr", [] {
+        static_assert(util::find_first_of("hello <b>", "<&") == 6);
+        static_assert(util::find_first_of("hello", "<&") == std::string_view::npos);
+    });
+
+    etest::test("find_first_of, matches std", [] {
+        expect_same_as_std([](std::string_view haystack, std::string_view needles, std::size_t pos) {
+            return util::find_first_of(haystack, needles, pos);
+        });
+    });
+
+    etest::test("find_first_of, scalar", [] { expect_same_as_std(&util::detail::find_first_of_scalar); });
+
+#if defined(HASTUR_UTIL_FIND_FIRST_OF_SSE2)
+    etest::test("find_first_of, sse2", [] { expect_same_as_std(&util::detail::find_first_of_sse2); });
+#endif
+
+#if defined(HASTUR_UTIL_FIND_FIRST_OF_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        etest::test("find_first_of, avx2", [] { expect_same_as_std(&util::detail::find_first_of_avx2); });
+    }
+#endif
+
+    return etest::run_all_tests();
+}
@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef UTIL_LRU_CACHE_H_
+#define UTIL_LRU_CACHE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <map>
+#include <utility>
+
+namespace util {
+
+// A map holding at most capacity entries, where adding an entry to a full
+// cache evicts the one that was least recently used.
+template<typename Key, typename Value>
+class LruCache {
+public:
+    explicit LruCache(std::size_t capacity) : capacity_{std::max<std::size_t>(capacity, 1)} {}
+
+    // Marks the entry as the most recently used one. The pointer is valid
+    // until the entry is evicted.
+    template<typename K>
+    [[nodiscard]] Value *get(K const &key) {
+        auto it = index_.find(key);
+        if (it == end(index_)) {
+            return nullptr;
+        }
+
+        entries_.splice(begin(entries_), entries_, it->second);
+        return &it->second->second;
+    }
+
+    Value &put(Key key, Value value) {
+        if (auto it = index_.find(key); it != end(index_)) {
+            it->second->second = std::move(value);
+            entries_.splice(begin(entries_), entries_, it->second);
+            return it->second->second;
+        }
+
+        if (entries_.size() >= capacity_) {
+            index_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+
+        entries_.emplace_front(key, std::move(value));
+        index_.emplace(std::move(key), begin(entries_));
+        return entries_.front().second;
+    }
+
+    template<typename K>
+    void erase(K const &key) {
+        if (auto it = index_.find(key); it != end(index_)) {
+            entries_.erase(it->second);
+            index_.erase(it);
+        }
+    }
+
+    [[nodiscard]] std::size_t size() const { return entries_.size(); }
+    [[nodiscard]] std::size_t capacity() const { return capacity_; }
+
+    void clear() {
+        index_.clear();
+        entries_.clear();
+    }
+
+private:
+    using Entries = std::list<std::pair<Key, Value>>;
+
+    std::size_t capacity_{};
+    // Most recently used first.
+    Entries entries_;
+    std::map<Key, typename Entries::iterator, std::less<>> index_;
+};
+
+} // namespace util
+
+#endif
@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "util/lru_cache.h"
+
+#include "etest/etest.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+using namespace std::literals;
+using etest::expect;
+using etest::expect_eq;
+using etest::require;
+using util::LruCache;
+
+int main() {
+    etest::test("get and put", [] {
+        LruCache<std::string, int> cache{2};
+        expect_eq(cache.get("a"sv), nullptr);
+
+        cache.put("a", 1);
+        require(cache.get("a"sv) != nullptr);
+        expect_eq(*cache.get("a"sv), 1);
+
+        // Replacing a value doesn't add a new entry.
+        cache.put("a", 2);
+        expect_eq(*cache.get("a"sv), 2);
+        expect_eq(cache.size(), std::size_t{1});
+    });
+
+    etest::test("the least recently used entry is evicted", [] {
+        LruCache<std::string, int> cache{2};
+        cache.put("a", 1);
+        cache.put("b", 2);
+
+        // Using a makes b the least recently used entry.
+        expect(cache.get("a"sv) != nullptr);
+        cache.put("c", 3);
+        expect_eq(cache.size(), std::size_t{2});
+        expect_eq(cache.get("b"sv), nullptr);
+        expect(cache.get("a"sv) != nullptr);
+        expect(cache.get("c"sv) != nullptr);
+
+        // Replacing a value counts as using it.
+        cache.put("c", 4);
+        cache.put("d", 5);
+        expect_eq(cache.get("a"sv), nullptr);
+        expect_eq(*cache.get("c"sv), 4);
+        expect_eq(*cache.get("d"sv), 5);
+    });
+
+    etest::test("erase", [] {
+        LruCache<std::string, int> cache{2};
+        cache.put("a", 1);
+        cache.put("b", 2);
+
+        cache.erase("a"sv);
+        cache.erase("c"sv);
+        expect_eq(cache.size(), std::size_t{1});
+        expect_eq(cache.get("a"sv), nullptr);
+        expect_eq(*cache.get("b"sv), 2);
+    });
+
+    etest::test("evicted values are destroyed", [] {
+        auto value = std::make_shared<int>(1);
+        LruCache<int, std::shared_ptr<int>> cache{1};
+        cache.put(1, value);
+        expect_eq(value.use_count(), 2L);
+
+        cache.put(2, nullptr);
+        expect_eq(value.use_count(), 1L);
+
+        cache.clear();
+        expect_eq(cache.size(), std::size_t{0});
+        expect_eq(cache.capacity(), std::size_t{1});
+    });
+
+    etest::test("capacity is at least 1", [] {
+        LruCache<int, int> cache{0};
+        cache.put(1, 1);
+        expect_eq(*cache.get(1), 1);
+    });
+
+    return etest::run_all_tests();
+}
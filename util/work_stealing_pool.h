@@ -0,0 +1,168 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef UTIL_WORK_STEALING_POOL_H_
+#define UTIL_WORK_STEALING_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace util {
+
+// A thread pool where every worker has its own task queue and idle workers
+// steal tasks from the others' queues, so uneven tasks still keep all threads
+// busy.
+class WorkStealingPool {
+public:
+    // thread_count includes the thread calling parallel_for, which helps out
+    // while waiting, so a pool with a thread count of 1 runs everything inline.
+    explicit WorkStealingPool(std::size_t thread_count = std::max(1U, std::thread::hardware_concurrency())) {
+        auto const worker_count = std::max<std::size_t>(thread_count, 1) - 1;
+        for (std::size_t i = 0; i < worker_count; ++i) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+
+        for (std::size_t i = 0; i < worker_count; ++i) {
+            workers_.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    WorkStealingPool(WorkStealingPool const &) = delete;
+    WorkStealingPool &operator=(WorkStealingPool const &) = delete;
+
+    ~WorkStealingPool() {
+        {
+            std::scoped_lock lock{wake_mtx_};
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        workers_.clear();
+    }
+
+    [[nodiscard]] std::size_t thread_count() const { return workers_.size() + 1; }
+
+    // Calls fn(i) for every i in [0, count) and returns once all calls are
+    // done. It's fine to call parallel_for from inside of fn.
+    void parallel_for(std::size_t count, std::function<void(std::size_t)> const &fn) {
+        if (workers_.empty() || count <= 1) {
+            for (std::size_t i = 0; i < count; ++i) {
+                fn(i);
+            }
+            return;
+        }
+
+        std::mutex done_mtx;
+        std::condition_variable done;
+        std::size_t remaining{count};
+
+        for (std::size_t i = 0; i < count; ++i) {
+            push(i % queues_.size(), [&, i] {
+                fn(i);
+                // The lock is held while notifying, as the waiting thread
+                // destroys done_mtx and done as soon as it sees remaining hit 0.
+                std::scoped_lock lock{done_mtx};
+                if (--remaining == 0) {
+                    done.notify_all();
+                }
+            });
+        }
+
+        // Help out rather than just waiting.
+        while (auto task = steal(std::nullopt)) {
+            (*task)();
+        }
+
+        std::unique_lock lock{done_mtx};
+        done.wait(lock, [&] { return remaining == 0; });
+    }
+
+private:
+    using Task = std::function<void()>;
+
+    struct Queue {
+        std::mutex mtx;
+        std::deque<Task> tasks;
+    };
+
+    void push(std::size_t queue, Task task) {
+        {
+            // Holding wake_mtx_ here means the task can't be taken, and
+            // queued_ decremented, before it's been counted.
+            std::scoped_lock lock{wake_mtx_, queues_[queue]->mtx};
+            queues_[queue]->tasks.push_back(std::move(task));
+            queued_ += 1;
+        }
+        wake_.notify_one();
+    }
+
+    // Takes the newest task from the thread's own queue, or the oldest one
+    // from any other queue if its own is empty.
+    std::optional<Task> steal(std::optional<std::size_t> own_queue) {
+        std::optional<Task> task;
+        if (own_queue) {
+            auto &queue = *queues_[*own_queue];
+            std::scoped_lock lock{queue.mtx};
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+        }
+
+        auto const start = own_queue.value_or(0);
+        for (std::size_t i = 0; !task && i < queues_.size(); ++i) {
+            auto &queue = *queues_[(start + i) % queues_.size()];
+            std::scoped_lock lock{queue.mtx};
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+        }
+
+        if (task) {
+            std::scoped_lock lock{wake_mtx_};
+            queued_ -= 1;
+        }
+
+        return task;
+    }
+
+    void work(std::size_t own_queue) {
+        while (true) {
+            if (auto task = steal(own_queue)) {
+                (*task)();
+                continue;
+            }
+
+            std::unique_lock lock{wake_mtx_};
+            wake_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+            if (stopping_ && queued_ == 0) {
+                return;
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+
+    std::mutex wake_mtx_;
+    std::condition_variable wake_;
+    std::size_t queued_{};
+    bool stopping_{false};
+
+    // Last so that the workers are joined before anything they use is destroyed.
+    std::vector<std::jthread> workers_;
+};
+
+} // namespace util
+
+#endif
@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "util/work_stealing_pool.h"
+
+#include "etest/etest.h"
+
+#include <atomic>
+#include <cstddef>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using etest::expect;
+using etest::expect_eq;
+using util::WorkStealingPool;
+
+int main() {
+    etest::test("thread count", [] {
+        expect_eq(WorkStealingPool{1}.thread_count(), std::size_t{1});
+        expect_eq(WorkStealingPool{0}.thread_count(), std::size_t{1});
+        expect_eq(WorkStealingPool{4}.thread_count(), std::size_t{4});
+    });
+
+    etest::test("parallel_for, no tasks", [] {
+        WorkStealingPool pool{4};
+        pool.parallel_for(0, [](std::size_t) { expect(false); });
+    });
+
+    for (std::size_t threads : {1, 2, 4}) {
+        etest::test("parallel_for, " + std::to_string(threads) + " thread(s)", [threads] {
+            WorkStealingPool pool{threads};
+            std::vector<std::atomic<int>> visits(1000);
+            pool.parallel_for(visits.size(), [&](std::size_t i) { visits[i] += 1; });
+
+            for (auto const &v : visits) {
+                expect_eq(v.load(), 1);
+            }
+        });
+    }
+
+    etest::test("parallel_for, nested", [] {
+        WorkStealingPool pool{3};
+        std::atomic<int> sum{};
+        pool.parallel_for(10, [&](std::size_t i) {
+            pool.parallel_for(10, [&, i](std::size_t j) { sum += static_cast<int>(i * 10 + j); });
+        });
+
+        expect_eq(sum.load(), 4950);
+    });
+
+    etest::test("parallel_for, pool is reusable", [] {
+        WorkStealingPool pool{2};
+        for (int i = 0; i < 100; ++i) {
+            std::vector<int> out(16);
+            pool.parallel_for(out.size(), [&](std::size_t j) { out[j] = static_cast<int>(j); });
+
+            std::vector<int> expected(16);
+            std::iota(expected.begin(), expected.end(), 0);
+            expect(out == expected);
+        }
+    });
+
+    return etest::run_all_tests();
+}